@@ -0,0 +1,85 @@
+/*
+ * RGB565 frame content analysis
+ * RGB565 帧内容分析（黑/白像素统计、样本像素、平均亮度、曝光统计）
+ *
+ * Plain C, no ESP-IDF dependencies, so it also builds on Linux.
+ *
+ * frame_stats_t accumulates exposure statistics row by row, so the
+ * caller can feed it rows that were just written by the scaler and are
+ * still in cache, instead of reading the frame once more.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct {
+    uint32_t total;      // 像素数
+    uint32_t black;      // 0x0000
+    uint32_t white;      // 0xFFFF
+    uint16_t sample[4];  // 前4个像素 (原始字节序)
+} frame_analysis_t;
+
+// Analyse len bytes of RGB565 data (an odd trailing byte is ignored).
+void frame_analysis_rgb565(const uint8_t *buf, size_t len, frame_analysis_t *result);
+
+// Mean luma (0..255) of every step-th pixel of a big-endian RGB565 or YUYV
+// frame; cheap enough to run on each frame while the sensor settles.
+uint8_t frame_analysis_mean_luma(const uint8_t *buf, size_t len, bool yuyv, uint32_t step);
+
+#define FRAME_STATS_GRID_COLS 4
+#define FRAME_STATS_GRID_ROWS 4
+
+typedef enum {
+    FRAME_STATS_RED = 0,
+    FRAME_STATS_GREEN,
+    FRAME_STATS_BLUE,
+    FRAME_STATS_CHANNELS
+} frame_stats_channel_t;
+
+typedef struct {
+    uint16_t x;               // 统计区域 (图像坐标), 如缩放输出里被图像覆盖的部分
+    uint16_t y;
+    uint16_t width;
+    uint16_t height;
+    uint8_t step;             // 每 step 行、每 step 列取一个像素
+    uint32_t pixels;          // 取样像素数
+    uint32_t black;           // 0x0000
+    uint32_t white;           // 0xFFFF
+    // 各通道按原始位数: R/B 32 级, G 64 级
+    uint32_t hist_r[32];
+    uint32_t hist_g[64];
+    uint32_t hist_b[32];
+    // frame_stats_end 填写
+    uint32_t clipped_low[FRAME_STATS_CHANNELS];  // 该通道为 0
+    uint32_t clipped_high[FRAME_STATS_CHANNELS]; // 该通道为最大值
+    uint8_t mean_luma;                           // BT.601, 0..255
+    uint8_t grid_luma[FRAME_STATS_GRID_ROWS][FRAME_STATS_GRID_COLS]; // 各格平均亮度
+    // 累计中间值
+    uint32_t luma_sum;
+    uint32_t grid_sum[FRAME_STATS_GRID_ROWS][FRAME_STATS_GRID_COLS];
+    uint32_t grid_count[FRAME_STATS_GRID_ROWS][FRAME_STATS_GRID_COLS];
+} frame_stats_t;
+
+// Start a frame: statistics cover the width x height area at (x, y),
+// sampling every step-th pixel of every step-th row (from its top left).
+void frame_stats_begin(frame_stats_t *stats, uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+                       uint8_t step);
+
+// Add count big-endian RGB565 rows starting at image row y0, stride pixels
+// apart; rows and columns outside the area are skipped.
+void frame_stats_rows(frame_stats_t *stats, const uint16_t *rows, uint32_t stride, uint32_t y0, uint32_t count);
+
+// Fill in the clipped counts, mean luma and grid.
+void frame_stats_end(frame_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,133 @@
+/*
+ * Camera frame corruption checks
+ * 摄像头帧损坏检测（截断、字节错位、行错位、撕裂、测试图案）
+ *
+ * Plain C, no ESP-IDF dependencies, so it also builds on Linux.
+ * Only a sample of rows is read (every row_step-th, at most
+ * FRAME_CHECK_MAX_ROWS), so a QVGA frame costs a few dozen rows of PSRAM:
+ *   - length:     fewer bytes than width x height x 2
+ *   - pattern:    sampled rows identical to each other (colour bar test
+ *                 pattern, stuck sensor)
+ *   - duplicate:  every sampled row identical to one of the last frames
+ *   - stale:      some rows identical to the same row of a recent frame:
+ *                 the buffer was not fully rewritten (tear)
+ *   - truncated:  the last sampled rows hold a single value each, the
+ *                 rows above do not (DMA stopped early)
+ *   - byte phase: RGB565 rows decode smoother one byte off (a lost byte,
+ *                 seen as coloured stripes)
+ *   - line shift: from some row down, the rows match the same rows of the
+ *                 last good frame clearly better when moved sideways, the
+ *                 rows above do not (lost pixels); a pan moves them all
+ * Row checksums are compared bit-exact; sensor noise makes real rows
+ * differ from frame to frame. Clipped pixels (black or saturated) carry
+ * no noise, so in a static high-contrast scene such rows repeat exactly:
+ * a match only counts for rows with enough samples inside the range.
+ * A duplicate is the previous image again, not a damaged one; callers
+ * may show it as a static frame.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define FRAME_CHECK_MAX_ROWS 64
+#define FRAME_CHECK_HISTORY 3   // 驱动帧缓冲最多3个, 未覆盖的行来自其中某一帧
+#define FRAME_CHECK_MAX_SHIFT 16
+#define FRAME_CHECK_ROW_SAMPLES 32  // 每个取样行保存的亮度样本 (错位检查)
+
+typedef enum {
+    FRAME_CHECK_OK = 0,
+    FRAME_CHECK_LENGTH,
+    FRAME_CHECK_PATTERN,
+    FRAME_CHECK_DUPLICATE,
+    FRAME_CHECK_STALE,
+    FRAME_CHECK_TRUNCATED,
+    FRAME_CHECK_BYTE_PHASE,
+    FRAME_CHECK_LINE_SHIFT,
+    FRAME_CHECK_CLASS_COUNT
+} frame_check_class_t;
+
+typedef struct {
+    uint8_t row_step;         // 每隔几行取一行
+    uint8_t pixel_step;       // 行内每隔几个像素取样 (字节错位检查; 错位样本至少隔这么远)
+    uint8_t max_shift;        // 检查的最大水平错位 (像素, 不超过 FRAME_CHECK_MAX_SHIFT)
+    uint8_t min_shift;        // 更小的错位在噪声下分不清, 当作对齐
+    uint8_t shift_ratio_pct;  // 与上一好帧的差, 错开与对齐两者较小的要低于另一个的 ratio%, 否则该行不判断
+    uint8_t shift_min_diff;   // 错开后最大的平均差 (G 0..63 / Y 0..255) 低于它: 没有纹理, 不判断
+    uint8_t shift_rows;       // 帧尾连续错位的行达到它, 整帧判为错位
+    uint8_t shift_pct;        // 且占第一处错位以下可判断行的比例达到它
+    uint8_t phase_ratio_pct;  // 错一字节解码的差低于正常的 ratio%: 该行字节错位
+    uint8_t phase_rows;       // 字节错位的行达到它
+    uint8_t stale_rows;       // 与近几帧同一行相同的行达到它 (未全部相同时): 撕裂
+    uint8_t match_active_pct; // 行内取样不在两端 (非 0、非最大值) 的比例达到它, 与近几帧相同才算数
+    uint8_t truncated_rows;   // 末尾连续的单值行达到它
+    uint8_t pattern_pct;      // 与上一取样行相同的行占比达到它: 测试图案
+} frame_check_config_t;
+
+// Defaults tuned on the host corpus (host/tools/frame_check_corpus.c).
+#define FRAME_CHECK_CONFIG_DEFAULT() {  \
+    .row_step = 8,                      \
+    .pixel_step = 4,                    \
+    .max_shift = 8,                     \
+    .min_shift = 2,                     \
+    .shift_ratio_pct = 60,              \
+    .shift_min_diff = 2,                \
+    .shift_rows = 2,                    \
+    .shift_pct = 50,                    \
+    .phase_ratio_pct = 60,              \
+    .phase_rows = 2,                    \
+    .stale_rows = 2,                    \
+    .match_active_pct = 50,             \
+    .truncated_rows = 2,                \
+    .pattern_pct = 75,                  \
+}
+
+typedef struct {
+    frame_check_class_t verdict;
+    uint16_t rows;            // 取样行数
+    uint16_t repeated_rows;   // 与上一取样行相同
+    uint16_t active_rows;     // 取样不在两端的足够多, 与近几帧比较的行
+    uint16_t stale_rows;      // 其中与近几帧同一行相同的
+    uint16_t truncated_rows;  // 末尾连续的单值行
+    uint16_t phase_rows;      // 字节错位的行
+    uint16_t shifted_rows;    // 与上一帧相比水平错位的行
+    int16_t first_bad_row;    // 第一处异常所在的图像行, -1 = 没有
+    int8_t shift;             // 第一处错位的像素数 (负: 内容左移, 即丢了像素)
+} frame_check_result_t;
+
+typedef struct {
+    frame_check_config_t config;
+    uint16_t width;           // 上一帧的尺寸与格式, 改变时清空历史
+    uint16_t height;
+    bool yuyv;
+    uint8_t history;          // 有效的历史帧数
+    uint8_t next;
+    uint8_t ref;              // 当前的错位参考帧 (samples 下标)
+    uint8_t ref_age;          // 参考帧之后的帧数, 0 = 没有参考帧
+    uint32_t rows[FRAME_CHECK_HISTORY][FRAME_CHECK_MAX_ROWS]; // 近几帧各取样行的校验和
+    uint8_t samples[2][FRAME_CHECK_MAX_ROWS][FRAME_CHECK_ROW_SAMPLES]; // 上一个好帧与本帧的取样亮度
+    uint32_t counts[FRAME_CHECK_CLASS_COUNT];                 // 各结果的帧数
+} frame_check_t;
+
+void frame_check_init(frame_check_t *check, const frame_check_config_t *config);
+
+// Forget the recent frames (e.g. after the sensor was reprogrammed).
+void frame_check_reset(frame_check_t *check);
+
+// Check a big-endian RGB565 or YUYV frame of len bytes. result may be NULL.
+// The verdict is also counted in check->counts.
+frame_check_class_t frame_check_run(frame_check_t *check, const uint8_t *buf, size_t len, uint16_t width,
+                                    uint16_t height, bool yuyv, frame_check_result_t *result);
+
+const char *frame_check_class_name(frame_check_class_t verdict);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,114 @@
+/*
+ * Table-driven RGB565 frame scaler
+ * 查表式RGB565图像缩放（裁剪/适应/填充/居中）
+ *
+ * Plain C, no ESP-IDF dependencies, so it also builds on Linux.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// 目标图像最大尺寸（查表数组大小）
+#define FRAME_SCALER_MAX_DST_WIDTH 320
+#define FRAME_SCALER_MAX_DST_HEIGHT 320
+
+typedef enum {
+    FRAME_SCALER_MODE_CROP = 0,  // 取源图居中的 crop 区域，拉伸到整个屏幕
+    FRAME_SCALER_MODE_FIT,       // 保持比例完整显示，上下/左右留黑边
+    FRAME_SCALER_MODE_FILL,      // 保持比例铺满屏幕，裁掉多余部分
+    FRAME_SCALER_MODE_LETTERBOX, // 1:1 居中显示，不缩放，多余部分裁掉、不足部分留黑边
+} frame_scaler_mode_t;
+
+// 采样滤波方式, 可在运行时切换
+typedef enum {
+    FRAME_SCALER_FILTER_NEAREST = 0, // 最近邻点采样
+    FRAME_SCALER_FILTER_BOX,         // 2x2 区域平均, 缩小时减少锯齿和闪烁
+    FRAME_SCALER_FILTER_BILINEAR,    // 5位定点双线性插值
+} frame_scaler_filter_t;
+
+// 水平方向的行内核, 固定比例时使用 rgb565_kernels (最近邻) / rgb565_filters (滤波) 中的成对读取实现
+typedef enum {
+    FRAME_SCALER_KERNEL_LUT = 0,     // 任意比例, 查 x_map
+    FRAME_SCALER_KERNEL_COPY,        // 1:1
+    FRAME_SCALER_KERNEL_DECIMATE2,   // 2:1
+    FRAME_SCALER_KERNEL_DECIMATE5_2, // 5:2
+} frame_scaler_kernel_t;
+
+typedef struct {
+    uint16_t x;
+    uint16_t y;
+    uint16_t width;
+    uint16_t height;
+} frame_rect_t;
+
+typedef struct {
+    uint16_t src_width;
+    uint16_t src_height;
+    uint16_t src_stride;  // 源图每行像素数, 0 = src_width
+    uint16_t dst_width;
+    uint16_t dst_height;
+    frame_scaler_mode_t mode;
+    uint16_t crop_width;  // 仅 CROP 模式使用, 0 = 整个源图
+    uint16_t crop_height;
+    frame_scaler_filter_t filter;
+} frame_scaler_geometry_t;
+
+typedef struct {
+    frame_scaler_geometry_t geometry;
+    bool configured;
+    frame_scaler_kernel_t x_kernel;
+    frame_rect_t src_rect; // 被采样的源图区域
+    frame_rect_t dst_rect; // 目标图中被图像覆盖的区域, 其余填黑
+    uint16_t x_map[FRAME_SCALER_MAX_DST_WIDTH];      // dst_rect 内每列对应的源图 x
+    uint32_t y_offset[FRAME_SCALER_MAX_DST_HEIGHT];  // dst_rect 内每行对应的源图行偏移(像素)
+    // BOX/BILINEAR: 第二个采样点及其权重 (0..32)
+    uint16_t x_map2[FRAME_SCALER_MAX_DST_WIDTH];
+    uint32_t y_offset2[FRAME_SCALER_MAX_DST_HEIGHT];
+    uint8_t x_weight[FRAME_SCALER_MAX_DST_WIDTH];
+    uint8_t y_weight[FRAME_SCALER_MAX_DST_HEIGHT];
+} frame_scaler_t;
+
+// Build the lookup tables. Returns immediately when the geometry is unchanged,
+// so it is safe to call once per frame. Returns false for unsupported geometry.
+bool frame_scaler_configure(frame_scaler_t *scaler, const frame_scaler_geometry_t *geometry);
+
+// Scale one full frame. dst must hold dst_width * dst_height pixels.
+void frame_scaler_run(const frame_scaler_t *scaler, const uint16_t *src, uint16_t *dst);
+
+// Scale output rows [y0, y0 + rows) only. dst points at the first of those
+// rows and must hold rows * dst_width pixels (band buffer).
+void frame_scaler_run_rows(const frame_scaler_t *scaler, const uint16_t *src, uint16_t *dst,
+                           uint32_t y0, uint32_t rows);
+
+// Same as frame_scaler_run_rows for a YUYV (YUV422) source: colour
+// conversion, crop and scale in one pass. Always nearest sampling, the
+// filter setting is ignored. luma (optional) receives the Y plane of the
+// output rows, rows * dst_width bytes, black bars are 0.
+void frame_scaler_run_yuv422_rows(const frame_scaler_t *scaler, const uint8_t *src, uint16_t *dst,
+                                  uint8_t *luma, uint32_t y0, uint32_t rows);
+
+// Source pixels read by output rows [y0, y0 + rows): rows span->y ..
+// span->y + span->height - 1, columns span->x .. span->x + span->width - 1
+// (x and width even, whole YUYV pairs). Returns false when those rows are
+// all black bars and read nothing.
+bool frame_scaler_source_span(const frame_scaler_t *scaler, uint32_t y0, uint32_t rows, frame_rect_t *span);
+
+// frame_scaler_run_rows / frame_scaler_run_yuv422_rows on a copy of the
+// source rows (e.g. in internal RAM): band holds source rows from
+// first_row on, src_stride pixels apart, with the span columns of every
+// row at their usual x. Rows and columns outside the span are not read.
+void frame_scaler_run_rows_band(const frame_scaler_t *scaler, const uint16_t *band, uint32_t first_row,
+                                uint16_t *dst, uint32_t y0, uint32_t rows);
+void frame_scaler_run_yuv422_rows_band(const frame_scaler_t *scaler, const uint8_t *band, uint32_t first_row,
+                                       uint16_t *dst, uint8_t *luma, uint32_t y0, uint32_t rows);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,68 @@
+/*
+ * Motion detection on luma thumbnails
+ * 亮度缩略图上的运动检测（帧差 + 迟滞）
+ *
+ * Plain C, no ESP-IDF dependencies, so it also builds on Linux.
+ * Each thumbnail is compared with the previous one. The mean brightness
+ * change is taken out first, so auto exposure stepping does not count as
+ * motion; the score is the share of pixels that still differ by more
+ * than pixel_threshold, in permille. Motion starts after start_frames
+ * frames at or above start_permille and stops after stop_frames frames
+ * below stop_permille. A new detector, or one after reset, is moving.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define MOTION_THUMB_MAX_PIXELS (64 * 64)
+
+typedef struct {
+    uint16_t width;           // 缩略图尺寸
+    uint16_t height;
+    uint8_t pixel_threshold;  // 扣除整体亮度变化后, 亮度差超过它的像素算变化
+    uint8_t start_frames;     // 连续这么多帧达到 start_permille: 开始运动
+    uint16_t start_permille;
+    uint16_t stop_permille;   // 连续 stop_frames 帧低于它: 静止
+    uint16_t stop_frames;
+} motion_config_t;
+
+typedef enum {
+    MOTION_EVENT_NONE = 0,
+    MOTION_EVENT_START,
+    MOTION_EVENT_STOP,
+} motion_event_t;
+
+typedef struct {
+    motion_config_t config;
+    bool has_prev;
+    bool moving;
+    uint16_t score;           // 最近一帧, 千分比
+    int16_t brightness;       // 最近一帧的整体亮度变化
+    uint16_t run;             // 连续朝另一状态的帧数
+    uint8_t prev[MOTION_THUMB_MAX_PIXELS];
+} motion_detect_t;
+
+// False when the thumbnail is larger than MOTION_THUMB_MAX_PIXELS.
+bool motion_detect_init(motion_detect_t *m, const motion_config_t *config);
+
+// Forget the previous thumbnail (e.g. the capture format changed) and
+// start over as moving.
+void motion_detect_reset(motion_detect_t *m);
+
+// Score width * height luma values against the previous thumbnail.
+motion_event_t motion_detect_update(motion_detect_t *m, const uint8_t *thumb);
+
+// Luma (BT.601, 0..255) of count big-endian RGB565 pixels.
+void motion_luma_rgb565(const uint16_t *rgb, uint8_t *luma, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
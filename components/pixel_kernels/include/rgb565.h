@@ -0,0 +1,54 @@
+/*
+ * RGB565 pixel helpers
+ * RGB565 像素辅助函数
+ *
+ * The OV7670 and the ST7735S both use big-endian RGB565 (high byte first),
+ * so camera and LCD buffers can be passed through untouched. Arithmetic on
+ * the channels needs the value in CPU (little-endian) order first.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// 一个像素: 大端 <-> CPU 字节序
+static inline uint16_t rgb565_swap(uint16_t p)
+{
+    return (uint16_t)((p << 8) | (p >> 8));
+}
+
+// 一个32位字里的两个像素, 各自交换字节, 位置不变
+static inline uint32_t rgb565_swap_pair(uint32_t w)
+{
+    return ((w & 0x00FF00FFu) << 8) | ((w >> 8) & 0x00FF00FFu);
+}
+
+// CPU 字节序像素的各通道
+static inline uint32_t rgb565_r(uint16_t p)
+{
+    return p >> 11;
+}
+
+static inline uint32_t rgb565_g(uint16_t p)
+{
+    return (p >> 5) & 0x3F;
+}
+
+static inline uint32_t rgb565_b(uint16_t p)
+{
+    return p & 0x1F;
+}
+
+static inline uint16_t rgb565_pack(uint32_t r, uint32_t g, uint32_t b)
+{
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,58 @@
+/*
+ * Lossless RGB565 image codec
+ * RGB565 无损压缩 (QOI 风格: 游程 / 索引 / 差值)
+ *
+ * Plain C, no ESP-IDF dependencies, so it also builds on Linux.
+ * One pass, a fixed amount of work per pixel and no search, so encoding
+ * time only depends on the pixel count; the output never exceeds
+ * RGB565_CODEC_MAX_BYTES. Every image starts from the same state and
+ * decodes on its own.
+ *
+ * Byte stream, pixels in CPU order (r5 g6 b5), deltas modulo the channel:
+ *   00iiiiii           INDEX  像素 = 最近见过的 64 个颜色之一 (按哈希)
+ *   01rrggbb           DIFF   dr, dg, db 各 -2..1
+ *   10gggggg rrrrbbbb  LUMA   dg -32..31, dr - dg/2 与 db - dg/2 各 -8..7
+ *   11rrrrrr           RUN    重复上一个像素 1..62 次
+ *   11111110 hi lo     RAW    大端 RGB565
+ * The previous pixel starts as black.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// 全部是 RAW, 加上开头结束的上一次调用留下的游程
+#define RGB565_CODEC_MAX_BYTES(pixels) ((size_t)(pixels) * 3 + 1)
+#define RGB565_CODEC_INDEX_SIZE 64
+
+// Encoder state between rgb565_codec_encode() calls.
+typedef struct {
+    uint16_t prev;   // CPU 字节序
+    uint16_t run;
+    uint16_t index[RGB565_CODEC_INDEX_SIZE];
+} rgb565_encoder_t;
+
+void rgb565_codec_encode_begin(rgb565_encoder_t *enc);
+
+// Encode count big-endian RGB565 pixels (LCD/camera byte order), continuing
+// the image. out must hold RGB565_CODEC_MAX_BYTES(count); a pending run is
+// kept for the next call. Returns the bytes written.
+size_t rgb565_codec_encode(rgb565_encoder_t *enc, const uint16_t *pixels, size_t count, uint8_t *out);
+
+// End of the image: flush the pending run (at most 1 byte).
+size_t rgb565_codec_encode_end(rgb565_encoder_t *enc, uint8_t *out);
+
+// Decode one image of exactly count pixels (big-endian RGB565). Returns the
+// bytes consumed, 0 when the data is truncated or does not match count.
+size_t rgb565_codec_decode(const uint8_t *in, size_t in_bytes, uint16_t *pixels, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,38 @@
+/*
+ * RGB565 row resampling kernels
+ * RGB565 行重采样内核（1:1 复制、2:1 和 5:2 抽取）
+ *
+ * The portable versions use GCC vector extensions / 32-bit word access
+ * and build on Linux. On ESP32-S3 the 1:1 and 2:1 kernels use the PIE
+ * SIMD unit (rgb565_kernels_esp32s3.S) for 16-byte aligned rows and fall
+ * back to the portable code for the unaligned head/tail, so the output
+ * is identical on both targets.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// dst[i] = src[i]
+void rgb565_row_copy(const uint16_t *src, uint16_t *dst, uint32_t count);
+
+// dst[i] = src[2 * i]
+void rgb565_row_decimate2(const uint16_t *src, uint16_t *dst, uint32_t count);
+
+// dst[i] = src[(5 * i) / 2]
+void rgb565_row_decimate5_2(const uint16_t *src, uint16_t *dst, uint32_t count);
+
+// Portable implementations, always built. Used directly on non-S3
+// targets and as the reference for the PIE kernels.
+void rgb565_row_copy_portable(const uint16_t *src, uint16_t *dst, uint32_t count);
+void rgb565_row_decimate2_portable(const uint16_t *src, uint16_t *dst, uint32_t count);
+void rgb565_row_decimate5_2_portable(const uint16_t *src, uint16_t *dst, uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif
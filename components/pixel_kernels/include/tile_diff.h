@@ -0,0 +1,70 @@
+/*
+ * Tile-based change detection for partial LCD updates
+ * 分块变化检测（只刷新变化的区域）
+ *
+ * Plain C, no ESP-IDF dependencies, so it also builds on Linux.
+ * The frame is split into tiles of tile_size pixels; each tile carries a
+ * signature of 4x4 cell sums. A tile is dirty when any cell differs from
+ * the last *sent* signature by more than the noise threshold, so slow
+ * drift still ends up on screen. Dirty tiles are merged into at most
+ * max_rects non-overlapping rectangles.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "frame_scaler.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define TILE_DIFF_MAX_CELLS 2048 // 128x160 / 4x4 单元 = 1280
+#define TILE_DIFF_MAX_TILES 256
+#define TILE_DIFF_MAX_RECTS 8
+
+typedef struct {
+    uint16_t width;
+    uint16_t height;
+    uint16_t tile_size;    // 8/16/32, 每块 4x4 个单元
+    uint16_t threshold;    // 单元内平均每像素的变化量 (r5*2+g6+b5*2 单位)
+    uint8_t max_rects;     // <= TILE_DIFF_MAX_RECTS
+    uint8_t full_percent;  // 变化面积超过该比例时整帧发送
+} tile_diff_config_t;
+
+// 合并用的矩形, 以块为单位, 右/下边界不含
+typedef struct {
+    uint16_t x0, y0, x1, y1;
+} tile_diff_box_t;
+
+typedef struct {
+    tile_diff_config_t config;
+    uint16_t cell_size;
+    uint16_t cell_cols;
+    uint16_t cell_rows;
+    uint16_t tile_cols;
+    uint16_t tile_rows;
+    bool valid;                          // ref 是否对应屏幕内容
+    uint16_t ref[TILE_DIFF_MAX_CELLS];   // 已发送内容的单元和
+    uint16_t cur[TILE_DIFF_MAX_CELLS];
+    uint8_t dirty[TILE_DIFF_MAX_TILES];
+    tile_diff_box_t boxes[TILE_DIFF_MAX_TILES]; // 合并时的工作区, 不占任务栈
+} tile_diff_t;
+
+bool tile_diff_init(tile_diff_t *td, const tile_diff_config_t *config);
+
+// Compare a big-endian RGB565 frame against what was last sent and write
+// the rectangles to send into rects (capacity TILE_DIFF_MAX_RECTS, pixel
+// units). Returns 0 for a static frame. The covered tiles are assumed to
+// be sent; call tile_diff_invalidate() if sending fails.
+size_t tile_diff_update(tile_diff_t *td, const uint16_t *frame, frame_rect_t *rects);
+
+// Forget the screen contents; the next update returns the whole frame.
+void tile_diff_invalidate(tile_diff_t *td);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,30 @@
+/*
+ * YUV422 (YUYV) to RGB565 row conversion
+ * YUV422 (YUYV) 转 RGB565 行转换（裁剪、缩放、色彩转换一次完成）
+ *
+ * Plain C, no ESP-IDF dependencies, so it also builds on Linux.
+ * Full-range BT.601 with 8-bit fixed-point coefficients folded into lookup
+ * tables, so the per-pixel work is table loads and adds only.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// Build the coefficient tables. Called automatically on first use.
+void yuv422_init_tables(void);
+
+// Convert count output pixels from one YUYV source row. x_map[i] is the
+// source pixel column. dst receives big-endian RGB565 (LCD byte order);
+// luma, when not NULL, receives the Y value of each output pixel.
+void yuv422_row_to_rgb565(const uint8_t *row, const uint16_t *x_map,
+                          uint16_t *dst, uint8_t *luma, uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif
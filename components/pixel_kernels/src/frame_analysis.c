@@ -0,0 +1,200 @@
+/*
+ * RGB565 frame content analysis
+ * RGB565 帧内容分析
+ */
+#include <string.h>
+#include "frame_analysis.h"
+#include "rgb565.h"
+
+void frame_analysis_rgb565(const uint8_t *buf, size_t len, frame_analysis_t *result)
+{
+    const uint16_t *pixels = (const uint16_t *)buf;
+    uint32_t total = len / 2;
+    uint32_t black = 0, white = 0;
+
+    memset(result, 0, sizeof(*result));
+    // 0x0000/0xFFFF 与字节序无关, 直接比较
+    for (uint32_t i = 0; i < total; i++) {
+        black += pixels[i] == 0x0000;
+        white += pixels[i] == 0xFFFF;
+    }
+    result->total = total;
+    result->black = black;
+    result->white = white;
+    for (uint32_t i = 0; i < 4 && i < total; i++) {
+        result->sample[i] = pixels[i];
+    }
+}
+
+uint8_t frame_analysis_mean_luma(const uint8_t *buf, size_t len, bool yuyv, uint32_t step)
+{
+    uint32_t total = len / 2;
+    uint32_t sum = 0, n = 0;
+
+    if (step == 0) {
+        step = 1;
+    }
+    for (uint32_t i = 0; i < total; i += step, n++) {
+        const uint8_t *p = buf + i * 2;
+        if (yuyv) {
+            // YUYV: 每个像素的第一个字节是 Y
+            sum += p[0];
+        } else {
+            // BT.601 权重, 5/6位分量直接带入: (r*8*77 + g*4*150 + b*8*29) >> 8
+            uint32_t r = p[0] >> 3, g = ((p[0] & 0x07) << 3) | (p[1] >> 5), b = p[1] & 0x1f;
+            sum += (r * 616 + g * 600 + b * 232) >> 8;
+        }
+    }
+    return n ? (uint8_t)(sum / n) : 0;
+}
+
+void frame_stats_begin(frame_stats_t *stats, uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+                       uint8_t step)
+{
+    memset(stats, 0, sizeof(*stats));
+    stats->x = x;
+    stats->y = y;
+    stats->width = width;
+    stats->height = height;
+    stats->step = step ? step : 1;
+}
+
+typedef struct {
+    uint32_t r, g, b, n, black, white;
+} span_sums_t;
+
+// 一个字里两个半字中为 0 的个数
+static inline uint32_t zero_halves(uint32_t v)
+{
+    // 半字非 0 时其最高位在 t 中置位
+    uint32_t t = ((v & 0x7FFF7FFFu) + 0x7FFF7FFFu) | v;
+    return ((~t >> 15) & 1) + (~t >> 31);
+}
+
+static inline void add_pixel(span_sums_t *s, uint16_t p)
+{
+    s->r += rgb565_r(p);
+    s->g += rgb565_g(p);
+    s->b += rgb565_b(p);
+    s->black += p == 0x0000;
+    s->white += p == 0xFFFF;
+}
+
+// 一格内一行的取样像素: 直方图, 各通道和, 黑白计数. 累加用局部变量, 不与直方图的写入交错
+static void stats_span(frame_stats_t *stats, const uint16_t *row, uint32_t x, uint32_t x1, uint32_t step,
+                       span_sums_t *s)
+{
+    uint32_t *hist_r = stats->hist_r, *hist_g = stats->hist_g, *hist_b = stats->hist_b;
+    uint32_t sum_r = 0, sum_g = 0, sum_b = 0, n = 0, black = 0, white = 0;
+
+    for (; x < x1; x += step, n++) {
+        uint16_t p = rgb565_swap(row[x]);
+        uint32_t r = rgb565_r(p), g = rgb565_g(p), b = rgb565_b(p);
+        hist_r[r]++;
+        hist_g[g]++;
+        hist_b[b]++;
+        sum_r += r;
+        sum_g += g;
+        sum_b += b;
+        black += p == 0x0000;
+        white += p == 0xFFFF;
+    }
+    *s = (span_sums_t) {sum_r, sum_g, sum_b, n, black, white};
+}
+
+// step 为 1: 直方图只能逐个像素累加, 单独一遍; 其余统计按字 (两个像素) 计算
+static void stats_span_pairs(frame_stats_t *stats, const uint16_t *row, uint32_t x, uint32_t x1, span_sums_t *s)
+{
+    uint32_t *hist_r = stats->hist_r, *hist_g = stats->hist_g, *hist_b = stats->hist_b;
+
+    for (uint32_t i = x; i < x1; i++) {
+        uint16_t p = rgb565_swap(row[i]);
+        hist_r[rgb565_r(p)]++;
+        hist_g[rgb565_g(p)]++;
+        hist_b[rgb565_b(p)]++;
+    }
+
+    *s = (span_sums_t) {.n = x1 - x};
+    if (x < x1 && ((uintptr_t)(row + x) & 3)) {
+        add_pixel(s, rgb565_swap(row[x++]));
+    }
+    // 两个半字分别累加, 每半字最多 65535 / 63 = 1040 个像素对不溢出
+    const uint32_t *pairs = (const uint32_t *)(row + x);
+    uint32_t pair_count = (x1 - x) / 2;
+    for (uint32_t i = 0; i < pair_count;) {
+        uint32_t end = i + 1040 < pair_count ? i + 1040 : pair_count;
+        uint32_t acc_r = 0, acc_g = 0, acc_b = 0, black = 0, white = 0;
+        for (; i < end; i++) {
+            uint32_t v = rgb565_swap_pair(pairs[i]);
+            acc_r += (v >> 11) & 0x001F001Fu;
+            acc_g += (v >> 5) & 0x003F003Fu;
+            acc_b += v & 0x001F001Fu;
+            black += zero_halves(v);
+            white += zero_halves(~v);
+        }
+        s->r += (acc_r & 0xFFFF) + (acc_r >> 16);
+        s->g += (acc_g & 0xFFFF) + (acc_g >> 16);
+        s->b += (acc_b & 0xFFFF) + (acc_b >> 16);
+        s->black += black;
+        s->white += white;
+    }
+    if ((x1 - x) & 1) {
+        add_pixel(s, rgb565_swap(row[x1 - 1]));
+    }
+}
+
+void frame_stats_rows(frame_stats_t *stats, const uint16_t *rows, uint32_t stride, uint32_t y0, uint32_t count)
+{
+    const uint32_t step = stats->step;
+    const uint32_t top = stats->y, bottom = top + stats->height;
+    uint32_t black = 0, white = 0, luma = 0;
+
+    for (uint32_t y = y0 < top ? top : y0; y < y0 + count && y < bottom; y++) {
+        if ((y - top) % step) {
+            continue;
+        }
+        const uint16_t *row = rows + (y - y0) * stride + stats->x;
+        uint32_t gy = (y - top) * FRAME_STATS_GRID_ROWS / stats->height;
+        // 按格分段; 列 x 属于第 x * COLS / width 格, 与行相同
+        for (uint32_t gx = 0; gx < FRAME_STATS_GRID_COLS; gx++) {
+            uint32_t x = (gx * stats->width + FRAME_STATS_GRID_COLS - 1) / FRAME_STATS_GRID_COLS;
+            uint32_t x1 = ((gx + 1) * stats->width + FRAME_STATS_GRID_COLS - 1) / FRAME_STATS_GRID_COLS;
+            x = (x + step - 1) / step * step;
+            span_sums_t s;
+            if (step == 1) {
+                stats_span_pairs(stats, row, x, x1, &s);
+            } else {
+                stats_span(stats, row, x, x1, step, &s);
+            }
+            // 亮度由三个通道和算出, 不逐像素做乘法; BT.601, 与 frame_analysis_mean_luma 相同的权重
+            uint32_t sum = (s.r * 616 + s.g * 600 + s.b * 232) >> 8;
+            stats->grid_sum[gy][gx] += sum;
+            stats->grid_count[gy][gx] += s.n;
+            stats->pixels += s.n;
+            black += s.black;
+            white += s.white;
+            luma += sum;
+        }
+    }
+    stats->black += black;
+    stats->white += white;
+    stats->luma_sum += luma;
+}
+
+void frame_stats_end(frame_stats_t *stats)
+{
+    // 直方图按原始位数, 两端的格就是截断的像素
+    stats->clipped_low[FRAME_STATS_RED] = stats->hist_r[0];
+    stats->clipped_low[FRAME_STATS_GREEN] = stats->hist_g[0];
+    stats->clipped_low[FRAME_STATS_BLUE] = stats->hist_b[0];
+    stats->clipped_high[FRAME_STATS_RED] = stats->hist_r[31];
+    stats->clipped_high[FRAME_STATS_GREEN] = stats->hist_g[63];
+    stats->clipped_high[FRAME_STATS_BLUE] = stats->hist_b[31];
+    stats->mean_luma = stats->pixels ? (uint8_t)(stats->luma_sum / stats->pixels) : 0;
+    for (int gy = 0; gy < FRAME_STATS_GRID_ROWS; gy++) {
+        for (int gx = 0; gx < FRAME_STATS_GRID_COLS; gx++) {
+            uint32_t n = stats->grid_count[gy][gx];
+            stats->grid_luma[gy][gx] = n ? (uint8_t)(stats->grid_sum[gy][gx] / n) : 0;
+        }
+    }
+}
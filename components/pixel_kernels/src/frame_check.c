@@ -0,0 +1,279 @@
+/*
+ * Camera frame corruption checks
+ * 摄像头帧损坏检测
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "frame_check.h"
+
+static const char *const s_class_names[FRAME_CHECK_CLASS_COUNT] = {
+    "ok", "length", "pattern", "duplicate", "stale", "truncated", "byte phase", "line shift",
+};
+
+void frame_check_init(frame_check_t *check, const frame_check_config_t *config)
+{
+    memset(check, 0, sizeof(*check));
+    check->config = *config;
+    if (check->config.row_step == 0) {
+        check->config.row_step = 1;
+    }
+    if (check->config.pixel_step == 0) {
+        check->config.pixel_step = 1;
+    }
+    if (check->config.max_shift > FRAME_CHECK_MAX_SHIFT) {
+        check->config.max_shift = FRAME_CHECK_MAX_SHIFT;
+    }
+}
+
+void frame_check_reset(frame_check_t *check)
+{
+    check->history = 0;
+    check->next = 0;
+    check->ref_age = 0;
+}
+
+const char *frame_check_class_name(frame_check_class_t verdict)
+{
+    return verdict < FRAME_CHECK_CLASS_COUNT ? s_class_names[verdict] : "?";
+}
+
+// 行校验和 (FNV-1a, 按32位字); 所有字都相同时为单值行
+static uint32_t row_hash(const uint8_t *row, uint32_t bytes, bool *constant)
+{
+    uint32_t h = 2166136261u, first, diff = 0;
+    memcpy(&first, row, 4);
+    for (uint32_t i = 0; i + 4 <= bytes; i += 4) {
+        uint32_t w;
+        memcpy(&w, row + i, 4);
+        diff |= w ^ first;
+        h = (h ^ w) * 16777619u;
+    }
+    *constant = diff == 0;
+    return h;
+}
+
+// 相邻两个像素的颜色差; phase 1 时从第二个字节开始解码
+static uint32_t phase_diff(const uint8_t *p)
+{
+    int r0 = p[0] >> 3, g0 = ((p[0] & 0x07) << 3) | (p[1] >> 5), b0 = p[1] & 0x1f;
+    int r1 = p[2] >> 3, g1 = ((p[2] & 0x07) << 3) | (p[3] >> 5), b1 = p[3] & 0x1f;
+    return abs(r0 - r1) * 2 + abs(g0 - g1) + abs(b0 - b1) * 2;
+}
+
+// RGB565 行按错一字节解码明显更平滑
+static bool row_phase_flipped(const frame_check_config_t *c, const uint8_t *row, uint32_t width)
+{
+    uint32_t m0 = 0, m1 = 0, n = 0;
+    for (uint32_t x = 0; x + 2 < width; x += c->pixel_step, n++) {
+        m0 += phase_diff(row + x * 2);
+        m1 += phase_diff(row + x * 2 + 1);
+    }
+    return m0 >= n * c->shift_min_diff && m1 * 100 < m0 * c->phase_ratio_pct;
+}
+
+// 亮度近似: RGB565 取 G, YUYV 取 Y
+static inline uint8_t sample_value(const uint8_t *row, uint32_t x, bool yuyv)
+{
+    const uint8_t *p = row + x * 2;
+    return yuyv ? p[0] : ((p[0] & 0x07) << 3) | (p[1] >> 5);
+}
+
+#define SHIFT_UNKNOWN INT8_MIN
+
+// 当前行左右错开与上一个好帧的同一行比较: 0 = 对齐, SHIFT_UNKNOWN = 看不出
+static int row_shift(const frame_check_config_t *c, const uint8_t *ref, const uint8_t *row, uint32_t x0,
+                     uint32_t step, uint32_t n, bool yuyv)
+{
+    const int k = c->max_shift;
+    uint32_t sad[2 * FRAME_CHECK_MAX_SHIFT + 1];
+
+    memset(sad, 0, (2 * k + 1) * sizeof(sad[0]));
+    for (uint32_t j = 0, x = x0; j < n; j++, x += step) {
+        for (int d = -k; d <= k; d++) {
+            sad[d + k] += abs(ref[j] - sample_value(row, x + d, yuyv));
+        }
+    }
+    // near: 错开不到 min_shift 时最小的差 (噪声下分不清), far: 其余错开中最小的差
+    int best = 0;
+    uint32_t near = UINT32_MAX, far = UINT32_MAX, worst = 0;
+    for (int d = -k; d <= k; d++) {
+        uint32_t v = sad[d + k];
+        if (abs(d) < c->min_shift) {
+            near = v < near ? v : near;
+        } else if (v < far) {
+            far = v;
+            best = d;
+        }
+        worst = v > worst ? v : worst;
+    }
+    // 没有水平纹理的行看不出错位
+    if (worst < n * c->shift_min_diff) {
+        return SHIFT_UNKNOWN;
+    }
+    // 两边都要明显: 平移中的画面或运动的物体不算
+    if ((uint64_t)near * 100 < (uint64_t)far * c->shift_ratio_pct) {
+        return 0;
+    }
+    return (uint64_t)far * 100 < (uint64_t)near * c->shift_ratio_pct ? best : SHIFT_UNKNOWN;
+}
+
+// 从某行起直到帧尾都错开, 且上方有对齐的行, 才算错位; 整帧一起错开是镜头平移,
+// 中间一段错开是运动的物体
+static bool frame_shifted(const frame_check_config_t *c, const int8_t *shifts, uint32_t rows, uint32_t *first,
+                          frame_check_result_t *r)
+{
+    bool aligned_above = false;
+    uint32_t i = 0, judged = 0, tail = 0;
+    for (; i < rows && (shifts[i] == 0 || shifts[i] == SHIFT_UNKNOWN); i++) {
+        aligned_above |= shifts[i] == 0;
+    }
+    if (i == rows) {
+        return false;
+    }
+    *first = i;
+    r->shift = shifts[i];
+    for (; i < rows; i++) {
+        if (shifts[i] == SHIFT_UNKNOWN) {
+            continue;
+        }
+        judged++;
+        tail = shifts[i] != 0 ? tail + 1 : 0;
+        r->shifted_rows += shifts[i] != 0;
+    }
+    return aligned_above && tail >= c->shift_rows && r->shifted_rows * 100 >= judged * c->shift_pct;
+}
+
+// 取样各行, 按优先级给出结论; 尺寸已检查过
+static void check_rows(frame_check_t *check, const uint8_t *buf, uint16_t width, uint16_t height, bool yuyv,
+                       frame_check_result_t *result)
+{
+    const frame_check_config_t *c = &check->config;
+    frame_check_result_t r = {.verdict = FRAME_CHECK_OK, .first_bad_row = -1};
+    uint32_t hashes[FRAME_CHECK_MAX_ROWS];
+    int8_t shifts[FRAME_CHECK_MAX_ROWS];
+    uint32_t content = 0; // 不是单值的行
+    int16_t first_stale = -1, first_phase = -1, first_repeat = -1;
+    bool constant, above_constant = true;
+
+    if (width != check->width || height != check->height || yuyv != check->yuyv) {
+        frame_check_reset(check);
+        check->width = width;
+        check->height = height;
+        check->yuyv = yuyv;
+    }
+
+    uint32_t spacing = (height + FRAME_CHECK_MAX_ROWS - 1) / FRAME_CHECK_MAX_ROWS;
+    if (spacing < c->row_step) {
+        spacing = c->row_step;
+    }
+    // 错位样本取在 [k, width - k) 内, 左右错开 k 个像素也不越界
+    uint32_t k = c->max_shift, samples = 0, sample_step = c->pixel_step;
+    if (width > 2 * k + 1) {
+        if (sample_step < (width - 2 * k) / FRAME_CHECK_ROW_SAMPLES) {
+            sample_step = (width - 2 * k) / FRAME_CHECK_ROW_SAMPLES;
+        }
+        samples = (width - 2 * k - 1) / sample_step + 1;
+        samples = samples > FRAME_CHECK_ROW_SAMPLES ? FRAME_CHECK_ROW_SAMPLES : samples;
+    }
+    uint8_t (*ref)[FRAME_CHECK_ROW_SAMPLES] = check->samples[check->ref];
+    uint8_t (*cur)[FRAME_CHECK_ROW_SAMPLES] = check->samples[check->ref ^ 1];
+    const uint8_t clip_high = yuyv ? 255 : 63;
+
+    uint32_t row_bytes = (uint32_t)width * 2;
+    for (uint32_t y = 0; y < height; y += spacing, r.rows++) {
+        const uint8_t *row = buf + y * row_bytes;
+        uint32_t i = r.rows;
+        hashes[i] = row_hash(row, row_bytes, &constant);
+        shifts[i] = SHIFT_UNKNOWN;
+        uint32_t active = 0;
+        for (uint32_t j = 0; j < samples; j++) {
+            cur[i][j] = sample_value(row, k + j * sample_step, yuyv);
+            active += cur[i][j] != 0 && cur[i][j] != clip_high;
+        }
+        if (constant) {
+            r.truncated_rows++;
+            above_constant = true;
+            continue;
+        }
+        r.truncated_rows = 0;
+        content++;
+
+        if (!above_constant && hashes[i] == hashes[i - 1]) {
+            r.repeated_rows++;
+            first_repeat = first_repeat < 0 ? (int16_t)y : first_repeat;
+        }
+        above_constant = false;
+        // 截断的像素没有噪声, 静止的高反差画面里这样的行会逐位重复, 不与历史比较
+        if (active * 100 >= samples * c->match_active_pct) {
+            r.active_rows++;
+            for (uint32_t h = 0; h < check->history; h++) {
+                if (check->rows[h][i] == hashes[i]) {
+                    r.stale_rows++;
+                    first_stale = first_stale < 0 ? (int16_t)y : first_stale;
+                    break;
+                }
+            }
+        }
+        if (!yuyv && row_phase_flipped(c, row, width)) {
+            r.phase_rows++;
+            first_phase = first_phase < 0 ? (int16_t)y : first_phase;
+        }
+        if (check->ref_age > 0 && samples > 0) {
+            shifts[i] = (int8_t)row_shift(c, ref[i], row, k, sample_step, samples, yuyv);
+        }
+    }
+
+    uint32_t first_shift;
+    if (content > 1 && r.repeated_rows * 100 >= (content - 1) * c->pattern_pct) {
+        r.verdict = FRAME_CHECK_PATTERN;
+        r.first_bad_row = first_repeat;
+    } else if (r.active_rows > 0 && check->history > 0 && r.stale_rows == r.active_rows) {
+        r.verdict = FRAME_CHECK_DUPLICATE;
+        r.first_bad_row = 0;
+    } else if (r.stale_rows >= c->stale_rows) {
+        r.verdict = FRAME_CHECK_STALE;
+        r.first_bad_row = first_stale;
+    } else if (content > 0 && r.truncated_rows >= c->truncated_rows) {
+        r.verdict = FRAME_CHECK_TRUNCATED;
+        r.first_bad_row = (int16_t)((r.rows - r.truncated_rows) * spacing);
+    } else if (r.phase_rows >= c->phase_rows) {
+        r.verdict = FRAME_CHECK_BYTE_PHASE;
+        r.first_bad_row = first_phase;
+    } else if (frame_shifted(c, shifts, r.rows, &first_shift, &r)) {
+        r.verdict = FRAME_CHECK_LINE_SHIFT;
+        r.first_bad_row = (int16_t)(first_shift * spacing);
+    }
+    if (r.verdict != FRAME_CHECK_LINE_SHIFT) {
+        r.shift = 0;
+    }
+
+    // 不论结果都记入历史: 之后未覆盖的行可能来自这一帧
+    memcpy(check->rows[check->next], hashes, r.rows * sizeof(hashes[0]));
+    check->next = (check->next + 1) % FRAME_CHECK_HISTORY;
+    if (check->history < FRAME_CHECK_HISTORY) {
+        check->history++;
+    }
+    // 错位参考只取好帧; 连续几帧都不好时也换掉, 以免一直报错
+    if (r.verdict == FRAME_CHECK_OK || check->ref_age == 0 || check->ref_age >= FRAME_CHECK_HISTORY) {
+        check->ref ^= 1;
+        check->ref_age = 1;
+    } else {
+        check->ref_age++;
+    }
+    *result = r;
+}
+
+frame_check_class_t frame_check_run(frame_check_t *check, const uint8_t *buf, size_t len, uint16_t width,
+                                    uint16_t height, bool yuyv, frame_check_result_t *result)
+{
+    frame_check_result_t r = {.verdict = FRAME_CHECK_LENGTH, .first_bad_row = -1};
+
+    if (len >= (size_t)width * height * 2 && width >= 2) {
+        check_rows(check, buf, width, height, yuyv, &r);
+    }
+    check->counts[r.verdict]++;
+    if (result != NULL) {
+        *result = r;
+    }
+    return r.verdict;
+}
@@ -0,0 +1,391 @@
+/*
+ * Table-driven RGB565 frame scaler
+ * 查表式RGB565图像缩放
+ */
+#include <string.h>
+#include "frame_scaler.h"
+#include "rgb565_kernels.h"
+#include "rgb565_filters.h"
+#include "yuv422.h"
+
+static uint16_t min_u16(uint16_t a, uint16_t b)
+{
+    return a < b ? a : b;
+}
+
+// 逐字段比较 (结构体有填充字节, 不能用 memcmp)
+static bool geometry_equal(const frame_scaler_geometry_t *a, const frame_scaler_geometry_t *b)
+{
+    return a->src_width == b->src_width && a->src_height == b->src_height &&
+           a->src_stride == b->src_stride && a->dst_width == b->dst_width &&
+           a->dst_height == b->dst_height && a->mode == b->mode &&
+           a->crop_width == b->crop_width && a->crop_height == b->crop_height &&
+           a->filter == b->filter;
+}
+
+// 计算一个方向上第 d 个输出的两个采样点和权重
+// src_start/src_len: 采样区域, dst_len: 输出长度, src_limit: 源图该方向总长度
+static void filter_taps(frame_scaler_filter_t filter, uint32_t d, uint32_t src_start, uint32_t src_len,
+                        uint32_t dst_len, uint32_t src_limit, uint32_t *tap0, uint32_t *tap1, uint8_t *weight)
+{
+    uint32_t first, second;
+
+    if (filter == FRAME_SCALER_FILTER_BILINEAR) {
+        // 像素中心对齐: pos = (d + 0.5) * src_len / dst_len - 0.5, 5位小数
+        int32_t pos = (int32_t)(((2 * d + 1) * src_len * 32) / (2 * dst_len)) - 16;
+        if (pos < 0) {
+            pos = 0;
+        }
+        first = src_start + (pos >> 5);
+        *weight = pos & 31;
+        second = first + 1;
+    } else {
+        first = src_start + (d * src_len) / dst_len;
+        *weight = 0;
+        // BOX: 缩小时取相邻两点平均, 放大时两点相同
+        second = (filter == FRAME_SCALER_FILTER_BOX && src_len > dst_len) ? first + 1 : first;
+    }
+
+    if (first >= src_limit) {
+        first = src_limit - 1;
+    }
+    if (second >= src_limit) {
+        second = src_limit - 1;
+    }
+    *tap0 = first;
+    *tap1 = second;
+}
+
+// 采样表是否是 kernel 对应的固定比例 (见 rgb565_filters.h 中各固定比例内核的约定)
+static bool x_map_matches(const frame_scaler_t *scaler, frame_scaler_filter_t filter, uint32_t src_x,
+                          uint32_t width, frame_scaler_kernel_t kernel)
+{
+    const bool bilinear = filter == FRAME_SCALER_FILTER_BILINEAR;
+
+    for (uint32_t x = 0; x < width; x++) {
+        uint32_t tap0, weight = 0;
+        if (kernel == FRAME_SCALER_KERNEL_COPY) {
+            tap0 = x;
+        } else if (kernel == FRAME_SCALER_KERNEL_DECIMATE2) {
+            tap0 = 2 * x;
+            weight = bilinear ? 16 : 0;
+        } else if (bilinear) {
+            tap0 = 5 * (x / 2) + 3 * (x & 1);
+            weight = x & 1 ? 8 : 24;
+        } else {
+            tap0 = (5 * x) / 2;
+        }
+        tap0 += src_x;
+        // 最近邻和 1:1 的区域平均两点相同; 1:1 的双线性权重为 0, 不读第二点
+        bool same = filter == FRAME_SCALER_FILTER_NEAREST || kernel == FRAME_SCALER_KERNEL_COPY;
+        uint32_t tap1 = same ? tap0 : tap0 + 1;
+
+        if (scaler->x_map[x] != tap0 || scaler->x_weight[x] != weight ||
+            (scaler->x_map2[x] != tap1 && !(bilinear && kernel == FRAME_SCALER_KERNEL_COPY))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 根据模式计算源图采样区域和目标覆盖区域
+static bool compute_rects(const frame_scaler_geometry_t *g, frame_rect_t *src, frame_rect_t *dst)
+{
+    uint32_t sw = g->src_width, sh = g->src_height;
+    uint32_t dw = g->dst_width, dh = g->dst_height;
+
+    *src = (frame_rect_t){0, 0, sw, sh};
+    *dst = (frame_rect_t){0, 0, dw, dh};
+
+    switch (g->mode) {
+    case FRAME_SCALER_MODE_CROP:
+        src->width = g->crop_width ? min_u16(g->crop_width, sw) : sw;
+        src->height = g->crop_height ? min_u16(g->crop_height, sh) : sh;
+        break;
+    case FRAME_SCALER_MODE_FIT:
+        if (sw * dh <= sh * dw) {
+            dst->width = (sw * dh) / sh; // 源图较高, 左右留黑边
+        } else {
+            dst->height = (sh * dw) / sw; // 源图较宽, 上下留黑边
+        }
+        break;
+    case FRAME_SCALER_MODE_FILL:
+        if (sw * dh > sh * dw) {
+            src->width = (sh * dw) / dh; // 源图较宽, 裁掉左右
+        } else {
+            src->height = (sw * dh) / dw; // 源图较高, 裁掉上下
+        }
+        break;
+    case FRAME_SCALER_MODE_LETTERBOX:
+        src->width = dst->width = min_u16(sw, dw);
+        src->height = dst->height = min_u16(sh, dh);
+        break;
+    default:
+        return false;
+    }
+
+    if (src->width == 0 || src->height == 0 || dst->width == 0 || dst->height == 0) {
+        return false;
+    }
+
+    // 两个区域都居中
+    src->x = (sw - src->width) / 2;
+    src->y = (sh - src->height) / 2;
+    dst->x = (dw - dst->width) / 2;
+    dst->y = (dh - dst->height) / 2;
+    return true;
+}
+
+bool frame_scaler_configure(frame_scaler_t *scaler, const frame_scaler_geometry_t *geometry)
+{
+    frame_scaler_geometry_t g = *geometry;
+    if (g.src_stride == 0) {
+        g.src_stride = g.src_width;
+    }
+
+    if (scaler->configured && geometry_equal(&scaler->geometry, &g)) {
+        return true;
+    }
+    scaler->configured = false;
+
+    if (g.src_width == 0 || g.src_height == 0 || g.src_stride < g.src_width ||
+        g.dst_width == 0 || g.dst_width > FRAME_SCALER_MAX_DST_WIDTH ||
+        g.dst_height == 0 || g.dst_height > FRAME_SCALER_MAX_DST_HEIGHT) {
+        return false;
+    }
+
+    frame_rect_t src, dst;
+    if (!compute_rects(&g, &src, &dst)) {
+        return false;
+    }
+
+    // 每次几何变化只做一次除法, 帧循环里只查表
+    for (uint32_t x = 0; x < dst.width; x++) {
+        uint32_t x0, x1;
+        filter_taps(g.filter, x, src.x, src.width, dst.width, g.src_width, &x0, &x1, &scaler->x_weight[x]);
+        scaler->x_map[x] = x0;
+        scaler->x_map2[x] = x1;
+    }
+    for (uint32_t y = 0; y < dst.height; y++) {
+        uint32_t y0, y1;
+        filter_taps(g.filter, y, src.y, src.height, dst.height, g.src_height, &y0, &y1, &scaler->y_weight[y]);
+        scaler->y_offset[y] = y0 * g.src_stride;
+        scaler->y_offset2[y] = y1 * g.src_stride;
+    }
+
+    scaler->x_kernel = FRAME_SCALER_KERNEL_LUT;
+    for (int k = FRAME_SCALER_KERNEL_COPY; k <= FRAME_SCALER_KERNEL_DECIMATE5_2; k++) {
+        if (x_map_matches(scaler, g.filter, src.x, dst.width, (frame_scaler_kernel_t)k)) {
+            scaler->x_kernel = (frame_scaler_kernel_t)k;
+            break;
+        }
+    }
+
+    scaler->geometry = g;
+    scaler->src_rect = src;
+    scaler->dst_rect = dst;
+    scaler->configured = true;
+    return true;
+}
+
+void frame_scaler_run(const frame_scaler_t *scaler, const uint16_t *src, uint16_t *dst)
+{
+    frame_scaler_run_rows(scaler, src, dst, 0, scaler->geometry.dst_height);
+}
+
+bool frame_scaler_source_span(const frame_scaler_t *scaler, uint32_t y0, uint32_t rows, frame_rect_t *span)
+{
+    const frame_rect_t *r = &scaler->dst_rect;
+    const uint32_t stride = scaler->geometry.src_stride;
+    uint32_t y1 = y0 + rows;
+
+    // 只有 dst_rect 内的行读取源图
+    if (y0 < r->y) {
+        y0 = r->y;
+    }
+    if (y1 > (uint32_t)r->y + r->height) {
+        y1 = r->y + r->height;
+    }
+    if (y0 >= y1) {
+        *span = (frame_rect_t){0, 0, 0, 0};
+        return false;
+    }
+
+    // 查表单调递增; 第二个采样点不小于第一个. 列按偶数对齐 (YUYV 按像素对读取),
+    // 右边多留一个像素: 向量抽取内核会读到最后一个采样点的下一个
+    uint32_t first = scaler->y_offset[y0 - r->y] / stride;
+    uint32_t last = scaler->y_offset2[y1 - 1 - r->y] / stride;
+    uint32_t x0 = scaler->x_map[0] & ~1u;
+    uint32_t x1 = (scaler->x_map2[r->width - 1] + 3u) & ~1u;
+    if (x1 > stride) {
+        x1 = stride;
+    }
+    *span = (frame_rect_t){(uint16_t)x0, (uint16_t)first, (uint16_t)(x1 - x0), (uint16_t)(last - first + 1)};
+    return true;
+}
+
+// 滤波缩放一行: 固定比例且两行都按字对齐时用成对读取的内核, 否则查表
+static void filter_row(const frame_scaler_t *scaler, const uint16_t *row0, const uint16_t *row1, uint32_t yw,
+                       uint16_t *out, uint32_t width)
+{
+    const bool box = scaler->geometry.filter == FRAME_SCALER_FILTER_BOX;
+    const uint16_t *s0 = row0 + scaler->x_map[0], *s1 = row1 + scaler->x_map[0];
+    frame_scaler_kernel_t kernel = scaler->x_kernel;
+
+    if ((((uintptr_t)s0 | (uintptr_t)s1) & 3) != 0) {
+        kernel = FRAME_SCALER_KERNEL_LUT;
+    }
+    switch (kernel) {
+    case FRAME_SCALER_KERNEL_COPY:
+        if (box) {
+            rgb565_row_box2x2_copy(s0, s1, out, width);
+        } else {
+            rgb565_row_bilinear_copy(s0, s1, yw, out, width);
+        }
+        break;
+    case FRAME_SCALER_KERNEL_DECIMATE2:
+        if (box) {
+            rgb565_row_box2x2_decimate2(s0, s1, out, width);
+        } else {
+            rgb565_row_bilinear_decimate2(s0, s1, yw, out, width);
+        }
+        break;
+    case FRAME_SCALER_KERNEL_DECIMATE5_2:
+        if (box) {
+            rgb565_row_box2x2_decimate5_2(s0, s1, out, width);
+        } else {
+            rgb565_row_bilinear_decimate5_2(s0, s1, yw, out, width);
+        }
+        break;
+    default:
+        if (box) {
+            rgb565_row_box2x2(row0, row1, scaler->x_map, scaler->x_map2, out, width);
+        } else {
+            rgb565_row_bilinear(row0, row1, scaler->x_map, scaler->x_map2, scaler->x_weight, yw, out, width);
+        }
+        break;
+    }
+}
+
+// 源行 = src + y_offset - bias: 整帧时 bias 为 0, 行副本中为其第一行的偏移
+static void run_rows(const frame_scaler_t *scaler, const uint16_t *src, uint32_t bias, uint16_t *dst,
+                     uint32_t y0, uint32_t rows)
+{
+    const frame_rect_t *r = &scaler->dst_rect;
+    const uint32_t dst_width = scaler->geometry.dst_width;
+    const uint32_t right = r->x + r->width;
+    uint32_t y1 = y0 + rows;
+
+    if (y1 > scaler->geometry.dst_height) {
+        y1 = scaler->geometry.dst_height;
+    }
+
+    for (uint32_t y = y0; y < y1; y++) {
+        uint16_t *out = dst + (y - y0) * dst_width;
+
+        if (y < r->y || y >= (uint32_t)r->y + r->height) {
+            memset(out, 0, dst_width * sizeof(uint16_t));
+            continue;
+        }
+        if (r->x > 0) {
+            memset(out, 0, r->x * sizeof(uint16_t));
+        }
+        if (right < dst_width) {
+            memset(out + right, 0, (dst_width - right) * sizeof(uint16_t));
+        }
+
+        const uint16_t *in = src + (scaler->y_offset[y - r->y] - bias);
+        out += r->x;
+
+        if (scaler->geometry.filter != FRAME_SCALER_FILTER_NEAREST) {
+            filter_row(scaler, in, src + (scaler->y_offset2[y - r->y] - bias), scaler->y_weight[y - r->y],
+                       out, r->width);
+            continue;
+        }
+
+        switch (scaler->x_kernel) {
+        case FRAME_SCALER_KERNEL_COPY:
+            rgb565_row_copy(in + scaler->x_map[0], out, r->width);
+            break;
+        case FRAME_SCALER_KERNEL_DECIMATE2:
+            rgb565_row_decimate2(in + scaler->x_map[0], out, r->width);
+            break;
+        case FRAME_SCALER_KERNEL_DECIMATE5_2:
+            rgb565_row_decimate5_2(in + scaler->x_map[0], out, r->width);
+            break;
+        default: {
+            const uint16_t *map = scaler->x_map;
+            for (uint32_t x = 0; x < r->width; x++) {
+                out[x] = in[map[x]];
+            }
+            break;
+        }
+        }
+    }
+}
+
+void frame_scaler_run_rows(const frame_scaler_t *scaler, const uint16_t *src, uint16_t *dst,
+                           uint32_t y0, uint32_t rows)
+{
+    run_rows(scaler, src, 0, dst, y0, rows);
+}
+
+void frame_scaler_run_rows_band(const frame_scaler_t *scaler, const uint16_t *band, uint32_t first_row,
+                                uint16_t *dst, uint32_t y0, uint32_t rows)
+{
+    run_rows(scaler, band, first_row * scaler->geometry.src_stride, dst, y0, rows);
+}
+
+static void run_yuv422_rows(const frame_scaler_t *scaler, const uint8_t *src, uint32_t bias, uint16_t *dst,
+                            uint8_t *luma, uint32_t y0, uint32_t rows)
+{
+    const frame_rect_t *r = &scaler->dst_rect;
+    const uint32_t dst_width = scaler->geometry.dst_width;
+    const uint32_t right = r->x + r->width;
+    uint32_t y1 = y0 + rows;
+
+    if (y1 > scaler->geometry.dst_height) {
+        y1 = scaler->geometry.dst_height;
+    }
+
+    for (uint32_t y = y0; y < y1; y++) {
+        uint16_t *out = dst + (y - y0) * dst_width;
+        uint8_t *lout = luma ? luma + (y - y0) * dst_width : NULL;
+
+        if (y < r->y || y >= (uint32_t)r->y + r->height) {
+            memset(out, 0, dst_width * sizeof(uint16_t));
+            if (lout) {
+                memset(lout, 0, dst_width);
+            }
+            continue;
+        }
+        if (r->x > 0) {
+            memset(out, 0, r->x * sizeof(uint16_t));
+            if (lout) {
+                memset(lout, 0, r->x);
+            }
+        }
+        if (right < dst_width) {
+            memset(out + right, 0, (dst_width - right) * sizeof(uint16_t));
+            if (lout) {
+                memset(lout + right, 0, dst_width - right);
+            }
+        }
+
+        // y_offset 以像素为单位, YUYV 同样每像素2字节
+        yuv422_row_to_rgb565(src + (scaler->y_offset[y - r->y] - bias) * 2, scaler->x_map,
+                             out + r->x, lout ? lout + r->x : NULL, r->width);
+    }
+}
+
+void frame_scaler_run_yuv422_rows(const frame_scaler_t *scaler, const uint8_t *src, uint16_t *dst,
+                                  uint8_t *luma, uint32_t y0, uint32_t rows)
+{
+    run_yuv422_rows(scaler, src, 0, dst, luma, y0, rows);
+}
+
+void frame_scaler_run_yuv422_rows_band(const frame_scaler_t *scaler, const uint8_t *band, uint32_t first_row,
+                                       uint16_t *dst, uint8_t *luma, uint32_t y0, uint32_t rows)
+{
+    run_yuv422_rows(scaler, band, first_row * scaler->geometry.src_stride, dst, luma, y0, rows);
+}
@@ -0,0 +1,78 @@
+/*
+ * Motion detection on luma thumbnails
+ * 亮度缩略图上的运动检测
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "motion_detect.h"
+
+bool motion_detect_init(motion_detect_t *m, const motion_config_t *config)
+{
+    memset(m, 0, sizeof(*m));
+    if ((size_t)config->width * config->height > MOTION_THUMB_MAX_PIXELS ||
+        config->width == 0 || config->height == 0) {
+        return false;
+    }
+    m->config = *config;
+    motion_detect_reset(m);
+    return true;
+}
+
+void motion_detect_reset(motion_detect_t *m)
+{
+    m->has_prev = false;
+    m->moving = true;
+    m->score = 0;
+    m->brightness = 0;
+    m->run = 0;
+}
+
+motion_event_t motion_detect_update(motion_detect_t *m, const uint8_t *thumb)
+{
+    const motion_config_t *c = &m->config;
+    uint32_t count = (uint32_t)c->width * c->height;
+
+    if (!m->has_prev) {
+        memcpy(m->prev, thumb, count);
+        m->has_prev = true;
+        return MOTION_EVENT_NONE;
+    }
+
+    // 整体亮度变化 (自动曝光) 先扣掉
+    int32_t sum = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        sum += (int32_t)thumb[i] - m->prev[i];
+    }
+    int32_t mean = sum / (int32_t)count;
+    uint32_t changed = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        changed += (uint32_t)abs((int32_t)thumb[i] - m->prev[i] - mean) > c->pixel_threshold;
+    }
+    memcpy(m->prev, thumb, count);
+    m->score = (uint16_t)(changed * 1000 / count);
+    m->brightness = (int16_t)mean;
+
+    // 迟滞: 只计数朝另一状态的连续帧, 中间有一帧不满足就重新计
+    bool toward_other = m->moving ? m->score < c->stop_permille : m->score >= c->start_permille;
+    if (!toward_other) {
+        m->run = 0;
+        return MOTION_EVENT_NONE;
+    }
+    m->run++;
+    if (m->run < (m->moving ? c->stop_frames : c->start_frames)) {
+        return MOTION_EVENT_NONE;
+    }
+    m->run = 0;
+    m->moving = !m->moving;
+    return m->moving ? MOTION_EVENT_START : MOTION_EVENT_STOP;
+}
+
+void motion_luma_rgb565(const uint16_t *rgb, uint8_t *luma, size_t count)
+{
+    const uint8_t *p = (const uint8_t *)rgb;
+    for (size_t i = 0; i < count; i++, p += 2) {
+        // 与 frame_analysis_mean_luma 相同的 BT.601 权重
+        uint32_t r = p[0] >> 3, g = ((p[0] & 0x07) << 3) | (p[1] >> 5), b = p[1] & 0x1f;
+        luma[i] = (uint8_t)((r * 616 + g * 600 + b * 232) >> 8);
+    }
+}
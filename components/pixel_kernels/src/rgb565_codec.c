@@ -0,0 +1,142 @@
+/*
+ * Lossless RGB565 image codec
+ * RGB565 无损压缩
+ */
+#include <string.h>
+#include "rgb565.h"
+#include "rgb565_codec.h"
+
+#define OP_INDEX 0x00
+#define OP_DIFF 0x40
+#define OP_LUMA 0x80
+#define OP_RUN 0xC0
+#define OP_RAW 0xFE
+#define OP_MASK 0xC0
+#define MAX_RUN 62 // 0xFE/0xFF 不能作为游程
+
+static inline uint32_t color_hash(uint32_t p)
+{
+    return (rgb565_r(p) * 3 + rgb565_g(p) * 5 + rgb565_b(p) * 7) & (RGB565_CODEC_INDEX_SIZE - 1);
+}
+
+// 通道差值按位宽取模, 落在 -2^(bits-1) .. 2^(bits-1)-1
+static inline int wrap_delta(int d, int bits)
+{
+    int half = 1 << (bits - 1);
+    return ((d + half) & ((1 << bits) - 1)) - half;
+}
+
+void rgb565_codec_encode_begin(rgb565_encoder_t *enc)
+{
+    memset(enc, 0, sizeof(*enc));
+}
+
+size_t rgb565_codec_encode(rgb565_encoder_t *enc, const uint16_t *pixels, size_t count, uint8_t *out)
+{
+    uint8_t *o = out;
+    uint32_t prev = enc->prev;
+    uint32_t run = enc->run;
+
+    for (size_t i = 0; i < count; i++) {
+        uint32_t p = rgb565_swap(pixels[i]);
+        if (p == prev) {
+            if (++run == MAX_RUN) {
+                *o++ = OP_RUN | (MAX_RUN - 1);
+                run = 0;
+            }
+            continue;
+        }
+        if (run > 0) {
+            *o++ = OP_RUN | (run - 1);
+            run = 0;
+        }
+
+        uint32_t h = color_hash(p);
+        if (enc->index[h] == p) {
+            *o++ = OP_INDEX | h;
+        } else {
+            enc->index[h] = p;
+            int dr = wrap_delta((int)rgb565_r(p) - (int)rgb565_r(prev), 5);
+            int dg = wrap_delta((int)rgb565_g(p) - (int)rgb565_g(prev), 6);
+            int db = wrap_delta((int)rgb565_b(p) - (int)rgb565_b(prev), 5);
+            // 绿色多一位: 红/蓝相对 dg/2 (向下取整) 预测
+            int half = ((dg + 32) >> 1) - 16;
+            int vr = wrap_delta(dr - half, 5);
+            int vb = wrap_delta(db - half, 5);
+            if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                *o++ = OP_DIFF | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2);
+            } else if (vr >= -8 && vr <= 7 && vb >= -8 && vb <= 7) {
+                *o++ = OP_LUMA | (dg + 32);
+                *o++ = (uint8_t)((vr + 8) << 4 | (vb + 8));
+            } else {
+                *o++ = OP_RAW;
+                *o++ = (uint8_t)(p >> 8);
+                *o++ = (uint8_t)p;
+            }
+        }
+        prev = p;
+    }
+    enc->prev = (uint16_t)prev;
+    enc->run = (uint16_t)run;
+    return o - out;
+}
+
+size_t rgb565_codec_encode_end(rgb565_encoder_t *enc, uint8_t *out)
+{
+    if (enc->run == 0) {
+        return 0;
+    }
+    out[0] = OP_RUN | (enc->run - 1);
+    enc->run = 0;
+    return 1;
+}
+
+size_t rgb565_codec_decode(const uint8_t *in, size_t in_bytes, uint16_t *pixels, size_t count)
+{
+    uint16_t index[RGB565_CODEC_INDEX_SIZE] = {0};
+    uint32_t p = 0;
+    size_t pos = 0;
+
+    for (size_t i = 0; i < count;) {
+        if (pos >= in_bytes) {
+            return 0;
+        }
+        uint32_t op = in[pos++];
+        if (op == OP_RAW) {
+            if (pos + 2 > in_bytes) {
+                return 0;
+            }
+            p = (uint32_t)in[pos] << 8 | in[pos + 1];
+            pos += 2;
+        } else if ((op & OP_MASK) == OP_RUN) {
+            uint32_t run = (op & 0x3F) + 1;
+            if (run > count - i) {
+                return 0;
+            }
+            uint16_t value = rgb565_swap((uint16_t)p);
+            for (uint32_t n = 0; n < run; n++) {
+                pixels[i++] = value;
+            }
+            continue;
+        } else if ((op & OP_MASK) == OP_INDEX) {
+            p = index[op];
+        } else if ((op & OP_MASK) == OP_DIFF) {
+            p = rgb565_pack((rgb565_r(p) + ((op >> 4) & 3) - 2) & 0x1F,
+                            (rgb565_g(p) + ((op >> 2) & 3) - 2) & 0x3F,
+                            (rgb565_b(p) + (op & 3) - 2) & 0x1F);
+        } else {
+            if (pos >= in_bytes) {
+                return 0;
+            }
+            uint32_t rb = in[pos++];
+            int dg = (int)(op & 0x3F) - 32;
+            int half = (int)((op & 0x3F) >> 1) - 16;
+            p = rgb565_pack((rgb565_r(p) + half + (int)(rb >> 4) - 8) & 0x1F,
+                            (rgb565_g(p) + dg) & 0x3F,
+                            (rgb565_b(p) + half + (int)(rb & 0x0F) - 8) & 0x1F);
+        }
+        index[color_hash(p)] = (uint16_t)p;
+        pixels[i++] = rgb565_swap((uint16_t)p);
+    }
+    return pos;
+}
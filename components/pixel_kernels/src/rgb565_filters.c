@@ -0,0 +1,410 @@
+/*
+ * Filtered RGB565 row kernels (box / bilinear)
+ * RGB565 滤波缩放行内核
+ */
+#include <stdbool.h>
+#include <string.h>
+#include "rgb565.h"
+#include "rgb565_filters.h"
+#include "rgb565_kernels.h"
+
+// 每个通道去掉最低位后右移, 通道之间不会互相借位
+#define RGB565_PAIR_LSB_CLEAR 0xF7DEF7DEu
+
+// 一个像素展开为 0000 0GGG GGG0 0000 RRRR R000 000B BBBB, 通道之间留出空位做乘法
+#define RGB565_SPREAD_MASK 0x07E0F81Fu
+
+static inline uint32_t pack_pair(uint16_t a, uint16_t b)
+{
+    return (uint32_t)a | ((uint32_t)b << 16);
+}
+
+// 两个像素同时求平均 (向下取整)
+static inline uint32_t avg_pair(uint32_t a, uint32_t b)
+{
+    return (a & b) + (((a ^ b) & RGB565_PAIR_LSB_CLEAR) >> 1);
+}
+
+void rgb565_row_box2x2(const uint16_t *row0, const uint16_t *row1,
+                       const uint16_t *x0, const uint16_t *x1,
+                       uint16_t *dst, uint32_t count)
+{
+    uint32_t i = 0;
+
+    for (; i + 2 <= count; i += 2) {
+        uint32_t tl = rgb565_swap_pair(pack_pair(row0[x0[i]], row0[x0[i + 1]]));
+        uint32_t tr = rgb565_swap_pair(pack_pair(row0[x1[i]], row0[x1[i + 1]]));
+        uint32_t bl = rgb565_swap_pair(pack_pair(row1[x0[i]], row1[x0[i + 1]]));
+        uint32_t br = rgb565_swap_pair(pack_pair(row1[x1[i]], row1[x1[i + 1]]));
+        uint32_t out = rgb565_swap_pair(avg_pair(avg_pair(tl, tr), avg_pair(bl, br)));
+        dst[i] = (uint16_t)out;
+        dst[i + 1] = (uint16_t)(out >> 16);
+    }
+    if (i < count) {
+        uint32_t tl = rgb565_swap_pair(row0[x0[i]]);
+        uint32_t tr = rgb565_swap_pair(row0[x1[i]]);
+        uint32_t bl = rgb565_swap_pair(row1[x0[i]]);
+        uint32_t br = rgb565_swap_pair(row1[x1[i]]);
+        dst[i] = (uint16_t)rgb565_swap_pair(avg_pair(avg_pair(tl, tr), avg_pair(bl, br)));
+    }
+}
+
+static inline uint32_t spread(uint16_t p)
+{
+    uint32_t v = rgb565_swap(p);
+    return (v | (v << 16)) & RGB565_SPREAD_MASK;
+}
+
+static inline uint16_t unspread(uint32_t e)
+{
+    return rgb565_swap((uint16_t)(e | (e >> 16)));
+}
+
+// (a * (32 - w) + b * w) / 32, 三个通道一次完成
+static inline uint32_t lerp_spread(uint32_t a, uint32_t b, uint32_t w)
+{
+    return ((a * (32 - w) + b * w) >> 5) & RGB565_SPREAD_MASK;
+}
+
+void rgb565_row_bilinear(const uint16_t *row0, const uint16_t *row1,
+                         const uint16_t *x0, const uint16_t *x1, const uint8_t *xw,
+                         uint32_t yw, uint16_t *dst, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t w = xw[i];
+        uint32_t top = lerp_spread(spread(row0[x0[i]]), spread(row0[x1[i]]), w);
+        uint32_t bottom = lerp_spread(spread(row1[x0[i]]), spread(row1[x1[i]]), w);
+        dst[i] = unspread(lerp_spread(top, bottom, yw));
+    }
+}
+
+// 固定比例: 源像素成对按32位字读取, 每个字只交换一次字节
+
+// 主机有128位SIMD时每次8个输出, 与 rgb565_kernels.c 相同的条件
+#if defined(__GNUC__) && !defined(__clang__) && (defined(__SSE2__) || defined(__ARM_NEON))
+#define RGB565_FILTERS_VECTOR_EXT 1
+typedef uint16_t u16x8_t __attribute__((vector_size(16)));
+typedef uint32_t u32x4_t __attribute__((vector_size(16)));
+#endif
+
+#define LOW_HALF 0x0000FFFFu
+#define HIGH_HALF 0xFFFF0000u
+
+// 两个像素 (CPU 字节序) 用同一个权重插值, 与 lerp_spread 逐位相同:
+// 低像素的 R/B 和高像素的 G 一组, 另外三个通道右移5位后一组, 乘积互不重叠
+static inline uint32_t lerp_pair(uint32_t a, uint32_t b, uint32_t w)
+{
+    uint32_t even = ((a & RGB565_SPREAD_MASK) * (32 - w) + (b & RGB565_SPREAD_MASK) * w) >> 5;
+    uint32_t odd = ((a & ~RGB565_SPREAD_MASK) >> 5) * (32 - w) + ((b & ~RGB565_SPREAD_MASK) >> 5) * w;
+    return (even & RGB565_SPREAD_MASK) | (odd & ~RGB565_SPREAD_MASK);
+}
+
+// 上下两行的结果按 yw 合成; 16 即两行平均, 不用乘法
+static inline uint32_t blend_rows(uint32_t top, uint32_t bottom, uint32_t yw)
+{
+    return yw == 16 ? avg_pair(top, bottom) : lerp_pair(top, bottom, yw);
+}
+
+// 调用者保证4字节对齐, 编译成一次字读取
+static inline uint32_t load_pair(const uint16_t *p)
+{
+    uint32_t w;
+    memcpy(&w, __builtin_assume_aligned(p, 4), sizeof(w));
+    return rgb565_swap_pair(w);
+}
+
+static inline void store_pair(uint16_t *dst, uint32_t out)
+{
+    out = rgb565_swap_pair(out);
+    dst[0] = (uint16_t)out;
+    dst[1] = (uint16_t)(out >> 16);
+}
+
+#if RGB565_FILTERS_VECTOR_EXT
+static inline u16x8_t load_v(const uint16_t *p)
+{
+    u16x8_t v;
+    memcpy(&v, p, sizeof(v));
+    return (v << 8) | (v >> 8);
+}
+
+static inline void store_v(uint16_t *dst, u16x8_t v)
+{
+    v = (v << 8) | (v >> 8);
+    memcpy(dst, &v, sizeof(v));
+}
+
+static inline u16x8_t avg_v(u16x8_t a, u16x8_t b)
+{
+    return (a & b) + (((a ^ b) & (uint16_t)0xF7DE) >> 1);
+}
+
+// SSE2 没有32位乘法, 按通道在16位通道里插值: a + (b - a) * w / 32 (算术右移即向下取整)
+static inline u16x8_t lerp_channel(u16x8_t a, u16x8_t b, uint32_t w)
+{
+    typedef int16_t s16x8_t __attribute__((vector_size(16)));
+    return (u16x8_t)((s16x8_t)a + ((((s16x8_t)b - (s16x8_t)a) * (int16_t)w) >> 5));
+}
+
+static inline u16x8_t lerp_v(u16x8_t a, u16x8_t b, uint32_t w)
+{
+    u16x8_t r = lerp_channel(a >> 11, b >> 11, w);
+    u16x8_t g = lerp_channel((a >> 5) & 63, (b >> 5) & 63, w);
+    u16x8_t bl = lerp_channel(a & 31, b & 31, w);
+    return (r << 11) | (g << 5) | bl;
+}
+
+// 32位通道 (两个像素一组) 的版本: 每个通道的低半是结果, 高半不用
+static inline u32x4_t load_lanes(const uint16_t *p)
+{
+    u32x4_t v;
+    memcpy(&v, p, sizeof(v));
+    return ((v & 0x00FF00FFu) << 8) | ((v >> 8) & 0x00FF00FFu);
+}
+
+static inline u32x4_t avg_lanes(u32x4_t a, u32x4_t b)
+{
+    return (a & b) + (((a ^ b) & RGB565_PAIR_LSB_CLEAR) >> 1);
+}
+
+// 每个通道里的两个像素求平均
+static inline u32x4_t hsum_lanes(u32x4_t v)
+{
+    return avg_lanes(v, v >> 16);
+}
+
+// 两个向量各通道的低半按顺序拼成8个像素
+static inline u16x8_t low_halves(u32x4_t a, u32x4_t b)
+{
+    const u16x8_t even = {0, 2, 4, 6, 8, 10, 12, 14};
+    return __builtin_shuffle((u16x8_t)a, (u16x8_t)b, even);
+}
+
+static inline u16x8_t blend_rows_v(u16x8_t top, u16x8_t bottom, uint32_t yw)
+{
+    return yw == 16 ? avg_v(top, bottom) : lerp_v(top, bottom, yw);
+}
+#endif
+
+// 两行相同时 (1:1 或放大) 任何权重的结果都是上一行
+static inline uint32_t row_weight(const uint16_t *row0, const uint16_t *row1, uint32_t yw)
+{
+    return row0 == row1 ? 0 : yw;
+}
+
+// 1:1: 横向不插值, 只在两行之间合成
+static void blend_copy(const uint16_t *row0, const uint16_t *row1, uint32_t yw, uint16_t *dst, uint32_t count)
+{
+    uint32_t i = 0;
+
+    yw = row_weight(row0, row1, yw);
+    if (yw == 0) {
+        rgb565_row_copy(row0, dst, count);
+        return;
+    }
+#if RGB565_FILTERS_VECTOR_EXT
+    for (; i + 8 <= count; i += 8) {
+        store_v(dst + i, blend_rows_v(load_v(row0 + i), load_v(row1 + i), yw));
+    }
+#endif
+    for (; i + 2 <= count; i += 2) {
+        store_pair(dst + i, blend_rows(load_pair(row0 + i), load_pair(row1 + i), yw));
+    }
+    if (i < count) {
+        dst[i] = (uint16_t)rgb565_swap_pair(blend_rows(rgb565_swap_pair(row0[i]), rgb565_swap_pair(row1[i]), yw));
+    }
+}
+
+// 2:1: 第 i 个输出是源像素 2i 和 2i+1 的平均, 正好是一个字的两半;
+// 两个字拼成 (2i, 2i+2) 和 (2i+1, 2i+3), 一次平均得到两个输出
+static inline uint32_t decimate2_pair(const uint16_t *s)
+{
+    uint32_t w0 = load_pair(s), w1 = load_pair(s + 2);
+    return avg_pair((w0 & LOW_HALF) | (w1 << 16), (w0 >> 16) | (w1 & HIGH_HALF));
+}
+
+#if RGB565_FILTERS_VECTOR_EXT
+// 偶数列和奇数列各挑成一个向量后平均
+static inline u16x8_t decimate2_v(const uint16_t *s)
+{
+    const u16x8_t even = {0, 2, 4, 6, 8, 10, 12, 14}, odd = even + 1;
+    u16x8_t a = load_v(s), b = load_v(s + 8);
+    return avg_v(__builtin_shuffle(a, b, even), __builtin_shuffle(a, b, odd));
+}
+#endif
+
+static void blend_decimate2(const uint16_t *row0, const uint16_t *row1, uint32_t yw, uint16_t *dst,
+                            uint32_t count)
+{
+    uint32_t i = 0;
+
+    yw = row_weight(row0, row1, yw);
+#if RGB565_FILTERS_VECTOR_EXT
+    for (; i + 8 <= count; i += 8) {
+        u16x8_t out = decimate2_v(row0 + 2 * i);
+        if (yw != 0) {
+            out = blend_rows_v(out, decimate2_v(row1 + 2 * i), yw);
+        }
+        store_v(dst + i, out);
+    }
+#endif
+    for (; i + 2 <= count; i += 2) {
+        uint32_t out = decimate2_pair(row0 + 2 * i);
+        if (yw != 0) {
+            out = blend_rows(out, decimate2_pair(row1 + 2 * i), yw);
+        }
+        store_pair(dst + i, out);
+    }
+    if (i < count) {
+        uint32_t w = load_pair(row0 + 2 * i);
+        uint32_t out = avg_pair(w, w >> 16);
+        if (yw != 0) {
+            w = load_pair(row1 + 2 * i);
+            out = blend_rows(out, avg_pair(w, w >> 16), yw);
+        }
+        dst[i] = (uint16_t)rgb565_swap_pair(out);
+    }
+}
+
+void rgb565_row_box2x2_copy(const uint16_t *row0, const uint16_t *row1, uint16_t *dst, uint32_t count)
+{
+    blend_copy(row0, row1, 16, dst, count);
+}
+
+void rgb565_row_box2x2_decimate2(const uint16_t *row0, const uint16_t *row1, uint16_t *dst, uint32_t count)
+{
+    blend_decimate2(row0, row1, 16, dst, count);
+}
+
+void rgb565_row_bilinear_copy(const uint16_t *row0, const uint16_t *row1, uint32_t yw, uint16_t *dst,
+                              uint32_t count)
+{
+    blend_copy(row0, row1, yw, dst, count);
+}
+
+// 2:1 时双线性的横向权重都是 16, 与区域平均相同
+void rgb565_row_bilinear_decimate2(const uint16_t *row0, const uint16_t *row1, uint32_t yw, uint16_t *dst,
+                                   uint32_t count)
+{
+    blend_decimate2(row0, row1, yw, dst, count);
+}
+
+// 5:2 区域平均: 每4个输出取源像素 (0,1) (2,3) (5,6) (7,8)
+static inline void box5_2_quad(const uint16_t *s, uint32_t *h01, uint32_t *h23)
+{
+    uint32_t w0 = load_pair(s), w1 = load_pair(s + 2), w2 = load_pair(s + 4), w3 = load_pair(s + 6);
+    uint32_t p8 = rgb565_swap(s[8]);  // 第9个像素不一定在采样范围内, 不按字读
+    *h01 = avg_pair((w0 & LOW_HALF) | (w1 << 16), (w0 >> 16) | (w1 & HIGH_HALF));
+    *h23 = avg_pair((w2 >> 16) | (w3 & HIGH_HALF), (w3 & LOW_HALF) | (p8 << 16));
+}
+
+#if RGB565_FILTERS_VECTOR_EXT
+// 8个输出的像素对从 0,2,5,7,10,12,15,17 开始: 偶数起点的对在 s 的32位通道里,
+// 奇数起点的在 s+1 / s+11 的通道里, 整对挑出后再求平均, 最远读到第18个像素
+static inline u16x8_t box5_2_v(const uint16_t *s)
+{
+    const u32x4_t pick_a = {0, 1, 6, 7}, pick_b = {1, 2, 6, 7};
+    return low_halves(hsum_lanes(__builtin_shuffle(load_lanes(s), load_lanes(s + 1), pick_a)),
+                      hsum_lanes(__builtin_shuffle(load_lanes(s + 8), load_lanes(s + 11), pick_b)));
+}
+#endif
+
+void rgb565_row_box2x2_decimate5_2(const uint16_t *row0, const uint16_t *row1, uint16_t *dst, uint32_t count)
+{
+    const bool two_rows = row0 != row1;
+    uint32_t i = 0;
+
+#if RGB565_FILTERS_VECTOR_EXT
+    for (; i + 8 <= count; i += 8) {
+        u16x8_t out = box5_2_v(row0 + (5 * i) / 2);
+        if (two_rows) {
+            out = avg_v(out, box5_2_v(row1 + (5 * i) / 2));
+        }
+        store_v(dst + i, out);
+    }
+#endif
+    for (; i + 4 <= count; i += 4) {
+        uint32_t top01, top23;
+        box5_2_quad(row0 + (5 * i) / 2, &top01, &top23);
+        if (two_rows) {
+            uint32_t bottom01, bottom23;
+            box5_2_quad(row1 + (5 * i) / 2, &bottom01, &bottom23);
+            top01 = avg_pair(top01, bottom01);
+            top23 = avg_pair(top23, bottom23);
+        }
+        store_pair(dst + i, top01);
+        store_pair(dst + i + 2, top23);
+    }
+    for (; i < count; i++) {
+        uint32_t x = (5 * i) / 2;
+        uint32_t out = avg_pair(rgb565_swap(row0[x]), rgb565_swap(row0[x + 1]));
+        if (two_rows) {
+            out = avg_pair(out, avg_pair(rgb565_swap(row1[x]), rgb565_swap(row1[x + 1])));
+        }
+        dst[i] = rgb565_swap((uint16_t)out);
+    }
+}
+
+// 5:2 双线性: 输出 0..3 取源像素 (0,1) (3,4) (5,6) (8,9), 权重 24 8 24 8.
+// 奇数输出把两点对调后权重也是 24, 一个字里的两个输出用同一个权重
+static inline void bilinear5_2_quad(const uint16_t *s, uint32_t *h01, uint32_t *h23)
+{
+    uint32_t w0 = load_pair(s), w1 = load_pair(s + 2), w2 = load_pair(s + 4);
+    uint32_t w3 = load_pair(s + 6), w4 = load_pair(s + 8);
+    *h01 = lerp_pair((w0 & LOW_HALF) | (w2 << 16), (w0 >> 16) | (w1 & HIGH_HALF), 24);
+    *h23 = lerp_pair((w2 >> 16) | (w4 & HIGH_HALF), (w3 & LOW_HALF) | (w4 << 16), 24);
+}
+
+#if RGB565_FILTERS_VECTOR_EXT
+// 权重 24 的一点 0,4,5,9,10,14,15,19, 另一点 1,3,6,8,11,13,16,18
+static inline u16x8_t bilinear5_2_v(const uint16_t *s)
+{
+    const u16x8_t near = {0, 4, 5, 9, 10, 14, 15, 0}, near_c = {0, 1, 2, 3, 4, 5, 6, 15};
+    const u16x8_t far = {1, 3, 6, 8, 11, 13, 0, 0}, far_c = {0, 1, 2, 3, 4, 5, 12, 14};
+    u16x8_t a, b, c;
+    memcpy(&a, s, sizeof(a));
+    memcpy(&b, s + 8, sizeof(b));
+    memcpy(&c, s + 12, sizeof(c));
+    // 先挑出像素再交换字节, 少交换一个向量
+    u16x8_t t0 = __builtin_shuffle(__builtin_shuffle(a, b, near), c, near_c);
+    u16x8_t t1 = __builtin_shuffle(__builtin_shuffle(a, b, far), c, far_c);
+    return lerp_v((t0 << 8) | (t0 >> 8), (t1 << 8) | (t1 >> 8), 24);
+}
+#endif
+
+void rgb565_row_bilinear_decimate5_2(const uint16_t *row0, const uint16_t *row1, uint32_t yw, uint16_t *dst,
+                                     uint32_t count)
+{
+    uint32_t i = 0;
+
+    yw = row_weight(row0, row1, yw);
+#if RGB565_FILTERS_VECTOR_EXT
+    for (; i + 8 <= count; i += 8) {
+        u16x8_t out = bilinear5_2_v(row0 + (5 * i) / 2);
+        if (yw != 0) {
+            out = blend_rows_v(out, bilinear5_2_v(row1 + (5 * i) / 2), yw);
+        }
+        store_v(dst + i, out);
+    }
+#endif
+    for (; i + 4 <= count; i += 4) {
+        uint32_t top01, top23;
+        bilinear5_2_quad(row0 + (5 * i) / 2, &top01, &top23);
+        if (yw != 0) {
+            uint32_t bottom01, bottom23;
+            bilinear5_2_quad(row1 + (5 * i) / 2, &bottom01, &bottom23);
+            top01 = blend_rows(top01, bottom01, yw);
+            top23 = blend_rows(top23, bottom23, yw);
+        }
+        store_pair(dst + i, top01);
+        store_pair(dst + i + 2, top23);
+    }
+    for (; i < count; i++) {
+        uint32_t x = 5 * (i / 2) + 3 * (i & 1), w = i & 1 ? 8 : 24;
+        uint32_t out = lerp_pair(rgb565_swap(row0[x]), rgb565_swap(row0[x + 1]), w);
+        if (yw != 0) {
+            out = blend_rows(out, lerp_pair(rgb565_swap(row1[x]), rgb565_swap(row1[x + 1]), w), yw);
+        }
+        dst[i] = rgb565_swap((uint16_t)out);
+    }
+}
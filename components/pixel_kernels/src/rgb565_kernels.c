@@ -0,0 +1,139 @@
+/*
+ * RGB565 row resampling kernels
+ * RGB565 行重采样内核
+ */
+#include <stdbool.h>
+#include <string.h>
+#include "rgb565_kernels.h"
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
+#if CONFIG_IDF_TARGET_ESP32S3
+#define RGB565_KERNELS_PIE 1
+#endif
+
+// 主机有128位SIMD时使用GCC向量扩展, 其余目标用展开的标量循环
+#if defined(__GNUC__) && !defined(__clang__) && (defined(__SSE2__) || defined(__ARM_NEON))
+#define RGB565_KERNELS_VECTOR_EXT 1
+typedef uint16_t u16x8_t __attribute__((vector_size(16)));
+#endif
+
+void rgb565_row_copy_portable(const uint16_t *src, uint16_t *dst, uint32_t count)
+{
+    memcpy(dst, src, count * sizeof(uint16_t));
+}
+
+void rgb565_row_decimate2_portable(const uint16_t *src, uint16_t *dst, uint32_t count)
+{
+    uint32_t i = 0;
+#if RGB565_KERNELS_VECTOR_EXT
+    const u16x8_t even = {0, 2, 4, 6, 8, 10, 12, 14};
+    for (; i + 8 <= count; i += 8) {
+        u16x8_t a, b;
+        memcpy(&a, src + 2 * i, sizeof(a));
+        memcpy(&b, src + 2 * i + 8, sizeof(b));
+        u16x8_t r = __builtin_shuffle(a, b, even);
+        memcpy(dst + i, &r, sizeof(r));
+    }
+#endif
+    for (; i + 4 <= count; i += 4) {
+        dst[i] = src[2 * i];
+        dst[i + 1] = src[2 * i + 2];
+        dst[i + 2] = src[2 * i + 4];
+        dst[i + 3] = src[2 * i + 6];
+    }
+    for (; i < count; i++) {
+        dst[i] = src[2 * i];
+    }
+}
+
+void rgb565_row_decimate5_2_portable(const uint16_t *src, uint16_t *dst, uint32_t count)
+{
+    uint32_t i = 0;
+#if RGB565_KERNELS_VECTOR_EXT
+    // 8个输出来自源像素 0,2,5,7,10,12,15,17 (跨越3个向量)
+    const u16x8_t pick = {0, 2, 5, 7, 10, 12, 15, 15};
+    for (; i + 8 <= count; i += 8) {
+        const uint16_t *s = src + (5 * i) / 2;
+        u16x8_t a, b;
+        memcpy(&a, s, sizeof(a));
+        memcpy(&b, s + 8, sizeof(b));
+        u16x8_t r = __builtin_shuffle(a, b, pick);
+        r[7] = s[17];
+        memcpy(dst + i, &r, sizeof(r));
+    }
+#endif
+    // 每5个源像素产生2个输出: src[0], src[2]
+    for (; i + 2 <= count; i += 2) {
+        const uint16_t *s = src + (5 * i) / 2;
+        dst[i] = s[0];
+        dst[i + 1] = s[2];
+    }
+    if (i < count) {
+        dst[i] = src[(5 * i) / 2];
+    }
+}
+
+#if RGB565_KERNELS_PIE
+// rgb565_kernels_esp32s3.S: src/dst 16字节对齐, blocks = 输出像素数 / 8
+void rgb565_row_copy_pie(const uint16_t *src, uint16_t *dst, uint32_t blocks);
+void rgb565_row_decimate2_pie(const uint16_t *src, uint16_t *dst, uint32_t blocks);
+
+static inline bool aligned16(const void *p)
+{
+    return ((uintptr_t)p & 15) == 0;
+}
+
+void rgb565_row_copy(const uint16_t *src, uint16_t *dst, uint32_t count)
+{
+    // src/dst 对齐偏移一致时, 先用标量补齐到16字节边界
+    uint32_t head = 0;
+    while (head < count && !aligned16(dst + head)) {
+        head++;
+    }
+    if (!aligned16(src + head) || count - head < 8) {
+        rgb565_row_copy_portable(src, dst, count);
+        return;
+    }
+    uint32_t blocks = (count - head) / 8;
+    rgb565_row_copy_portable(src, dst, head);
+    rgb565_row_copy_pie(src + head, dst + head, blocks);
+    uint32_t done = head + blocks * 8;
+    rgb565_row_copy_portable(src + done, dst + done, count - done);
+}
+
+void rgb565_row_decimate2(const uint16_t *src, uint16_t *dst, uint32_t count)
+{
+    uint32_t head = 0;
+    while (head < count && !aligned16(dst + head)) {
+        head++;
+    }
+    if (!aligned16(src + 2 * head) || count - head < 8) {
+        rgb565_row_decimate2_portable(src, dst, count);
+        return;
+    }
+    uint32_t blocks = (count - head) / 8;
+    rgb565_row_decimate2_portable(src, dst, head);
+    rgb565_row_decimate2_pie(src + 2 * head, dst + head, blocks);
+    uint32_t done = head + blocks * 8;
+    rgb565_row_decimate2_portable(src + 2 * done, dst + done, count - done);
+}
+#else
+void rgb565_row_copy(const uint16_t *src, uint16_t *dst, uint32_t count)
+{
+    rgb565_row_copy_portable(src, dst, count);
+}
+
+void rgb565_row_decimate2(const uint16_t *src, uint16_t *dst, uint32_t count)
+{
+    rgb565_row_decimate2_portable(src, dst, count);
+}
+#endif
+
+// 5:2 的取样位置不规则, PIE 的 unzip/shuffle 无法高效表达, 两个目标共用可移植实现
+void rgb565_row_decimate5_2(const uint16_t *src, uint16_t *dst, uint32_t count)
+{
+    rgb565_row_decimate5_2_portable(src, dst, count);
+}
@@ -0,0 +1,239 @@
+/*
+ * Tile-based change detection for partial LCD updates
+ * 分块变化检测
+ */
+#include <string.h>
+#include "rgb565.h"
+#include "tile_diff.h"
+
+#define CELLS_PER_TILE 4
+
+static uint32_t box_area(const tile_diff_box_t *b)
+{
+    return (uint32_t)(b->x1 - b->x0) * (b->y1 - b->y0);
+}
+
+static tile_diff_box_t box_union(const tile_diff_box_t *a, const tile_diff_box_t *b)
+{
+    return (tile_diff_box_t) {
+        a->x0 < b->x0 ? a->x0 : b->x0,
+        a->y0 < b->y0 ? a->y0 : b->y0,
+        a->x1 > b->x1 ? a->x1 : b->x1,
+        a->y1 > b->y1 ? a->y1 : b->y1,
+    };
+}
+
+static bool box_overlap(const tile_diff_box_t *a, const tile_diff_box_t *b)
+{
+    return a->x0 < b->x1 && b->x0 < a->x1 && a->y0 < b->y1 && b->y0 < a->y1;
+}
+
+bool tile_diff_init(tile_diff_t *td, const tile_diff_config_t *config)
+{
+    memset(td, 0, sizeof(*td));
+    if (config->tile_size < CELLS_PER_TILE || config->tile_size % CELLS_PER_TILE != 0 ||
+        config->width == 0 || config->height == 0 ||
+        config->max_rects == 0 || config->max_rects > TILE_DIFF_MAX_RECTS) {
+        return false;
+    }
+
+    td->config = *config;
+    td->cell_size = config->tile_size / CELLS_PER_TILE;
+    td->cell_cols = (config->width + td->cell_size - 1) / td->cell_size;
+    td->cell_rows = (config->height + td->cell_size - 1) / td->cell_size;
+    td->tile_cols = (config->width + config->tile_size - 1) / config->tile_size;
+    td->tile_rows = (config->height + config->tile_size - 1) / config->tile_size;
+    // 单元和用 uint16_t: 每像素最大 187, 8x8 单元 (32 像素块) 不会溢出
+    if (td->cell_size > 8 ||
+        (uint32_t)td->cell_cols * td->cell_rows > TILE_DIFF_MAX_CELLS ||
+        (uint32_t)td->tile_cols * td->tile_rows > TILE_DIFF_MAX_TILES) {
+        return false;
+    }
+    return true;
+}
+
+void tile_diff_invalidate(tile_diff_t *td)
+{
+    td->valid = false;
+}
+
+// 一次遍历整帧, 累加每个单元的 r*2 + g + b*2 (近似亮度, 各通道同为6位刻度)
+static void compute_cells(tile_diff_t *td, const uint16_t *frame)
+{
+    const uint32_t width = td->config.width;
+    const uint32_t cs = td->cell_size;
+
+    memset(td->cur, 0, (size_t)td->cell_cols * td->cell_rows * sizeof(td->cur[0]));
+    for (uint32_t y = 0; y < td->config.height; y++) {
+        const uint16_t *in = frame + y * width;
+        uint16_t *cells = td->cur + (y / cs) * td->cell_cols;
+        for (uint32_t cx = 0, x = 0; cx < td->cell_cols; cx++) {
+            uint32_t end = x + cs < width ? x + cs : width;
+            uint32_t sum = 0;
+            for (; x < end; x++) {
+                uint16_t p = rgb565_swap(in[x]);
+                sum += (rgb565_r(p) << 1) + rgb565_g(p) + (rgb565_b(p) << 1);
+            }
+            cells[cx] += sum;
+        }
+    }
+}
+
+static bool tile_changed(const tile_diff_t *td, uint32_t tx, uint32_t ty)
+{
+    const int32_t limit = td->config.threshold * td->cell_size * td->cell_size;
+    uint32_t cx1 = (tx + 1) * CELLS_PER_TILE, cy1 = (ty + 1) * CELLS_PER_TILE;
+
+    if (cx1 > td->cell_cols) {
+        cx1 = td->cell_cols;
+    }
+    if (cy1 > td->cell_rows) {
+        cy1 = td->cell_rows;
+    }
+    for (uint32_t cy = ty * CELLS_PER_TILE; cy < cy1; cy++) {
+        for (uint32_t cx = tx * CELLS_PER_TILE; cx < cx1; cx++) {
+            uint32_t i = cy * td->cell_cols + cx;
+            int32_t d = (int32_t)td->cur[i] - td->ref[i];
+            if (d > limit || d < -limit) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// 这些块即将发送, 记下它们的新签名
+static void commit_box(tile_diff_t *td, const tile_diff_box_t *b)
+{
+    uint32_t cx0 = b->x0 * CELLS_PER_TILE, cx1 = b->x1 * CELLS_PER_TILE;
+    uint32_t cy0 = b->y0 * CELLS_PER_TILE, cy1 = b->y1 * CELLS_PER_TILE;
+
+    if (cx1 > td->cell_cols) {
+        cx1 = td->cell_cols;
+    }
+    if (cy1 > td->cell_rows) {
+        cy1 = td->cell_rows;
+    }
+    for (uint32_t cy = cy0; cy < cy1; cy++) {
+        uint32_t i = cy * td->cell_cols;
+        memcpy(&td->ref[i + cx0], &td->cur[i + cx0], (cx1 - cx0) * sizeof(td->ref[0]));
+    }
+}
+
+static void remove_box(tile_diff_box_t *boxes, size_t *count, size_t i)
+{
+    boxes[i] = boxes[--*count];
+}
+
+// 两两合并增加面积最小的一对, 直到数量不超过 max; 合并后吞掉与之重叠的矩形
+static void reduce_boxes(tile_diff_box_t *boxes, size_t *count, size_t max)
+{
+    while (*count > max) {
+        size_t bi = 0, bj = 1;
+        uint32_t best = UINT32_MAX;
+        for (size_t i = 0; i < *count; i++) {
+            for (size_t j = i + 1; j < *count; j++) {
+                tile_diff_box_t u = box_union(&boxes[i], &boxes[j]);
+                uint32_t cost = box_area(&u) - box_area(&boxes[i]) - box_area(&boxes[j]);
+                if (cost < best) {
+                    best = cost;
+                    bi = i;
+                    bj = j;
+                }
+            }
+        }
+        boxes[bi] = box_union(&boxes[bi], &boxes[bj]);
+        remove_box(boxes, count, bj);
+        if (bi == *count) {
+            bi = bj; // 被移到了 bj 的位置
+        }
+
+        for (size_t k = 0; k < *count;) {
+            if (k != bi && box_overlap(&boxes[bi], &boxes[k])) {
+                boxes[bi] = box_union(&boxes[bi], &boxes[k]);
+                remove_box(boxes, count, k);
+                if (bi == *count) {
+                    bi = k;
+                }
+                k = 0;
+            } else {
+                k++;
+            }
+        }
+    }
+}
+
+size_t tile_diff_update(tile_diff_t *td, const uint16_t *frame, frame_rect_t *rects)
+{
+    const uint32_t total = (uint32_t)td->tile_cols * td->tile_rows;
+    tile_diff_box_t *boxes = td->boxes;
+    size_t count = 0;
+    uint32_t dirty = 0;
+
+    compute_cells(td, frame);
+
+    if (td->valid) {
+        for (uint32_t ty = 0; ty < td->tile_rows; ty++) {
+            for (uint32_t tx = 0; tx < td->tile_cols; tx++) {
+                bool changed = tile_changed(td, tx, ty);
+                td->dirty[ty * td->tile_cols + tx] = changed;
+                dirty += changed;
+            }
+        }
+        if (dirty == 0) {
+            return 0;
+        }
+    }
+
+    if (!td->valid || dirty * 100 >= total * td->config.full_percent) {
+        count = 1;
+        boxes[0] = (tile_diff_box_t) {0, 0, td->tile_cols, td->tile_rows};
+    } else {
+        // 每行的连续脏块组成一段, 与上一行相同跨度的段向下延伸
+        for (uint32_t ty = 0; ty < td->tile_rows; ty++) {
+            const uint8_t *row = td->dirty + ty * td->tile_cols;
+            for (uint32_t tx = 0; tx < td->tile_cols;) {
+                if (!row[tx]) {
+                    tx++;
+                    continue;
+                }
+                uint32_t start = tx;
+                while (tx < td->tile_cols && row[tx]) {
+                    tx++;
+                }
+                size_t i;
+                for (i = 0; i < count; i++) {
+                    if (boxes[i].y1 == ty && boxes[i].x0 == start && boxes[i].x1 == tx) {
+                        boxes[i].y1++;
+                        break;
+                    }
+                }
+                if (i == count) {
+                    boxes[count++] = (tile_diff_box_t) {start, ty, tx, ty + 1};
+                }
+            }
+        }
+        reduce_boxes(boxes, &count, td->config.max_rects);
+
+        uint32_t area = 0;
+        for (size_t i = 0; i < count; i++) {
+            area += box_area(&boxes[i]);
+        }
+        if (area * 100 >= total * td->config.full_percent) {
+            count = 1;
+            boxes[0] = (tile_diff_box_t) {0, 0, td->tile_cols, td->tile_rows};
+        }
+    }
+
+    const uint32_t ts = td->config.tile_size;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t x1 = boxes[i].x1 * ts, y1 = boxes[i].y1 * ts;
+        commit_box(td, &boxes[i]);
+        rects[i].x = boxes[i].x0 * ts;
+        rects[i].y = boxes[i].y0 * ts;
+        rects[i].width = (x1 < td->config.width ? x1 : td->config.width) - rects[i].x;
+        rects[i].height = (y1 < td->config.height ? y1 : td->config.height) - rects[i].y;
+    }
+    td->valid = true;
+    return count;
+}
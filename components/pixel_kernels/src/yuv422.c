@@ -0,0 +1,64 @@
+/*
+ * YUV422 (YUYV) to RGB565 row conversion
+ * YUV422 (YUYV) 转 RGB565 行转换
+ */
+#include <stdbool.h>
+#include "rgb565.h"
+#include "yuv422.h"
+
+// 色度偏移表 (Q0, 已乘系数): R = Y + rv[V], G = Y + gu[U] + gv[V], B = Y + bu[U]
+static int16_t s_rv[256];
+static int16_t s_gu[256];
+static int16_t s_gv[256];
+static int16_t s_bu[256];
+
+// 饱和到 0..255 后直接给出 5/6 位通道值, 下标偏移 CLAMP_BIAS
+#define CLAMP_BIAS 256
+static uint8_t s_to5[768];
+static uint8_t s_to6[768];
+
+static bool s_tables_ready;
+
+void yuv422_init_tables(void)
+{
+    // BT.601 全范围系数, 8位定点: 1.402, 0.344, 0.714, 1.772
+    for (int i = 0; i < 256; i++) {
+        int c = i - 128;
+        s_rv[i] = (int16_t)((359 * c) >> 8);
+        s_gu[i] = (int16_t)(-((88 * c) >> 8));
+        s_gv[i] = (int16_t)(-((183 * c) >> 8));
+        s_bu[i] = (int16_t)((454 * c) >> 8);
+    }
+    for (int i = 0; i < 768; i++) {
+        int v = i - CLAMP_BIAS;
+        v = v < 0 ? 0 : (v > 255 ? 255 : v);
+        s_to5[i] = (uint8_t)(v >> 3);
+        s_to6[i] = (uint8_t)(v >> 2);
+    }
+    s_tables_ready = true;
+}
+
+void yuv422_row_to_rgb565(const uint8_t *row, const uint16_t *x_map,
+                          uint16_t *dst, uint8_t *luma, uint32_t count)
+{
+    if (!s_tables_ready) {
+        yuv422_init_tables();
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t x = x_map[i];
+        // YUYV: 每两个像素共用一组 U/V
+        const uint8_t *pair = row + (x & ~1u) * 2;
+        int y = row[x * 2] + CLAMP_BIAS;
+        uint8_t u = pair[1];
+        uint8_t v = pair[3];
+
+        uint32_t r = s_to5[y + s_rv[v]];
+        uint32_t g = s_to6[y + s_gu[u] + s_gv[v]];
+        uint32_t b = s_to5[y + s_bu[u]];
+        dst[i] = rgb565_swap(rgb565_pack(r, g, b));
+        if (luma) {
+            luma[i] = (uint8_t)(y - CLAMP_BIAS);
+        }
+    }
+}
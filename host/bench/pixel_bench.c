@@ -0,0 +1,444 @@
+/*
+ * Host benchmark for the pixel kernels
+ * 像素内核的主机端性能测试
+ *
+ * Runs every source size / scale mode / filter / format combination on
+ * synthetic frames (and optionally on recorded raw RGB565 frames), with
+ * warm-up and repetitions. A human-readable table goes to stderr and the
+ * results as JSON to stdout (or --json FILE) for regression tracking.
+ *
+ * --max-filter-ratio R fails (exit 1) when a box or bilinear RGB565 scale
+ * case takes more than R times the nearest-neighbour case with the same
+ * input and mode; both must pass --filter.
+ *
+ *   pixel_bench [--warmup N] [--reps N] [--filter TEXT] [--max-filter-ratio R]
+ *               [--frames FILE WIDTHxHEIGHT] [--json FILE]
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "frame_analysis.h"
+#include "frame_check.h"
+#include "frame_scaler.h"
+#include "rgb565.h"
+#include "rgb565_codec.h"
+#include "tile_diff.h"
+
+#define DST_WIDTH 128
+#define DST_HEIGHT 160
+#define SYNTHETIC_FRAMES 4
+
+typedef struct {
+    uint16_t width;
+    uint16_t height;
+} frame_size_t;
+
+// 摄像头常用分辨率 + 传感器开窗输出
+static const frame_size_t s_sizes[] = {
+    {160, 120}, {128, 128}, {176, 144}, {320, 240}, {640, 480}, {128, 160},
+};
+
+static const char *const s_mode_names[] = {"crop", "fit", "fill", "letterbox"};
+static const char *const s_filter_names[] = {"nearest", "box", "bilinear"};
+
+typedef struct {
+    const char *name;
+    uint8_t *data;       // count 帧, 每帧 width * height * 2 字节
+    uint32_t count;
+    uint16_t width;
+    uint16_t height;
+} frame_set_t;
+
+typedef struct {
+    int warmup;
+    int reps;
+    const char *filter;
+    FILE *json;
+    bool first_result;
+    double max_filter_ratio;  // 0: 不检查
+    int check_failures;
+} bench_options_t;
+
+typedef void (*bench_fn_t)(void *ctx, const uint8_t *frame);
+
+static bench_options_t s_opt = {
+    .warmup = 10,
+    .reps = 100,
+};
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static int compare_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+// 渐变 + 伪随机噪声, 每帧略有不同, 避免缓存里全是相同数据
+static void fill_synthetic(uint8_t *buf, uint32_t width, uint32_t height, uint32_t seed)
+{
+    uint32_t state = 0x9E3779B9u ^ seed;
+    uint16_t *px = (uint16_t *)buf;
+
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x++) {
+            state = state * 1664525u + 1013904223u;
+            uint32_t noise = state >> 30;
+            uint32_t r = (x * 31 / width + noise) & 31;
+            uint32_t g = (y * 63 / height + noise) & 63;
+            uint32_t b = ((x + y + seed) * 31 / (width + height)) & 31;
+            px[y * width + x] = rgb565_swap(rgb565_pack(r, g, b));
+        }
+    }
+}
+
+static bool make_synthetic(frame_set_t *set, uint16_t width, uint16_t height)
+{
+    size_t frame_bytes = (size_t)width * height * 2;
+
+    set->name = "synthetic";
+    set->width = width;
+    set->height = height;
+    set->count = SYNTHETIC_FRAMES;
+    set->data = malloc(frame_bytes * SYNTHETIC_FRAMES);
+    if (set->data == NULL) {
+        return false;
+    }
+    for (uint32_t i = 0; i < SYNTHETIC_FRAMES; i++) {
+        fill_synthetic(set->data + i * frame_bytes, width, height, i);
+    }
+    return true;
+}
+
+static bool load_recorded(frame_set_t *set, const char *path, uint16_t width, uint16_t height)
+{
+    size_t frame_bytes = (size_t)width * height * 2;
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        perror(path);
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    set->name = "recorded";
+    set->width = width;
+    set->height = height;
+    set->count = size > 0 ? (uint32_t)(size / frame_bytes) : 0;
+    set->data = set->count ? malloc(frame_bytes * set->count) : NULL;
+    bool ok = set->data && fread(set->data, frame_bytes, set->count, f) == set->count;
+    fclose(f);
+    if (!ok) {
+        fprintf(stderr, "%s: need at least one %ux%u RGB565 frame\n", path, width, height);
+    }
+    return ok;
+}
+
+// 预热后重复 reps 次, 每次处理输入集里的下一帧; 返回每帧耗时的中位数, 未运行时为 0
+static uint64_t run_case(const char *name, const char *json_fields, uint32_t pixels,
+                     const frame_set_t *set, bench_fn_t fn, void *ctx)
+{
+    if (s_opt.filter && strstr(name, s_opt.filter) == NULL) {
+        return 0;
+    }
+
+    size_t frame_bytes = (size_t)set->width * set->height * 2;
+    uint64_t *samples = malloc(sizeof(uint64_t) * s_opt.reps);
+    if (samples == NULL) {
+        return 0;
+    }
+
+    for (int i = 0; i < s_opt.warmup; i++) {
+        fn(ctx, set->data + (i % set->count) * frame_bytes);
+    }
+    uint64_t total = 0;
+    for (int i = 0; i < s_opt.reps; i++) {
+        const uint8_t *frame = set->data + (i % set->count) * frame_bytes;
+        uint64_t t0 = now_ns();
+        fn(ctx, frame);
+        samples[i] = now_ns() - t0;
+        total += samples[i];
+    }
+    qsort(samples, s_opt.reps, sizeof(uint64_t), compare_u64);
+
+    uint64_t median = samples[s_opt.reps / 2];
+    uint64_t min = samples[0];
+    uint64_t p95 = samples[(s_opt.reps * 95) / 100 < s_opt.reps ? (s_opt.reps * 95) / 100 : s_opt.reps - 1];
+    double mean = (double)total / s_opt.reps;
+
+    fprintf(stderr, "%-52s %10.0f ns/frame  %7.3f ns/px (min %7.3f)\n",
+            name, (double)median, (double)median / pixels, (double)min / pixels);
+    fprintf(s_opt.json,
+            "%s\n    {\"name\": \"%s\", %s, \"input\": \"%s\", \"pixels\": %u, "
+            "\"ns_per_frame_median\": %llu, \"ns_per_frame_min\": %llu, \"ns_per_frame_p95\": %llu, "
+            "\"ns_per_frame_mean\": %.1f, \"ns_per_pixel_median\": %.4f, \"ns_per_pixel_min\": %.4f}",
+            s_opt.first_result ? "" : ",", name, json_fields, set->name, pixels,
+            (unsigned long long)median, (unsigned long long)min, (unsigned long long)p95,
+            mean, (double)median / pixels, (double)min / pixels);
+    s_opt.first_result = false;
+    free(samples);
+    return median;
+}
+
+typedef struct {
+    frame_scaler_t scaler;
+    bool yuv;
+    uint16_t dst[DST_WIDTH * DST_HEIGHT];
+    uint8_t luma[DST_WIDTH * DST_HEIGHT];
+} scale_ctx_t;
+
+static void bench_scale(void *ctx, const uint8_t *frame)
+{
+    scale_ctx_t *c = ctx;
+    if (c->yuv) {
+        frame_scaler_run_yuv422_rows(&c->scaler, frame, c->dst, c->luma, 0, DST_HEIGHT);
+    } else {
+        frame_scaler_run(&c->scaler, (const uint16_t *)frame, c->dst);
+    }
+}
+
+static void bench_analysis(void *ctx, const uint8_t *frame)
+{
+    const frame_set_t *set = ctx;
+    frame_analysis_t result;
+    frame_analysis_rgb565(frame, (size_t)set->width * set->height * 2, &result);
+    // 防止整个调用被优化掉
+    __asm__ volatile("" : : "r"(&result) : "memory");
+}
+
+typedef struct {
+    const frame_set_t *set;
+    uint8_t step;
+    frame_stats_t stats;
+} stats_ctx_t;
+
+// 流水线里逐段 (8行) 累计, 这里同样分段
+static void bench_stats(void *ctx, const uint8_t *frame)
+{
+    stats_ctx_t *c = ctx;
+    uint32_t w = c->set->width, h = c->set->height;
+    frame_stats_begin(&c->stats, 0, 0, w, h, c->step);
+    for (uint32_t y = 0; y < h; y += 8) {
+        frame_stats_rows(&c->stats, (const uint16_t *)frame + y * w, w, y, h - y < 8 ? h - y : 8);
+    }
+    frame_stats_end(&c->stats);
+}
+
+typedef struct {
+    const frame_set_t *set;
+    frame_check_t check;
+} check_ctx_t;
+
+static void bench_check(void *ctx, const uint8_t *frame)
+{
+    check_ctx_t *c = ctx;
+    uint32_t w = c->set->width, h = c->set->height;
+    frame_check_run(&c->check, frame, (size_t)w * h * 2, w, h, false, NULL);
+}
+
+typedef struct {
+    tile_diff_t diff;
+    frame_rect_t rects[TILE_DIFF_MAX_RECTS];
+} diff_ctx_t;
+
+static void bench_tile_diff(void *ctx, const uint8_t *frame)
+{
+    diff_ctx_t *c = ctx;
+    tile_diff_update(&c->diff, (const uint16_t *)frame, c->rects);
+}
+
+typedef struct {
+    rgb565_encoder_t enc;
+    uint8_t out[RGB565_CODEC_MAX_BYTES(DST_WIDTH * DST_HEIGHT)];
+} codec_ctx_t;
+
+// 与录制时相同, 逐行编码
+static void bench_codec(void *ctx, const uint8_t *frame)
+{
+    codec_ctx_t *c = ctx;
+    const uint16_t *pixels = (const uint16_t *)frame;
+    size_t n = 0;
+    rgb565_codec_encode_begin(&c->enc);
+    for (int y = 0; y < DST_HEIGHT; y++) {
+        n += rgb565_codec_encode(&c->enc, pixels + y * DST_WIDTH, DST_WIDTH, c->out + n);
+    }
+    rgb565_codec_encode_end(&c->enc, c->out + n);
+}
+
+static void run_frame_set(const frame_set_t *set)
+{
+    static scale_ctx_t scale;
+    char name[128], fields[256];
+
+    // 缩放: 每种模式 x 滤波 (RGB565), 以及 YUV422 一次转换+缩放 (最近邻)
+    for (int mode = 0; mode < 4; mode++) {
+        uint64_t nearest_ns = 0;
+        for (int filter = 0; filter < 3 + 1; filter++) {
+            bool yuv = filter == 3;
+            frame_scaler_geometry_t g = {
+                .src_width = set->width,
+                .src_height = set->height,
+                .dst_width = DST_WIDTH,
+                .dst_height = DST_HEIGHT,
+                .mode = (frame_scaler_mode_t)mode,
+                .filter = yuv ? FRAME_SCALER_FILTER_NEAREST : (frame_scaler_filter_t)filter,
+            };
+            memset(&scale.scaler, 0, sizeof(scale.scaler));
+            if (!frame_scaler_configure(&scale.scaler, &g)) {
+                continue;
+            }
+            scale.yuv = yuv;
+            const char *filter_name = s_filter_names[g.filter];
+            const char *format = yuv ? "yuv422" : "rgb565";
+            snprintf(name, sizeof(name), "scale/%ux%u/%s/%s/%s/%s", set->width, set->height,
+                     s_mode_names[mode], filter_name, format, set->name);
+            snprintf(fields, sizeof(fields),
+                     "\"kernel\": \"scale\", \"src_width\": %u, \"src_height\": %u, "
+                     "\"dst_width\": %u, \"dst_height\": %u, \"mode\": \"%s\", \"filter\": \"%s\", "
+                     "\"format\": \"%s\", \"x_kernel\": %d",
+                     set->width, set->height, DST_WIDTH, DST_HEIGHT, s_mode_names[mode],
+                     filter_name, format, scale.scaler.x_kernel);
+            uint64_t ns = run_case(name, fields, DST_WIDTH * DST_HEIGHT, set, bench_scale, &scale);
+            if (g.filter == FRAME_SCALER_FILTER_NEAREST && !yuv) {
+                nearest_ns = ns;
+            } else if (!yuv && s_opt.max_filter_ratio > 0 && ns && nearest_ns &&
+                       ns > nearest_ns * s_opt.max_filter_ratio) {
+                fprintf(stderr, "  ^ %.1fx nearest, limit %.1fx\n", (double)ns / nearest_ns, s_opt.max_filter_ratio);
+                s_opt.check_failures++;
+            }
+        }
+    }
+
+    snprintf(name, sizeof(name), "analysis/%ux%u/%s", set->width, set->height, set->name);
+    snprintf(fields, sizeof(fields), "\"kernel\": \"analysis\", \"src_width\": %u, \"src_height\": %u",
+             set->width, set->height);
+    run_case(name, fields, (uint32_t)set->width * set->height, set, bench_analysis, (void *)set);
+
+    // 曝光统计: 每像素 / 每2、4行列取一个 (EXAMPLE_FRAME_STATS_STEP)
+    static stats_ctx_t stats;
+    for (uint8_t step = 1; step <= 4; step *= 2) {
+        stats.set = set;
+        stats.step = step;
+        snprintf(name, sizeof(name), "stats/%ux%u/step%u/%s", set->width, set->height, step, set->name);
+        snprintf(fields, sizeof(fields),
+                 "\"kernel\": \"stats\", \"src_width\": %u, \"src_height\": %u, \"step\": %u",
+                 set->width, set->height, step);
+        run_case(name, fields, (uint32_t)set->width * set->height, set, bench_stats, &stats);
+    }
+
+    // 损坏检测: 默认阈值, 与上一帧比较 (输入集里的帧轮流)
+    static check_ctx_t check;
+    frame_check_config_t check_config = FRAME_CHECK_CONFIG_DEFAULT();
+    check.set = set;
+    frame_check_init(&check.check, &check_config);
+    snprintf(name, sizeof(name), "check/%ux%u/%s", set->width, set->height, set->name);
+    snprintf(fields, sizeof(fields), "\"kernel\": \"check\", \"src_width\": %u, \"src_height\": %u",
+             set->width, set->height);
+    run_case(name, fields, (uint32_t)set->width * set->height, set, bench_check, &check);
+
+    // 分块比较在屏幕分辨率上运行
+    if (set->width == DST_WIDTH && set->height == DST_HEIGHT) {
+        static diff_ctx_t diff;
+        tile_diff_config_t config = {DST_WIDTH, DST_HEIGHT, 16, 3, 4, 70};
+        if (tile_diff_init(&diff.diff, &config)) {
+            snprintf(name, sizeof(name), "tile_diff/%ux%u/%s", set->width, set->height, set->name);
+            snprintf(fields, sizeof(fields),
+                     "\"kernel\": \"tile_diff\", \"src_width\": %u, \"src_height\": %u, \"tile_size\": 16",
+                     set->width, set->height);
+            run_case(name, fields, DST_WIDTH * DST_HEIGHT, set, bench_tile_diff, &diff);
+        }
+
+        static codec_ctx_t codec;
+        snprintf(name, sizeof(name), "codec/%ux%u/%s", set->width, set->height, set->name);
+        snprintf(fields, sizeof(fields), "\"kernel\": \"codec\", \"src_width\": %u, \"src_height\": %u",
+                 set->width, set->height);
+        run_case(name, fields, DST_WIDTH * DST_HEIGHT, set, bench_codec, &codec);
+    }
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr, "usage: %s [--warmup N] [--reps N] [--filter TEXT] [--max-filter-ratio R] "
+            "[--frames FILE WIDTHxHEIGHT] [--json FILE]\n", argv0);
+}
+
+int main(int argc, char **argv)
+{
+    const char *frames_path = NULL;
+    unsigned frames_w = 0, frames_h = 0;
+
+    s_opt.json = stdout;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--warmup") && i + 1 < argc) {
+            s_opt.warmup = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--reps") && i + 1 < argc) {
+            s_opt.reps = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--filter") && i + 1 < argc) {
+            s_opt.filter = argv[++i];
+        } else if (!strcmp(argv[i], "--max-filter-ratio") && i + 1 < argc) {
+            s_opt.max_filter_ratio = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--frames") && i + 2 < argc) {
+            frames_path = argv[++i];
+            if (sscanf(argv[++i], "%ux%u", &frames_w, &frames_h) != 2 || !frames_w || !frames_h) {
+                usage(argv[0]);
+                return 2;
+            }
+        } else if (!strcmp(argv[i], "--json") && i + 1 < argc) {
+            s_opt.json = fopen(argv[++i], "w");
+            if (s_opt.json == NULL) {
+                perror(argv[i]);
+                return 1;
+            }
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (s_opt.reps < 1 || s_opt.warmup < 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    fprintf(s_opt.json, "{\n  \"schema\": 1,\n  \"warmup\": %d,\n  \"reps\": %d,\n  \"results\": [",
+            s_opt.warmup, s_opt.reps);
+    s_opt.first_result = true;
+
+    for (size_t i = 0; i < sizeof(s_sizes) / sizeof(s_sizes[0]); i++) {
+        frame_set_t set;
+        if (!make_synthetic(&set, s_sizes[i].width, s_sizes[i].height)) {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+        run_frame_set(&set);
+        free(set.data);
+    }
+    if (frames_path) {
+        frame_set_t set;
+        if (!load_recorded(&set, frames_path, frames_w, frames_h)) {
+            return 1;
+        }
+        run_frame_set(&set);
+        free(set.data);
+    }
+
+    fprintf(s_opt.json, "\n  ]\n}\n");
+    if (s_opt.json != stdout) {
+        fclose(s_opt.json);
+    }
+    if (s_opt.check_failures) {
+        fprintf(stderr, "%d filtered scale case(s) above %.1fx nearest\n", s_opt.check_failures,
+                s_opt.max_filter_ratio);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,9 @@
+/*
+ * esp_attr.h for the host pipeline simulation
+ * 主机端模拟: 段属性为空
+ */
+
+#pragma once
+
+#define IRAM_ATTR
+#define DRAM_ATTR
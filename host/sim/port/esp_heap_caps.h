@@ -0,0 +1,50 @@
+/*
+ * esp_heap_caps.h for the host pipeline simulation
+ * 主机端模拟: 内存能力标志被忽略
+ *
+ * Free and largest-block sizes are fixed, nominal ESP32-S3 values at boot
+ * (internal DMA-capable RAM, 8 MB PSRAM), so a buffer budget that would
+ * not fit on the device also fails in the simulation.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define MALLOC_CAP_DMA (1 << 3)
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+
+#define SIM_HEAP_INTERNAL_BYTES (280 * 1024)
+#define SIM_HEAP_SPIRAM_BYTES (8 * 1024 * 1024)
+
+static inline void *heap_caps_malloc(size_t size, uint32_t caps)
+{
+    (void)caps;
+    return malloc(size);
+}
+
+static inline void heap_caps_free(void *ptr)
+{
+    free(ptr);
+}
+
+static inline void *heap_caps_aligned_alloc(size_t alignment, size_t size, uint32_t caps)
+{
+    void *ptr = NULL;
+    (void)caps;
+    return posix_memalign(&ptr, alignment < sizeof(void *) ? sizeof(void *) : alignment, size) == 0 ? ptr : NULL;
+}
+
+static inline size_t heap_caps_get_free_size(uint32_t caps)
+{
+    return (caps & MALLOC_CAP_SPIRAM) ? SIM_HEAP_SPIRAM_BYTES : SIM_HEAP_INTERNAL_BYTES;
+}
+
+static inline size_t heap_caps_get_largest_free_block(uint32_t caps)
+{
+    return heap_caps_get_free_size(caps);
+}
@@ -0,0 +1,10 @@
+/*
+ * esp_lcd_panel_commands.h for the host pipeline simulation
+ * 主机端模拟: 用到的 MIPI DCS 命令
+ */
+
+#pragma once
+
+#define LCD_CMD_CASET 0x2A // 列地址
+#define LCD_CMD_RASET 0x2B // 行地址
+#define LCD_CMD_RAMWR 0x2C // 写显存
@@ -0,0 +1,33 @@
+/*
+ * esp_lcd_panel_io.h for the host pipeline simulation
+ * 主机端模拟: 面板 IO 句柄、命令/颜色传输 (sim_lcd.c) 与传输完成回调
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct sim_panel_io *esp_lcd_panel_io_handle_t;
+
+typedef struct {
+} esp_lcd_panel_io_event_data_t;
+
+typedef bool (*esp_lcd_panel_io_color_trans_done_cb_t)(esp_lcd_panel_io_handle_t panel_io,
+                                                       esp_lcd_panel_io_event_data_t *edata,
+                                                       void *user_ctx);
+
+esp_err_t esp_lcd_panel_io_tx_param(esp_lcd_panel_io_handle_t io, int lcd_cmd, const void *param,
+                                    size_t param_size);
+esp_err_t esp_lcd_panel_io_tx_color(esp_lcd_panel_io_handle_t io, int lcd_cmd, const void *color,
+                                    size_t color_size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,26 @@
+/*
+ * esp_memory_utils.h for the host pipeline simulation
+ * 主机端模拟: 帧缓冲都当作可被 DMA 直接读取的 PSRAM
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+static inline bool esp_ptr_dma_capable(const void *p)
+{
+    (void)p;
+    return false;
+}
+
+static inline bool esp_ptr_dma_ext_capable(const void *p)
+{
+    (void)p;
+    return true;
+}
+
+static inline bool esp_ptr_external_ram(const void *p)
+{
+    (void)p;
+    return true;
+}
@@ -0,0 +1,19 @@
+/*
+ * esp_timer.h for the host pipeline simulation
+ * 主机端模拟: 单调时钟, 微秒
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+int64_t esp_timer_get_time(void);
+
+#ifdef __cplusplus
+}
+#endif
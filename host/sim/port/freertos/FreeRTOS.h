@@ -0,0 +1,33 @@
+/*
+ * FreeRTOS subset for the host pipeline simulation
+ * 主机端模拟用的 FreeRTOS 子集（pthread 实现）
+ *
+ * Only what preview_pipeline.c uses. Ticks are milliseconds; task cores
+ * and priorities are ignored, every task is a plain thread.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define configTICK_RATE_HZ 1000
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+#ifdef __cplusplus
+}
+#endif
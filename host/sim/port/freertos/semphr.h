@@ -0,0 +1,29 @@
+/*
+ * FreeRTOS semaphore subset for the host pipeline simulation
+ * 主机端模拟: 二值信号量
+ */
+
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct sim_semaphore *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+
+static inline BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t *need_yield)
+{
+    *need_yield = pdFALSE;
+    return xSemaphoreGive(sem);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,34 @@
+/*
+ * FreeRTOS task subset for the host pipeline simulation
+ * 主机端模拟: 任务与任务通知
+ */
+
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct sim_task *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack_depth,
+                                   void *arg, UBaseType_t priority, TaskHandle_t *handle,
+                                   BaseType_t core);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+void vTaskDelay(TickType_t ticks);
+void xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks);
+
+static inline void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *need_yield)
+{
+    *need_yield = pdFALSE;
+    xTaskNotifyGive(task);
+}
+
+#ifdef __cplusplus
+}
+#endif
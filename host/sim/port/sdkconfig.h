@@ -0,0 +1,6 @@
+/*
+ * sdkconfig.h for the host pipeline simulation
+ * 主机端模拟: 没有 Kconfig 选项
+ */
+
+#pragma once
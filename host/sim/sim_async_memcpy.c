@@ -0,0 +1,102 @@
+/*
+ * Async memcpy for the host pipeline simulation
+ * 主机端模拟: 异步内存拷贝
+ *
+ * Copies are queued up to backlog and done one after another by a worker
+ * thread, which then runs the completion callback, so a caller that reads
+ * the destination before the callback sees stale data as on the device.
+ * Every source is taken to be a PSRAM frame buffer: without
+ * psram_trans_align, or with a source or length off that alignment, the
+ * copy is refused like the driver does.
+ */
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_async_memcpy.h"
+
+#define SIM_MEMCPY_MAX_BACKLOG 16
+
+typedef struct {
+    void *dst;
+    const void *src;
+    size_t n;
+    async_memcpy_isr_cb_t cb;
+    void *cb_args;
+} sim_copy_t;
+
+struct sim_async_memcpy {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    sim_copy_t queue[SIM_MEMCPY_MAX_BACKLOG];
+    uint32_t head, count, backlog;
+    size_t psram_align;
+};
+
+static void *copy_thread(void *arg)
+{
+    struct sim_async_memcpy *mcp = arg;
+
+    while (1) {
+        pthread_mutex_lock(&mcp->lock);
+        while (mcp->count == 0) {
+            pthread_cond_wait(&mcp->cond, &mcp->lock);
+        }
+        sim_copy_t copy = mcp->queue[mcp->head];
+        pthread_mutex_unlock(&mcp->lock);
+
+        memcpy(copy.dst, copy.src, copy.n);
+
+        // 回调之前释放队列位置: 回调里可以启动下一次拷贝
+        pthread_mutex_lock(&mcp->lock);
+        mcp->head = (mcp->head + 1) % SIM_MEMCPY_MAX_BACKLOG;
+        mcp->count--;
+        pthread_mutex_unlock(&mcp->lock);
+        if (copy.cb) {
+            async_memcpy_event_t event = {0};
+            copy.cb(mcp, &event, copy.cb_args);
+        }
+    }
+    return NULL;
+}
+
+esp_err_t esp_async_memcpy_install(const async_memcpy_config_t *config, async_memcpy_handle_t *mcp)
+{
+    if (config->backlog == 0 || config->backlog > SIM_MEMCPY_MAX_BACKLOG) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    struct sim_async_memcpy *m = calloc(1, sizeof(*m));
+    if (m == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    pthread_mutex_init(&m->lock, NULL);
+    pthread_cond_init(&m->cond, NULL);
+    m->backlog = config->backlog;
+    m->psram_align = config->psram_trans_align;
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, copy_thread, m) != 0) {
+        free(m);
+        return ESP_FAIL;
+    }
+    pthread_detach(thread);
+    *mcp = m;
+    return ESP_OK;
+}
+
+esp_err_t esp_async_memcpy(async_memcpy_handle_t mcp, void *dst, void *src, size_t n,
+                           async_memcpy_isr_cb_t cb_isr, void *cb_args)
+{
+    if (mcp->psram_align == 0 || (uintptr_t)src % mcp->psram_align != 0 || n % mcp->psram_align != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&mcp->lock);
+    if (mcp->count >= mcp->backlog) {
+        pthread_mutex_unlock(&mcp->lock);
+        return ESP_FAIL;
+    }
+    mcp->queue[(mcp->head + mcp->count) % SIM_MEMCPY_MAX_BACKLOG] = (sim_copy_t) {dst, src, n, cb_isr, cb_args};
+    mcp->count++;
+    pthread_cond_signal(&mcp->cond);
+    pthread_mutex_unlock(&mcp->lock);
+    return ESP_OK;
+}
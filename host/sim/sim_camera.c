@@ -0,0 +1,265 @@
+/*
+ * File-backed camera for the host pipeline simulation
+ * 主机端模拟: 录制帧回放
+ *
+ * Models the esp32-camera driver with CAMERA_GRAB_LATEST: the sensor
+ * thread writes each recorded frame into a free frame buffer at its
+ * original capture time (scaled by speed). When no buffer is free the
+ * oldest buffer that is ready but not yet taken is overwritten; when all
+ * buffers are held by the pipeline the frame is lost. esp_camera_fb_get
+ * returns the newest ready frame and frees older ready ones.
+ */
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "esp_camera.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "example_config.h"
+#include "sim_camera.h"
+
+static const char *TAG = "sim_camera";
+
+#define SIM_CAMERA_MAX_FB 4
+
+typedef enum {
+    FB_FREE,
+    FB_READY,  // 已写入, 等待 fb_get
+    FB_HELD,   // 流水线持有
+} fb_state_t;
+
+static sim_camera_config_t s_config;
+static uint8_t *s_frames;
+static size_t s_frame_bytes;
+static uint32_t s_frame_count;
+static int64_t *s_timestamps;  // 相对第一帧, 微秒
+
+static camera_fb_t s_fb[SIM_CAMERA_MAX_FB];
+static fb_state_t s_state[SIM_CAMERA_MAX_FB];
+static uint32_t s_ready_seq[SIM_CAMERA_MAX_FB];
+static uint32_t s_seq;
+static bool s_source_done;
+static sim_camera_stats_t s_stats;
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_ready = PTHREAD_COND_INITIALIZER;
+
+static bool load_frames(void)
+{
+    FILE *f = fopen(s_config.frames_path, "rb");
+    if (f == NULL) {
+        ESP_LOGE(TAG, "Cannot open %s", s_config.frames_path);
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    s_frame_bytes = (size_t)s_config.width * s_config.height * 2;
+    s_frame_count = size > 0 ? (uint32_t)(size / s_frame_bytes) : 0;
+    if (s_frame_count == 0) {
+        ESP_LOGE(TAG, "%s holds no complete %ux%u frame", s_config.frames_path,
+                 s_config.width, s_config.height);
+        fclose(f);
+        return false;
+    }
+    s_frames = malloc(s_frame_count * s_frame_bytes);
+    bool ok = s_frames && fread(s_frames, s_frame_bytes, s_frame_count, f) == s_frame_count;
+    fclose(f);
+    return ok;
+}
+
+static bool load_timestamps(void)
+{
+    s_timestamps = calloc(s_frame_count, sizeof(*s_timestamps));
+    if (s_timestamps == NULL) {
+        return false;
+    }
+    if (s_config.timestamps_path == NULL) {
+        for (uint32_t i = 0; i < s_frame_count; i++) {
+            s_timestamps[i] = (int64_t)(i * 1e6 / s_config.fps);
+        }
+        return true;
+    }
+
+    FILE *f = fopen(s_config.timestamps_path, "r");
+    if (f == NULL) {
+        ESP_LOGE(TAG, "Cannot open %s", s_config.timestamps_path);
+        return false;
+    }
+    long long value, first = 0;
+    uint32_t n = 0;
+    while (n < s_frame_count && fscanf(f, "%lld", &value) == 1) {
+        if (n == 0) {
+            first = value;
+        }
+        s_timestamps[n++] = value - first;
+    }
+    fclose(f);
+    if (n != s_frame_count) {
+        ESP_LOGE(TAG, "%s: %u timestamps for %u frames", s_config.timestamps_path, n, s_frame_count);
+        return false;
+    }
+    return true;
+}
+
+static void sleep_until(int64_t when_us)
+{
+    int64_t now = esp_timer_get_time();
+    if (when_us > now) {
+        struct timespec ts = {
+            .tv_sec = (when_us - now) / 1000000,
+            .tv_nsec = (long)((when_us - now) % 1000000) * 1000,
+        };
+        nanosleep(&ts, NULL);
+    }
+}
+
+// 选择写入的帧缓冲: 空闲的, 否则最旧的未取走帧; 全部被持有时返回 -1
+static int pick_buffer(void)
+{
+    int oldest = -1;
+    for (uint32_t i = 0; i < s_config.fb_count; i++) {
+        if (s_state[i] == FB_FREE) {
+            return i;
+        }
+        if (s_state[i] == FB_READY && (oldest < 0 || (int32_t)(s_ready_seq[i] - s_ready_seq[oldest]) < 0)) {
+            oldest = i;
+        }
+    }
+    if (oldest >= 0) {
+        s_stats.sensor_dropped++;
+    }
+    return oldest;
+}
+
+static void *sensor_thread(void *arg)
+{
+    int64_t start = esp_timer_get_time();
+    int64_t loop_length = s_frame_count > 1 ?
+        s_timestamps[s_frame_count - 1] + s_timestamps[s_frame_count - 1] / (s_frame_count - 1) : 0;
+
+    for (uint32_t loop = 0; loop < s_config.loops; loop++) {
+        for (uint32_t i = 0; i < s_frame_count; i++) {
+            sleep_until(start + (int64_t)((loop * loop_length + s_timestamps[i]) / s_config.speed));
+            int64_t now = esp_timer_get_time();
+
+            pthread_mutex_lock(&s_lock);
+            s_stats.source_frames++;
+            if (s_stats.first_us == 0) {
+                s_stats.first_us = now;
+            }
+            s_stats.last_us = now;
+            int slot = pick_buffer();
+            if (slot < 0) {
+                s_stats.sensor_dropped++;
+            } else {
+                // 实际由 DMA 写入; 驱动在帧结束时打时间戳
+                camera_fb_t *fb = &s_fb[slot];
+                memcpy(fb->buf, s_frames + i * s_frame_bytes, s_frame_bytes);
+                fb->timestamp.tv_sec = now / 1000000;
+                fb->timestamp.tv_usec = now % 1000000;
+                s_state[slot] = FB_READY;
+                s_ready_seq[slot] = s_seq++;
+                pthread_cond_signal(&s_ready);
+            }
+            pthread_mutex_unlock(&s_lock);
+        }
+    }
+
+    pthread_mutex_lock(&s_lock);
+    s_source_done = true;
+    pthread_mutex_unlock(&s_lock);
+    ESP_LOGI(TAG, "Recording finished: %u frames", s_stats.source_frames);
+    return NULL;
+}
+
+camera_fb_t *esp_camera_fb_get(void)
+{
+    pthread_mutex_lock(&s_lock);
+    int newest;
+    while (1) {
+        newest = -1;
+        for (uint32_t i = 0; i < s_config.fb_count; i++) {
+            if (s_state[i] == FB_READY &&
+                (newest < 0 || (int32_t)(s_ready_seq[i] - s_ready_seq[newest]) > 0)) {
+                newest = i;
+            }
+        }
+        if (newest >= 0) {
+            break;
+        }
+        // 录制结束后一直阻塞, 模拟没有新帧的传感器
+        pthread_cond_wait(&s_ready, &s_lock);
+    }
+    for (uint32_t i = 0; i < s_config.fb_count; i++) {
+        if (s_state[i] == FB_READY && (int)i != newest) {
+            s_state[i] = FB_FREE;
+            s_stats.sensor_dropped++;
+        }
+    }
+    s_state[newest] = FB_HELD;
+    s_stats.delivered++;
+    pthread_mutex_unlock(&s_lock);
+    return &s_fb[newest];
+}
+
+void esp_camera_fb_return(camera_fb_t *fb)
+{
+    pthread_mutex_lock(&s_lock);
+    s_state[fb - s_fb] = FB_FREE;
+    pthread_mutex_unlock(&s_lock);
+}
+
+bool sim_camera_finished(void)
+{
+    pthread_mutex_lock(&s_lock);
+    bool finished = s_source_done;
+    for (uint32_t i = 0; i < s_config.fb_count; i++) {
+        finished = finished && s_state[i] == FB_FREE;
+    }
+    pthread_mutex_unlock(&s_lock);
+    return finished;
+}
+
+void sim_camera_get_stats(sim_camera_stats_t *stats)
+{
+    pthread_mutex_lock(&s_lock);
+    *stats = s_stats;
+    pthread_mutex_unlock(&s_lock);
+}
+
+bool sim_camera_start(const sim_camera_config_t *config)
+{
+    s_config = *config;
+    if (s_config.fb_count == 0 || s_config.fb_count > SIM_CAMERA_MAX_FB) {
+        ESP_LOGE(TAG, "fb_count must be 1..%d", SIM_CAMERA_MAX_FB);
+        return false;
+    }
+    if (!load_frames() || !load_timestamps()) {
+        return false;
+    }
+    for (uint32_t i = 0; i < s_config.fb_count; i++) {
+        s_fb[i] = (camera_fb_t) {
+            // 与驱动在 PSRAM 中的帧缓冲一样按 GDMA 突发长度对齐
+            .buf = aligned_alloc(64, (s_frame_bytes + 63) & ~(size_t)63),
+            .len = s_frame_bytes,
+            .width = s_config.width,
+            .height = s_config.height,
+            .format = EXAMPLE_CAMERA_PIXFORMAT,
+        };
+        if (s_fb[i].buf == NULL) {
+            return false;
+        }
+    }
+    ESP_LOGI(TAG, "%u frames of %ux%u, %u frame buffers, speed x%.2f, %u loop(s)",
+             s_frame_count, s_config.width, s_config.height, s_config.fb_count,
+             s_config.speed, s_config.loops);
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, sensor_thread, NULL) != 0) {
+        return false;
+    }
+    pthread_detach(thread);
+    return true;
+}
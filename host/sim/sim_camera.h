@@ -0,0 +1,45 @@
+/*
+ * File-backed camera for the host pipeline simulation
+ * 主机端模拟: 按原始时间戳回放录制的帧, 代替 esp_camera 驱动
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct {
+    const char *frames_path;     // 连续的原始帧 (RGB565 或 YUYV, 每像素2字节)
+    const char *timestamps_path; // 每行一个采集时间戳(微秒), NULL 时按 fps
+    uint16_t width;
+    uint16_t height;
+    float fps;                   // 没有时间戳文件时的帧率
+    float speed;                 // 回放速度倍数
+    uint32_t loops;              // 重复次数
+    uint32_t fb_count;           // 驱动帧缓冲数 (EXAMPLE_CAMERA_FB_COUNT)
+} sim_camera_config_t;
+
+typedef struct {
+    uint32_t source_frames;  // 传感器输出的帧数
+    uint32_t delivered;      // 被 esp_camera_fb_get 取走的帧数
+    uint32_t sensor_dropped; // 没有空闲帧缓冲或被更新的帧覆盖 (GRAB_LATEST)
+    int64_t first_us;        // 第一帧/最后一帧的时间
+    int64_t last_us;
+} sim_camera_stats_t;
+
+// Load the recording and start the sensor thread.
+bool sim_camera_start(const sim_camera_config_t *config);
+
+// True once every frame was emitted and no buffer is ready or held.
+bool sim_camera_finished(void);
+
+void sim_camera_get_stats(sim_camera_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,266 @@
+/*
+ * SPI LCD sink for the host pipeline simulation
+ * 主机端模拟: LCD 接收端
+ *
+ * Follows what esp_lcd's SPI panel IO does: a command (tx_param, or
+ * tx_color with a command) first waits for every queued color transaction
+ * to finish and is then sent by polling; tx_color(-1) only queues its data
+ * and blocks while queue_depth transactions are in flight. CASET/RASET
+ * set the GRAM window, RAMWR moves the write pointer to its start, and
+ * every color transaction continues from where the previous one stopped.
+ *
+ * The bus thread holds each color transaction for bytes * 8 / pclk plus
+ * a fixed overhead, reads the caller's buffer only when the transfer
+ * ends (so reusing a buffer early shows up as corruption, as on the
+ * device), then runs on_color_trans_done.
+ *
+ * A refresh thread scans GRAM at the panel rate and writes it as a PPM
+ * whenever it changed, so tearing between scan and update is visible.
+ */
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_lcd_panel_commands.h"
+#include "sim_lcd.h"
+
+static const char *TAG = "sim_lcd";
+
+#define SIM_LCD_MAX_QUEUE 32
+
+typedef struct {
+    const uint8_t *data;
+    size_t bytes;
+} sim_lcd_trans_t;
+
+static sim_lcd_config_t s_config;
+static uint8_t *s_gram;          // 大端 RGB565, 与发送的字节顺序相同
+static bool s_gram_dirty;
+static int s_window[4];          // x0, y0, x1, y1 (不含 x1/y1)
+static int s_cursor_x, s_cursor_y;
+static sim_lcd_trans_t s_queue[SIM_LCD_MAX_QUEUE];
+static uint32_t s_head, s_count; // 排队中和发送中的颜色传输
+static sim_lcd_stats_t s_stats;
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_cond = PTHREAD_COND_INITIALIZER;
+
+static int64_t transfer_us(uint32_t bytes, uint32_t transactions)
+{
+    return (int64_t)bytes * 8 * 1000000 / s_config.pclk_hz + transactions * s_config.trans_overhead_us;
+}
+
+static void busy_until(int64_t when_us)
+{
+    int64_t now = esp_timer_get_time();
+    if (when_us > now) {
+        struct timespec ts = {
+            .tv_sec = (when_us - now) / 1000000,
+            .tv_nsec = (long)((when_us - now) % 1000000) * 1000,
+        };
+        nanosleep(&ts, NULL);
+    }
+}
+
+// 命令: 等所有已排队的颜色传输完成, 再以轮询方式发送命令和参数
+static void send_command(int cmd, const uint8_t *param, size_t len)
+{
+    pthread_mutex_lock(&s_lock);
+    while (s_count > 0) {
+        pthread_cond_wait(&s_cond, &s_lock);
+    }
+    pthread_mutex_unlock(&s_lock);
+
+    int64_t start = esp_timer_get_time();
+    busy_until(start + transfer_us(1 + len, len ? 2 : 1));
+
+    pthread_mutex_lock(&s_lock);
+    // 队列已空, 总线线程不会同时访问窗口
+    if ((cmd == LCD_CMD_CASET || cmd == LCD_CMD_RASET) && len == 4) {
+        int *range = &s_window[cmd == LCD_CMD_CASET ? 0 : 1];
+        range[0] = param[0] << 8 | param[1];
+        range[2] = (param[2] << 8 | param[3]) + 1;
+    } else if (cmd == LCD_CMD_RAMWR) {
+        s_cursor_x = s_window[0];
+        s_cursor_y = s_window[1];
+    }
+    s_stats.commands++;
+    s_stats.busy_us += esp_timer_get_time() - start;
+    pthread_mutex_unlock(&s_lock);
+}
+
+esp_err_t esp_lcd_panel_io_tx_param(esp_lcd_panel_io_handle_t io, int lcd_cmd, const void *param,
+                                    size_t param_size)
+{
+    send_command(lcd_cmd, param, param_size);
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_io_tx_color(esp_lcd_panel_io_handle_t io, int lcd_cmd, const void *color,
+                                    size_t color_size)
+{
+    if (color_size == 0 || color_size % 2 != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (lcd_cmd >= 0) {
+        send_command(lcd_cmd, NULL, 0);
+    }
+
+    // 队列满时等最早的一次传输完成
+    pthread_mutex_lock(&s_lock);
+    while (s_count >= s_config.queue_depth) {
+        pthread_cond_wait(&s_cond, &s_lock);
+    }
+    s_queue[(s_head + s_count) % SIM_LCD_MAX_QUEUE] = (sim_lcd_trans_t) {color, color_size};
+    s_count++;
+    pthread_cond_broadcast(&s_cond);
+    pthread_mutex_unlock(&s_lock);
+    return ESP_OK;
+}
+
+// 按窗口逐像素写入 GRAM, 写到窗口末尾后回到起点 (与面板相同)
+static void write_gram(const uint8_t *data, size_t bytes)
+{
+    for (size_t i = 0; i + 1 < bytes; i += 2) {
+        if (s_cursor_x >= 0 && s_cursor_x < s_config.width && s_cursor_y >= 0 && s_cursor_y < s_config.height) {
+            uint8_t *p = s_gram + ((size_t)s_cursor_y * s_config.width + s_cursor_x) * 2;
+            p[0] = data[i];
+            p[1] = data[i + 1];
+        }
+        if (++s_cursor_x >= s_window[2]) {
+            s_cursor_x = s_window[0];
+            if (++s_cursor_y >= s_window[3]) {
+                s_cursor_y = s_window[1];
+            }
+        }
+    }
+}
+
+static void *bus_thread(void *arg)
+{
+    while (1) {
+        pthread_mutex_lock(&s_lock);
+        while (s_count == 0) {
+            pthread_cond_wait(&s_cond, &s_lock);
+        }
+        sim_lcd_trans_t t = s_queue[s_head];
+        pthread_mutex_unlock(&s_lock);
+
+        int64_t start = esp_timer_get_time();
+        busy_until(start + transfer_us(t.bytes, 1));
+
+        pthread_mutex_lock(&s_lock);
+        write_gram(t.data, t.bytes);
+        s_gram_dirty = true;
+        s_stats.transactions++;
+        s_stats.bytes += t.bytes;
+        s_stats.last_done_us = esp_timer_get_time();
+        s_stats.busy_us += s_stats.last_done_us - start;
+        pthread_mutex_unlock(&s_lock);
+
+        // 回调先于释放队列位置, 与驱动中 ISR 的顺序一致
+        s_config.on_color_trans_done(NULL, NULL, NULL);
+
+        pthread_mutex_lock(&s_lock);
+        s_head = (s_head + 1) % SIM_LCD_MAX_QUEUE;
+        s_count--;
+        pthread_cond_broadcast(&s_cond);
+        pthread_mutex_unlock(&s_lock);
+    }
+    return NULL;
+}
+
+static void write_ppm(const uint8_t *gram, uint32_t index)
+{
+    char path[512];
+    snprintf(path, sizeof(path), "%s/frame_%05u.ppm", s_config.out_dir, index);
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        ESP_LOGE(TAG, "Cannot write %s", path);
+        return;
+    }
+    fprintf(f, "P6\n%u %u\n255\n", s_config.width, s_config.height);
+    for (size_t i = 0; i < (size_t)s_config.width * s_config.height; i++) {
+        uint16_t p = (uint16_t)(gram[i * 2] << 8 | gram[i * 2 + 1]);
+        uint8_t rgb[3] = {
+            (uint8_t)((p >> 11) * 255 / 31),
+            (uint8_t)(((p >> 5) & 0x3f) * 255 / 63),
+            (uint8_t)((p & 0x1f) * 255 / 31),
+        };
+        fwrite(rgb, 1, 3, f);
+    }
+    fclose(f);
+}
+
+static void *refresh_thread(void *arg)
+{
+    size_t gram_bytes = (size_t)s_config.width * s_config.height * 2;
+    uint8_t *scan = malloc(gram_bytes);
+    int64_t period = (int64_t)(1e6 / s_config.refresh_hz);
+    int64_t next = esp_timer_get_time();
+
+    while (scan) {
+        next += period;
+        busy_until(next);
+        pthread_mutex_lock(&s_lock);
+        bool dirty = s_gram_dirty;
+        if (dirty) {
+            memcpy(scan, s_gram, gram_bytes);
+            s_gram_dirty = false;
+        }
+        uint32_t index = dirty ? s_stats.frames_written++ : 0;
+        pthread_mutex_unlock(&s_lock);
+        if (dirty) {
+            write_ppm(scan, index);
+        }
+    }
+    return NULL;
+}
+
+bool sim_lcd_idle(void)
+{
+    pthread_mutex_lock(&s_lock);
+    bool idle = s_count == 0;
+    pthread_mutex_unlock(&s_lock);
+    return idle;
+}
+
+void sim_lcd_get_stats(sim_lcd_stats_t *stats)
+{
+    pthread_mutex_lock(&s_lock);
+    *stats = s_stats;
+    pthread_mutex_unlock(&s_lock);
+}
+
+bool sim_lcd_init(const sim_lcd_config_t *config, esp_lcd_panel_io_handle_t *io)
+{
+    s_config = *config;
+    s_gram = calloc((size_t)s_config.width * s_config.height, 2);
+    if (s_gram == NULL || s_config.pclk_hz == 0 || s_config.on_color_trans_done == NULL ||
+        s_config.queue_depth == 0 || s_config.queue_depth > SIM_LCD_MAX_QUEUE) {
+        return false;
+    }
+    s_window[2] = s_config.width;
+    s_window[3] = s_config.height;
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, bus_thread, NULL) != 0) {
+        return false;
+    }
+    pthread_detach(thread);
+    if (s_config.out_dir && s_config.refresh_hz > 0) {
+        if (pthread_create(&thread, NULL, refresh_thread, NULL) != 0) {
+            return false;
+        }
+        pthread_detach(thread);
+    }
+    ESP_LOGI(TAG, "%ux%u panel, SPI %.1f MHz, queue depth %u, full frame %.2f ms", s_config.width,
+             s_config.height, s_config.pclk_hz / 1e6, s_config.queue_depth,
+             transfer_us(s_config.width * s_config.height * 2, 1) / 1000.0);
+    // 只有一块面板, 句柄不需要指向实际对象
+    *io = (esp_lcd_panel_io_handle_t)&s_config;
+    return true;
+}
@@ -0,0 +1,46 @@
+/*
+ * SPI LCD sink for the host pipeline simulation
+ * 主机端模拟: 按 SPI 时钟建模面板 IO 的命令与颜色传输队列, 把屏幕内容写成图片
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_lcd_panel_io.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct {
+    uint16_t width;               // 面板 GRAM (EXAMPLE_PREVIEW_WIDTH x HEIGHT)
+    uint16_t height;
+    uint32_t pclk_hz;             // SPI 时钟
+    uint32_t trans_overhead_us;   // 每次 SPI 传输的固定开销 (驱动/DMA 设置)
+    uint32_t queue_depth;         // trans_queue_depth: 同时排队的颜色传输数
+    float refresh_hz;             // 面板扫描频率, 每次扫描时 GRAM 有变化则输出一帧
+    const char *out_dir;          // PPM 输出目录, NULL 不输出
+    esp_lcd_panel_io_color_trans_done_cb_t on_color_trans_done;
+} sim_lcd_config_t;
+
+typedef struct {
+    uint32_t transactions;  // 颜色传输
+    uint32_t commands;
+    uint64_t bytes;
+    int64_t busy_us;        // SPI 总线占用时间 (含命令)
+    int64_t last_done_us;   // 最后一次颜色传输完成的时间
+    uint32_t frames_written;
+} sim_lcd_stats_t;
+
+bool sim_lcd_init(const sim_lcd_config_t *config, esp_lcd_panel_io_handle_t *io);
+
+// True when no color transfer is queued or in flight.
+bool sim_lcd_idle(void);
+
+void sim_lcd_get_stats(sim_lcd_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,190 @@
+/*
+ * Host simulation of the camera -> LCD preview pipeline
+ * 摄像头到LCD预览流水线的主机端模拟
+ *
+ * Runs main/preview_pipeline.c unchanged on Linux: esp_camera_fb_get
+ * replays a raw recording at its original capture times (sim_camera.c),
+ * panel IO commands and color transactions cost what the SPI bus would
+ * at the given pixel clock (sim_lcd.c). Reports end-to-end FPS, capture -> panel
+ * latency and where frames were dropped.
+ *
+ * CPU stages (scaling, conversion) run at host speed, not ESP32-S3 speed,
+ * so the results show pacing and buffering effects, not absolute timing.
+ *
+ *   pipeline_sim --frames FILE WIDTHxHEIGHT [--timestamps FILE | --fps N]
+ *                [--speed X] [--loop N] [--pclk HZ] [--overhead US]
+ *                [--out DIR] [--refresh HZ] [--target-fps N] [--record FILE]
+ *
+ * --record: FILE stands in for the frame recorder partition
+ * (EXAMPLE_RECORDER_FPS > 0); decode it with frame_rec_decode.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "example_config.h"
+#include "esp_partition.h"
+#include "buffer_arena.h"
+#include "frame_recorder.h"
+#include "preview_pipeline.h"
+#include "sim_camera.h"
+#include "sim_lcd.h"
+
+static const char *TAG = "pipeline_sim";
+
+#define SIM_RECORD_PARTITION_BYTES (2 * 1024 * 1024) // 与 partitions.csv 相同
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr, "usage: %s --frames FILE WIDTHxHEIGHT [--timestamps FILE | --fps N] "
+            "[--speed X] [--loop N] [--pclk HZ] [--overhead US] [--out DIR] [--refresh HZ] "
+            "[--target-fps N] [--record FILE]\n", argv0);
+    exit(2);
+}
+
+static void log_stage(const char *name, preview_perf_stage_t stage)
+{
+    perf_summary_t sum;
+    if (preview_pipeline_perf_summary(stage, &sum) && sum.count > 0) {
+        printf("%-10s p50 %7.2f  p95 %7.2f  p99 %7.2f  max %7.2f ms\n", name,
+               sum.p50 / 1000.0, sum.p95 / 1000.0, sum.p99 / 1000.0, sum.max / 1000.0);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    sim_camera_config_t camera = {
+        .fps = 30,
+        .speed = 1,
+        .loops = 1,
+        .fb_count = EXAMPLE_CAMERA_FB_COUNT,
+    };
+    sim_lcd_config_t lcd = {
+        .width = EXAMPLE_PREVIEW_WIDTH,
+        .height = EXAMPLE_PREVIEW_HEIGHT,
+        .pclk_hz = EXAMPLE_LCD_PIXEL_CLOCK_HZ,
+        .trans_overhead_us = 10,
+        .queue_depth = EXAMPLE_LCD_TRANS_QUEUE_DEPTH,
+        .refresh_hz = 60,
+        .on_color_trans_done = preview_pipeline_color_trans_done,
+    };
+    unsigned w = 0, h = 0;
+    int target_fps = -1;
+    const char *record_path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--frames") && i + 2 < argc) {
+            camera.frames_path = argv[++i];
+            if (sscanf(argv[++i], "%ux%u", &w, &h) != 2 || !w || !h) {
+                usage(argv[0]);
+            }
+        } else if (!strcmp(argv[i], "--timestamps") && i + 1 < argc) {
+            camera.timestamps_path = argv[++i];
+        } else if (!strcmp(argv[i], "--fps") && i + 1 < argc) {
+            camera.fps = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--speed") && i + 1 < argc) {
+            camera.speed = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--loop") && i + 1 < argc) {
+            camera.loops = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--pclk") && i + 1 < argc) {
+            lcd.pclk_hz = strtoul(argv[++i], NULL, 0);
+        } else if (!strcmp(argv[i], "--overhead") && i + 1 < argc) {
+            lcd.trans_overhead_us = strtoul(argv[++i], NULL, 0);
+        } else if (!strcmp(argv[i], "--out") && i + 1 < argc) {
+            lcd.out_dir = argv[++i];
+        } else if (!strcmp(argv[i], "--refresh") && i + 1 < argc) {
+            lcd.refresh_hz = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--target-fps") && i + 1 < argc) {
+            target_fps = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--record") && i + 1 < argc) {
+            record_path = argv[++i];
+        } else {
+            usage(argv[0]);
+        }
+    }
+    if (camera.frames_path == NULL || camera.fps <= 0 || camera.speed <= 0 || camera.loops == 0) {
+        usage(argv[0]);
+    }
+    camera.width = w;
+    camera.height = h;
+
+    static buffer_arena_t arena;
+    esp_lcd_panel_io_handle_t io;
+    buffer_arena_init(&arena);
+    if (record_path && sim_partition_open(EXAMPLE_RECORDER_PARTITION, record_path, SIM_RECORD_PARTITION_BYTES) != ESP_OK) {
+        ESP_LOGE(TAG, "Cannot open %s", record_path);
+        return 1;
+    }
+#if EXAMPLE_RECORDER_FPS > 0
+    if (frame_recorder_reserve(&arena) != ESP_OK) {
+        return 1;
+    }
+#endif
+    if (preview_pipeline_reserve(&arena) != ESP_OK || buffer_arena_commit(&arena) != ESP_OK ||
+        preview_pipeline_init() != ESP_OK || !sim_lcd_init(&lcd, &io) ||
+        !sim_camera_start(&camera) || preview_pipeline_start(io) != ESP_OK) {
+        ESP_LOGE(TAG, "Simulation setup failed");
+        return 1;
+    }
+    if (target_fps >= 0) {
+        preview_pipeline_set_target_fps(target_fps);
+    }
+#if EXAMPLE_RECORDER_FPS > 0
+    frame_recorder_init();
+#endif
+
+    // 录制回放完毕, 且最后一帧已经发送到面板
+    int idle_polls = 0;
+    while (idle_polls < 5) {
+        usleep(10000);
+        idle_polls = sim_camera_finished() && sim_lcd_idle() ? idle_polls + 1 : 0;
+    }
+    if (lcd.out_dir) {
+        usleep((useconds_t)(2e6 / lcd.refresh_hz));
+    }
+
+    preview_pipeline_log_perf();
+
+    sim_camera_stats_t cam;
+    sim_lcd_stats_t bus;
+    preview_pipeline_tx_stats_t tx;
+    sim_camera_get_stats(&cam);
+    sim_lcd_get_stats(&bus);
+    preview_pipeline_get_tx_stats(&tx);
+
+    // 源: 第一帧到最后一帧再加一个平均帧间隔; 显示: 到最后一次传输完成
+    double source_s = cam.source_frames > 1 ?
+        (cam.last_us - cam.first_us) / 1e6 * cam.source_frames / (cam.source_frames - 1) : 0;
+    double run_s = (bus.last_done_us - cam.first_us) / 1e6;
+    uint32_t lost = cam.source_frames - tx.frames;
+    printf("\nsource      %u frames, %.1f fps\n", cam.source_frames,
+           source_s > 0 ? cam.source_frames / source_s : 0.0);
+    printf("displayed   %u frames, %.1f fps (%u static)\n", tx.frames,
+           run_s > 0 ? tx.frames / run_s : 0.0, tx.static_frames);
+    printf("idle        %u frames, scene static (not converted)\n", tx.idle_frames);
+    lost -= tx.idle_frames;
+    printf("dropped     %u (%.1f%%): sensor %u, corrupt %u, pipeline %u\n", lost,
+           100.0 * lost / cam.source_frames, cam.sensor_dropped, tx.corrupt_frames,
+           cam.delivered - tx.frames - tx.idle_frames - tx.corrupt_frames);
+    printf("SPI         %.2f MHz, %u transactions, %u commands, %.1f KB, bus busy %.1f%%\n",
+           lcd.pclk_hz / 1e6, bus.transactions, bus.commands, bus.bytes / 1024.0,
+           run_s > 0 ? 100.0 * bus.busy_us / (run_s * 1e6) : 0.0);
+    // 流水线自己由完成回调估计的总线占用, 与上面模拟的实际值对照
+    printf("submitter   busy %.1f%%, %u gaps with data waiting, %.2f ms total\n",
+           run_s > 0 ? 100.0 * tx.bus_busy_us / (run_s * 1e6) : 0.0, tx.bus_gaps, tx.bus_gap_us / 1000.0);
+    log_stage("latency", PREVIEW_PERF_LATENCY);
+    log_stage("frame", PREVIEW_PERF_FRAME);
+    if (lcd.out_dir) {
+        printf("output      %u frames in %s\n", bus.frames_written, lcd.out_dir);
+    }
+#if EXAMPLE_RECORDER_FPS > 0
+    frame_recorder_stats_t rec;
+    frame_recorder_get_stats(&rec);
+    printf("recorder    %u frames, %.1f%% of raw, %u skipped, %u failed, %u sectors erased, %u wraps\n",
+           rec.frames, rec.raw_bytes ? 100.0 * rec.stored_bytes / rec.raw_bytes : 0.0,
+           rec.skipped, rec.failed, rec.erases, rec.wraps);
+#endif
+    return 0;
+}
@@ -0,0 +1,86 @@
+/*
+ * Flash partition for the host pipeline simulation
+ * 主机端模拟: 文件代替 flash 分区
+ *
+ * Erase and write cost what they would on the device, so the recorder
+ * falls behind and skips frames the same way.
+ */
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "esp_partition.h"
+
+#define SIM_SECTOR_BYTES 4096
+#define SIM_ERASE_US 45000   // 4KB 扇区擦除的典型时间
+#define SIM_PAGE_WRITE_US 700 // 256 字节页编程
+
+static esp_partition_t s_partition;
+static uint8_t *s_data;
+static int s_fd = -1;
+
+esp_err_t sim_partition_open(const char *label, const char *path, uint32_t size)
+{
+    s_fd = open(path, O_RDWR | O_CREAT, 0644);
+    s_data = malloc(size);
+    if (s_fd < 0 || s_data == NULL) {
+        return ESP_FAIL;
+    }
+    // 文件比分区短的部分视为已擦除
+    memset(s_data, 0xFF, size);
+    ssize_t n = pread(s_fd, s_data, size, 0);
+    if (n < (ssize_t)size && pwrite(s_fd, s_data, size, 0) != (ssize_t)size) {
+        return ESP_FAIL;
+    }
+    s_partition = (esp_partition_t) {
+        .type = ESP_PARTITION_TYPE_DATA,
+        .subtype = ESP_PARTITION_SUBTYPE_ANY,
+        .size = size,
+        .erase_size = SIM_SECTOR_BYTES,
+    };
+    snprintf(s_partition.label, sizeof(s_partition.label), "%s", label);
+    return ESP_OK;
+}
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char *label)
+{
+    if (s_data == NULL || type != s_partition.type || (label && strcmp(label, s_partition.label))) {
+        return NULL;
+    }
+    return &s_partition;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset, void *dst, size_t size)
+{
+    if (src_offset > partition->size || size > partition->size - src_offset) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(dst, s_data + src_offset, size);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *partition, size_t dst_offset, const void *src, size_t size)
+{
+    if (dst_offset > partition->size || size > partition->size - dst_offset) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    const uint8_t *p = src;
+    for (size_t i = 0; i < size; i++) {
+        s_data[dst_offset + i] &= p[i];
+    }
+    usleep((useconds_t)((size + 255) / 256 * SIM_PAGE_WRITE_US));
+    return pwrite(s_fd, s_data + dst_offset, size, dst_offset) == (ssize_t)size ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t offset, size_t size)
+{
+    if (offset % partition->erase_size || size % partition->erase_size ||
+        offset > partition->size || size > partition->size - offset) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(s_data + offset, 0xFF, size);
+    usleep((useconds_t)(size / SIM_SECTOR_BYTES * SIM_ERASE_US));
+    return pwrite(s_fd, s_data + offset, size, offset) == (ssize_t)size ? ESP_OK : ESP_FAIL;
+}
@@ -0,0 +1,151 @@
+/*
+ * Host simulation of the LCD SPI clock calibration
+ * LCD SPI 时钟校准的主机端模拟
+ *
+ * Runs main/spi_clock_tune.c against a simulated ST7735S: one row of
+ * frame memory, written at the clock under test, read back as RGB666
+ * (RAMRD) after a few dummy bits. Above --fail-above every written bit
+ * flips with probability --ber, so the search should settle one margin
+ * step below the threshold.
+ *
+ *   spi_clock_sim [--fail-above HZ] [--ber P] [--dummy-bits N] [--bgr]
+ *                 [--no-miso] [--min HZ] [--max HZ] [--rounds N]
+ *                 [--margin N] [--seed N]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "example_config.h"
+#include "spi_clock_tune.h"
+
+typedef struct {
+    uint32_t fail_above_hz;
+    double ber;             // 超过阈值时每一位出错的概率
+    uint32_t dummy_bits;
+    bool bgr;
+    bool no_miso;           // MISO 未连接: 读到的全是 1
+    uint16_t gram[SPI_CLOCK_TUNE_MAX_PIXELS];
+    uint32_t writes;
+} sim_panel_t;
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr, "usage: %s [--fail-above HZ] [--ber P] [--dummy-bits N] [--bgr] [--no-miso] "
+            "[--min HZ] [--max HZ] [--rounds N] [--margin N] [--seed N]\n", argv0);
+    exit(2);
+}
+
+static void put_bits(uint8_t *raw, uint32_t bit, uint8_t value)
+{
+    for (int i = 7; i >= 0; i--, bit++) {
+        if (value >> i & 1) {
+            raw[bit / 8] |= 0x80 >> (bit % 8);
+        }
+    }
+}
+
+// 面板内部把 RGB565 扩展为 RGB666, 回读时每个分量左对齐, 低两位不确定
+static uint8_t expand(uint8_t value, int bits)
+{
+    uint8_t v6 = bits == 5 ? (uint8_t)(value << 1 | value >> 4) : value;
+    return (uint8_t)(v6 << 2 | (rand() & 3));
+}
+
+static int sim_write_read(void *ctx, uint32_t hz, const uint16_t *pixels, size_t count,
+                          uint8_t *raw, size_t raw_len)
+{
+    sim_panel_t *panel = ctx;
+
+    panel->writes++;
+    for (size_t i = 0; i < count; i++) {
+        uint16_t p = pixels[i];
+        if (hz > panel->fail_above_hz) {
+            for (int b = 0; b < 16; b++) {
+                if (rand() < panel->ber * ((double)RAND_MAX + 1)) {
+                    p ^= (uint16_t)(1u << b);
+                }
+            }
+        }
+        panel->gram[i] = p;
+    }
+
+    memset(raw, panel->no_miso ? 0xff : 0, raw_len);
+    if (panel->no_miso) {
+        return 0;
+    }
+    for (size_t i = 0; i < count; i++) {
+        uint16_t p = panel->gram[i];
+        uint8_t r = expand(p >> 11, 5), g = expand((p >> 5) & 0x3f, 6), b = expand(p & 0x1f, 5);
+        uint32_t bit = panel->dummy_bits + (uint32_t)i * 24;
+        put_bits(raw, bit, panel->bgr ? b : r);
+        put_bits(raw, bit + 8, g);
+        put_bits(raw, bit + 16, panel->bgr ? r : b);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    sim_panel_t panel = {
+        .fail_above_hz = 27 * 1000 * 1000,
+        .ber = 0.002,
+        .dummy_bits = 1,
+    };
+    spi_clock_tune_config_t config = {
+        .source_hz = 80 * 1000 * 1000,
+        .min_hz = EXAMPLE_LCD_PIXEL_CLOCK_HZ,
+        .max_hz = EXAMPLE_LCD_CLOCK_TUNE_MAX_HZ,
+        .pixels = ST7735S_LCD_H_RES,
+        .rounds = EXAMPLE_LCD_CLOCK_TUNE_ROUNDS,
+        .margin_steps = EXAMPLE_LCD_CLOCK_TUNE_MARGIN,
+    };
+    unsigned seed = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--fail-above") && i + 1 < argc) {
+            panel.fail_above_hz = strtoul(argv[++i], NULL, 0);
+        } else if (!strcmp(argv[i], "--ber") && i + 1 < argc) {
+            panel.ber = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--dummy-bits") && i + 1 < argc) {
+            panel.dummy_bits = strtoul(argv[++i], NULL, 0);
+        } else if (!strcmp(argv[i], "--bgr")) {
+            panel.bgr = true;
+        } else if (!strcmp(argv[i], "--no-miso")) {
+            panel.no_miso = true;
+        } else if (!strcmp(argv[i], "--min") && i + 1 < argc) {
+            config.min_hz = strtoul(argv[++i], NULL, 0);
+        } else if (!strcmp(argv[i], "--max") && i + 1 < argc) {
+            config.max_hz = strtoul(argv[++i], NULL, 0);
+        } else if (!strcmp(argv[i], "--rounds") && i + 1 < argc) {
+            config.rounds = strtoul(argv[++i], NULL, 0);
+        } else if (!strcmp(argv[i], "--margin") && i + 1 < argc) {
+            config.margin_steps = strtoul(argv[++i], NULL, 0);
+        } else if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+            seed = strtoul(argv[++i], NULL, 0);
+        } else {
+            usage(argv[0]);
+        }
+    }
+    if (panel.dummy_bits > SPI_CLOCK_TUNE_MAX_DUMMY_BITS) {
+        usage(argv[0]);
+    }
+    srand(seed);
+
+    spi_clock_panel_t bus = {.write_read = sim_write_read, .ctx = &panel};
+    spi_clock_tune_result_t result;
+    bool ok = spi_clock_tune_run(&config, &bus, &result);
+
+    for (size_t i = 0; i < result.step_count; i++) {
+        printf("%7.2f MHz  %-4s %u bad pixels\n", result.steps[i].hz / 1e6,
+               result.steps[i].errors ? "fail" : "ok", result.steps[i].errors);
+    }
+    if (!ok) {
+        printf("readback failed at %.2f MHz, keep the default\n", config.min_hz / 1e6);
+        return 1;
+    }
+    printf("chosen      %.2f MHz (fastest verified %.2f MHz, first failure %.2f MHz)\n",
+           result.chosen_hz / 1e6, result.fastest_pass_hz / 1e6, result.first_fail_hz / 1e6);
+    printf("readback    %u dummy bits, %s, %u row writes\n", result.dummy_bits,
+           result.swap_rb ? "BGR" : "RGB", panel.writes);
+    return 0;
+}
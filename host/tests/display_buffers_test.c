@@ -0,0 +1,172 @@
+/*
+ * LCD buffer hand-off against a fake panel IO
+ * LCD多缓冲区交接: 用模拟的SPI队列按提交顺序完成传输
+ *
+ * The fake panel queues one entry per color transaction with the buffer
+ * it reads and completes them in order, calling
+ * display_buffers_on_trans_done like the real callback. A buffer handed
+ * out by acquire must never still have a transaction in that queue.
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "display_buffers.h"
+#include "test_check.h"
+
+#define QUEUE_MAX 64
+#define BUFFER_COUNT 3
+
+typedef struct {
+    const void *reads[QUEUE_MAX]; // 每个排队的传输读取的内存
+    uint32_t head;
+    uint32_t count;
+} fake_panel_t;
+
+static display_buffers_t s_db;
+static fake_panel_t s_panel;
+static uint8_t s_memory[BUFFER_COUNT][16];
+static uint8_t s_outside[16]; // 不在缓冲区组里的内存 (如摄像头帧)
+
+static void panel_queue(const void *buffer, uint32_t transactions)
+{
+    for (uint32_t i = 0; i < transactions && s_panel.count < QUEUE_MAX; i++, s_panel.count++) {
+        s_panel.reads[(s_panel.head + s_panel.count) % QUEUE_MAX] = buffer;
+    }
+}
+
+static void panel_complete(uint32_t transactions)
+{
+    for (uint32_t i = 0; i < transactions && s_panel.count > 0; i++, s_panel.count--) {
+        s_panel.head = (s_panel.head + 1) % QUEUE_MAX;
+        display_buffers_on_trans_done(&s_db);
+    }
+}
+
+static bool panel_reading(const void *buffer)
+{
+    for (uint32_t i = 0; i < s_panel.count; i++) {
+        if (s_panel.reads[(s_panel.head + i) % QUEUE_MAX] == buffer) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void reset(uint32_t start_count)
+{
+    void *buffers[BUFFER_COUNT] = {s_memory[0], s_memory[1], s_memory[2]};
+    display_buffers_init(&s_db, buffers, BUFFER_COUNT);
+    // 计数器从任意值开始, 用于检查回绕
+    s_db.submitted = start_count;
+    atomic_store(&s_db.completed, start_count);
+    for (uint32_t i = 0; i < BUFFER_COUNT; i++) {
+        atomic_store(&s_db.release_at[i], start_count);
+    }
+    memset(&s_panel, 0, sizeof(s_panel));
+}
+
+static void submit(void *buffer, uint32_t transactions)
+{
+    display_buffers_submit(&s_db, buffer, transactions);
+    panel_queue(buffer, transactions);
+}
+
+static void test_sequence(uint32_t start_count)
+{
+    reset(start_count);
+    void *a = display_buffers_acquire(&s_db);
+    void *b = display_buffers_acquire(&s_db);
+    void *c = display_buffers_acquire(&s_db);
+    CHECK(a && b && c && a != b && b != c && a != c, "three distinct buffers (start %u)", start_count);
+    CHECK(display_buffers_acquire(&s_db) == NULL, "all owned, none left (start %u)", start_count);
+    CHECK(display_buffers_free_count(&s_db) == 0, "free count 0 (start %u)", start_count);
+
+    // 提交后在传输完成前不可再获取
+    submit(a, 3);
+    CHECK(display_buffers_acquire(&s_db) == NULL, "a still being sent (start %u)", start_count);
+    CHECK(!display_buffers_idle(&s_db), "not idle with 3 queued (start %u)", start_count);
+    panel_complete(2);
+    CHECK(display_buffers_acquire(&s_db) == NULL, "a has 1 transaction left (start %u)", start_count);
+    panel_complete(1);
+    CHECK(display_buffers_idle(&s_db), "idle after the last completion (start %u)", start_count);
+    CHECK(display_buffers_acquire(&s_db) == a, "a free again (start %u)", start_count);
+
+    // 丢弃的帧直接归还
+    display_buffers_release(&s_db, b);
+    CHECK(display_buffers_acquire(&s_db) == b, "released b comes back (start %u)", start_count);
+
+    // 排队失败: 只发出了1个传输, 其余撤销
+    display_buffers_submit(&s_db, c, 4);
+    panel_queue(c, 1);
+    display_buffers_cancel(&s_db, c, 3);
+    CHECK(display_buffers_acquire(&s_db) == NULL, "c waits for its issued transaction (start %u)", start_count);
+    panel_complete(1);
+    CHECK(display_buffers_idle(&s_db), "idle after cancel + completion (start %u)", start_count);
+    CHECK(display_buffers_acquire(&s_db) == c, "c free after its issued transaction (start %u)", start_count);
+
+    // 原地发送 (NULL) 与组外内存: 只计数, 用 mark 判断何时发完
+    submit(NULL, 2);
+    submit(s_outside, 2);
+    uint32_t mark = display_buffers_mark(&s_db);
+    CHECK(!display_buffers_reached(&s_db, mark), "in-place data still queued (start %u)", start_count);
+    panel_complete(3);
+    CHECK(!display_buffers_reached(&s_db, mark), "one in-place transaction left (start %u)", start_count);
+    panel_complete(1);
+    CHECK(display_buffers_reached(&s_db, mark), "in-place data sent (start %u)", start_count);
+    CHECK(display_buffers_idle(&s_db), "idle after in-place and outside submits (start %u)", start_count);
+}
+
+// 随机的获取/提交/丢弃/完成顺序, 与模拟队列对照
+static void test_random(uint32_t start_count)
+{
+    reset(start_count);
+    void *owned[BUFFER_COUNT];
+    uint32_t n_owned = 0;
+
+    for (int step = 0; step < 200000; step++) {
+        int op = rand() % 4;
+        if (op == 0) {
+            void *buf = display_buffers_acquire(&s_db);
+            if (buf != NULL) {
+                CHECK(!panel_reading(buf), "acquired a buffer still queued (step %d)", step);
+                owned[n_owned++] = buf;
+            }
+        } else if (op == 1 && n_owned > 0) {
+            uint32_t i = rand() % n_owned;
+            uint32_t transactions = 1 + rand() % 4;
+            if (s_panel.count + transactions > QUEUE_MAX) {
+                continue;
+            }
+            if (rand() % 8 == 0) {
+                display_buffers_release(&s_db, owned[i]);
+            } else {
+                submit(owned[i], transactions);
+            }
+            owned[i] = owned[--n_owned];
+        } else if (op == 2 && s_panel.count + 2 <= QUEUE_MAX && rand() % 4 == 0) {
+            submit(NULL, 2);
+        } else {
+            panel_complete(rand() % 3);
+        }
+        if (step % 1000 == 0) {
+            CHECK(display_buffers_idle(&s_db) == (s_panel.count == 0), "idle disagrees with the queue (step %d)",
+                  step);
+        }
+    }
+    panel_complete(QUEUE_MAX);
+    CHECK(display_buffers_idle(&s_db), "idle once the queue drained (start %u)", start_count);
+    CHECK(display_buffers_free_count(&s_db) == BUFFER_COUNT - n_owned, "free count after drain (start %u)",
+          start_count);
+}
+
+int main(void)
+{
+    srand(1);
+    // 0, 以及计数器在序列中途回绕
+    const uint32_t starts[] = {0, UINT32_MAX - 4, UINT32_MAX};
+    for (size_t i = 0; i < sizeof(starts) / sizeof(starts[0]); i++) {
+        test_sequence(starts[i]);
+        test_random(starts[i]);
+    }
+    return test_report("display_buffers_test");
+}
@@ -0,0 +1,118 @@
+/*
+ * frame_check on static high-contrast scenes and on torn frames
+ * 帧损坏检测: 静止的高反差画面不误判, 撕裂和重复帧照常检出
+ *
+ * Black and saturated pixels carry no sensor noise, so the rows of a
+ * static black-and-white scene repeat bit for bit from frame to frame.
+ * With a small object moving over it every frame must still pass. Noisy
+ * mid-tone frames must pass as they are, and be caught when their bottom
+ * rows are left over from an earlier frame or the whole frame repeats.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "frame_check.h"
+#include "rgb565.h"
+#include "test_check.h"
+
+#define W 320
+#define H 240
+#define FRAME_BYTES (W * H * 2)
+
+static uint8_t s_frame[FRAME_BYTES];
+static uint8_t s_prev[FRAME_BYTES];
+
+static void put(uint32_t x, uint32_t y, uint16_t cpu)
+{
+    uint16_t be = rgb565_swap(cpu);
+    memcpy(s_frame + (y * W + x) * 2, &be, 2);
+}
+
+// 8x8 的黑白块, 每帧相同
+static void draw_static_scene(void)
+{
+    srand(3);
+    for (uint32_t by = 0; by < H; by += 8) {
+        for (uint32_t bx = 0; bx < W; bx += 8) {
+            uint16_t v = rand() & 1 ? 0xFFFF : 0x0000;
+            for (uint32_t y = by; y < by + 8; y++) {
+                for (uint32_t x = bx; x < bx + 8; x++) {
+                    put(x, y, v);
+                }
+            }
+        }
+    }
+}
+
+// 带噪声的中间调纹理
+static void draw_noisy(uint32_t x0, uint32_t y0, uint32_t w, uint32_t h, uint32_t seed)
+{
+    for (uint32_t y = y0; y < y0 + h; y++) {
+        for (uint32_t x = x0; x < x0 + w; x++) {
+            uint32_t base = 16 + (x * 7 + y * 3) % 32;
+            uint32_t noise = (uint32_t)rand() % 3;
+            put(x, y, rgb565_pack((base + noise) / 2, base + noise + seed % 2, (base + noise) / 2));
+        }
+    }
+}
+
+static void test_static_high_contrast(void)
+{
+    static frame_check_t check;
+    frame_check_config_t config = FRAME_CHECK_CONFIG_DEFAULT();
+    frame_check_init(&check, &config);
+
+    uint32_t flagged = 0;
+    frame_check_result_t first = {0};
+    for (uint32_t n = 0; n < 30; n++) {
+        draw_static_scene();
+        // 一个物体在上半部分横向移动, 其余的行与上一帧逐位相同
+        draw_noisy(n * 8, 40, 48, 32, n);
+        frame_check_result_t r;
+        if (frame_check_run(&check, s_frame, FRAME_BYTES, W, H, false, &r) != FRAME_CHECK_OK && flagged++ == 0) {
+            first = r;
+        }
+    }
+    CHECK(flagged == 0, "%u of 30 static high-contrast frames flagged, first %s from row %d (%u active, %u stale)",
+          flagged, frame_check_class_name(first.verdict), first.first_bad_row, first.active_rows, first.stale_rows);
+
+    // 整帧静止且全是截断的像素: 没有可比较的行, 不报重复
+    draw_static_scene();
+    CHECK(frame_check_run(&check, s_frame, FRAME_BYTES, W, H, false, NULL) == FRAME_CHECK_OK, "%s",
+          "static clipped frame flagged");
+}
+
+static void test_noisy_frames(void)
+{
+    static frame_check_t check;
+    frame_check_config_t config = FRAME_CHECK_CONFIG_DEFAULT();
+    frame_check_init(&check, &config);
+
+    srand(5);
+    for (uint32_t n = 0; n < 4; n++) {
+        draw_noisy(0, 0, W, H, n);
+        CHECK(frame_check_run(&check, s_frame, FRAME_BYTES, W, H, false, NULL) == FRAME_CHECK_OK,
+              "noisy frame %u flagged", n);
+        memcpy(s_prev, s_frame, FRAME_BYTES);
+    }
+
+    // 下半部分还是上一帧: 撕裂
+    draw_noisy(0, 0, W, H, 4);
+    memcpy(s_frame + FRAME_BYTES / 2, s_prev + FRAME_BYTES / 2, FRAME_BYTES / 2);
+    frame_check_result_t r;
+    CHECK(frame_check_run(&check, s_frame, FRAME_BYTES, W, H, false, &r) == FRAME_CHECK_STALE,
+          "torn frame: %s", frame_check_class_name(r.verdict));
+    CHECK(r.first_bad_row >= H / 2 && r.first_bad_row < H / 2 + 8, "torn frame: first bad row %d",
+          r.first_bad_row);
+
+    // 整帧重复
+    memcpy(s_frame, s_prev, FRAME_BYTES);
+    CHECK(frame_check_run(&check, s_frame, FRAME_BYTES, W, H, false, &r) == FRAME_CHECK_DUPLICATE,
+          "repeated frame: %s", frame_check_class_name(r.verdict));
+}
+
+int main(void)
+{
+    test_static_high_contrast();
+    test_noisy_frames();
+    return test_report("frame_check_test");
+}
@@ -0,0 +1,183 @@
+/*
+ * Frame record headers and resuming the recorder ring
+ * 录制帧: 记录头校验, 以及重启后在环形区里找到接着写的位置
+ *
+ * CRC-32 is checked against the standard check value; a sealed header
+ * must fail validation after any single bit flip or when its payload does
+ * not fit the space left. frame_recorder.c is included directly so that
+ * its static ring_resume() runs against partition layouts written into
+ * sim_partition: blank, a chain across sectors, a wrapped ring with older
+ * records left behind the newest one, a record cut short before its
+ * header was written, a corrupted header, and a chain continued in the
+ * next sector after a failed write.
+ */
+#include <string.h>
+#include <unistd.h>
+#include "test_check.h"
+#include "../../main/frame_recorder.c"
+
+#define PART_SECTORS 4
+#define PART_FILE "frame_record_test.bin"
+
+static uint8_t s_payload[8192];
+
+static void test_crc(void)
+{
+    CHECK(frame_record_crc32(0, "123456789", 9) == 0xCBF43926, "crc32 check value %08x",
+          frame_record_crc32(0, "123456789", 9));
+    CHECK(frame_record_crc32(frame_record_crc32(0, "1234", 4), "56789", 5) == 0xCBF43926, "%s",
+          "crc32 not continued across calls");
+    CHECK(frame_record_crc32(0, NULL, 0) == 0, "%s", "crc32 of nothing");
+}
+
+static frame_record_header_t make_header(uint32_t seq, uint32_t payload_bytes)
+{
+    frame_record_header_t header = {
+        .seq = seq,
+        .time_ms = seq * 250,
+        .width = 128,
+        .height = 160,
+        .format = FRAME_RECORD_FORMAT_RGB565_CODEC,
+        .payload_bytes = payload_bytes,
+        .payload_crc = frame_record_crc32(0, s_payload, payload_bytes),
+    };
+    frame_record_seal(&header);
+    return header;
+}
+
+static void test_header(void)
+{
+    frame_record_header_t header = make_header(7, 1000);
+    size_t fits = sizeof(header) + 1000;
+
+    CHECK(frame_record_valid(&header, fits), "%s", "sealed header rejected");
+    CHECK(!frame_record_valid(&header, fits - 1), "%s", "payload past the end of the space accepted");
+    CHECK(!frame_record_valid(&header, sizeof(header) - 1), "%s", "header larger than the space accepted");
+    CHECK(frame_record_size(&header) == (sizeof(header) + 1000 + 3) / 4 * 4, "record size %zu",
+          frame_record_size(&header));
+
+    for (size_t bit = 0; bit < sizeof(header) * 8; bit++) {
+        frame_record_header_t flipped = header;
+        ((uint8_t *)&flipped)[bit / 8] ^= (uint8_t)(1u << bit % 8);
+        CHECK(!frame_record_valid(&flipped, 1 << 20), "header with bit %zu flipped accepted", bit);
+    }
+
+    // 超大的 payload_bytes 不能让 space - header 回绕
+    header.payload_bytes = 0xFFFFFFF0u;
+    frame_record_seal(&header);
+    CHECK(!frame_record_valid(&header, fits), "%s", "huge payload accepted");
+}
+
+// 空白分区, 录制任务的状态回到开机时
+static void ring_reset(void)
+{
+    CHECK(esp_partition_erase_range(s_part, 0, s_part->size) == ESP_OK, "%s", "erase failed");
+    s_seq = 0;
+    s_head = s_erased_to = 0;
+}
+
+// 与 record_snapshot 相同: 先写数据, 后写头 (header = false 时只有数据, 像复位时没写完)
+static uint32_t put_record(uint32_t offset, uint32_t seq, uint32_t payload_bytes, bool header)
+{
+    frame_record_header_t h = make_header(seq, payload_bytes);
+
+    CHECK(esp_partition_write(s_part, offset + sizeof(h), s_payload, payload_bytes) == ESP_OK,
+          "payload of #%u at 0x%x", seq, offset);
+    if (header) {
+        CHECK(esp_partition_write(s_part, offset, &h, sizeof(h)) == ESP_OK, "header of #%u at 0x%x", seq, offset);
+    }
+    return offset + frame_record_size(&h);
+}
+
+static void expect_resume(const char *name, uint32_t seq, uint32_t head)
+{
+    ring_resume();
+    CHECK(s_seq == seq && s_head == head && s_erased_to == head, "%s: resumed at #%u 0x%x (erased to 0x%x), want #%u 0x%x",
+          name, s_seq, s_head, s_erased_to, seq, head);
+}
+
+static void test_resume(void)
+{
+    const uint32_t sector = s_part->erase_size;
+    uint32_t end;
+
+    ring_reset();
+    expect_resume("blank", 0, 0);
+
+    // 跨扇区的记录链, 长度不是 4 的倍数
+    ring_reset();
+    end = 0;
+    for (uint32_t seq = 0; seq < 5; seq++) {
+        end = put_record(end, seq, 1001 + seq * 3, true);
+    }
+    expect_resume("chain", 5, align_sector(end));
+
+    // 回绕: 上一轮的 #20.. 占满分区 (每条正好 1 KB, 扇区开头都有旧记录),
+    // 新的一轮擦了前两个扇区, 写到第二个扇区中间
+    ring_reset();
+    end = 0;
+    for (uint32_t seq = 20; end + 1024 <= s_part->size; seq++) {
+        end = put_record(end, seq, 1024 - sizeof(frame_record_header_t), true);
+    }
+    CHECK(esp_partition_erase_range(s_part, 0, 2 * sector) == ESP_OK, "%s", "erase failed");
+    end = 0;
+    for (uint32_t seq = 40; seq < 45; seq++) {
+        end = put_record(end, seq, 1200, true);
+    }
+    expect_resume("wrapped, old record at the sector start", 45, 2 * sector);
+
+    // 同样回绕, 旧记录跨过扇区边界
+    ring_reset();
+    end = 0;
+    for (uint32_t seq = 20; end + 1500 <= s_part->size; seq++) {
+        end = put_record(end, seq, 1500 - sizeof(frame_record_header_t) - 1, true);
+    }
+    CHECK(esp_partition_erase_range(s_part, 0, sector) == ESP_OK, "%s", "erase failed");
+    end = put_record(0, 40, 2000, true);
+    expect_resume("wrapped, old record across the sector start", 41, sector);
+
+    // 复位时最后一条只写了数据, 没有头
+    ring_reset();
+    end = put_record(0, 0, 900, true);
+    end = put_record(end, 1, 900, true);
+    put_record(end, 2, 3000, false);
+    expect_resume("cut short", 2, align_sector(end));
+
+    // 记录头损坏
+    ring_reset();
+    end = put_record(0, 0, 900, true);
+    uint32_t bad = end;
+    end = put_record(end, 1, 900, true);
+    uint8_t zero = 0;
+    CHECK(esp_partition_write(s_part, bad + offsetof(frame_record_header_t, payload_bytes), &zero, 1) == ESP_OK,
+          "%s", "corrupt failed");
+    put_record(end, 2, 900, true);
+    expect_resume("corrupted header", 1, align_sector(bad));
+
+    // 写入失败后从下一个扇区接着写
+    ring_reset();
+    end = put_record(0, 0, 900, true);
+    end = put_record(end, 1, 900, true);
+    end = put_record(sector, 2, 5000, true);
+    end = put_record(end, 3, 100, true);
+    expect_resume("continued after a failed write", 4, align_sector(end));
+}
+
+int main(void)
+{
+    for (size_t i = 0; i < sizeof(s_payload); i++) {
+        s_payload[i] = (uint8_t)(i * 31 + 7);
+    }
+    test_crc();
+    test_header();
+
+    unlink(PART_FILE);
+    if (sim_partition_open(EXAMPLE_RECORDER_PARTITION, PART_FILE, PART_SECTORS * 4096) != ESP_OK) {
+        fprintf(stderr, "cannot open %s\n", PART_FILE);
+        return 1;
+    }
+    s_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, EXAMPLE_RECORDER_PARTITION);
+    test_resume();
+    unlink(PART_FILE);
+    return test_report("frame_record_test");
+}
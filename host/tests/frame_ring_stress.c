@@ -0,0 +1,124 @@
+/*
+ * Two-thread stress test of the frame ring
+ * 帧队列的双线程压力测试: 每帧恰好出来一次 (取出或作为丢弃的最旧帧), 且保持顺序
+ *
+ * The producer pushes sequence numbers as frame pointers and keeps the
+ * ones handed back through *dropped; the consumer pops with random pauses
+ * so the ring keeps running full. Afterwards every number must have come
+ * out exactly once, and each side must have seen its numbers in order.
+ */
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "frame_ring.h"
+#include "test_check.h"
+
+#define FRAMES 1000000u
+
+static frame_ring_t s_ring;
+static uint8_t s_popped[FRAMES + 1];
+static uint8_t s_dropped[FRAMES + 1];
+static atomic_bool s_done;
+static uint32_t s_pop_order_errors;
+static uint32_t s_drop_order_errors;
+static uint32_t s_drops;
+
+static void *producer(void *arg)
+{
+    uint32_t last = 0;
+    (void)arg;
+    for (uint32_t i = 1; i <= FRAMES; i++) {
+        void *dropped;
+        frame_ring_push(&s_ring, (void *)(uintptr_t)i, &dropped);
+        if (dropped != NULL) {
+            uint32_t n = (uint32_t)(uintptr_t)dropped;
+            s_drop_order_errors += n <= last;
+            last = n;
+            s_drops++;
+            if (n <= FRAMES) {
+                s_dropped[n]++;
+            }
+        }
+        if ((i & 15) == 0) {
+            sched_yield();
+        }
+    }
+    atomic_store(&s_done, true);
+    return NULL;
+}
+
+static void consume(uint32_t *last, void *item)
+{
+    uint32_t n = (uint32_t)(uintptr_t)item;
+    s_pop_order_errors += n <= *last;
+    *last = n;
+    if (n <= FRAMES) {
+        s_popped[n]++;
+    }
+}
+
+static void *consumer(void *arg)
+{
+    uint32_t last = 0, seed = 7;
+    void *item;
+    (void)arg;
+    while (!atomic_load(&s_done)) {
+        if (frame_ring_pop(&s_ring, &item)) {
+            consume(&last, item);
+        }
+        // 时快时慢, 让生产者经常遇到满队列
+        seed = seed * 1103515245u + 12345u;
+        if ((seed >> 16) % 64 == 0) {
+            sched_yield();
+        }
+    }
+    while (frame_ring_pop(&s_ring, &item)) {
+        consume(&last, item);
+    }
+    return NULL;
+}
+
+static void run(uint32_t capacity)
+{
+    memset(s_popped, 0, sizeof(s_popped));
+    memset(s_dropped, 0, sizeof(s_dropped));
+    s_pop_order_errors = s_drop_order_errors = s_drops = 0;
+    atomic_store(&s_done, false);
+    CHECK(frame_ring_init(&s_ring, capacity), "capacity %u rejected", capacity);
+
+    pthread_t p, c;
+    pthread_create(&c, NULL, consumer, NULL);
+    pthread_create(&p, NULL, producer, NULL);
+    pthread_join(p, NULL);
+    pthread_join(c, NULL);
+
+    uint32_t missing = 0, twice = 0, popped = 0;
+    for (uint32_t i = 1; i <= FRAMES; i++) {
+        uint32_t seen = s_popped[i] + s_dropped[i];
+        missing += seen == 0;
+        twice += seen > 1;
+        popped += s_popped[i];
+    }
+    CHECK(missing == 0, "capacity %u: %u frames lost", capacity, missing);
+    CHECK(twice == 0, "capacity %u: %u frames came out twice", capacity, twice);
+    CHECK(s_pop_order_errors == 0, "capacity %u: %u pops out of order", capacity, s_pop_order_errors);
+    CHECK(s_drop_order_errors == 0, "capacity %u: %u drops out of order", capacity, s_drop_order_errors);
+    CHECK(atomic_load(&s_ring.pushed) == FRAMES, "capacity %u: pushed %u", capacity,
+          (unsigned)atomic_load(&s_ring.pushed));
+    CHECK(atomic_load(&s_ring.dropped) == s_drops, "capacity %u: dropped counter %u, producer got %u", capacity,
+          (unsigned)atomic_load(&s_ring.dropped), s_drops);
+    CHECK(frame_ring_count(&s_ring) == 0, "capacity %u: ring not empty", capacity);
+    printf("capacity %u: %u popped, %u dropped\n", capacity, popped, s_drops);
+}
+
+int main(void)
+{
+    CHECK(!frame_ring_init(&s_ring, 3), "%s", "capacity 3 is not a power of two");
+    CHECK(!frame_ring_init(&s_ring, FRAME_RING_MAX_SLOTS * 2), "%s", "capacity above FRAME_RING_MAX_SLOTS");
+    for (uint32_t capacity = 1; capacity <= FRAME_RING_MAX_SLOTS; capacity *= 2) {
+        run(capacity);
+    }
+    return test_report("frame_ring_stress");
+}
@@ -0,0 +1,137 @@
+/*
+ * frame_stats against a per-pixel reference
+ * 曝光统计: 与逐像素的参考实现比较
+ *
+ * Random frames with black and white pixels mixed in are fed in bands of
+ * a few rows, with areas starting at odd columns and odd widths so that
+ * the word-at-a-time path sees every alignment and tail, for steps 1 to 5.
+ * Histograms, counts and pixels per grid cell must match exactly; mean and
+ * grid luma may differ by one from rounding.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "frame_analysis.h"
+#include "rgb565.h"
+#include "test_check.h"
+
+#define W 53
+#define H 37
+
+static uint16_t s_frame[W * H];
+
+typedef struct {
+    uint32_t hist_r[32], hist_g[64], hist_b[32];
+    uint32_t pixels, black, white;
+    uint64_t luma_sum;
+    uint64_t grid_sum[FRAME_STATS_GRID_ROWS][FRAME_STATS_GRID_COLS];
+    uint32_t grid_count[FRAME_STATS_GRID_ROWS][FRAME_STATS_GRID_COLS];
+} ref_stats_t;
+
+static void reference(ref_stats_t *ref, uint32_t ax, uint32_t ay, uint32_t aw, uint32_t ah, uint32_t step)
+{
+    memset(ref, 0, sizeof(*ref));
+    for (uint32_t y = 0; y < ah; y += step) {
+        for (uint32_t x = 0; x < aw; x += step) {
+            uint16_t raw = s_frame[(ay + y) * W + ax + x];
+            uint16_t p = rgb565_swap(raw);
+            uint32_t r = rgb565_r(p), g = rgb565_g(p), b = rgb565_b(p);
+            uint32_t gy = y * FRAME_STATS_GRID_ROWS / ah, gx = x * FRAME_STATS_GRID_COLS / aw;
+            uint32_t luma = r * 616 + g * 600 + b * 232;
+            ref->hist_r[r]++;
+            ref->hist_g[g]++;
+            ref->hist_b[b]++;
+            ref->pixels++;
+            ref->black += raw == 0x0000;
+            ref->white += raw == 0xFFFF;
+            ref->luma_sum += luma;
+            ref->grid_sum[gy][gx] += luma;
+            ref->grid_count[gy][gx]++;
+        }
+    }
+}
+
+static int near(uint32_t a, uint32_t b)
+{
+    return a + 1 >= b && b + 1 >= a;
+}
+
+static void compare(const char *name, uint32_t ax, uint32_t ay, uint32_t aw, uint32_t ah, uint32_t step,
+                    uint32_t band)
+{
+    static frame_stats_t stats;
+    ref_stats_t ref;
+
+    reference(&ref, ax, ay, aw, ah, step);
+    frame_stats_begin(&stats, ax, ay, aw, ah, step);
+    for (uint32_t y = 0; y < H; y += band) {
+        frame_stats_rows(&stats, s_frame + y * W, W, y, H - y < band ? H - y : band);
+    }
+    frame_stats_end(&stats);
+
+    CHECK(!memcmp(stats.hist_r, ref.hist_r, sizeof(ref.hist_r)), "%s step %u: red histogram", name, step);
+    CHECK(!memcmp(stats.hist_g, ref.hist_g, sizeof(ref.hist_g)), "%s step %u: green histogram", name, step);
+    CHECK(!memcmp(stats.hist_b, ref.hist_b, sizeof(ref.hist_b)), "%s step %u: blue histogram", name, step);
+    CHECK(stats.pixels == ref.pixels, "%s step %u: %u pixels, want %u", name, step, stats.pixels, ref.pixels);
+    CHECK(stats.black == ref.black && stats.white == ref.white, "%s step %u: black %u white %u, want %u %u", name,
+          step, stats.black, stats.white, ref.black, ref.white);
+    CHECK(stats.clipped_low[FRAME_STATS_GREEN] == ref.hist_g[0] &&
+          stats.clipped_high[FRAME_STATS_BLUE] == ref.hist_b[31], "%s step %u: clipped counts", name, step);
+
+    uint32_t mean = ref.pixels ? (uint32_t)(ref.luma_sum / 256 / ref.pixels) : 0;
+    CHECK(near(stats.mean_luma, mean), "%s step %u: mean luma %u, want %u", name, step, stats.mean_luma, mean);
+    for (int gy = 0; gy < FRAME_STATS_GRID_ROWS; gy++) {
+        for (int gx = 0; gx < FRAME_STATS_GRID_COLS; gx++) {
+            uint32_t n = ref.grid_count[gy][gx];
+            uint32_t want = n ? (uint32_t)(ref.grid_sum[gy][gx] / 256 / n) : 0;
+            CHECK(stats.grid_count[gy][gx] == n, "%s step %u: cell %d,%d has %u pixels, want %u", name, step, gx,
+                  gy, stats.grid_count[gy][gx], n);
+            CHECK(near(stats.grid_luma[gy][gx], want), "%s step %u: cell %d,%d luma %u, want %u", name, step, gx,
+                  gy, stats.grid_luma[gy][gx], want);
+        }
+    }
+}
+
+static void test_random(void)
+{
+    srand(7);
+    for (int i = 0; i < W * H; i++) {
+        int k = rand() % 16;
+        s_frame[i] = k == 0 ? 0x0000 : k == 1 ? 0xFFFF : (uint16_t)rand();
+    }
+    for (uint32_t step = 1; step <= 5; step++) {
+        compare("whole frame", 0, 0, W, H, step, 8);
+        compare("odd area", 3, 2, 47, 31, step, 3);
+        compare("even area", 4, 5, 44, 24, step, 1);
+        compare("narrow area", 7, 0, 9, H, step, 5);
+    }
+}
+
+// 单色帧: 每格亮度相同, 直方图只有一格
+static void test_flat(void)
+{
+    const uint16_t cpu = rgb565_pack(20, 40, 10);
+    for (int i = 0; i < W * H; i++) {
+        s_frame[i] = rgb565_swap(cpu);
+    }
+    static frame_stats_t stats;
+    frame_stats_begin(&stats, 1, 0, W - 1, H, 1);
+    frame_stats_rows(&stats, s_frame, W, 0, H);
+    frame_stats_end(&stats);
+
+    uint32_t luma = (20 * 616 + 40 * 600 + 10 * 232) >> 8;
+    uint32_t n = (W - 1) * H;
+    CHECK(stats.hist_r[20] == n && stats.hist_g[40] == n && stats.hist_b[10] == n, "%s", "flat histograms");
+    CHECK(stats.mean_luma == luma, "flat mean luma %u, want %u", stats.mean_luma, luma);
+    for (int gy = 0; gy < FRAME_STATS_GRID_ROWS; gy++) {
+        for (int gx = 0; gx < FRAME_STATS_GRID_COLS; gx++) {
+            CHECK(stats.grid_luma[gy][gx] == luma, "flat cell %d,%d luma %u", gx, gy, stats.grid_luma[gy][gx]);
+        }
+    }
+}
+
+int main(void)
+{
+    test_random();
+    test_flat();
+    return test_report("frame_stats_test");
+}
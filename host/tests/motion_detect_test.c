@@ -0,0 +1,175 @@
+/*
+ * motion_detect hysteresis on synthetic thumbnail clips
+ * 运动检测: 合成的缩略图序列上的开始/静止事件
+ *
+ * A noisy static scene and the same scene with a block moving over it.
+ * START must come on exactly the start_frames-th qualifying frame and STOP
+ * on the stop_frames-th; one frame that does not qualify in between starts
+ * the count over. Stepping the brightness of the whole scene, as auto
+ * exposure does, is not motion.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "motion_detect.h"
+#include "test_check.h"
+
+#define W 32
+#define H 40
+
+static const motion_config_t s_config = {
+    .width = W,
+    .height = H,
+    .pixel_threshold = 12,
+    .start_frames = 3,
+    .start_permille = 20,
+    .stop_permille = 5,
+    .stop_frames = 4,
+};
+
+static uint8_t s_thumb[W * H];
+static uint32_t s_block_x;
+
+// 中间调纹理加 ±2 的噪声, brightness 整体加上
+static void draw_static(int brightness)
+{
+    for (uint32_t y = 0; y < H; y++) {
+        for (uint32_t x = 0; x < W; x++) {
+            int v = 60 + (int)((x * 7 + y * 13) % 90) + rand() % 5 - 2 + brightness;
+            s_thumb[y * W + x] = (uint8_t)v;
+        }
+    }
+}
+
+// 8x8 的亮块每帧右移 8 个像素: 约 10% 的像素变化
+static void draw_moving(void)
+{
+    draw_static(0);
+    for (uint32_t y = 16; y < 24; y++) {
+        for (uint32_t x = 0; x < 8; x++) {
+            s_thumb[y * W + (s_block_x + x) % W] = 240;
+        }
+    }
+    s_block_x += 8;
+}
+
+static const char *event_name(motion_event_t e)
+{
+    return e == MOTION_EVENT_START ? "START" : e == MOTION_EVENT_STOP ? "STOP" : "none";
+}
+
+// n 帧, 前 n-1 帧没有事件, 最后一帧得到 last
+static void feed(motion_detect_t *m, const char *name, bool moving, uint32_t n, motion_event_t last)
+{
+    for (uint32_t i = 1; i <= n; i++) {
+        if (moving) {
+            draw_moving();
+        } else {
+            draw_static(0);
+        }
+        motion_event_t e = motion_detect_update(m, s_thumb);
+        motion_event_t want = i == n ? last : MOTION_EVENT_NONE;
+        CHECK(e == want, "%s: frame %u of %u gave %s, want %s (score %u)", name, i, n, event_name(e),
+              event_name(want), m->score);
+    }
+}
+
+static void test_hysteresis(void)
+{
+    static motion_detect_t m;
+
+    srand(17);
+    CHECK(motion_detect_init(&m, &s_config), "%s", "init failed");
+    CHECK(m.moving, "%s", "new detector not moving");
+    feed(&m, "first frame", false, 1, MOTION_EVENT_NONE);
+
+    feed(&m, "still", false, s_config.stop_frames, MOTION_EVENT_STOP);
+    CHECK(!m.moving && m.score < s_config.stop_permille, "after STOP: moving %d, score %u", m.moving, m.score);
+
+    feed(&m, "moving", true, s_config.start_frames, MOTION_EVENT_START);
+    CHECK(m.moving && m.score >= s_config.start_permille, "after START: moving %d, score %u", m.moving, m.score);
+
+    // 第一帧静止的画面与上一帧的亮块比较仍算运动, 之后才开始计数
+    feed(&m, "block leaves", false, 1, MOTION_EVENT_NONE);
+    feed(&m, "still again", false, s_config.stop_frames, MOTION_EVENT_STOP);
+}
+
+static void test_run_reset(void)
+{
+    static motion_detect_t m;
+
+    srand(19);
+    motion_detect_init(&m, &s_config);
+    feed(&m, "first frame", false, 1, MOTION_EVENT_NONE);
+    feed(&m, "still", false, s_config.stop_frames, MOTION_EVENT_STOP);
+
+    // 差一帧就开始运动时插入一帧不满足的: 重新计数
+    feed(&m, "moving, cut short", true, s_config.start_frames - 1, MOTION_EVENT_NONE);
+    // 亮块停住一帧: 与上一帧相同
+    CHECK(motion_detect_update(&m, s_thumb) == MOTION_EVENT_NONE && m.score == 0, "repeated frame: score %u",
+          m.score);
+    CHECK(m.run == 0 && !m.moving, "after a still frame: run %u, moving %d", m.run, m.moving);
+    feed(&m, "moving, counted again", true, s_config.start_frames, MOTION_EVENT_START);
+
+    // 静止计数中间有一帧运动
+    feed(&m, "block leaves", false, 1, MOTION_EVENT_NONE);
+    feed(&m, "still, cut short", false, s_config.stop_frames - 1, MOTION_EVENT_NONE);
+    feed(&m, "one moving frame", true, 1, MOTION_EVENT_NONE);
+    CHECK(m.run == 0 && m.moving, "after a moving frame: run %u, moving %d", m.run, m.moving);
+    feed(&m, "block leaves", false, 1, MOTION_EVENT_NONE);
+    feed(&m, "still, counted again", false, s_config.stop_frames, MOTION_EVENT_STOP);
+}
+
+// 自动曝光: 整个画面一起变亮/变暗, 每次都是一步
+static void test_brightness_step(void)
+{
+    static motion_detect_t m;
+    static const int steps[] = {40, -30, 25, 0, -45};
+
+    srand(23);
+    motion_detect_init(&m, &s_config);
+    feed(&m, "first frame", false, 1, MOTION_EVENT_NONE);
+    feed(&m, "still", false, s_config.stop_frames, MOTION_EVENT_STOP);
+
+    int prev = 0;
+    for (uint32_t i = 0; i < sizeof(steps) / sizeof(steps[0]); i++) {
+        draw_static(steps[i]);
+        motion_event_t e = motion_detect_update(&m, s_thumb);
+        int step = steps[i] - prev;
+        CHECK(e == MOTION_EVENT_NONE && m.score < s_config.start_permille,
+              "brightness step %+d: %s, score %u", step, event_name(e), m.score);
+        CHECK(m.brightness >= step - 1 && m.brightness <= step + 1, "brightness step %+d measured as %d", step,
+              m.brightness);
+        prev = steps[i];
+    }
+    CHECK(!m.moving, "%s", "brightness steps started motion");
+}
+
+static void test_init_reset(void)
+{
+    static motion_detect_t m;
+    motion_config_t big = s_config;
+
+    big.width = 65;
+    big.height = 64;
+    CHECK(!motion_detect_init(&m, &big), "%s", "thumbnail over MOTION_THUMB_MAX_PIXELS accepted");
+
+    srand(29);
+    motion_detect_init(&m, &s_config);
+    feed(&m, "first frame", false, 1, MOTION_EVENT_NONE);
+    feed(&m, "still", false, s_config.stop_frames, MOTION_EVENT_STOP);
+    motion_detect_reset(&m);
+    CHECK(m.moving, "%s", "not moving after reset");
+    // 重置后第一帧只作为参考, 即使与之前完全不同
+    feed(&m, "first frame after reset", true, 1, MOTION_EVENT_NONE);
+    feed(&m, "still after reset", false, 1, MOTION_EVENT_NONE);
+    feed(&m, "still after reset", false, s_config.stop_frames, MOTION_EVENT_STOP);
+}
+
+int main(void)
+{
+    test_hysteresis();
+    test_run_reset();
+    test_brightness_step();
+    test_init_reset();
+    return test_report("motion_detect_test");
+}
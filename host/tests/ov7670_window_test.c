@@ -0,0 +1,142 @@
+/*
+ * OV7670 window register tables decoded back to what the sensor outputs
+ * 开窗寄存器表反解: 窗口位置、降采样和输出尺寸
+ *
+ * Both shipped modes must decode to a centred window halved to the panel
+ * size, the standard VGA register values to the full 640x480 array, and
+ * tables with a missing register or a window outside the array must be
+ * rejected.
+ */
+#include <string.h>
+#include "ov7670_window.h"
+#include "test_check.h"
+
+static void check_info(const char *name, const ov7670_window_info_t *info, uint16_t x, uint16_t y, uint16_t width,
+                       uint16_t height, uint8_t down, uint8_t pclk, uint16_t out_width, uint16_t out_height)
+{
+    CHECK(info->x == x && info->y == y, "%s: window at %u,%u, want %u,%u", name, info->x, info->y, x, y);
+    CHECK(info->width == width && info->height == height, "%s: window %ux%u, want %ux%u", name, info->width,
+          info->height, width, height);
+    CHECK(info->h_downsample == down && info->v_downsample == down, "%s: downsample %u/%u, want %u", name,
+          info->h_downsample, info->v_downsample, down);
+    CHECK(info->pclk_divider == pclk, "%s: pclk divider %u, want %u", name, info->pclk_divider, pclk);
+    CHECK(info->out_width == out_width && info->out_height == out_height, "%s: output %ux%u, want %ux%u", name,
+          info->out_width, info->out_height, out_width, out_height);
+}
+
+static void test_modes(void)
+{
+    static const struct {
+        ov7670_window_mode_t mode;
+        const char *name;
+        uint16_t x, y, width, height, out_width, out_height;
+    } modes[] = {
+        // VGA 中央 256x320 -> 128x160, 320x256 -> 160x128
+        {OV7670_WINDOW_128X160, "128x160", 192, 80, 256, 320, 128, 160},
+        {OV7670_WINDOW_160X128, "160x128", 160, 112, 320, 256, 160, 128},
+    };
+
+    for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); i++) {
+        size_t count = 0;
+        ov7670_window_info_t info;
+        const ov7670_reg_t *regs = ov7670_window_regs(modes[i].mode, &count);
+        CHECK(regs != NULL && count > 0, "%s: no register table", modes[i].name);
+        if (regs == NULL) {
+            continue;
+        }
+        CHECK(ov7670_window_decode(regs, count, &info), "%s: decode failed", modes[i].name);
+        check_info(modes[i].name, &info, modes[i].x, modes[i].y, modes[i].width, modes[i].height, 2, 2,
+                   modes[i].out_width, modes[i].out_height);
+        // 窗口居中
+        CHECK(2 * info.x + info.width == OV7670_VGA_WIDTH && 2 * info.y + info.height == OV7670_VGA_HEIGHT,
+              "%s: window not centred", modes[i].name);
+
+        uint16_t w = 0, h = 0;
+        CHECK(ov7670_window_size(modes[i].mode, &w, &h) && w == modes[i].out_width && h == modes[i].out_height,
+              "%s: ov7670_window_size gave %ux%u", modes[i].name, w, h);
+    }
+
+    size_t count = 1;
+    uint16_t w, h;
+    CHECK(ov7670_window_regs(OV7670_WINDOW_OFF, &count) == NULL && count == 0, "%s", "OFF has a table");
+    CHECK(!ov7670_window_size(OV7670_WINDOW_OFF, &w, &h), "%s", "OFF has a size");
+}
+
+// 数据手册的 VGA 默认值: HSTART 0x13 HSTOP 0x01 HREF 0xB6, VSTART 0x02 VSTOP 0x7A VREF 0x0A
+static const ov7670_reg_t s_vga[] = {
+    {OV7670_REG_HSTART, 0xFF, 0x13},
+    {OV7670_REG_HSTOP, 0xFF, 0x01},
+    {OV7670_REG_HREF, 0xFF, 0xB6},
+    {OV7670_REG_VSTART, 0xFF, 0x02},
+    {OV7670_REG_VSTOP, 0xFF, 0x7A},
+    {OV7670_REG_VREF, 0x0F, 0x0A},
+};
+#define VGA_COUNT (sizeof(s_vga) / sizeof(s_vga[0]))
+
+static void test_full_frame(void)
+{
+    ov7670_window_info_t info;
+    CHECK(ov7670_window_decode(s_vga, VGA_COUNT, &info), "%s", "VGA decode failed");
+    check_info("VGA", &info, 0, 0, 640, 480, 1, 1, 640, 480);
+
+    // DCW 只有在 COM3[2] 置位时生效; PCLK 分频只有在 COM14[4] 置位时生效
+    ov7670_reg_t regs[VGA_COUNT + 3];
+    memcpy(regs, s_vga, sizeof(s_vga));
+    regs[VGA_COUNT] = (ov7670_reg_t){OV7670_REG_SCALING_DCWCTR, 0xFF, 0x22};
+    regs[VGA_COUNT + 1] = (ov7670_reg_t){OV7670_REG_COM14, 0x1F, 0x0A};
+    CHECK(ov7670_window_decode(regs, VGA_COUNT + 2, &info), "%s", "VGA + DCWCTR decode failed");
+    check_info("VGA, DCW off", &info, 0, 0, 640, 480, 1, 1, 640, 480);
+
+    regs[VGA_COUNT + 1] = (ov7670_reg_t){OV7670_REG_COM14, 0x1F, 0x1A};
+    regs[VGA_COUNT + 2] = (ov7670_reg_t){OV7670_REG_COM3, 0x0C, 0x04};
+    CHECK(ov7670_window_decode(regs, VGA_COUNT + 3, &info), "%s", "VGA /4 decode failed");
+    check_info("VGA /4", &info, 0, 0, 640, 480, 4, 4, 160, 120);
+}
+
+static void test_rejected(void)
+{
+    ov7670_window_info_t info;
+    ov7670_reg_t regs[VGA_COUNT];
+
+    // 缺任何一个窗口寄存器
+    for (size_t skip = 0; skip < VGA_COUNT; skip++) {
+        size_t n = 0;
+        for (size_t i = 0; i < VGA_COUNT; i++) {
+            if (i != skip) {
+                regs[n++] = s_vga[i];
+            }
+        }
+        CHECK(!ov7670_window_decode(regs, n, &info), "register %02x missing but decoded", s_vga[skip].reg);
+    }
+
+    // 右边超出: HSTART 后移 8 个像素, 宽度不变
+    memcpy(regs, s_vga, sizeof(s_vga));
+    regs[0].value = 0x14;
+    regs[1].value = 0x02;
+    CHECK(!ov7670_window_decode(regs, VGA_COUNT, &info), "%s", "window past the right edge decoded");
+
+    // 左边超出有效区域
+    memcpy(regs, s_vga, sizeof(s_vga));
+    regs[0].value = 0x12;
+    CHECK(!ov7670_window_decode(regs, VGA_COUNT, &info), "%s", "window left of the array decoded");
+
+    // 底部超出, 以及 VSTOP 不大于 VSTART
+    memcpy(regs, s_vga, sizeof(s_vga));
+    regs[4].value = 0x7B;
+    CHECK(!ov7670_window_decode(regs, VGA_COUNT, &info), "%s", "window past the bottom decoded");
+    regs[4].value = 0x02;
+    CHECK(!ov7670_window_decode(regs, VGA_COUNT, &info), "%s", "empty window decoded");
+
+    // mask 以外的位不算: VREF 高位写 1 不改变窗口
+    memcpy(regs, s_vga, sizeof(s_vga));
+    regs[5].value = 0xFA;
+    CHECK(ov7670_window_decode(regs, VGA_COUNT, &info) && info.height == 480, "%s", "VREF high bits not masked");
+}
+
+int main(void)
+{
+    test_modes();
+    test_full_frame();
+    test_rejected();
+    return test_report("ov7670_window_test");
+}
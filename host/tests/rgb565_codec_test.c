@@ -0,0 +1,200 @@
+/*
+ * rgb565_codec round trips, size bound and malformed input
+ * RGB565 无损压缩: 逐行编码后解码与原图逐位相同, 输出不超过上限, 坏数据被拒绝
+ *
+ * Images are encoded row by row as the frame recorder does, so runs
+ * continue across rows, and must decode to the same pixels with every
+ * byte consumed. Each call and the whole image stay within
+ * RGB565_CODEC_MAX_BYTES. The op counts show that the images reach runs
+ * across rows, RAW and index hits. Cut-off data and data for more pixels
+ * than asked for must not decode.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "rgb565.h"
+#include "rgb565_codec.h"
+#include "test_check.h"
+
+#define MAX_W 128
+#define MAX_H 160
+#define MAX_PIXELS (MAX_W * MAX_H)
+
+static uint16_t s_image[MAX_PIXELS];
+static uint16_t s_decoded[MAX_PIXELS + 1];
+static uint8_t s_stream[RGB565_CODEC_MAX_BYTES(MAX_PIXELS)];
+
+typedef struct {
+    uint32_t index, diff, luma, run, raw;
+} op_counts_t;
+
+static void put(uint32_t i, uint16_t cpu)
+{
+    s_image[i] = rgb565_swap(cpu);
+}
+
+// 与编码器相同的逐行调用方式, 返回整幅图的字节数
+static size_t encode_rows(const char *name, uint32_t w, uint32_t h)
+{
+    rgb565_encoder_t enc;
+    size_t bytes = 0;
+
+    rgb565_codec_encode_begin(&enc);
+    for (uint32_t y = 0; y < h; y++) {
+        size_t n = rgb565_codec_encode(&enc, s_image + y * w, w, s_stream + bytes);
+        CHECK(n <= RGB565_CODEC_MAX_BYTES(w), "%s: row %u took %zu bytes, bound %zu", name, y, n,
+              RGB565_CODEC_MAX_BYTES(w));
+        bytes += n;
+    }
+    bytes += rgb565_codec_encode_end(&enc, s_stream + bytes);
+    CHECK(bytes <= RGB565_CODEC_MAX_BYTES(w * h), "%s: %zu bytes, bound %zu", name, bytes,
+          RGB565_CODEC_MAX_BYTES(w * h));
+    return bytes;
+}
+
+// 按格式说明数各种操作
+static op_counts_t count_ops(size_t bytes)
+{
+    op_counts_t c = {0};
+
+    for (size_t pos = 0; pos < bytes;) {
+        uint8_t op = s_stream[pos];
+        if (op == 0xFE) {
+            c.raw++;
+            pos += 3;
+        } else if ((op & 0xC0) == 0xC0) {
+            c.run++;
+            pos++;
+        } else if ((op & 0xC0) == 0x80) {
+            c.luma++;
+            pos += 2;
+        } else if ((op & 0xC0) == 0x40) {
+            c.diff++;
+            pos++;
+        } else {
+            c.index++;
+            pos++;
+        }
+    }
+    return c;
+}
+
+static op_counts_t round_trip(const char *name, uint32_t w, uint32_t h)
+{
+    size_t pixels = (size_t)w * h;
+    size_t bytes = encode_rows(name, w, h);
+
+    memset(s_decoded, 0xA5, sizeof(s_decoded));
+    size_t used = rgb565_codec_decode(s_stream, bytes, s_decoded, pixels);
+    CHECK(used == bytes, "%s: decode used %zu of %zu bytes", name, used, bytes);
+    CHECK(!memcmp(s_decoded, s_image, pixels * 2), "%s: decoded pixels differ", name);
+    CHECK(s_decoded[pixels] == 0xA5A5, "%s: decode wrote past %zu pixels", name, pixels);
+
+    // 截断: 少一个像素也解不出来
+    for (size_t cut = 1; cut <= bytes && cut <= 4; cut++) {
+        CHECK(rgb565_codec_decode(s_stream, bytes - cut, s_decoded, pixels) == 0,
+              "%s: decoded with the last %zu bytes cut off", name, cut);
+    }
+    CHECK(bytes < 2 || rgb565_codec_decode(s_stream, bytes / 2, s_decoded, pixels) == 0,
+          "%s: decoded half the stream", name);
+    // 数据比要求的像素多: 要么拒绝, 要么在用完之前就停下
+    CHECK(rgb565_codec_decode(s_stream, bytes, s_decoded, pixels - 1) != bytes,
+          "%s: %zu pixels of data accepted as %zu", name, pixels, pixels - 1);
+    CHECK(rgb565_codec_decode(s_stream, bytes, s_decoded, pixels + 1) == 0,
+          "%s: decoded one pixel more than encoded", name);
+    return count_ops(bytes);
+}
+
+static void test_random(void)
+{
+    srand(11);
+    for (uint32_t i = 0; i < MAX_PIXELS; i++) {
+        put(i, (uint16_t)rand());
+    }
+    op_counts_t c = round_trip("random", MAX_W, MAX_H);
+    CHECK(c.raw > 0, "%s", "random: no RAW ops");
+
+    // 奇数宽度, 每行长度不是 4 的倍数
+    round_trip("random 37x5", 37, 5);
+}
+
+// 单色: 游程跨行, 整幅图只有游程
+static void test_flat(void)
+{
+    for (uint32_t i = 0; i < MAX_PIXELS; i++) {
+        put(i, rgb565_pack(9, 33, 20));
+    }
+    op_counts_t c = round_trip("flat", MAX_W, MAX_H);
+    // 每行单独结束游程时是每行 3 个
+    uint32_t runs = (MAX_PIXELS - 1 + 61) / 62;
+    CHECK(c.run == runs, "flat: %u runs, want %u", c.run, runs);
+
+    // 全黑: 与初始的上一个像素相同, 从第一个像素起就是游程
+    memset(s_image, 0, sizeof(s_image));
+    c = round_trip("black", MAX_W, MAX_H);
+    CHECK(c.run == (MAX_PIXELS + 61) / 62 && c.raw + c.luma + c.diff + c.index == 0, "black: %u runs, %u other",
+          c.run, c.raw + c.luma + c.diff + c.index);
+}
+
+static void test_gradient(void)
+{
+    for (uint32_t y = 0; y < MAX_H; y++) {
+        for (uint32_t x = 0; x < MAX_W; x++) {
+            put(y * MAX_W + x, rgb565_pack(x / 4, (x + y) / 5, 31 - y / 5));
+        }
+    }
+    op_counts_t c = round_trip("gradient", MAX_W, MAX_H);
+    CHECK(c.diff + c.luma > 0 && c.raw < MAX_H, "gradient: %u diff, %u luma, %u raw", c.diff, c.luma, c.raw);
+}
+
+// 每个像素在上一个的基础上翻转一位: 差值落在所有通道的各个位上
+static void test_bit_flips(void)
+{
+    uint16_t p = 0x1234;
+
+    srand(13);
+    for (uint32_t i = 0; i < MAX_PIXELS; i++) {
+        p ^= (uint16_t)(1u << (rand() % 16));
+        put(i, p);
+    }
+    op_counts_t c = round_trip("bit flips", MAX_W, MAX_H);
+    CHECK(c.diff > 0 && c.luma > 0 && c.raw > 0, "bit flips: %u diff, %u luma, %u raw", c.diff, c.luma, c.raw);
+}
+
+// 几种颜色交替: 除了第一次出现都应命中索引
+static void test_palette(void)
+{
+    static const uint16_t colors[] = {0xF800, 0x07E0, 0x001F, 0xFFE0, 0x8410};
+    const uint32_t n = sizeof(colors) / sizeof(colors[0]);
+
+    for (uint32_t i = 0; i < MAX_PIXELS; i++) {
+        put(i, colors[(i * 7 / 3) % n]);
+    }
+    op_counts_t c = round_trip("palette", MAX_W, MAX_H);
+    CHECK(c.index > MAX_PIXELS / 2, "palette: %u index hits", c.index);
+}
+
+static void test_malformed(void)
+{
+    // 一个 62 像素的游程, 只要 10 个像素
+    const uint8_t run62[] = {0xC0 | 61};
+    CHECK(rgb565_codec_decode(run62, sizeof(run62), s_decoded, 10) == 0, "%s", "run past the pixel count accepted");
+    CHECK(rgb565_codec_decode(run62, sizeof(run62), s_decoded, 62) == 1, "%s", "62 pixel run rejected");
+
+    // RAW/LUMA 缺少后面的字节
+    const uint8_t raw[] = {0xFE, 0x12};
+    CHECK(rgb565_codec_decode(raw, sizeof(raw), s_decoded, 1) == 0, "%s", "truncated RAW accepted");
+    const uint8_t luma[] = {0x80 | 40};
+    CHECK(rgb565_codec_decode(luma, sizeof(luma), s_decoded, 1) == 0, "%s", "truncated LUMA accepted");
+    CHECK(rgb565_codec_decode(raw, 0, s_decoded, 1) == 0, "%s", "empty input accepted");
+}
+
+int main(void)
+{
+    test_random();
+    test_flat();
+    test_gradient();
+    test_bit_flips();
+    test_palette();
+    test_malformed();
+    return test_report("rgb565_codec_test");
+}
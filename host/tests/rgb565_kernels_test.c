@@ -0,0 +1,90 @@
+/*
+ * Row kernels against plain indexed loops
+ * 行内核与逐像素下标循环比较: 奇数长度, 不对齐的起点, 不越界写
+ *
+ * Only stdio is used, so the same file can be built into a test app on
+ * the ESP32-S3 and rgb565_kernels_test() called from app_main: there the
+ * dispatching kernels take the PIE path for the 16-byte aligned middle,
+ * and are checked against the same reference as the portable versions.
+ */
+#include <stdint.h>
+#include <string.h>
+#include "rgb565_kernels.h"
+#include "test_check.h"
+
+#define MAX_COUNT 72
+#define MAX_OFFSET 8
+#define GUARD 0xA5A5
+
+typedef void (*row_kernel_t)(const uint16_t *src, uint16_t *dst, uint32_t count);
+
+typedef struct {
+    const char *name;
+    row_kernel_t kernel;
+    uint32_t num, den;  // dst[i] = src[(num * i) / den]
+} kernel_case_t;
+
+static const kernel_case_t s_cases[] = {
+    {"copy_portable", rgb565_row_copy_portable, 1, 1},
+    {"decimate2_portable", rgb565_row_decimate2_portable, 2, 1},
+    {"decimate5_2_portable", rgb565_row_decimate5_2_portable, 5, 2},
+    {"copy", rgb565_row_copy, 1, 1},
+    {"decimate2", rgb565_row_decimate2, 2, 1},
+    {"decimate5_2", rgb565_row_decimate5_2, 5, 2},
+};
+
+// 16字节对齐, 偏移0时 S3 上会走 PIE 路径
+static uint16_t s_src[MAX_OFFSET + (5 * MAX_COUNT) / 2 + 8] __attribute__((aligned(16)));
+static uint16_t s_dst[MAX_OFFSET + MAX_COUNT + 8] __attribute__((aligned(16)));
+
+static void check_case(const kernel_case_t *c)
+{
+    for (uint32_t src_off = 0; src_off < MAX_OFFSET; src_off++) {
+        for (uint32_t dst_off = 0; dst_off < MAX_OFFSET; dst_off++) {
+            for (uint32_t count = 0; count <= MAX_COUNT; count++) {
+                for (size_t k = 0; k < sizeof(s_dst) / sizeof(s_dst[0]); k++) {
+                    s_dst[k] = GUARD;
+                }
+                const uint16_t *src = s_src + src_off;
+                uint16_t *dst = s_dst + dst_off;
+                c->kernel(src, dst, count);
+
+                int bad = 0;
+                for (uint32_t i = 0; i < count && !bad; i++) {
+                    uint16_t want = src[(c->num * i) / c->den];
+                    if (dst[i] != want) {
+                        CHECK(dst[i] == want, "%s src+%u dst+%u count %u: dst[%u] = %04x, want %04x", c->name,
+                              (unsigned)src_off, (unsigned)dst_off, (unsigned)count, (unsigned)i, dst[i], want);
+                        bad = 1;
+                    }
+                }
+                for (size_t k = 0; k < sizeof(s_dst) / sizeof(s_dst[0]) && !bad; k++) {
+                    if ((k < dst_off || k >= dst_off + count) && s_dst[k] != GUARD) {
+                        CHECK(s_dst[k] == GUARD, "%s src+%u dst+%u count %u: wrote outside the row at %u", c->name,
+                              (unsigned)src_off, (unsigned)dst_off, (unsigned)count, (unsigned)k);
+                        bad = 1;
+                    }
+                }
+            }
+        }
+    }
+}
+
+int rgb565_kernels_test(void)
+{
+    // 每个像素值不同, 且不与 GUARD 相同
+    for (size_t k = 0; k < sizeof(s_src) / sizeof(s_src[0]); k++) {
+        s_src[k] = (uint16_t)(0x1000 + k * 7);
+    }
+    for (size_t c = 0; c < sizeof(s_cases) / sizeof(s_cases[0]); c++) {
+        check_case(&s_cases[c]);
+    }
+    return test_report("rgb565_kernels_test");
+}
+
+#ifndef ESP_PLATFORM
+int main(void)
+{
+    return rgb565_kernels_test();
+}
+#endif
@@ -0,0 +1,213 @@
+/*
+ * sccb_cache against a fake register file
+ * SCCB 寄存器缓存: 用模拟的寄存器文件检查总线上实际发生的读写
+ *
+ * The fake sensor counts bus reads and writes, can fail a chosen write,
+ * and goes back to its power-on values when the COM7 reset bit is set.
+ */
+#include <string.h>
+#include "sccb_cache.h"
+#include "test_check.h"
+
+#define REG_GAIN 0x00
+#define REG_COM7 0x12
+#define COM7_RESET 0x80
+
+typedef struct {
+    uint8_t regs[SCCB_CACHE_REGS];
+    uint32_t reads;
+    uint32_t writes;
+    int fail_write_reg;     // 对该寄存器的写入失败, -1 不失败
+    uint8_t order[16];      // 写入顺序
+    uint32_t order_count;
+} fake_sensor_t;
+
+static void fake_power_on(fake_sensor_t *f)
+{
+    for (int i = 0; i < SCCB_CACHE_REGS; i++) {
+        f->regs[i] = (uint8_t)(i ^ 0x5A);
+    }
+}
+
+static int fake_read(void *ctx, uint8_t reg)
+{
+    fake_sensor_t *f = ctx;
+    f->reads++;
+    return f->regs[reg];
+}
+
+static int fake_write(void *ctx, uint8_t reg, uint8_t value)
+{
+    fake_sensor_t *f = ctx;
+    f->writes++;
+    if (reg == f->fail_write_reg) {
+        return -1;
+    }
+    if (f->order_count < sizeof(f->order)) {
+        f->order[f->order_count++] = reg;
+    }
+    if (reg == REG_COM7 && (value & COM7_RESET)) {
+        fake_power_on(f);
+        return 0;
+    }
+    f->regs[reg] = value;
+    return 0;
+}
+
+static fake_sensor_t s_fake;
+static sccb_cache_t s_cache;
+
+static void setup(void)
+{
+    memset(&s_fake, 0, sizeof(s_fake));
+    fake_power_on(&s_fake);
+    s_fake.fail_write_reg = -1;
+    sccb_bus_t bus = {fake_read, fake_write, &s_fake};
+    sccb_cache_init(&s_cache, &bus);
+    sccb_cache_set_volatile(&s_cache, REG_GAIN);
+    sccb_cache_set_reset(&s_cache, REG_COM7, COM7_RESET);
+}
+
+static void test_redundant_writes(void)
+{
+    setup();
+    CHECK(sccb_cache_write(&s_cache, 0x40, 0xFF, 0x55) == 0, "%s", "first write");
+    CHECK(s_fake.writes == 1 && s_fake.regs[0x40] == 0x55, "first write: %u bus writes", s_fake.writes);
+    CHECK(sccb_cache_write(&s_cache, 0x40, 0xFF, 0x55) == 0, "%s", "same value");
+    CHECK(s_fake.writes == 1, "same value went to the bus (%u writes)", s_fake.writes);
+    CHECK(s_cache.stats.writes_skipped == 1, "skipped %u", s_cache.stats.writes_skipped);
+
+    // 读过的寄存器写入原值也跳过
+    CHECK(sccb_cache_read(&s_cache, 0x41) == (0x41 ^ 0x5A), "%s", "read 0x41");
+    CHECK(sccb_cache_write(&s_cache, 0x41, 0xFF, 0x41 ^ 0x5A) == 0, "%s", "write back");
+    CHECK(s_fake.writes == 1 && s_fake.reads == 1, "write back: %u writes %u reads", s_fake.writes, s_fake.reads);
+
+    CHECK(sccb_cache_write(&s_cache, 0x40, 0xFF, 0x56) == 0 && s_fake.writes == 2 && s_fake.regs[0x40] == 0x56,
+          "%s", "changed value not written");
+}
+
+static void test_masked_writes(void)
+{
+    setup();
+    // 未知寄存器: 读一次, 合并后写
+    CHECK(sccb_cache_write(&s_cache, 0x3A, 0x0F, 0x03) == 0, "%s", "masked write");
+    uint8_t want = (uint8_t)(((0x3A ^ 0x5A) & 0xF0) | 0x03);
+    CHECK(s_fake.reads == 1 && s_fake.writes == 1 && s_fake.regs[0x3A] == want,
+          "first masked write: %u reads %u writes, value %02x want %02x", s_fake.reads, s_fake.writes,
+          s_fake.regs[0x3A], want);
+
+    // 之后的部分写入从缓存取其余位, 不再读总线
+    CHECK(sccb_cache_write(&s_cache, 0x3A, 0xC0, 0x80) == 0, "%s", "second masked write");
+    want = (uint8_t)((want & 0x3F) | 0x80);
+    CHECK(s_fake.reads == 1 && s_fake.writes == 2 && s_fake.regs[0x3A] == want,
+          "second masked write: %u reads %u writes, value %02x want %02x", s_fake.reads, s_fake.writes,
+          s_fake.regs[0x3A], want);
+    CHECK(sccb_cache_read(&s_cache, 0x3A) == want && s_fake.reads == 1, "%s", "read not served from the cache");
+
+    // 部分写入后值不变: 跳过
+    CHECK(sccb_cache_write(&s_cache, 0x3A, 0x0F, 0x03) == 0 && s_fake.writes == 2, "%s", "unchanged bits written");
+}
+
+static void test_volatile(void)
+{
+    setup();
+    s_fake.regs[REG_GAIN] = 0x10;
+    CHECK(sccb_cache_read(&s_cache, REG_GAIN) == 0x10, "%s", "gain read");
+    s_fake.regs[REG_GAIN] = 0x22;  // AGC 自己改了
+    CHECK(sccb_cache_read(&s_cache, REG_GAIN) == 0x22, "%s", "gain read again");
+    CHECK(s_fake.reads == 2 && s_cache.stats.read_hits == 0, "volatile reads: %u bus, %u hits", s_fake.reads,
+          s_cache.stats.read_hits);
+
+    CHECK(sccb_cache_write(&s_cache, REG_GAIN, 0xFF, 0x30) == 0, "%s", "gain write");
+    CHECK(sccb_cache_write(&s_cache, REG_GAIN, 0xFF, 0x30) == 0, "%s", "gain write again");
+    CHECK(s_fake.writes == 2, "volatile writes: %u on the bus, want 2", s_fake.writes);
+
+    // 部分写入每次都读当前值
+    s_fake.regs[REG_GAIN] = 0xF0;
+    CHECK(sccb_cache_write(&s_cache, REG_GAIN, 0x0F, 0x05) == 0 && s_fake.regs[REG_GAIN] == 0xF5, "%s",
+          "volatile masked write");
+    CHECK(s_fake.reads == 3 && s_fake.writes == 3, "volatile masked write: %u reads %u writes", s_fake.reads,
+          s_fake.writes);
+}
+
+static void test_batch(void)
+{
+    setup();
+    CHECK(sccb_cache_read(&s_cache, 0x60) >= 0, "%s", "read 0x60");
+    uint32_t reads = s_fake.reads;
+
+    sccb_cache_begin(&s_cache);
+    sccb_cache_write(&s_cache, 0x50, 0xFF, 0x01);
+    sccb_cache_write(&s_cache, 0x51, 0xFF, 0x02);
+    sccb_cache_write(&s_cache, 0x50, 0xFF, 0x03);
+    sccb_cache_write(&s_cache, 0x60, 0xFF, 0x77);
+    sccb_cache_write(&s_cache, 0x60, 0xFF, 0x60 ^ 0x5A);  // 改回硬件上的值
+    CHECK(s_fake.writes == 0, "%u writes before commit", s_fake.writes);
+    CHECK(sccb_cache_read(&s_cache, 0x50) == 0x03 && s_fake.reads == reads, "%s", "batched value not readable");
+
+    CHECK(sccb_cache_commit(&s_cache) == 0, "%s", "commit");
+    CHECK(s_fake.writes == 2 && s_fake.order[0] == 0x50 && s_fake.order[1] == 0x51,
+          "commit: %u writes, order %02x %02x", s_fake.writes, s_fake.order[0], s_fake.order[1]);
+    CHECK(s_fake.regs[0x50] == 0x03 && s_fake.regs[0x51] == 0x02, "%s", "final values not written");
+    CHECK(sccb_cache_commit(&s_cache) == 0 && s_fake.writes == 2, "%s", "second commit wrote again");
+
+    // 中途写入失败: 之后的写入丢弃, 失败的和丢弃的寄存器都从缓存里去掉
+    sccb_cache_begin(&s_cache);
+    sccb_cache_write(&s_cache, 0x52, 0xFF, 0x11);
+    sccb_cache_write(&s_cache, 0x53, 0xFF, 0x12);
+    sccb_cache_write(&s_cache, 0x54, 0xFF, 0x13);
+    s_fake.fail_write_reg = 0x53;
+    s_fake.order_count = 0;
+    CHECK(sccb_cache_commit(&s_cache) == -1, "%s", "failed commit returned 0");
+    CHECK(s_fake.order_count == 1 && s_fake.order[0] == 0x52, "failed commit: %u writes went through",
+          s_fake.order_count);
+    CHECK(s_fake.regs[0x54] == (0x54 ^ 0x5A), "%s", "write after the failure was sent");
+    s_fake.fail_write_reg = -1;
+
+    reads = s_fake.reads;
+    CHECK(sccb_cache_read(&s_cache, 0x52) == 0x11 && s_fake.reads == reads, "%s", "written register forgotten");
+    CHECK(sccb_cache_read(&s_cache, 0x53) == (0x53 ^ 0x5A) && s_fake.reads == reads + 1, "%s",
+          "failed register still cached");
+    CHECK(sccb_cache_read(&s_cache, 0x54) == (0x54 ^ 0x5A) && s_fake.reads == reads + 2, "%s",
+          "dropped register still cached");
+
+    // 下一批正常提交
+    sccb_cache_begin(&s_cache);
+    sccb_cache_write(&s_cache, 0x54, 0xFF, 0x13);
+    CHECK(sccb_cache_commit(&s_cache) == 0 && s_fake.regs[0x54] == 0x13, "%s", "commit after a failure");
+}
+
+static void test_reset(void)
+{
+    setup();
+    sccb_cache_write(&s_cache, 0x70, 0xFF, 0x01);
+    sccb_cache_read(&s_cache, 0x71);
+
+    sccb_cache_begin(&s_cache);
+    sccb_cache_write(&s_cache, 0x72, 0xFF, 0x02);
+    uint32_t writes = s_fake.writes;
+    // 复位在批处理中也立即发送, 暂存的写入作废
+    CHECK(sccb_cache_write(&s_cache, REG_COM7, COM7_RESET, COM7_RESET) == 0, "%s", "reset write");
+    CHECK(s_fake.writes == writes + 1 && s_fake.order[s_fake.order_count - 1] == REG_COM7, "%s",
+          "reset not sent at once");
+    CHECK(sccb_cache_commit(&s_cache) == 0 && s_fake.writes == writes + 1, "%s", "pending write sent after reset");
+    CHECK(s_fake.regs[0x72] == (0x72 ^ 0x5A), "%s", "pending write reached the sensor");
+
+    // 缓存清空: 写入复位前的值不能被当作重复写入跳过, 读取走总线
+    writes = s_fake.writes;
+    CHECK(sccb_cache_write(&s_cache, 0x70, 0xFF, 0x01) == 0, "%s", "write after reset");
+    CHECK(s_fake.writes == writes + 1 && s_fake.regs[0x70] == 0x01, "%s", "write after reset skipped");
+    uint32_t reads = s_fake.reads;
+    CHECK(sccb_cache_read(&s_cache, 0x71) == (0x71 ^ 0x5A) && s_fake.reads == reads + 1, "%s",
+          "read after reset served from the cache");
+}
+
+int main(void)
+{
+    test_redundant_writes();
+    test_masked_writes();
+    test_volatile();
+    test_batch();
+    test_reset();
+    return test_report("sccb_cache_test");
+}
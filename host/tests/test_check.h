@@ -0,0 +1,30 @@
+/*
+ * Minimal checks for the host tests
+ * 主机端测试用的简单断言: 失败时打印位置继续运行, 最后以失败数作为退出码
+ */
+
+#pragma once
+
+#include <stdio.h>
+
+static int s_test_failures;
+
+#define CHECK(cond, ...)                                                        \
+    do {                                                                        \
+        if (!(cond)) {                                                          \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed: ", __FILE__, __LINE__, #cond); \
+            fprintf(stderr, __VA_ARGS__);                                       \
+            fputc('\n', stderr);                                                \
+            s_test_failures++;                                                  \
+        }                                                                       \
+    } while (0)
+
+static inline int test_report(const char *name)
+{
+    if (s_test_failures) {
+        fprintf(stderr, "%s: %d check(s) failed\n", name, s_test_failures);
+        return 1;
+    }
+    printf("%s: ok\n", name);
+    return 0;
+}
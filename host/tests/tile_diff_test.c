@@ -0,0 +1,173 @@
+/*
+ * tile_diff replayed over a known frame sequence
+ * 分块变化检测: 已知帧序列的合并矩形和发送字节数
+ *
+ * Each step edits the frame, runs tile_diff_update and compares the
+ * rectangles (in any order) and the bytes they cover with the expected
+ * ones: first frame and invalidate send everything, a static frame sends
+ * nothing, small edits send their tiles, drift below the threshold adds
+ * up until it is sent, scattered tiles are merged down to max_rects, and
+ * a large change falls back to the whole frame.
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "rgb565.h"
+#include "tile_diff.h"
+#include "test_check.h"
+
+#define W 128
+#define H 160
+#define T 16
+
+static uint16_t s_frame[W * H];
+static uint32_t s_total_bytes;
+
+static void fill(uint32_t x, uint32_t y, uint32_t w, uint32_t h, uint16_t cpu, uint32_t width)
+{
+    for (uint32_t j = y; j < y + h; j++) {
+        for (uint32_t i = x; i < x + w; i++) {
+            s_frame[j * width + i] = rgb565_swap(cpu);
+        }
+    }
+}
+
+static int rect_order(const void *a, const void *b)
+{
+    const frame_rect_t *p = a, *q = b;
+    return p->y != q->y ? (int)p->y - (int)q->y : (int)p->x - (int)q->x;
+}
+
+static void step(tile_diff_t *td, const char *name, const frame_rect_t *want, size_t want_count)
+{
+    frame_rect_t rects[TILE_DIFF_MAX_RECTS], sorted[TILE_DIFF_MAX_RECTS];
+    size_t count = tile_diff_update(td, s_frame, rects);
+    uint32_t bytes = 0, want_bytes = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        bytes += (uint32_t)rects[i].width * rects[i].height * 2;
+    }
+    for (size_t i = 0; i < want_count; i++) {
+        want_bytes += (uint32_t)want[i].width * want[i].height * 2;
+    }
+    s_total_bytes += bytes;
+
+    CHECK(count == want_count, "%s: %zu rects, want %zu", name, count, want_count);
+    CHECK(bytes == want_bytes, "%s: %u bytes, want %u", name, (unsigned)bytes, (unsigned)want_bytes);
+    if (count != want_count) {
+        return;
+    }
+    memcpy(sorted, want, want_count * sizeof(want[0]));
+    qsort(rects, count, sizeof(rects[0]), rect_order);
+    qsort(sorted, count, sizeof(sorted[0]), rect_order);
+    for (size_t i = 0; i < count; i++) {
+        CHECK(!memcmp(&rects[i], &sorted[i], sizeof(rects[i])), "%s: rect %zu is %u,%u %ux%u, want %u,%u %ux%u",
+              name, i, rects[i].x, rects[i].y, rects[i].width, rects[i].height, sorted[i].x, sorted[i].y,
+              sorted[i].width, sorted[i].height);
+    }
+    // 矩形互不重叠
+    for (size_t i = 0; i < count; i++) {
+        for (size_t j = i + 1; j < count; j++) {
+            const frame_rect_t *a = &rects[i], *b = &rects[j];
+            bool overlap = a->x < b->x + b->width && b->x < a->x + a->width && a->y < b->y + b->height &&
+                           b->y < a->y + a->height;
+            CHECK(!overlap, "%s: rects %zu and %zu overlap", name, i, j);
+        }
+    }
+}
+
+#define TILE(tx, ty, tw, th) {(tx) * T, (ty) * T, (tw) * T, (th) * T}
+
+static void test_replay(void)
+{
+    static tile_diff_t td;
+    const tile_diff_config_t config = {
+        .width = W, .height = H, .tile_size = T, .threshold = 4, .max_rects = 4, .full_percent = 50,
+    };
+    CHECK(tile_diff_init(&td, &config), "%s", "init");
+
+    const frame_rect_t full[] = {{0, 0, W, H}};
+    fill(0, 0, W, H, 0x4208, W);
+    step(&td, "first frame", full, 1);
+    step(&td, "static", NULL, 0);
+
+    // 一个块内的小方块; 跨两块的方块
+    fill(20, 20, 8, 8, 0xFFFF, W);
+    const frame_rect_t one[] = {TILE(1, 1, 1, 1)};
+    step(&td, "one tile", one, 1);
+    step(&td, "static again", NULL, 0);
+
+    fill(60, 100, 8, 8, 0xF800, W);
+    const frame_rect_t two_wide[] = {TILE(3, 6, 2, 1)};
+    step(&td, "two tiles", two_wide, 1);
+
+    // 两处不相邻的变化
+    fill(0, 0, 4, 4, 0x001F, W);
+    fill(120, 150, 4, 4, 0x07E0, W);
+    const frame_rect_t corners[] = {TILE(0, 0, 1, 1), TILE(7, 9, 1, 1)};
+    step(&td, "two corners", corners, 2);
+
+    // 缓慢变化: 每帧低于阈值, 与上次发送的内容比较, 累积到超过阈值时发送
+    const frame_rect_t drift[] = {TILE(4, 2, 1, 1)};
+    for (uint16_t g = 1; g <= 2; g++) {
+        fill(64, 32, T, T, (uint16_t)(0x4208 + (g << 5)), W);
+        step(&td, "drift below threshold", NULL, 0);
+    }
+    fill(64, 32, T, T, (uint16_t)(0x4208 + (5 << 5)), W);
+    step(&td, "drift adds up", drift, 1);
+
+    // 5 个分散的块, 最多 4 个矩形: (0,0) 与 (1,1) 合并代价最小
+    fill(0, 0, 2, 2, 0xFFFF, W);
+    fill(16, 16, 2, 2, 0x0000, W);
+    fill(112, 0, 2, 2, 0xFFFF, W);
+    fill(0, 144, 2, 2, 0xFFFF, W);
+    fill(112, 144, 2, 2, 0xFFFF, W);
+    const frame_rect_t merged[] = {TILE(0, 0, 2, 2), TILE(7, 0, 1, 1), TILE(0, 9, 1, 1), TILE(7, 9, 1, 1)};
+    step(&td, "merged to max_rects", merged, 4);
+
+    // 竖条: 同一跨度的段向下延伸成一个矩形
+    fill(32, 16, 32, 64, 0x07FF, W);
+    const frame_rect_t column[] = {TILE(2, 1, 2, 4)};
+    step(&td, "column", column, 1);
+
+    // 超过一半的块变化: 整帧
+    fill(0, 0, W, 96, 0x1234, W);
+    step(&td, "large change", full, 1);
+    step(&td, "static after full", NULL, 0);
+
+    tile_diff_invalidate(&td);
+    step(&td, "invalidated", full, 1);
+
+    // 整个序列发送的字节数
+    uint32_t want_total = 3 * W * H * 2 + (1 + 2 + 2 + 1 + 7 + 8) * T * T * 2;
+    CHECK(s_total_bytes == want_total, "replay sent %u bytes, want %u", (unsigned)s_total_bytes,
+          (unsigned)want_total);
+}
+
+// 宽高不是块大小整数倍: 最后一列/行的矩形截到帧边缘
+static void test_edges(void)
+{
+    static tile_diff_t td;
+    const tile_diff_config_t config = {
+        .width = 100, .height = 60, .tile_size = 32, .threshold = 4, .max_rects = 2, .full_percent = 75,
+    };
+    CHECK(tile_diff_init(&td, &config), "%s", "init 100x60");
+
+    fill(0, 0, 100, 60, 0x0000, 100);
+    const frame_rect_t full[] = {{0, 0, 100, 60}};
+    step(&td, "100x60 first frame", full, 1);
+
+    fill(98, 58, 2, 2, 0xFFFF, 100);
+    const frame_rect_t corner[] = {{96, 32, 4, 28}};
+    step(&td, "100x60 corner", corner, 1);
+
+    const tile_diff_config_t bad = {.width = 100, .height = 60, .tile_size = 6, .threshold = 4, .max_rects = 2};
+    CHECK(!tile_diff_init(&td, &bad), "%s", "tile size 6 accepted");
+}
+
+int main(void)
+{
+    test_replay();
+    test_edges();
+    return test_report("tile_diff_test");
+}
@@ -0,0 +1,163 @@
+/*
+ * YUYV conversion against a floating-point BT.601 reference
+ * YUYV 转换与浮点 BT.601 比较: 每通道误差不超过 1 LSB, 亮度平面等于采样点的 Y
+ *
+ * Every Y/U/V combination goes through yuv422_row_to_rgb565 once. The fused
+ * crop/scale/convert path is then run for the 160x120, 128x128 and
+ * 320x240 presets on random frames, whole and in bands, and each output
+ * pixel and luma byte is compared with the reference at the source pixel
+ * the old preview loops sampled.
+ */
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "frame_scaler.h"
+#include "rgb565.h"
+#include "yuv422.h"
+#include "test_check.h"
+
+#define LCD_W 128
+#define LCD_H 160
+
+static uint32_t to_bits(double v, int bits)
+{
+    long q = lround(v);
+    q = q < 0 ? 0 : (q > 255 ? 255 : q);
+    return (uint32_t)q >> (8 - bits);
+}
+
+// 全范围 BT.601, 结果为 CPU 字节序 RGB565
+static uint16_t reference(uint8_t y, uint8_t u, uint8_t v)
+{
+    double cb = u - 128.0, cr = v - 128.0;
+    return rgb565_pack(to_bits(y + 1.402 * cr, 5), to_bits(y - 0.344136 * cb - 0.714136 * cr, 6),
+                       to_bits(y + 1.772 * cb, 5));
+}
+
+static int channel_error(uint16_t got, uint16_t want)
+{
+    int dr = abs((int)rgb565_r(got) - (int)rgb565_r(want));
+    int dg = abs((int)rgb565_g(got) - (int)rgb565_g(want));
+    int db = abs((int)rgb565_b(got) - (int)rgb565_b(want));
+    int e = dr > dg ? dr : dg;
+    return e > db ? e : db;
+}
+
+static void test_all_values(void)
+{
+    static const uint16_t x_map[2] = {0, 1};
+    int worst = 0, reported = 0;
+
+    for (int u = 0; u < 256; u++) {
+        for (int v = 0; v < 256; v++) {
+            for (int y = 0; y < 256; y += 2) {
+                uint8_t row[4] = {(uint8_t)y, (uint8_t)u, (uint8_t)(y + 1), (uint8_t)v};
+                uint16_t out[2];
+                uint8_t luma[2];
+                yuv422_row_to_rgb565(row, x_map, out, luma, 2);
+                for (int k = 0; k < 2; k++) {
+                    uint16_t want = reference((uint8_t)(y + k), (uint8_t)u, (uint8_t)v);
+                    int e = channel_error(rgb565_swap(out[k]), want);
+                    worst = e > worst ? e : worst;
+                    if ((e > 1 || luma[k] != y + k) && reported++ < 8) {
+                        CHECK(e <= 1 && luma[k] == y + k, "Y %d U %d V %d: %04x, want %04x, luma %u", y + k, u, v,
+                              rgb565_swap(out[k]), want, luma[k]);
+                    }
+                }
+            }
+        }
+    }
+    printf("worst channel error %d LSB\n", worst);
+}
+
+typedef struct {
+    uint16_t width, height;
+    frame_scaler_mode_t mode;
+    uint16_t crop_width, crop_height;
+} preset_t;
+
+// 原预览循环的采样点, 返回 false 表示黑边
+static bool sample_at(const preset_t *p, uint32_t dx, uint32_t dy, uint32_t *sx, uint32_t *sy)
+{
+    if (p->mode == FRAME_SCALER_MODE_LETTERBOX) {
+        uint32_t off_x = (LCD_W - p->width) / 2, off_y = (LCD_H - p->height) / 2;
+        if (dx < off_x || dx >= off_x + p->width || dy < off_y || dy >= off_y + p->height) {
+            return false;
+        }
+        *sx = dx - off_x;
+        *sy = dy - off_y;
+        return true;
+    }
+    *sx = (p->width - p->crop_width) / 2 + (dx * p->crop_width) / LCD_W;
+    *sy = (p->height - p->crop_height) / 2 + (dy * p->crop_height) / LCD_H;
+    return true;
+}
+
+static void check_frame(const preset_t *p, const uint8_t *src, const uint16_t *dst, const uint8_t *luma,
+                        const char *how)
+{
+    for (uint32_t dy = 0; dy < LCD_H; dy++) {
+        for (uint32_t dx = 0; dx < LCD_W; dx++) {
+            uint32_t sx, sy, i = dy * LCD_W + dx;
+            uint16_t want = 0;
+            uint8_t want_y = 0;
+            if (sample_at(p, dx, dy, &sx, &sy)) {
+                const uint8_t *pair = src + ((size_t)sy * p->width + (sx & ~1u)) * 2;
+                want_y = src[((size_t)sy * p->width + sx) * 2];
+                want = reference(want_y, pair[1], pair[3]);
+            }
+            uint16_t got = rgb565_swap(dst[i]);
+            if (channel_error(got, want) > 1 || luma[i] != want_y) {
+                CHECK(0, "%ux%u %s at %u,%u: %04x luma %u, want %04x luma %u", p->width, p->height, how,
+                      (unsigned)dx, (unsigned)dy, got, luma[i], want, want_y);
+                return;
+            }
+        }
+    }
+}
+
+static void test_presets(void)
+{
+    static const preset_t presets[] = {
+        {160, 120, FRAME_SCALER_MODE_CROP, 128, 120},
+        {128, 128, FRAME_SCALER_MODE_LETTERBOX, 0, 0},
+        {320, 240, FRAME_SCALER_MODE_CROP, 256, 192},
+    };
+    static uint8_t src[320 * 240 * 2], luma[LCD_W * LCD_H];
+    static uint16_t dst[LCD_W * LCD_H];
+    static frame_scaler_t scaler;
+
+    for (size_t k = 0; k < sizeof(presets) / sizeof(presets[0]); k++) {
+        const preset_t *p = &presets[k];
+        frame_scaler_geometry_t g = {
+            .src_width = p->width, .src_height = p->height, .src_stride = p->width,
+            .dst_width = LCD_W, .dst_height = LCD_H,
+            .mode = p->mode, .crop_width = p->crop_width, .crop_height = p->crop_height,
+        };
+        CHECK(frame_scaler_configure(&scaler, &g), "%ux%u configure", p->width, p->height);
+        for (size_t i = 0; i < (size_t)p->width * p->height * 2; i++) {
+            src[i] = (uint8_t)rand();
+        }
+
+        memset(luma, 0xAA, sizeof(luma));
+        frame_scaler_run_yuv422_rows(&scaler, src, dst, luma, 0, LCD_H);
+        check_frame(p, src, dst, luma, "whole");
+
+        // 分段: 每段写到 dst/luma 的对应位置
+        memset(luma, 0xAA, sizeof(luma));
+        memset(dst, 0xAA, sizeof(dst));
+        for (uint32_t y = 0; y < LCD_H; y += 24) {
+            frame_scaler_run_yuv422_rows(&scaler, src, dst + y * LCD_W, luma + y * LCD_W, y, 24);
+        }
+        check_frame(p, src, dst, luma, "bands");
+    }
+}
+
+int main(void)
+{
+    srand(7);
+    test_all_values();
+    test_presets();
+    return test_report("yuv422_test");
+}
@@ -0,0 +1,263 @@
+/*
+ * Run the frame corruption checks over a corpus of captures
+ * 用已知好/坏的录制帧调整帧损坏检测的阈值
+ *
+ * Every clip is a raw file of consecutive frames (RGB565 big-endian or
+ * YUYV), labelled good or bad. Frames of good clips that are flagged are
+ * false positives, frames of bad clips that pass are misses; both are
+ * listed by class. With --synth every 4th frame of the good clips is also
+ * corrupted in each of the known ways (truncated, stale bottom rows,
+ * duplicate, colour bars, a lost byte, lost pixels) at a random row, to
+ * see which ones are caught. Good clips must be real captures: sensor
+ * noise is what keeps unchanged rows from matching the last frame.
+ *
+ *   ./build-host/frame_check_corpus good:capture.raw:320x240 bad:stripes.raw:160x120 --synth
+ *   ./build-host/frame_check_corpus good:capture.raw:320x240:yuv --set shift_ratio_pct=40
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "frame_check.h"
+
+typedef struct {
+    const char *name;
+    size_t offset;
+} config_field_t;
+
+#define FIELD(f) {#f, offsetof(frame_check_config_t, f)}
+static const config_field_t s_fields[] = {
+    FIELD(row_step), FIELD(pixel_step), FIELD(max_shift), FIELD(min_shift), FIELD(shift_ratio_pct), FIELD(shift_min_diff),
+    FIELD(shift_rows), FIELD(shift_pct), FIELD(phase_ratio_pct), FIELD(phase_rows), FIELD(stale_rows),
+    FIELD(match_active_pct), FIELD(truncated_rows), FIELD(pattern_pct),
+};
+#define FIELD_COUNT (sizeof(s_fields) / sizeof(s_fields[0]))
+
+typedef enum {
+    SYNTH_TRUNCATED = 0,
+    SYNTH_STALE,
+    SYNTH_DUPLICATE,
+    SYNTH_COLORBAR,
+    SYNTH_LOST_BYTE,
+    SYNTH_LOST_PIXELS,
+    SYNTH_COUNT
+} synth_kind_t;
+
+static const char *const s_synth_names[SYNTH_COUNT] = {
+    "truncated", "stale rows", "duplicate", "colour bars", "lost byte", "lost pixels",
+};
+
+typedef struct {
+    uint32_t frames;
+    uint32_t verdicts[FRAME_CHECK_CLASS_COUNT];
+} tally_t;
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr, "usage: %s good|bad:FILE:WIDTHxHEIGHT[:yuv] ... [--synth] [--seed N] [--set FIELD=VALUE]\n"
+            "fields:", argv0);
+    for (size_t i = 0; i < FIELD_COUNT; i++) {
+        fprintf(stderr, " %s", s_fields[i].name);
+    }
+    fprintf(stderr, "\n");
+    exit(2);
+}
+
+static void print_tally(const char *label, const tally_t *t, bool want_ok)
+{
+    uint32_t hits = t->frames - t->verdicts[FRAME_CHECK_OK];
+    uint32_t wrong = want_ok ? hits : t->verdicts[FRAME_CHECK_OK];
+    printf("%-22s %6u frames, %6u %s (%5.1f%%) |", label, t->frames, wrong, want_ok ? "flagged" : "missed",
+           t->frames ? 100.0 * wrong / t->frames : 0.0);
+    for (int c = 1; c < FRAME_CHECK_CLASS_COUNT; c++) {
+        if (t->verdicts[c]) {
+            printf(" %s %u", frame_check_class_name((frame_check_class_t)c), t->verdicts[c]);
+        }
+    }
+    printf("\n");
+}
+
+// 原 OV7670 彩条测试图: 8 条竖条
+static void make_colorbar(uint8_t *frame, uint32_t w, uint32_t h, bool yuyv)
+{
+    static const uint16_t rgb[8] = {0xFFFF, 0xFFE0, 0x07FF, 0x07E0, 0xF81F, 0xF800, 0x001F, 0x0000};
+    static const uint8_t yuv[8][3] = {{235, 128, 128}, {210, 16, 146}, {170, 166, 16}, {145, 54, 34},
+                                      {106, 202, 222}, {81, 90, 240}, {41, 240, 110}, {16, 128, 128}};
+    for (uint32_t y = 0; y < h; y++) {
+        for (uint32_t x = 0; x < w; x++) {
+            uint32_t bar = x * 8 / w;
+            uint8_t *p = frame + (y * w + x) * 2;
+            if (yuyv) {
+                p[0] = yuv[bar][0];
+                p[1] = yuv[bar][1 + (x & 1)];
+            } else {
+                p[0] = rgb[bar] >> 8;
+                p[1] = rgb[bar] & 0xFF;
+            }
+        }
+    }
+}
+
+// 在第 y 行的某处丢掉 bytes 个字节, 后面的数据整体前移, 末尾补上最后一个字节
+static void drop_bytes(uint8_t *frame, size_t frame_bytes, size_t at, size_t bytes)
+{
+    memmove(frame + at, frame + at + bytes, frame_bytes - at - bytes);
+    memset(frame + frame_bytes - bytes, frame[frame_bytes - bytes - 1], bytes);
+}
+
+static void corrupt(synth_kind_t kind, uint8_t *frame, const uint8_t *prev, uint32_t w, uint32_t h, bool yuyv)
+{
+    size_t row_bytes = (size_t)w * 2, frame_bytes = row_bytes * h;
+    uint32_t y = h / 8 + (uint32_t)rand() % (h * 3 / 4);
+    size_t at = y * row_bytes + (size_t)(rand() % w) * 2;
+
+    switch (kind) {
+    case SYNTH_TRUNCATED:
+        memset(frame + y * row_bytes, 0, frame_bytes - y * row_bytes);
+        break;
+    case SYNTH_STALE:
+        memcpy(frame + y * row_bytes, prev + y * row_bytes, frame_bytes - y * row_bytes);
+        break;
+    case SYNTH_DUPLICATE:
+        memcpy(frame, prev, frame_bytes);
+        break;
+    case SYNTH_COLORBAR:
+        make_colorbar(frame, w, h, yuyv);
+        break;
+    case SYNTH_LOST_BYTE:
+        drop_bytes(frame, frame_bytes, at, 1);
+        break;
+    case SYNTH_LOST_PIXELS:
+        // YUYV 丢的像素数取偶数, 否则 U/V 也会错位
+        drop_bytes(frame, frame_bytes, at, (size_t)(1 + rand() % 8) * (yuyv ? 4 : 2));
+        break;
+    default:
+        break;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    frame_check_config_t config = FRAME_CHECK_CONFIG_DEFAULT();
+    bool synth = false;
+    unsigned seed = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--synth")) {
+            synth = true;
+        } else if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+            seed = (unsigned)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--set") && i + 1 < argc) {
+            char name[64];
+            unsigned value;
+            size_t f = FIELD_COUNT;
+            if (sscanf(argv[++i], "%63[a-z_]=%u", name, &value) == 2 && value <= 255) {
+                for (f = 0; f < FIELD_COUNT && strcmp(s_fields[f].name, name); f++) {
+                }
+            }
+            if (f == FIELD_COUNT) {
+                usage(argv[0]);
+            }
+            *((uint8_t *)&config + s_fields[f].offset) = (uint8_t)value;
+        } else if (strncmp(argv[i], "good:", 5) && strncmp(argv[i], "bad:", 4)) {
+            usage(argv[0]);
+        }
+    }
+    srand(seed);
+
+    printf("config:");
+    for (size_t f = 0; f < FIELD_COUNT; f++) {
+        printf(" %s=%u", s_fields[f].name, *((uint8_t *)&config + s_fields[f].offset));
+    }
+    printf("\n\n");
+
+    static frame_check_t check;
+    tally_t good = {0}, bad = {0}, synth_tally[SYNTH_COUNT] = {{0}};
+    double check_ns = 0;
+    uint32_t checked = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--seed") || !strcmp(argv[i], "--set")) {
+            i++;
+            continue;
+        }
+        if (strncmp(argv[i], "good:", 5) && strncmp(argv[i], "bad:", 4)) {
+            continue;
+        }
+        bool is_good = argv[i][0] == 'g';
+        char path[1024], format[8] = "";
+        unsigned w, h;
+        if (sscanf(argv[i] + (is_good ? 5 : 4), "%1023[^:]:%ux%u:%7s", path, &w, &h, format) < 3 || !w || !h) {
+            usage(argv[0]);
+        }
+        bool yuyv = !strcmp(format, "yuv");
+        FILE *f = fopen(path, "rb");
+        if (f == NULL) {
+            fprintf(stderr, "Cannot open %s\n", path);
+            return 1;
+        }
+        size_t frame_bytes = (size_t)w * h * 2;
+        uint8_t *frame = malloc(frame_bytes), *prev = malloc(frame_bytes), *work = malloc(frame_bytes);
+        static frame_check_t synth_check[SYNTH_COUNT];
+        frame_check_init(&check, &config);
+        for (int k = 0; k < SYNTH_COUNT; k++) {
+            frame_check_init(&synth_check[k], &config);
+        }
+
+        tally_t clip = {0};
+        for (uint32_t n = 0; fread(frame, 1, frame_bytes, f) == frame_bytes; n++) {
+            struct timespec t0, t1;
+            clock_gettime(CLOCK_MONOTONIC, &t0);
+            frame_check_class_t verdict = frame_check_run(&check, frame, frame_bytes, w, h, yuyv, NULL);
+            clock_gettime(CLOCK_MONOTONIC, &t1);
+            check_ns += (t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec);
+            checked++;
+            clip.frames++;
+            clip.verdicts[verdict]++;
+
+            // 合成的坏帧: 每4帧损坏一帧, 其余原样送入, 历史与实际运行时相同
+            for (int k = 0; synth && is_good && k < SYNTH_COUNT; k++) {
+                memcpy(work, frame, frame_bytes);
+                bool corrupted = n > 0 && n % 4 == 0;
+                if (corrupted) {
+                    corrupt((synth_kind_t)k, work, prev, w, h, yuyv);
+                }
+                verdict = frame_check_run(&synth_check[k], work, frame_bytes, w, h, yuyv, NULL);
+                if (corrupted) {
+                    synth_tally[k].frames++;
+                    synth_tally[k].verdicts[verdict]++;
+                }
+            }
+            memcpy(prev, frame, frame_bytes);
+        }
+        fclose(f);
+        free(frame);
+        free(prev);
+        free(work);
+
+        char label[64];
+        snprintf(label, sizeof(label), "%s %ux%u%s", is_good ? "good" : "bad", w, h, yuyv ? " yuv" : "");
+        print_tally(label, &clip, is_good);
+        printf("  %s\n", path);
+        tally_t *total = is_good ? &good : &bad;
+        total->frames += clip.frames;
+        for (int c = 0; c < FRAME_CHECK_CLASS_COUNT; c++) {
+            total->verdicts[c] += clip.verdicts[c];
+        }
+    }
+
+    printf("\n");
+    if (good.frames) {
+        print_tally("good (false positives)", &good, true);
+    }
+    if (bad.frames) {
+        print_tally("bad (misses)", &bad, false);
+    }
+    for (int k = 0; synth && k < SYNTH_COUNT; k++) {
+        char label[64];
+        snprintf(label, sizeof(label), "synth %s", s_synth_names[k]);
+        print_tally(label, &synth_tally[k], false);
+    }
+    printf("\n%.1f us per frame on this host\n", checked ? check_ns / checked / 1000.0 : 0.0);
+    return 0;
+}
@@ -0,0 +1,217 @@
+/*
+ * Decode a frame recorder partition dump to PNG files
+ * 把录制分区的内容解码成 PNG 序列
+ *
+ * Reads the whole partition (frame_record.h), finds every record with a
+ * valid header and payload CRC, and writes them in recording order as
+ * DIR/frame_<seq>.png. Read the partition from the device with
+ *
+ *   parttool.py -p PORT read_partition --partition-name framerec --output framerec.bin
+ *   ./build-host/frame_rec_decode framerec.bin frames/
+ *
+ * The PNGs are uncompressed (stored deflate blocks), so no zlib is needed.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "frame_record.h"
+#include "rgb565_codec.h"
+
+typedef struct {
+    frame_record_header_t header;
+    size_t offset;
+} found_record_t;
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr, "usage: %s PARTITION.bin OUT_DIR [--list]\n", argv0);
+    exit(2);
+}
+
+static void put_be32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static void write_chunk(FILE *f, const char *type, const uint8_t *data, size_t bytes)
+{
+    uint8_t word[4];
+    put_be32(word, (uint32_t)bytes);
+    fwrite(word, 1, 4, f);
+    fwrite(type, 1, 4, f);
+    if (bytes > 0) {
+        fwrite(data, 1, bytes, f);
+    }
+    // PNG 的 CRC 与记录的 CRC 相同 (IEEE), 覆盖类型和数据
+    put_be32(word, frame_record_crc32(frame_record_crc32(0, type, 4), data, bytes));
+    fwrite(word, 1, 4, f);
+}
+
+static int write_png(const char *path, const uint16_t *pixels, uint32_t width, uint32_t height)
+{
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        return -1;
+    }
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    fwrite(signature, 1, sizeof(signature), f);
+
+    uint8_t ihdr[13] = {0};
+    put_be32(ihdr, width);
+    put_be32(ihdr + 4, height);
+    ihdr[8] = 8; // 8 位 RGB
+    ihdr[9] = 2;
+    write_chunk(f, "IHDR", ihdr, sizeof(ihdr));
+
+    // 每行: 过滤类型 0 + RGB; zlib 流由不压缩的 deflate 块组成
+    size_t row_bytes = 1 + (size_t)width * 3;
+    size_t raw_bytes = row_bytes * height;
+    size_t blocks = (raw_bytes + 65534) / 65535;
+    uint8_t *raw = malloc(raw_bytes);
+    uint8_t *idat = malloc(2 + raw_bytes + blocks * 5 + 4);
+    if (raw == NULL || idat == NULL) {
+        fclose(f);
+        free(raw);
+        free(idat);
+        return -1;
+    }
+    for (uint32_t y = 0; y < height; y++) {
+        uint8_t *row = raw + y * row_bytes;
+        row[0] = 0;
+        for (uint32_t x = 0; x < width; x++) {
+            const uint8_t *be = (const uint8_t *)&pixels[y * width + x];
+            uint32_t p = (uint32_t)be[0] << 8 | be[1];
+            row[1 + x * 3] = (uint8_t)((p >> 11) * 255 / 31);
+            row[2 + x * 3] = (uint8_t)(((p >> 5) & 0x3F) * 255 / 63);
+            row[3 + x * 3] = (uint8_t)((p & 0x1F) * 255 / 31);
+        }
+    }
+    uint8_t *o = idat;
+    *o++ = 0x78;
+    *o++ = 0x01;
+    uint32_t a = 1, b = 0;
+    for (size_t pos = 0; pos < raw_bytes;) {
+        size_t n = raw_bytes - pos < 65535 ? raw_bytes - pos : 65535;
+        *o++ = pos + n == raw_bytes; // BFINAL, 不压缩
+        *o++ = (uint8_t)n;
+        *o++ = (uint8_t)(n >> 8);
+        *o++ = (uint8_t)~n;
+        *o++ = (uint8_t)(~n >> 8);
+        memcpy(o, raw + pos, n);
+        for (size_t i = 0; i < n; i++) {
+            a = (a + raw[pos + i]) % 65521;
+            b = (b + a) % 65521;
+        }
+        o += n;
+        pos += n;
+    }
+    put_be32(o, b << 16 | a); // Adler-32
+    o += 4;
+    write_chunk(f, "IDAT", idat, o - idat);
+    write_chunk(f, "IEND", NULL, 0);
+    free(raw);
+    free(idat);
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+static int by_seq(const void *a, const void *b)
+{
+    uint32_t sa = ((const found_record_t *)a)->header.seq, sb = ((const found_record_t *)b)->header.seq;
+    return sa < sb ? -1 : sa > sb;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3) {
+        usage(argv[0]);
+    }
+    bool list_only = argc > 3 && !strcmp(argv[3], "--list");
+
+    FILE *f = fopen(argv[1], "rb");
+    if (f == NULL) {
+        fprintf(stderr, "Cannot open %s\n", argv[1]);
+        return 1;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *part = malloc(size > 0 ? size : 1);
+    if (part == NULL || fread(part, 1, size, f) != (size_t)size) {
+        fprintf(stderr, "Cannot read %s\n", argv[1]);
+        return 1;
+    }
+    fclose(f);
+
+    // 环形区回绕后新旧记录交错, 逐个对齐位置找有效的记录头
+    size_t capacity = 256, count = 0, bad_payload = 0;
+    found_record_t *records = malloc(capacity * sizeof(*records));
+    for (size_t offset = 0; offset + sizeof(frame_record_header_t) <= (size_t)size;) {
+        frame_record_header_t header;
+        memcpy(&header, part + offset, sizeof(header));
+        if (!frame_record_valid(&header, size - offset)) {
+            offset += FRAME_RECORD_ALIGN;
+            continue;
+        }
+        if (frame_record_crc32(0, part + offset + sizeof(header), header.payload_bytes) != header.payload_crc) {
+            bad_payload++; // 记录头有效, 数据已被后来的扇区擦除或覆盖
+            offset += FRAME_RECORD_ALIGN;
+            continue;
+        }
+        if (count == capacity) {
+            capacity *= 2;
+            records = realloc(records, capacity * sizeof(*records));
+        }
+        records[count++] = (found_record_t) {header, offset};
+        offset += frame_record_size(&header);
+    }
+    qsort(records, count, sizeof(*records), by_seq);
+
+    size_t written = 0, failed = 0, raw_total = 0, stored_total = 0;
+    for (size_t i = 0; i < count; i++) {
+        const frame_record_header_t *h = &records[i].header;
+        size_t pixels = (size_t)h->width * h->height;
+        if (list_only) {
+            printf("#%-6u %9.3f s  %ux%u  %6u bytes  at 0x%06zx%s\n", h->seq, h->time_ms / 1000.0,
+                   h->width, h->height, h->payload_bytes, records[i].offset,
+                   h->flags & FRAME_RECORD_FLAG_SESSION_START ? "  (boot)" : "");
+            continue;
+        }
+        uint16_t *image = malloc(pixels * sizeof(uint16_t));
+        const uint8_t *payload = part + records[i].offset + sizeof(*h);
+        if (h->format != FRAME_RECORD_FORMAT_RGB565_CODEC || image == NULL ||
+            rgb565_codec_decode(payload, h->payload_bytes, image, pixels) != h->payload_bytes) {
+            fprintf(stderr, "Frame #%u: cannot decode\n", h->seq);
+            failed++;
+            free(image);
+            continue;
+        }
+        char path[1024];
+        snprintf(path, sizeof(path), "%s/frame_%06u.png", argv[2], h->seq);
+        if (write_png(path, image, h->width, h->height) == 0) {
+            written++;
+            raw_total += pixels * sizeof(uint16_t);
+            stored_total += frame_record_size(h);
+        } else {
+            failed++;
+        }
+        free(image);
+    }
+
+    if (count > 0) {
+        printf("%zu frames (#%u .. #%u)", count, records[0].header.seq, records[count - 1].header.seq);
+    } else {
+        printf("no frames");
+    }
+    if (!list_only) {
+        printf(", %zu written to %s, %.1f%% of raw RGB565", written, argv[2],
+               raw_total ? 100.0 * stored_total / raw_total : 0.0);
+    }
+    printf(" | %zu failed, %zu overwritten\n", failed, bad_payload);
+    free(records);
+    free(part);
+    return failed > 0;
+}
@@ -0,0 +1,137 @@
+/*
+ * Replay a raw clip through the motion detector
+ * 用录制的原始帧回放运动检测, 调整阈值
+ *
+ * Each frame is reduced to a luma thumbnail with frame_scaler (2x2 box,
+ * the whole frame, as the pipeline does for the 1:1 profiles) and scored
+ * with motion_detect.h, using the thresholds of example_config.h unless
+ * overridden. Prints the motion events, or one CSV line per frame with
+ * --csv, and how many frames the display would have skipped.
+ *
+ *   ./build-host/motion_replay capture.raw 320x240 [--yuv] [--fps N] [--csv]
+ *       [--thumb WxH] [--pixel N] [--start PERMILLE FRAMES] [--stop PERMILLE FRAMES]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "example_config.h"
+#include "frame_scaler.h"
+#include "motion_detect.h"
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr, "usage: %s FILE WIDTHxHEIGHT [--yuv] [--fps N] [--csv] [--thumb WxH] [--pixel N] "
+            "[--start PERMILLE FRAMES] [--stop PERMILLE FRAMES]\n", argv0);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned width = 0, height = 0, thumb_w = EXAMPLE_MOTION_THUMB_WIDTH, thumb_h = EXAMPLE_MOTION_THUMB_HEIGHT;
+    unsigned start_permille = EXAMPLE_MOTION_START_PERMILLE, start_frames = EXAMPLE_MOTION_START_FRAMES;
+    unsigned stop_permille = EXAMPLE_MOTION_STOP_PERMILLE, stop_frames = EXAMPLE_MOTION_STOP_FRAMES;
+    unsigned pixel = EXAMPLE_MOTION_PIXEL_THRESHOLD;
+    bool yuv = false, csv = false;
+    double fps = 30;
+
+    if (argc < 3 || sscanf(argv[2], "%ux%u", &width, &height) != 2 || !width || !height) {
+        usage(argv[0]);
+    }
+    for (int i = 3; i < argc; i++) {
+        if (!strcmp(argv[i], "--yuv")) {
+            yuv = true;
+        } else if (!strcmp(argv[i], "--csv")) {
+            csv = true;
+        } else if (!strcmp(argv[i], "--fps") && i + 1 < argc) {
+            fps = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--thumb") && i + 1 < argc) {
+            if (sscanf(argv[++i], "%ux%u", &thumb_w, &thumb_h) != 2) {
+                usage(argv[0]);
+            }
+        } else if (!strcmp(argv[i], "--pixel") && i + 1 < argc) {
+            pixel = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--start") && i + 2 < argc) {
+            start_permille = atoi(argv[++i]);
+            start_frames = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--stop") && i + 2 < argc) {
+            stop_permille = atoi(argv[++i]);
+            stop_frames = atoi(argv[++i]);
+        } else {
+            usage(argv[0]);
+        }
+    }
+    if (fps <= 0 || pixel > 255 || start_frames > 255) {
+        usage(argv[0]);
+    }
+
+    static frame_scaler_t scaler;
+    frame_scaler_geometry_t geometry = {
+        .src_width = width,
+        .src_height = height,
+        .src_stride = width,
+        .dst_width = thumb_w,
+        .dst_height = thumb_h,
+        .mode = FRAME_SCALER_MODE_CROP,
+        .filter = FRAME_SCALER_FILTER_BOX,
+    };
+    static motion_detect_t motion;
+    motion_config_t config = {
+        .width = thumb_w,
+        .height = thumb_h,
+        .pixel_threshold = pixel,
+        .start_frames = start_frames,
+        .start_permille = start_permille,
+        .stop_permille = stop_permille,
+        .stop_frames = stop_frames,
+    };
+    if (!frame_scaler_configure(&scaler, &geometry) || !motion_detect_init(&motion, &config)) {
+        fprintf(stderr, "Unsupported size: %ux%u -> %ux%u (at most %d thumbnail pixels)\n",
+                width, height, thumb_w, thumb_h, MOTION_THUMB_MAX_PIXELS);
+        return 1;
+    }
+
+    FILE *f = fopen(argv[1], "rb");
+    if (f == NULL) {
+        fprintf(stderr, "Cannot open %s\n", argv[1]);
+        return 1;
+    }
+    size_t frame_bytes = (size_t)width * height * 2;
+    uint8_t *frame = malloc(frame_bytes);
+    uint16_t *thumb_rgb = malloc((size_t)thumb_w * thumb_h * sizeof(uint16_t));
+    uint8_t *thumb = malloc((size_t)thumb_w * thumb_h);
+    if (frame == NULL || thumb_rgb == NULL || thumb == NULL) {
+        return 1;
+    }
+
+    uint32_t frames = 0, idle = 0, events = 0;
+    if (csv) {
+        printf("frame,time_s,score_permille,brightness,moving\n");
+    }
+    while (fread(frame, 1, frame_bytes, f) == frame_bytes) {
+        if (yuv) {
+            frame_scaler_run_yuv422_rows(&scaler, frame, thumb_rgb, thumb, 0, thumb_h);
+        } else {
+            frame_scaler_run_rows(&scaler, (const uint16_t *)frame, thumb_rgb, 0, thumb_h);
+            motion_luma_rgb565(thumb_rgb, thumb, (size_t)thumb_w * thumb_h);
+        }
+        motion_event_t event = motion_detect_update(&motion, thumb);
+        double t = frames / fps;
+        if (csv) {
+            printf("%u,%.3f,%u,%d,%d\n", frames, t, motion.score, motion.brightness, motion.moving);
+        } else if (event != MOTION_EVENT_NONE) {
+            printf("%8.3f s  frame %-6u %s (score %u permille)\n", t, frames,
+                   event == MOTION_EVENT_START ? "motion" : "static", motion.score);
+        }
+        events += event != MOTION_EVENT_NONE;
+        idle += !motion.moving;
+        frames++;
+    }
+    fclose(f);
+
+    fprintf(csv ? stderr : stdout, "%u frames, %u events, %u idle (%.1f%%), %s at the end\n",
+            frames, events, idle, frames ? 100.0 * idle / frames : 0.0, motion.moving ? "moving" : "static");
+    free(frame);
+    free(thumb_rgb);
+    free(thumb);
+    return 0;
+}
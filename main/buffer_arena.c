@@ -0,0 +1,235 @@
+/*
+ * Boot-time buffer arena
+ * 启动时一次性预留的缓冲区
+ */
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "sdkconfig.h"
+#include "example_config.h"
+#include "buffer_arena.h"
+
+static const char *TAG = "buffer_arena";
+
+typedef struct {
+    const char *name;
+    uint32_t caps;
+    uint32_t align;
+} region_info_t;
+
+static const region_info_t s_regions[BUFFER_ARENA_REGION_COUNT] = {
+    [BUFFER_ARENA_INTERNAL_DMA] = {"internal DMA", MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL, 4},
+    [BUFFER_ARENA_PSRAM] = {"PSRAM", MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT, 4},
+    // 缓冲区之间不共享缓存行, 写回/失效一块不会波及相邻的一块
+    [BUFFER_ARENA_PSRAM_DMA] = {"PSRAM DMA", MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT, BUFFER_ARENA_CACHE_LINE},
+};
+
+void buffer_arena_init(buffer_arena_t *arena)
+{
+    memset(arena, 0, sizeof(*arena));
+}
+
+esp_err_t buffer_arena_request(buffer_arena_t *arena, const char *name, buffer_arena_region_t region,
+                               size_t size, uint32_t count, void **out)
+{
+    if (arena->committed) {
+        ESP_LOGE(TAG, "%s requested after commit", name);
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (region >= BUFFER_ARENA_REGION_COUNT || size == 0 || count == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (arena->entry_count == BUFFER_ARENA_MAX_ENTRIES) {
+        ESP_LOGE(TAG, "More than %d buffer requests", BUFFER_ARENA_MAX_ENTRIES);
+        return ESP_ERR_NO_MEM;
+    }
+    uint32_t align = s_regions[region].align;
+    buffer_arena_entry_t *entry = &arena->entries[arena->entry_count++];
+    *entry = (buffer_arena_entry_t) {
+        .name = name,
+        .region = region,
+        .size = (uint32_t)((size + align - 1) & ~(size_t)(align - 1)),
+        .count = count,
+        .out = out,
+        .offset = arena->used[region],
+    };
+    arena->used[region] += entry->size * count;
+    return ESP_OK;
+}
+
+static void log_budget(const buffer_arena_t *arena, const size_t *largest)
+{
+    ESP_LOGI(TAG, "Buffer budget:");
+    ESP_LOGI(TAG, "  %-16s %-13s %15s %9s", "buffer", "region", "size", "bytes");
+    for (uint32_t i = 0; i < arena->entry_count; i++) {
+        const buffer_arena_entry_t *e = &arena->entries[i];
+        ESP_LOGI(TAG, "  %-16s %-13s %7" PRIu32 " x %-5" PRIu32 " %9" PRIu32, e->name, s_regions[e->region].name,
+                 e->size, e->count, e->size * e->count);
+    }
+    ESP_LOGI(TAG, "  %-13s %9s %9s %13s", "region", "needed", "free", "largest block");
+    for (int r = 0; r < BUFFER_ARENA_REGION_COUNT; r++) {
+        if (arena->used[r] == 0) {
+            continue;
+        }
+        size_t free_bytes = heap_caps_get_free_size(s_regions[r].caps);
+        if (arena->used[r] <= largest[r]) {
+            ESP_LOGI(TAG, "  %-13s %9" PRIu32 " %9u %13u ✓", s_regions[r].name, arena->used[r],
+                     (unsigned)free_bytes, (unsigned)largest[r]);
+        } else {
+            ESP_LOGE(TAG, "  %-13s %9" PRIu32 " %9u %13u ✗ does not fit", s_regions[r].name, arena->used[r],
+                     (unsigned)free_bytes, (unsigned)largest[r]);
+        }
+    }
+}
+
+esp_err_t buffer_arena_commit(buffer_arena_t *arena)
+{
+    size_t largest[BUFFER_ARENA_REGION_COUNT] = {0};
+    bool fits = true;
+
+    if (arena->committed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    // 每个区域一整块: 堆还没有碎片时最容易拿到
+    for (int r = 0; r < BUFFER_ARENA_REGION_COUNT; r++) {
+        if (arena->used[r] > 0) {
+            largest[r] = heap_caps_get_largest_free_block(s_regions[r].caps);
+            fits = fits && arena->used[r] <= largest[r];
+        }
+    }
+    log_budget(arena, largest);
+    if (!fits) {
+        ESP_LOGE(TAG, "Buffers do not fit, reduce the buffer counts/sizes in example_config.h");
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (int r = 0; r < BUFFER_ARENA_REGION_COUNT; r++) {
+        if (arena->used[r] == 0) {
+            continue;
+        }
+        arena->base[r] = heap_caps_aligned_alloc(s_regions[r].align, arena->used[r], s_regions[r].caps);
+        if (arena->base[r] == NULL) {
+            // 对齐开销或并发分配让最大块估计失准
+            ESP_LOGE(TAG, "Failed to reserve %" PRIu32 " bytes of %s", arena->used[r], s_regions[r].name);
+            return ESP_ERR_NO_MEM;
+        }
+        memset(arena->base[r], 0, arena->used[r]);
+    }
+    uint32_t buffers = 0;
+    for (uint32_t i = 0; i < arena->entry_count; i++) {
+        const buffer_arena_entry_t *e = &arena->entries[i];
+        for (uint32_t n = 0; n < e->count; n++) {
+            e->out[n] = arena->base[e->region] + e->offset + n * e->size;
+        }
+        buffers += e->count;
+    }
+    arena->committed = true;
+    ESP_LOGI(TAG, "✓ %" PRIu32 " buffers reserved: %" PRIu32 " bytes internal DMA, %" PRIu32 " bytes PSRAM",
+             buffers, arena->used[BUFFER_ARENA_INTERNAL_DMA],
+             arena->used[BUFFER_ARENA_PSRAM] + arena->used[BUFFER_ARENA_PSRAM_DMA]);
+#if EXAMPLE_ARENA_ALLOC_GUARD && !CONFIG_HEAP_USE_HOOKS
+    ESP_LOGW(TAG, "⚠ Allocation guard needs CONFIG_HEAP_USE_HOOKS, not active");
+#endif
+    return ESP_OK;
+}
+
+void buffer_arena_log_heap(const char *when)
+{
+    ESP_LOGI(TAG, "Heap %s: internal DMA %u free (largest block %u), PSRAM %u free (largest block %u)", when,
+             (unsigned)heap_caps_get_free_size(MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL),
+             (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL),
+             (unsigned)heap_caps_get_free_size(MALLOC_CAP_SPIRAM),
+             (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM));
+}
+
+#if EXAMPLE_ARENA_ALLOC_GUARD && CONFIG_HEAP_USE_HOOKS
+#include "esp_rom_sys.h"
+
+#define GUARD_TASKS 4 // 采集/转换/显示任务
+
+static atomic_uintptr_t s_guard_task[GUARD_TASKS];
+static atomic_bool s_guard_active[GUARD_TASKS];
+static atomic_uint_least32_t s_violations;
+static volatile uint32_t s_last_size;
+
+// 当前任务的槽位, 第一次进入时登记
+static int guard_slot(void)
+{
+    uintptr_t task = (uintptr_t)xTaskGetCurrentTaskHandle();
+    for (int i = 0; i < GUARD_TASKS; i++) {
+        uintptr_t expected = 0;
+        if (atomic_load(&s_guard_task[i]) == task ||
+            atomic_compare_exchange_strong(&s_guard_task[i], &expected, task)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void buffer_arena_guard_enter(void)
+{
+    int slot = guard_slot();
+    if (slot >= 0) {
+        atomic_store(&s_guard_active[slot], true);
+    }
+}
+
+void buffer_arena_guard_exit(void)
+{
+    int slot = guard_slot();
+    if (slot >= 0) {
+        atomic_store(&s_guard_active[slot], false);
+    }
+}
+
+uint32_t buffer_arena_guard_violations(uint32_t *last_size)
+{
+    *last_size = s_last_size;
+    return atomic_load(&s_violations);
+}
+
+// CONFIG_HEAP_USE_HOOKS: 每次成功分配后由堆调用, 在分配者的上下文里
+void IRAM_ATTR esp_heap_trace_alloc_hook(void *ptr, size_t size, uint32_t caps)
+{
+    uintptr_t task = (uintptr_t)xTaskGetCurrentTaskHandle();
+    if (task == 0) {
+        return;
+    }
+    for (int i = 0; i < GUARD_TASKS; i++) {
+        if (atomic_load_explicit(&s_guard_task[i], memory_order_relaxed) == task &&
+            atomic_load_explicit(&s_guard_active[i], memory_order_relaxed)) {
+            s_last_size = size;
+            atomic_fetch_add_explicit(&s_violations, 1, memory_order_relaxed);
+#if EXAMPLE_ARENA_ALLOC_GUARD == 2
+            esp_rom_printf("buffer_arena: %u byte heap allocation in the frame loop\n", (unsigned)size);
+            abort();
+#endif
+            return;
+        }
+    }
+}
+
+void IRAM_ATTR esp_heap_trace_free_hook(void *ptr)
+{
+}
+#else
+void buffer_arena_guard_enter(void)
+{
+}
+
+void buffer_arena_guard_exit(void)
+{
+}
+
+uint32_t buffer_arena_guard_violations(uint32_t *last_size)
+{
+    *last_size = 0;
+    return 0;
+}
+#endif
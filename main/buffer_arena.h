@@ -0,0 +1,84 @@
+/*
+ * Boot-time buffer arena
+ * 启动时一次性预留所有流水线缓冲区：按内存能力分区，放不下时打印预算表并立即失败
+ *
+ * Modules request their buffers (name, region, size, count) during
+ * start-up; buffer_arena_commit() then takes one block per region from
+ * the heap while it is still unfragmented, carves the requests out of it
+ * and writes the pointers back. Nothing is ever freed, so the heap never
+ * sees these buffers come and go and long uptimes cannot fragment them.
+ * If a region does not fit, the whole budget table is logged next to the
+ * free and largest-block sizes and commit fails before anything starts.
+ *
+ * The allocation guard (EXAMPLE_ARENA_ALLOC_GUARD, needs
+ * CONFIG_HEAP_USE_HOOKS) counts heap allocations made by a task between
+ * guard_enter and guard_exit, i.e. inside the frame loop; mode 2 aborts
+ * at the offending allocation so the backtrace shows the caller.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define BUFFER_ARENA_MAX_ENTRIES 16
+#define BUFFER_ARENA_CACHE_LINE 64 // PSRAM DMA 缓冲区的对齐与补齐 (ESP32-S3 数据缓存行最大 64 字节)
+
+typedef enum {
+    BUFFER_ARENA_INTERNAL_DMA = 0, // 内部 RAM, SPI/GDMA 可直接读写
+    BUFFER_ARENA_PSRAM,            // PSRAM, 只由 CPU 访问
+    BUFFER_ARENA_PSRAM_DMA,        // PSRAM, 按缓存行对齐与补齐, DMA 前后用 esp_cache_msync
+    BUFFER_ARENA_REGION_COUNT
+} buffer_arena_region_t;
+
+typedef struct {
+    const char *name;
+    buffer_arena_region_t region;
+    uint32_t size;          // 每块字节数, 已按区域对齐补齐
+    uint32_t count;
+    void **out;             // count 个指针, 提交时写入
+    uint32_t offset;        // 第一块在区域内的偏移
+} buffer_arena_entry_t;
+
+typedef struct {
+    buffer_arena_entry_t entries[BUFFER_ARENA_MAX_ENTRIES];
+    uint32_t entry_count;
+    uint32_t used[BUFFER_ARENA_REGION_COUNT];
+    uint8_t *base[BUFFER_ARENA_REGION_COUNT];
+    bool committed;
+} buffer_arena_t;
+
+void buffer_arena_init(buffer_arena_t *arena);
+
+// Ask for count buffers of size bytes each; out (count pointers) is filled
+// by commit. name must be a string literal or otherwise outlive the arena.
+esp_err_t buffer_arena_request(buffer_arena_t *arena, const char *name, buffer_arena_region_t region,
+                               size_t size, uint32_t count, void **out);
+
+// Allocate every region and hand out the buffers (zeroed). Logs the
+// budget table; on ESP_ERR_NO_MEM it names the region that did not fit.
+esp_err_t buffer_arena_commit(buffer_arena_t *arena);
+
+// Free and largest-block size of each region's heap, e.g. after the
+// drivers have allocated theirs or after long uptimes.
+void buffer_arena_log_heap(const char *when);
+
+// Allocation guard for the calling task: allocations between enter and
+// exit are counted (and abort with EXAMPLE_ARENA_ALLOC_GUARD 2). No-ops
+// when the guard is disabled.
+void buffer_arena_guard_enter(void);
+void buffer_arena_guard_exit(void);
+
+// Allocations caught so far and the size of the last one.
+uint32_t buffer_arena_guard_violations(uint32_t *last_size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -9,12 +9,16 @@
 #include "sdkconfig.h"
 #include "esp_attr.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_camera.h"
 #include "esp_heap_caps.h"
 #include "esp_system.h"
 #include "example_config.h"
+#include "frame_analysis.h"
+#include "sensor_profile.h"
+#include "buffer_arena.h"
 
 static const char *TAG = "camera_test";
 
@@ -46,6 +50,42 @@ static void camera_clear_buffers(void)
     vTaskDelay(pdMS_TO_TICKS(100));
 }
 
+// 测试用的传感器设置, 按顺序写入
+static const sensor_setting_t s_test_profile[] = {
+    {SENSOR_SET_PIXFORMAT, PIXFORMAT_RGB565},
+    {SENSOR_SET_FRAMESIZE, FRAMESIZE_QVGA},
+    {SENSOR_SET_COLORBAR, 0},          // 确保禁用颜色条测试模式
+    {SENSOR_SET_RAW_GMA, 1},           // Gamma校正
+    {SENSOR_SET_LENC, 1},              // 镜头校正
+    {SENSOR_SET_GAINCEILING, GAINCEILING_16X},
+    {SENSOR_SET_GAIN_CTRL, 1},
+    {SENSOR_SET_EXPOSURE_CTRL, 1},
+    {SENSOR_SET_BRIGHTNESS, 0},
+    {SENSOR_SET_CONTRAST, 1},          // 增加对比度帮助图像清晰
+    {SENSOR_SET_SATURATION, 0},
+    {SENSOR_SET_WHITEBAL, 1},
+    {SENSOR_SET_AWB_GAIN, 1},
+    {SENSOR_SET_WB_MODE, 0},           // 自动白平衡模式
+    {SENSOR_SET_HMIRROR, 0},
+    {SENSOR_SET_VFLIP, 0},
+    {SENSOR_SET_DCW, 1},
+    {SENSOR_SET_BPC, 0},               // 禁用坏点校正
+    {SENSOR_SET_WPC, 1},               // 启用白点校正
+    {SENSOR_SET_SPECIAL_EFFECT, 0},
+    {SENSOR_SET_AGC_GAIN, 0},          // 较低的AGC增益
+    {SENSOR_SET_AEC_VALUE, 300},       // 中等曝光值
+    {SENSOR_SET_QUALITY, 10},
+    {SENSOR_SET_PIXFORMAT, PIXFORMAT_RGB565}, // 重新确认像素格式
+};
+
+static const sensor_settle_config_t s_settle_config = {
+    .timeout_ms = EXAMPLE_SENSOR_SETTLE_TIMEOUT_MS,
+    .stable_frames = EXAMPLE_SENSOR_SETTLE_FRAMES,
+    .reg_tolerance = EXAMPLE_SENSOR_SETTLE_REG_TOLERANCE,
+    .luma_tolerance = EXAMPLE_SENSOR_SETTLE_LUMA_TOLERANCE,
+    .min_luma = EXAMPLE_SENSOR_SETTLE_MIN_LUMA,
+};
+
 // Camera initialization function for ESP32-S3
 static esp_err_t camera_init(void)
 {
@@ -87,11 +127,6 @@ static esp_err_t camera_init(void)
 
     ESP_LOGI(TAG, "Camera hardware initialized successfully");
 
-    // 初始化后立即清理可能存在的缓冲区
-    ESP_LOGI(TAG, "Clearing any initial buffers...");
-    vTaskDelay(pdMS_TO_TICKS(1000)); // 等待1秒让硬件稳定
-    camera_clear_buffers();
-
     // Get camera sensor
     sensor_t *s = esp_camera_sensor_get();
     if (s == NULL) {
@@ -99,244 +134,27 @@ static esp_err_t camera_init(void)
         return ESP_FAIL;
     }
 
-    ESP_LOGI(TAG, "Camera sensor object obtained successfully");
-
     // 输出传感器信息
     ESP_LOGI(TAG, "Camera sensor detected: PID=0x%02x, VER=0x%02x", s->id.PID, s->id.VER);
 
-    // 在配置传感器前再次清理缓冲区
-    ESP_LOGI(TAG, "Pre-configuration buffer cleanup...");
-    camera_clear_buffers();
-    vTaskDelay(pdMS_TO_TICKS(500)); // 额外延迟
-
-    // 安全地设置传感器参数 - 检查函数指针是否有效
+    // 整张设置表一次写入, 不再逐项延时
     ESP_LOGI(TAG, "Configuring sensor settings...");
-
-    // 首先设置关键的像素格式和帧大小
-    if (s->set_pixformat)
-    {
-        s->set_pixformat(s, PIXFORMAT_RGB565);
-        ESP_LOGI(TAG, "✓ Pixel format explicitly set to RGB565");
-        vTaskDelay(pdMS_TO_TICKS(300));
-    }
-
-    // 首先设置帧率控制以增加HTS/VTS时间
-    if (s->set_framesize)
-    {
-        s->set_framesize(s, FRAMESIZE_QVGA);
-        ESP_LOGI(TAG, "✓ Frame size set to QVGA");
-        vTaskDelay(pdMS_TO_TICKS(300));
-    }
-
-    // 禁用测试模式和颜色条
-    if (s->set_colorbar)
-    {
-        s->set_colorbar(s, 0); // 确保禁用颜色条测试模式
-        ESP_LOGI(TAG, "✓ Color bar test mode disabled");
-        vTaskDelay(pdMS_TO_TICKS(200));
-    }
-    else
-    {
-        ESP_LOGW(TAG, "⚠ set_colorbar function not available");
-    }
-
-    // 设置正确的输出格式相关参数
-    if (s->set_raw_gma)
-    {
-        s->set_raw_gma(s, 1); // 启用Gamma校正
-        ESP_LOGI(TAG, "✓ Gamma correction enabled");
-        vTaskDelay(pdMS_TO_TICKS(200));
-    }
-
-    if (s->set_lenc)
-    {
-        s->set_lenc(s, 1); // 启用镜头校正
-        ESP_LOGI(TAG, "✓ Lens correction enabled");
-        vTaskDelay(pdMS_TO_TICKS(200));
-    }
-
-    // 设置较低的增益和曝光以稳定时序
-    if (s->set_gainceiling)
-    {
-        s->set_gainceiling(s, GAINCEILING_16X); // 进一步降低增益
-        ESP_LOGI(TAG, "✓ Gain ceiling set to 16X (for stable image)");
-        vTaskDelay(pdMS_TO_TICKS(200));
-    }
-    else
-    {
-        ESP_LOGW(TAG, "⚠ set_gainceiling function not available");
-    }
-
-    if (s->set_gain_ctrl)
-    {
-        s->set_gain_ctrl(s, 1); // 0 = disable, 1 = enable
-        ESP_LOGI(TAG, "✓ Gain control enabled");
-        vTaskDelay(pdMS_TO_TICKS(200));
-    }
-    else
-    {
-        ESP_LOGW(TAG, "⚠ set_gain_ctrl function not available");
-    }
-
-    if (s->set_exposure_ctrl)
-    {
-        s->set_exposure_ctrl(s, 1); // 0 = disable, 1 = enable
-        ESP_LOGI(TAG, "✓ Exposure control enabled");
-        vTaskDelay(pdMS_TO_TICKS(200));
-    }
-    else
-    {
-        ESP_LOGW(TAG, "⚠ set_exposure_ctrl function not available");
-    }
-    if (s->set_brightness) {
-        s->set_brightness(s, 0);     // -2 to 2
-        ESP_LOGI(TAG, "✓ Brightness set");
-        vTaskDelay(pdMS_TO_TICKS(200));
-    } else {
-        ESP_LOGW(TAG, "⚠ set_brightness function not available");
-    }
-    
-    if (s->set_contrast) {
-        s->set_contrast(s, 1); // 增加对比度帮助图像清晰
-        ESP_LOGI(TAG, "✓ Contrast set to +1");
-        vTaskDelay(pdMS_TO_TICKS(200));
-    } else {
-        ESP_LOGW(TAG, "⚠ set_contrast function not available");
-    }
-    
-    if (s->set_saturation) {
-        s->set_saturation(s, 0);     // -2 to 2
-        ESP_LOGI(TAG, "✓ Saturation set");
-        vTaskDelay(pdMS_TO_TICKS(200));
-    } else {
-        ESP_LOGW(TAG, "⚠ set_saturation function not available");
-    }
-
-    if (s->set_whitebal) {
-        s->set_whitebal(s, 1);       // 0 = disable, 1 = enable
-        ESP_LOGI(TAG, "✓ White balance enabled");
-        vTaskDelay(pdMS_TO_TICKS(200));
-    } else {
-        ESP_LOGW(TAG, "⚠ set_whitebal function not available");
-    }
-
-    if (s->set_awb_gain)
-    {
-        s->set_awb_gain(s, 1); // 启用自动白平衡增益
-        ESP_LOGI(TAG, "✓ Auto white balance gain enabled");
-        vTaskDelay(pdMS_TO_TICKS(200));
-    }
-
-    if (s->set_wb_mode)
-    {
-        s->set_wb_mode(s, 0); // 自动白平衡模式
-        ESP_LOGI(TAG, "✓ White balance mode set to auto");
-        vTaskDelay(pdMS_TO_TICKS(200));
-    }
-
-    if (s->set_hmirror) {
-        s->set_hmirror(s, 0);        // 0 = disable, 1 = enable
-        ESP_LOGI(TAG, "✓ Horizontal mirror disabled");
-        vTaskDelay(pdMS_TO_TICKS(200));
-    } else {
-        ESP_LOGW(TAG, "⚠ set_hmirror function not available");
-    }
-    
-    if (s->set_vflip) {
-        s->set_vflip(s, 0);          // 0 = disable, 1 = enable
-        ESP_LOGI(TAG, "✓ Vertical flip disabled");
-        vTaskDelay(pdMS_TO_TICKS(200));
-    } else {
-        ESP_LOGW(TAG, "⚠ set_vflip function not available");
-    }
-
-    // 关键：设置正确的时钟极性和同步信号
-    if (s->set_dcw)
-    {
-        s->set_dcw(s, 1); // 启用DCW (Data Clock Width)
-        ESP_LOGI(TAG, "✓ DCW enabled for proper timing");
-        vTaskDelay(pdMS_TO_TICKS(200));
-    }
-
-    if (s->set_bpc)
-    {
-        s->set_bpc(s, 0); // 禁用坏点校正
-        ESP_LOGI(TAG, "✓ Bad pixel correction disabled");
-        vTaskDelay(pdMS_TO_TICKS(200));
-    }
-
-    if (s->set_wpc)
-    {
-        s->set_wpc(s, 1); // 启用白点校正
-        ESP_LOGI(TAG, "✓ White pixel correction enabled");
-        vTaskDelay(pdMS_TO_TICKS(200));
-    }
-
-    // 额外的时序优化设置
-    ESP_LOGI(TAG, "Applying additional timing optimizations for DMA...");
-
-    // 确保禁用所有测试模式
-    if (s->set_special_effect)
-    {
-        s->set_special_effect(s, 0); // 无特效，减少处理负载
-        ESP_LOGI(TAG, "✓ Special effects disabled for better timing");
-        vTaskDelay(pdMS_TO_TICKS(200));
-    }
-
-    // 设置AGC (自动增益控制)
-    if (s->set_agc_gain)
-    {
-        s->set_agc_gain(s, 0); // 较低的AGC增益
-        ESP_LOGI(TAG, "✓ AGC gain set to low");
-        vTaskDelay(pdMS_TO_TICKS(200));
-    }
-
-    // 设置AEC (自动曝光控制)
-    if (s->set_aec_value)
-    {
-        s->set_aec_value(s, 300); // 中等曝光值
-        ESP_LOGI(TAG, "✓ AEC value set to 300");
-        vTaskDelay(pdMS_TO_TICKS(200));
-    }
-
-    // 如果支持，设置较低的质量模式以减少数据量
-    if (s->set_quality)
-    {
-        s->set_quality(s, 10); // 提高质量设置
-        ESP_LOGI(TAG, "✓ Quality set to higher value for better image");
-        vTaskDelay(pdMS_TO_TICKS(200));
+    err = sensor_profile_apply(s, s_test_profile, sizeof(s_test_profile) / sizeof(s_test_profile[0]));
+    if (err != ESP_OK) {
+        return err;
     }
 
-    // 最重要：重新确认像素格式设置
-    ESP_LOGI(TAG, "Final pixel format confirmation...");
-    if (s->set_pixformat)
-    {
-        s->set_pixformat(s, PIXFORMAT_RGB565);
-        ESP_LOGI(TAG, "✓ Pixel format re-confirmed as RGB565");
-        vTaskDelay(pdMS_TO_TICKS(500));
+    // 轮询增益/曝光/白平衡与帧亮度, 收敛即可开始测试 (取代8秒等待和反复清理缓冲区)
+    sensor_settle_result_t settle;
+    err = sensor_wait_ready(s, &s_settle_config, &settle);
+    if (err != ESP_OK) {
+        return err;
     }
+    ESP_LOGI(TAG, "Camera initialized successfully, ready %lld ms after boot",
+             esp_timer_get_time() / 1000);
 
-    ESP_LOGI(TAG, "Camera initialized successfully");
-
-    // 应用HTS/VTS时序优化
-    ESP_LOGI(TAG, "Applying HTS/VTS timing optimizations...");
-
-    // 配置完成后清理缓冲区
-    ESP_LOGI(TAG, "Post-configuration buffer cleanup...");
-    camera_clear_buffers();
-
-    // 等待传感器稳定
-    ESP_LOGI(TAG, "Waiting for sensor to stabilize with new timing settings...");
-    vTaskDelay(pdMS_TO_TICKS(8000)); // 增加到8秒等待时间，让时序完全稳定
-
-    // 最终清理
-    ESP_LOGI(TAG, "Final buffer cleanup before use...");
-    camera_clear_buffers();
-
-    // 显示摄像头内存使用情况
-    multi_heap_info_t psram_info_after;
-    heap_caps_get_info(&psram_info_after, MALLOC_CAP_SPIRAM);
-    ESP_LOGI(TAG, "After camera init - PSRAM free: %zu bytes", psram_info_after.total_free_bytes);
+    // 显示摄像头内存使用情况: 内部DMA与PSRAM的空闲量和最大连续块
+    buffer_arena_log_heap("after camera init");
     
     return ESP_OK;
 }
@@ -350,25 +168,29 @@ static void print_camera_frame_info(camera_fb_t *fb, uint32_t frame_num)
     ESP_LOGI(TAG, "  Buffer size: %d bytes", fb->len);
     ESP_LOGI(TAG, "  Timestamp: %lld", fb->timestamp.tv_sec * 1000000LL + fb->timestamp.tv_usec);
     
-    // 简单的数据完整性检查
-    if (fb->len > 0 && fb->buf != NULL) {
-        uint16_t *pixel_data = (uint16_t *)fb->buf;
-        uint32_t total_pixels = fb->len / 2; // RGB565 = 2 bytes per pixel
-        
-        // 统计像素值分布
-        uint32_t zero_pixels = 0;
-        uint32_t max_pixels = 0;
-        for (uint32_t i = 0; i < total_pixels; i++) {
-            if (pixel_data[i] == 0x0000) zero_pixels++;
-            if (pixel_data[i] == 0xFFFF) max_pixels++;
+    // 简单的数据完整性检查: 每4行取一行、每行每4个像素取一个, 只读约1/4的PSRAM缓存行
+    if (fb->buf != NULL && fb->len >= (size_t)fb->width * fb->height * 2 && fb->width >= 4) {
+        static frame_stats_t stats; // 约 700 字节, 不放在栈上
+        frame_stats_begin(&stats, 0, 0, fb->width, fb->height, 4);
+        frame_stats_rows(&stats, (const uint16_t *)fb->buf, fb->width, 0, fb->height);
+        frame_stats_end(&stats);
+
+        float pct = 100.0f / stats.pixels;
+        ESP_LOGI(TAG, "  Pixel analysis: %lu sampled, %.1f%% black (0x0000), %.1f%% white (0xFFFF), mean luma %u",
+                 stats.pixels, stats.black * pct, stats.white * pct, stats.mean_luma);
+        ESP_LOGI(TAG, "  Clipped high: R %.1f%% G %.1f%% B %.1f%%, low: R %.1f%% G %.1f%% B %.1f%%",
+                 stats.clipped_high[FRAME_STATS_RED] * pct, stats.clipped_high[FRAME_STATS_GREEN] * pct,
+                 stats.clipped_high[FRAME_STATS_BLUE] * pct, stats.clipped_low[FRAME_STATS_RED] * pct,
+                 stats.clipped_low[FRAME_STATS_GREEN] * pct, stats.clipped_low[FRAME_STATS_BLUE] * pct);
+        for (int gy = 0; gy < FRAME_STATS_GRID_ROWS; gy++) {
+            ESP_LOGI(TAG, "  Luma grid: %3u %3u %3u %3u", stats.grid_luma[gy][0], stats.grid_luma[gy][1],
+                     stats.grid_luma[gy][2], stats.grid_luma[gy][3]);
         }
-        
-        ESP_LOGI(TAG, "  Pixel analysis: %lu total, %lu black (0x0000), %lu white (0xFFFF)", 
-                 total_pixels, zero_pixels, max_pixels);
-        
+
         // 显示前几个像素值作为样本
-        ESP_LOGI(TAG, "  Sample pixels: 0x%04X 0x%04X 0x%04X 0x%04X", 
-                 pixel_data[0], pixel_data[1], pixel_data[2], pixel_data[3]);
+        const uint16_t *sample = (const uint16_t *)fb->buf;
+        ESP_LOGI(TAG, "  Sample pixels: 0x%04X 0x%04X 0x%04X 0x%04X",
+                 sample[0], sample[1], sample[2], sample[3]);
     }
 }
 
@@ -404,7 +226,6 @@ void app_main(void)
     // 摄像头测试
     // =================================================================
     ESP_LOGI(TAG, "=== Camera Test Start ===");
-    vTaskDelay(pdMS_TO_TICKS(5000)); // 增加到5000ms延迟
 
     // 初始化摄像头
     esp_err_t camera_init_result = camera_init();
@@ -0,0 +1,271 @@
+/*
+ * Runtime capture profile switching
+ * 运行时切换采集配置
+ */
+#include <inttypes.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "example_config.h"
+#include "preview_pipeline.h"
+#include "capture_profile.h"
+
+static const char *TAG = "capture_profile";
+
+static const capture_profile_t *s_current;
+static size_t s_buffer_bytes; // esp_camera_init 分配的每个帧缓冲大小
+static ov7670_window_mode_t s_window = OV7670_WINDOW_OFF; // 传感器上当前的开窗
+static bool s_window_failed; // 开窗帧收不到: 之后的配置都不开窗, 由 CPU 缩放
+
+// RGB565/YUV422 每像素2字节; 开窗输出比 frame_size 小, 按 frame_size 计算
+static size_t frame_bytes(framesize_t frame_size)
+{
+    return (size_t)resolution[frame_size].width * resolution[frame_size].height * 2;
+}
+
+static bool profile_fits(const capture_profile_t *profile)
+{
+    return profile->frame_size < FRAMESIZE_INVALID && frame_bytes(profile->frame_size) <= s_buffer_bytes;
+}
+
+// 实际使用的开窗
+static ov7670_window_mode_t window_of(const capture_profile_t *profile)
+{
+    return s_window_failed ? OV7670_WINDOW_OFF : profile->window;
+}
+
+// 输出帧尺寸, 用于日志
+static void output_size(const capture_profile_t *profile, uint16_t *width, uint16_t *height)
+{
+    if (!ov7670_window_size(window_of(profile), width, height)) {
+        *width = resolution[profile->frame_size].width;
+        *height = resolution[profile->frame_size].height;
+    }
+}
+
+// 写入开窗寄存器表, 传感器直接输出屏幕尺寸
+static esp_err_t apply_window(sensor_t *s, ov7670_window_mode_t mode)
+{
+    size_t count;
+    const ov7670_reg_t *regs = ov7670_window_regs(mode, &count);
+    ov7670_window_info_t info;
+
+    if (regs == NULL) {
+        return ESP_OK;
+    }
+    if (s->set_reg == NULL || !ov7670_window_decode(regs, count, &info)) {
+        ESP_LOGE(TAG, "Sensor window %d not supported", mode);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    // 经寄存器缓存一次提交, 与当前窗口相同的寄存器不会再写
+    esp_err_t err = sensor_profile_write_regs(s, regs, count);
+    if (err != ESP_OK) {
+        return err;
+    }
+    ESP_LOGI(TAG, "✓ Sensor window %ux%u at (%u,%u), /%u x /%u -> %ux%u, PCLK /%u",
+             info.width, info.height, info.x, info.y, info.h_downsample, info.v_downsample,
+             info.out_width, info.out_height, info.pclk_divider);
+    return ESP_OK;
+}
+
+// 只发送与当前配置不同的设置: 格式/尺寸由 setter 影子去重, 开窗寄存器由 SCCB 缓存去重
+static esp_err_t apply_sensor(sensor_t *s, const capture_profile_t *profile)
+{
+    const sensor_setting_t base[] = {
+        {SENSOR_SET_PIXFORMAT, profile->pixformat},
+        {SENSOR_SET_FRAMESIZE, profile->frame_size},
+    };
+    ov7670_window_mode_t window = window_of(profile);
+
+    // 开窗寄存器覆盖了驱动的窗口, 关窗时即使尺寸相同也要重新 set_framesize
+    if (s_window != OV7670_WINDOW_OFF && window == OV7670_WINDOW_OFF) {
+        sensor_profile_forget(SENSOR_SET_FRAMESIZE);
+        s_window = OV7670_WINDOW_OFF;
+    }
+    esp_err_t err = sensor_profile_apply(s, base, sizeof(base) / sizeof(base[0]));
+    if (err == ESP_OK && profile->setting_count > 0) {
+        err = sensor_profile_apply(s, profile->settings, profile->setting_count);
+    }
+    if (err == ESP_OK) {
+        // 最后写开窗寄存器, 覆盖驱动 set_framesize 的窗口设置
+        err = apply_window(s, window);
+    }
+    if (err == ESP_OK) {
+        s_window = window;
+    }
+    return err;
+}
+
+static esp_err_t set_pipeline_capture(const capture_profile_t *profile, int64_t valid_from_us)
+{
+    preview_capture_t capture = {
+        .format = profile->pixformat,
+        .window = window_of(profile),
+        .crop_width = profile->crop_width,
+        .crop_height = profile->crop_height,
+    };
+    return preview_pipeline_set_capture(&capture, valid_from_us);
+}
+
+// 驱动按 frame_size 分配帧缓冲并检查每帧的字节数 (非JPEG), 开窗输出的帧更小,
+// 可能被当作残帧整帧丢弃. 在流水线启动前直接取帧, 确认写完开窗寄存器后确实有帧到达.
+// 驱动取帧超时 (约 4 s) 时 esp_camera_fb_get 返回 NULL
+static bool window_frames_arrive(ov7670_window_mode_t window, int64_t written)
+{
+    uint16_t width, height;
+    int64_t deadline = written + EXAMPLE_CAPTURE_SWITCH_TIMEOUT_MS * 1000LL;
+
+    if (!ov7670_window_size(window, &width, &height)) {
+        return true;
+    }
+    while (esp_timer_get_time() < deadline) {
+        camera_fb_t *pic = esp_camera_fb_get();
+        if (pic == NULL) {
+            return false;
+        }
+        // 写寄存器之前开始的帧还是驱动的窗口, 跳过
+        int64_t captured = pic->timestamp.tv_sec * 1000000LL + pic->timestamp.tv_usec;
+        bool ok = captured >= written && pic->len >= (size_t)width * height * 2;
+        esp_camera_fb_return(pic);
+        if (ok) {
+            return true;
+        }
+    }
+    return false;
+}
+
+framesize_t capture_profile_buffer_size(const capture_profile_t *profiles, size_t count)
+{
+    framesize_t largest = profiles[0].frame_size;
+
+    for (size_t i = 1; i < count; i++) {
+        if (frame_bytes(profiles[i].frame_size) > frame_bytes(largest)) {
+            largest = profiles[i].frame_size;
+        }
+    }
+    return largest;
+}
+
+esp_err_t capture_profile_init(sensor_t *s, const capture_profile_t *profile, framesize_t buffer_size)
+{
+    if (buffer_size >= FRAMESIZE_INVALID) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_buffer_bytes = frame_bytes(buffer_size);
+    if (!profile_fits(profile)) {
+        ESP_LOGE(TAG, "Profile %s does not fit the %u byte frame buffers",
+                 profile->name, (unsigned)s_buffer_bytes);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    esp_err_t err = apply_sensor(s, profile);
+    int64_t written = esp_timer_get_time();
+    if (err == ESP_OK && !window_frames_arrive(window_of(profile), written)) {
+        // 不让预览停在收不到的开窗帧上: 关窗, 由 CPU 缩放 frame_size 的整帧
+        ESP_LOGW(TAG, "⚠ No frames with sensor window %d within %d ms, using %ux%u and the CPU scaler",
+                 profile->window, EXAMPLE_CAPTURE_SWITCH_TIMEOUT_MS,
+                 resolution[profile->frame_size].width, resolution[profile->frame_size].height);
+        s_window_failed = true;
+        err = apply_sensor(s, profile);
+    }
+    if (err == ESP_OK) {
+        err = set_pipeline_capture(profile, 0);
+    }
+    if (err != ESP_OK) {
+        return err;
+    }
+    s_current = profile;
+
+    uint16_t width, height;
+    output_size(profile, &width, &height);
+    ESP_LOGI(TAG, "✓ Capture profile %s: %ux%u, %u byte frame buffers",
+             profile->name, width, height, (unsigned)s_buffer_bytes);
+    return ESP_OK;
+}
+
+// 切换失败后回到之前的配置, 并等它的第一帧上屏
+static void restore(sensor_t *s, const capture_profile_t *previous)
+{
+    preview_pipeline_pause(EXAMPLE_CAPTURE_SWITCH_TIMEOUT_MS);
+    esp_err_t err = apply_sensor(s, previous);
+    if (err == ESP_OK) {
+        err = set_pipeline_capture(previous, esp_timer_get_time());
+    }
+    if (err == ESP_OK) {
+        s_current = previous;
+        err = preview_pipeline_resume(EXAMPLE_CAPTURE_SWITCH_TIMEOUT_MS, NULL);
+    } else {
+        preview_pipeline_resume(0, NULL);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Restoring %s failed: %s", previous->name, esp_err_to_name(err));
+    }
+}
+
+esp_err_t capture_profile_switch(sensor_t *s, const capture_profile_t *profile,
+                                 capture_switch_stats_t *stats)
+{
+    capture_switch_stats_t local = {0};
+
+    if (stats == NULL) {
+        stats = &local;
+    }
+    *stats = (capture_switch_stats_t) {0};
+    if (s_current == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (profile == s_current) {
+        return ESP_OK;
+    }
+    if (!profile_fits(profile)) {
+        // 帧缓冲只在 esp_camera_init 时分配, 更大的尺寸需要重新初始化驱动
+        ESP_LOGE(TAG, "Profile %s needs %u byte frame buffers, %u allocated",
+                 profile->name, (unsigned)frame_bytes(profile->frame_size), (unsigned)s_buffer_bytes);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    const capture_profile_t *previous = s_current;
+    int64_t start = esp_timer_get_time();
+    // 超时也继续: 剩下的旧帧按时间戳或尺寸被丢弃
+    preview_pipeline_pause(EXAMPLE_CAPTURE_SWITCH_TIMEOUT_MS);
+    int64_t paused = esp_timer_get_time();
+
+    esp_err_t err = apply_sensor(s, profile);
+    int64_t written = esp_timer_get_time();
+    if (err == ESP_OK) {
+        err = set_pipeline_capture(profile, written);
+    }
+    if (err != ESP_OK) {
+        // 传感器可能只切换了一部分: 切回之前的配置
+        ESP_LOGE(TAG, "Switch to %s failed: %s", profile->name, esp_err_to_name(err));
+        restore(s, previous);
+        return err;
+    }
+    s_current = profile;
+
+    int64_t shown = 0;
+    err = preview_pipeline_resume(EXAMPLE_CAPTURE_SWITCH_TIMEOUT_MS, &shown);
+    int64_t end = err == ESP_OK ? shown : esp_timer_get_time();
+    stats->pause_us = (uint32_t)(paused - start);
+    stats->sensor_us = (uint32_t)(written - paused);
+    stats->first_frame_us = (uint32_t)(end - written);
+    stats->total_us = (uint32_t)(end - start);
+    if (err != ESP_OK) {
+        // 驱动可能丢弃了新配置的每一帧 (字节数与帧缓冲不符等), 不让预览停在这里
+        ESP_LOGW(TAG, "⚠ No %s frame on the panel within %d ms, back to %s", profile->name,
+                 EXAMPLE_CAPTURE_SWITCH_TIMEOUT_MS, previous->name);
+        restore(s, previous);
+        return err;
+    }
+
+    uint16_t width, height;
+    output_size(profile, &width, &height);
+    ESP_LOGI(TAG, "✓ Switched to %s (%ux%u) in %" PRIu32 " ms: pause %" PRIu32 ", sensor %" PRIu32 ", first frame %" PRIu32 " ms",
+             profile->name, width, height, stats->total_us / 1000, stats->pause_us / 1000,
+             stats->sensor_us / 1000, stats->first_frame_us / 1000);
+    return ESP_OK;
+}
+
+const capture_profile_t *capture_profile_current(void)
+{
+    return s_current;
+}
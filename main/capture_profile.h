@@ -0,0 +1,77 @@
+/*
+ * Runtime capture profile switching
+ * 运行时切换采集配置（分辨率/像素格式/开窗/裁剪），不重新初始化摄像头驱动
+ *
+ * esp_camera_init allocates its PSRAM frame buffers once, for the frame
+ * size it is given. Initialising with the largest profile lets every
+ * smaller profile reuse those buffers, so a switch is only: pause the
+ * preview pipeline, send the sensor settings that differ from the current
+ * profile (setter shadow + SCCB cache in sensor_profile.h), and resume.
+ * Frames the sensor started before the last register write are dropped,
+ * and the scaler rebuilds its tables on the first frame of the new size.
+ * Auto exposure/white balance keep running, so no settle wait is needed.
+ *
+ * A profile that needs bigger buffers than were allocated is refused with
+ * ESP_ERR_INVALID_SIZE; that case still needs esp_camera_deinit/init.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_camera.h"
+#include "ov7670_window.h"
+#include "sensor_profile.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct {
+    const char *name;
+    framesize_t frame_size;          // 开窗时为装得下窗口的标准尺寸
+    pixformat_t pixformat;           // PIXFORMAT_RGB565 / PIXFORMAT_YUV422
+    ov7670_window_mode_t window;     // OV7670_WINDOW_OFF = 驱动的 frame_size
+    uint16_t crop_width;             // 居中裁剪后缩放, 0 = 该分辨率的默认显示方式
+    uint16_t crop_height;
+    const sensor_setting_t *settings; // 该配置额外的传感器设置, 可为 NULL
+    size_t setting_count;
+} capture_profile_t;
+
+// Where the time of one switch went, all in microseconds.
+typedef struct {
+    uint32_t pause_us;        // 流水线排空
+    uint32_t sensor_us;       // 传感器寄存器写入
+    uint32_t first_frame_us;  // 恢复到新配置的第一帧提交到屏幕
+    uint32_t total_us;
+} capture_switch_stats_t;
+
+// Frame size to pass to esp_camera_init so every profile fits the buffers.
+framesize_t capture_profile_buffer_size(const capture_profile_t *profiles, size_t count);
+
+// Program the sensor for the first profile and set the pipeline capture
+// format. Call after esp_camera_init (with buffer_size) and before
+// preview_pipeline_start. With a sensor window it takes frames directly to
+// check that the driver delivers the smaller window frames; if none arrive
+// the window is turned off for this and every later profile and the CPU
+// scaler shrinks the full frame_size instead.
+esp_err_t capture_profile_init(sensor_t *s, const capture_profile_t *profile, framesize_t buffer_size);
+
+// Switch to another profile while the preview is running. Waits until the
+// first frame of the new profile is on its way to the panel (or
+// EXAMPLE_CAPTURE_SWITCH_TIMEOUT_MS) and reports the timing in stats
+// (may be NULL). If the sensor write fails or no frame of the new profile
+// arrives in time (e.g. the driver drops frames whose size does not match
+// its buffers), the previous profile is applied again and the error is
+// returned.
+esp_err_t capture_profile_switch(sensor_t *s, const capture_profile_t *profile,
+                                 capture_switch_stats_t *stats);
+
+// The profile currently applied, NULL before capture_profile_init.
+const capture_profile_t *capture_profile_current(void);
+
+#ifdef __cplusplus
+}
+#endif
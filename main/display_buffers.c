@@ -0,0 +1,113 @@
+/*
+ * Multi-buffered LCD output hand-off
+ * LCD多缓冲区交接
+ */
+#include <string.h>
+#include "display_buffers.h"
+
+static int find_buffer(const display_buffers_t *db, const void *buffer)
+{
+    for (uint32_t i = 0; i < db->count; i++) {
+        if (db->buffers[i] == buffer) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+void display_buffers_init(display_buffers_t *db, void *const *buffers, uint32_t count)
+{
+    memset(db, 0, sizeof(*db));
+    if (count > DISPLAY_BUFFERS_MAX) {
+        count = DISPLAY_BUFFERS_MAX;
+    }
+    for (uint32_t i = 0; i < DISPLAY_BUFFERS_MAX; i++) {
+        db->buffers[i] = i < count ? buffers[i] : NULL;
+        atomic_init(&db->owned[i], false);
+        atomic_init(&db->release_at[i], 0);
+    }
+    db->count = count;
+    atomic_init(&db->completed, 0);
+}
+
+void *display_buffers_acquire(display_buffers_t *db)
+{
+    uint32_t completed = atomic_load_explicit(&db->completed, memory_order_acquire);
+
+    // 从上次位置开始轮询, 保持缓冲区轮流使用
+    for (uint32_t n = 0; n < db->count; n++) {
+        uint32_t i = (db->next + n) % db->count;
+        if (atomic_load_explicit(&db->owned[i], memory_order_acquire)) {
+            continue;
+        }
+        // 计数器会回绕, 用有符号差值比较
+        uint32_t release_at = atomic_load_explicit(&db->release_at[i], memory_order_relaxed);
+        if ((int32_t)(completed - release_at) < 0) {
+            continue;
+        }
+        atomic_store_explicit(&db->owned[i], true, memory_order_relaxed);
+        db->next = (i + 1) % db->count;
+        return db->buffers[i];
+    }
+    return NULL;
+}
+
+uint32_t display_buffers_free_count(const display_buffers_t *db)
+{
+    uint32_t completed = atomic_load_explicit(&db->completed, memory_order_acquire);
+    uint32_t free = 0;
+
+    for (uint32_t i = 0; i < db->count; i++) {
+        uint32_t release_at = atomic_load_explicit(&db->release_at[i], memory_order_relaxed);
+        free += !atomic_load_explicit(&db->owned[i], memory_order_acquire) &&
+                (int32_t)(completed - release_at) >= 0;
+    }
+    return free;
+}
+
+void display_buffers_submit(display_buffers_t *db, void *buffer, uint32_t transactions)
+{
+    // 不在缓冲区组里的内存与 NULL 一样只计数: 它的传输同样会完成
+    db->submitted += transactions;
+    int i = buffer != NULL ? find_buffer(db, buffer) : -1;
+    if (i < 0) {
+        return;
+    }
+    atomic_store_explicit(&db->release_at[i], db->submitted, memory_order_relaxed);
+    atomic_store_explicit(&db->owned[i], false, memory_order_release);
+}
+
+void display_buffers_cancel(display_buffers_t *db, void *buffer, uint32_t transactions)
+{
+    db->submitted -= transactions;
+    int i = buffer != NULL ? find_buffer(db, buffer) : -1;
+    if (i < 0) {
+        return;
+    }
+    atomic_store_explicit(&db->release_at[i], db->submitted, memory_order_release);
+}
+
+void display_buffers_release(display_buffers_t *db, void *buffer)
+{
+    int i = find_buffer(db, buffer);
+    if (i < 0) {
+        return;
+    }
+    atomic_store_explicit(&db->owned[i], false, memory_order_release);
+}
+
+bool display_buffers_idle(const display_buffers_t *db)
+{
+    return atomic_load_explicit(&db->completed, memory_order_acquire) == db->submitted;
+}
+
+uint32_t display_buffers_mark(const display_buffers_t *db)
+{
+    return db->submitted;
+}
+
+bool display_buffers_reached(const display_buffers_t *db, uint32_t mark)
+{
+    uint32_t completed = atomic_load_explicit(&db->completed, memory_order_acquire);
+    return (int32_t)(completed - mark) >= 0;
+}
@@ -0,0 +1,77 @@
+/*
+ * Multi-buffered LCD output hand-off
+ * LCD多缓冲区交接：生产者填充缓冲区，SPI传输完成回调归还缓冲区
+ *
+ * Plain C, no ESP-IDF dependencies, so it also builds on Linux.
+ * One task acquires buffers, one task (possibly the same) submits them,
+ * and the panel IO on_color_trans_done callback (ISR context) counts
+ * finished color transactions. SPI completes transactions in submission
+ * order, so a buffer is free again once the completion count reaches the
+ * count recorded when it was submitted.
+ */
+
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define DISPLAY_BUFFERS_MAX 4
+
+typedef struct {
+    void *buffers[DISPLAY_BUFFERS_MAX];
+    uint32_t count;
+    uint32_t next;                                       // 获取方: 下一个优先检查的缓冲区
+    atomic_bool owned[DISPLAY_BUFFERS_MAX];              // 已被获取, 尚未提交/释放
+    atomic_uint_least32_t release_at[DISPLAY_BUFFERS_MAX]; // 完成数达到该值时缓冲区空闲
+    uint32_t submitted;                                  // 提交方: 已提交的颜色传输数
+    atomic_uint_least32_t completed;                     // 回调: 已完成的颜色传输数
+} display_buffers_t;
+
+void display_buffers_init(display_buffers_t *db, void *const *buffers, uint32_t count);
+
+// A buffer that is neither owned nor still being sent, or NULL.
+void *display_buffers_acquire(display_buffers_t *db);
+
+// Number of buffers acquire would return right now. Safe to call from
+// any task; the answer may be stale by the time it is used.
+uint32_t display_buffers_free_count(const display_buffers_t *db);
+
+// Call BEFORE queueing the transfers: the callback may fire before the
+// draw call returns. transactions = number of on_color_trans_done events
+// the buffer will produce. buffer NULL (or any memory outside the set,
+// e.g. a camera frame sent in place) only counts its transactions; take
+// display_buffers_mark afterwards to know when it has been sent.
+void display_buffers_submit(display_buffers_t *db, void *buffer, uint32_t transactions);
+
+// Undo the last submit for the transactions that were not issued when
+// queueing failed; the buffer is free once the issued ones complete.
+void display_buffers_cancel(display_buffers_t *db, void *buffer, uint32_t transactions);
+
+// Give back an acquired buffer that will not be sent (e.g. dropped frame).
+void display_buffers_release(display_buffers_t *db, void *buffer);
+
+// True when every submitted transaction has completed.
+bool display_buffers_idle(const display_buffers_t *db);
+
+// Completion mark for everything submitted so far, for memory that is sent
+// alongside the buffers (e.g. a staging area); reached once it is all sent.
+uint32_t display_buffers_mark(const display_buffers_t *db);
+bool display_buffers_reached(const display_buffers_t *db, uint32_t mark);
+
+// Called from on_color_trans_done (ISR). Kept inline so it lands in the
+// caller's IRAM section.
+static inline void display_buffers_on_trans_done(display_buffers_t *db)
+{
+    atomic_fetch_add_explicit(&db->completed, 1, memory_order_release);
+}
+
+#ifdef __cplusplus
+}
+#endif
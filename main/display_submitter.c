@@ -0,0 +1,113 @@
+/*
+ * Pipelined SPI submission to the panel
+ * 流水线化的 SPI 提交
+ */
+#include <string.h>
+#include "esp_lcd_panel_commands.h"
+#include "display_submitter.h"
+
+void display_submitter_init(display_submitter_t *s, esp_lcd_panel_io_handle_t io, uint32_t chunk_bytes)
+{
+    memset(s, 0, sizeof(*s));
+    s->io = io;
+    // 保持2字节对齐, 一个像素不会被拆到两次传输里
+    s->chunk_bytes = chunk_bytes > 2 ? chunk_bytes & ~1u : 2;
+    atomic_init(&s->open, false);
+    atomic_init(&s->queued, 0);
+    atomic_init(&s->completed, 0);
+    atomic_init(&s->idle_since, 0);
+}
+
+uint32_t display_submitter_transactions(const display_submitter_t *s, size_t bytes)
+{
+    return (uint32_t)((bytes + s->chunk_bytes - 1) / s->chunk_bytes);
+}
+
+static esp_err_t set_window(display_submitter_t *s, int x0, int y0, int x1, int y1)
+{
+    const uint8_t caset[] = {(uint8_t)(x0 >> 8), (uint8_t)x0, (uint8_t)((x1 - 1) >> 8), (uint8_t)(x1 - 1)};
+    const uint8_t raset[] = {(uint8_t)(y0 >> 8), (uint8_t)y0, (uint8_t)((y1 - 1) >> 8), (uint8_t)(y1 - 1)};
+
+    s->window_valid = false;
+    esp_err_t err = esp_lcd_panel_io_tx_param(s->io, LCD_CMD_CASET, caset, sizeof(caset));
+    if (err == ESP_OK) {
+        err = esp_lcd_panel_io_tx_param(s->io, LCD_CMD_RASET, raset, sizeof(raset));
+    }
+    if (err == ESP_OK) {
+        s->window[0] = x0;
+        s->window[1] = y0;
+        s->window[2] = x1;
+        s->window[3] = y1;
+        s->window_valid = true;
+        s->stats.windows++;
+    }
+    return err;
+}
+
+esp_err_t display_submitter_begin(display_submitter_t *s, int x0, int y0, int x1, int y1)
+{
+    // 之后队列排空 (包括下面等待发送窗口命令) 到下一块排队之间算作间隙;
+    // 总线本来就空闲时不算, 那是没有数据可发
+    atomic_store(&s->open, true);
+    s->stats.rects++;
+
+    if (!s->window_valid || s->window[0] != x0 || s->window[1] != y0 ||
+        s->window[2] != x1 || s->window[3] != y1) {
+        esp_err_t err = set_window(s, x0, y0, x1, y1);
+        if (err != ESP_OK) {
+            display_submitter_end(s);
+            return err;
+        }
+    }
+    s->ramwr_pending = true;
+    return ESP_OK;
+}
+
+esp_err_t display_submitter_push(display_submitter_t *s, const void *data, size_t bytes,
+                                 uint32_t tag, uint32_t *queued)
+{
+    const uint8_t *p = data;
+
+    *queued = 0;
+    while (bytes > 0) {
+        size_t n = bytes < s->chunk_bytes ? bytes : s->chunk_bytes;
+        uint32_t now = (uint32_t)esp_timer_get_time() | 1; // 与回调记录的 idle_since 同样取奇数
+        uint32_t seq = atomic_load_explicit(&s->queued, memory_order_relaxed) + 1;
+
+        uint32_t since = atomic_exchange(&s->idle_since, 0);
+        if (since != 0 && (int32_t)(now - since) >= 0) {
+            perf_hist_record(&s->gap_hist, now - since);
+            s->stats.gaps++;
+            s->stats.gap_us += now - since;
+        }
+        // 先记录再排队: 回调可能在 tx_color 返回前触发.
+        // 带 RAMWR 的一块在 tx_color 里先等队列排空, 命令时间计入忙碌
+        s->queued_at[seq % DISPLAY_SUBMITTER_SLOTS] = now;
+        s->tags[seq % DISPLAY_SUBMITTER_SLOTS] = n == bytes ? tag : 0;
+        atomic_store(&s->queued, seq);
+        // 队列满时 tx_color 等最早的一次传输完成后再排队
+        esp_err_t err = esp_lcd_panel_io_tx_color(s->io, s->ramwr_pending ? LCD_CMD_RAMWR : -1, p, n);
+        if (err != ESP_OK) {
+            atomic_store(&s->queued, seq - 1);
+            // 写指针位置未知, 下一个矩形重新设置窗口
+            s->window_valid = false;
+            return err;
+        }
+        s->ramwr_pending = false;
+        (*queued)++;
+        p += n;
+        bytes -= n;
+    }
+    return ESP_OK;
+}
+
+void display_submitter_end(display_submitter_t *s)
+{
+    atomic_store(&s->open, false);
+    atomic_store(&s->idle_since, 0);
+}
+
+void display_submitter_invalidate(display_submitter_t *s)
+{
+    s->window_valid = false;
+}
@@ -0,0 +1,120 @@
+/*
+ * Pipelined SPI submission to the panel
+ * 流水线化的 SPI 提交：窗口只设置一次，像素数据分块排队，让 SPI 总线一直有数据可发
+ *
+ * esp_lcd's SPI panel IO sends each command (tx_param, or tx_color with
+ * a command) as a polling transaction, and first waits until every queued
+ * color transaction has finished. draw_bitmap sends CASET, RASET and
+ * RAMWR that way, so every call drains the queue and the bus idles while
+ * the next window is set up; in band mode that happens for every band.
+ *
+ * The submitter sends CASET/RASET only when the window changes and RAMWR
+ * once per rectangle, then queues the pixels as tx_color(-1) transactions
+ * that continue the same memory write, each at most chunk_bytes (bounded
+ * by the bus max_transfer_sz). Up to trans_queue_depth of them are in
+ * flight; tx_color blocks when every slot is taken (back-pressure).
+ *
+ * Each color transaction produces one on_color_trans_done, which the
+ * callback forwards here: bus busy time is accumulated, and when the queue
+ * runs dry while a rectangle is still open (the producer has not got the
+ * next rows ready, or the next rectangle's commands are being sent), the
+ * idle time until the next transaction is queued is recorded as a gap.
+ */
+
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "esp_lcd_panel_io.h"
+#include "perf_stats.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define DISPLAY_SUBMITTER_SLOTS 16 // 按序号记录的传输, 须大于 trans_queue_depth
+
+// Cumulative; reporters subtract an earlier copy.
+typedef struct {
+    uint64_t busy_us;       // 颜色传输占用总线的时间
+    uint32_t transactions;  // 已完成的颜色传输
+    uint32_t rects;
+    uint32_t windows;       // 实际发送 CASET/RASET 的次数
+    uint32_t gaps;          // 有数据待发时总线空闲的次数
+    uint64_t gap_us;
+} display_submitter_stats_t;
+
+typedef struct {
+    esp_lcd_panel_io_handle_t io;
+    uint32_t chunk_bytes;
+    int window[4];                    // 上次设置的窗口 x0, y0, x1, y1 (不含 x1/y1)
+    bool window_valid;
+    bool ramwr_pending;               // 下一块数据带 RAMWR, 写指针回到窗口起点
+    atomic_bool open;                 // begin 之后 end 之前
+    atomic_uint_least32_t queued;     // 提交方: 已排队的颜色传输数
+    atomic_uint_least32_t completed;  // 回调: 已完成的颜色传输数
+    uint32_t queued_at[DISPLAY_SUBMITTER_SLOTS]; // 按序号: 排队时间 (微秒, 低32位)
+    uint32_t tags[DISPLAY_SUBMITTER_SLOTS];      // 按序号: push 的 tag, 只在最后一块
+    uint32_t last_done_us;            // 回调
+    atomic_uint_least32_t idle_since; // 有数据待发时队列排空的时间, 0 = 无
+    perf_hist_t gap_hist;             // 提交方
+    display_submitter_stats_t stats;  // busy_us/transactions 由回调写, 其余由提交方写
+} display_submitter_t;
+
+// chunk_bytes: largest color transaction, at most the bus max_transfer_sz.
+void display_submitter_init(display_submitter_t *s, esp_lcd_panel_io_handle_t io, uint32_t chunk_bytes);
+
+// Number of on_color_trans_done events push will produce for bytes, for
+// accounting that must be in place before the transfers are queued.
+uint32_t display_submitter_transactions(const display_submitter_t *s, size_t bytes);
+
+// Start a rectangle [x0, x1) x [y0, y1) in panel memory coordinates (no
+// esp_lcd_panel_set_gap offset); its pixels follow in push calls, row by
+// row. Waits for queued transfers only when commands are needed.
+esp_err_t display_submitter_begin(display_submitter_t *s, int x0, int y0, int x1, int y1);
+
+// Queue bytes of pixel data, continuing the rectangle. data must stay
+// untouched until the transfers complete. tag is handed back by
+// on_trans_done for the last transaction (0 for the others). *queued is
+// the number of transactions actually queued, also on error.
+esp_err_t display_submitter_push(display_submitter_t *s, const void *data, size_t bytes,
+                                 uint32_t tag, uint32_t *queued);
+
+// The rectangle is complete; bus idle time is no longer a gap.
+void display_submitter_end(display_submitter_t *s);
+
+// Forget the window, e.g. after something else drew on the panel.
+void display_submitter_invalidate(display_submitter_t *s);
+
+// Called from on_color_trans_done (ISR). Returns the transaction's tag and
+// its queue time in *queued_us. Kept inline so it lands in the caller's
+// IRAM section.
+static inline uint32_t display_submitter_on_trans_done(display_submitter_t *s, uint32_t *queued_us)
+{
+    uint32_t now = (uint32_t)esp_timer_get_time() | 1;
+    uint32_t seq = atomic_fetch_add_explicit(&s->completed, 1, memory_order_relaxed) + 1;
+    uint32_t queued = s->queued_at[seq % DISPLAY_SUBMITTER_SLOTS];
+    uint32_t busy = now - queued;
+
+    *queued_us = queued;
+    // 排队时总线还在发送前一块: 这一块从前一块完成时开始占用总线
+    if (now - s->last_done_us < busy) {
+        busy = now - s->last_done_us;
+    }
+    s->stats.busy_us += busy;
+    s->stats.transactions++;
+    s->last_done_us = now;
+    if (seq == atomic_load(&s->queued) && atomic_load(&s->open)) {
+        atomic_store(&s->idle_since, now);
+    }
+    return s->tags[seq % DISPLAY_SUBMITTER_SLOTS];
+}
+
+#ifdef __cplusplus
+}
+#endif
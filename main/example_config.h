@@ -16,7 +16,16 @@ extern "C"
 #define EXAMPLE_RGB565_BITS_PER_PIXEL 16
 
 // ILI9341 SPI LCD Configuration
-#define EXAMPLE_LCD_PIXEL_CLOCK_HZ (20 * 1000 * 1000)
+// 已验证可用的像素时钟, 也是自动校准的起点
+#define EXAMPLE_LCD_PIXEL_CLOCK_HZ (10 * 1000 * 1000)
+// SPI时钟自动校准 (lcd_clock_tune.h): 逐档升高写时钟, 经 MISO 用 RAMRD 回读校验
+// 0 = 固定 EXAMPLE_LCD_PIXEL_CLOCK_HZ, 1 = 使用NVS中保存的结果 (没有时校准), 2 = 每次开机都校准
+// 默认关闭: 校准只在模拟面板 (host spi_clock_sim) 上验证过, 板上尚未测量
+#define EXAMPLE_LCD_CLOCK_TUNE 0
+#define EXAMPLE_LCD_CLOCK_TUNE_MAX_HZ (40 * 1000 * 1000)
+#define EXAMPLE_LCD_READ_CLOCK_HZ (4 * 1000 * 1000) // RAMRD 回读时钟, 读周期比写长得多
+#define EXAMPLE_LCD_CLOCK_TUNE_ROUNDS 4             // 每档时钟写读的图案行数
+#define EXAMPLE_LCD_CLOCK_TUNE_MARGIN 1             // 从最快通过的一档向下退的档数
 #define EXAMPLE_LCD_BK_LIGHT_ON_LEVEL 1
 #define EXAMPLE_LCD_BK_LIGHT_OFF_LEVEL !EXAMPLE_LCD_BK_LIGHT_ON_LEVEL
 #define EXAMPLE_PIN_NUM_SCLK 13
@@ -52,6 +61,150 @@ extern "C"
 #define EXAMPLE_ISP_DVP_CAM_HSYNC_IO (40)// OV7670支持640 x 480 color Raw Bayer RGB Processed Bayer RGB
 // YUV/YCbCr422 GRB422 RGB565/555
 
+// ST7735S 实际分辨率定义
+#define ST7735S_LCD_H_RES 128
+#define ST7735S_LCD_V_RES 160
+
+// 横屏显示: 面板 swap_xy, 预览为 160x128 (与 OV7670_WINDOW_160X128 配合)
+#define EXAMPLE_LCD_SWAP_XY 0
+#if EXAMPLE_LCD_SWAP_XY
+#define EXAMPLE_PREVIEW_WIDTH ST7735S_LCD_V_RES
+#define EXAMPLE_PREVIEW_HEIGHT ST7735S_LCD_H_RES
+#else
+#define EXAMPLE_PREVIEW_WIDTH ST7735S_LCD_H_RES
+#define EXAMPLE_PREVIEW_HEIGHT ST7735S_LCD_V_RES
+#endif
+
+// LCD显示缓冲区数量（2 = 双缓冲, 缩放与SPI DMA传输并行）
+#define EXAMPLE_DISPLAY_BUFFER_COUNT 2
+
+// 分段发送: 每段行数, 0 = 整帧缓冲
+// >0 时只分配 EXAMPLE_DISPLAY_BAND_COUNT 个 EXAMPLE_PREVIEW_WIDTH x 行数 的内部DMA缓冲区
+#define EXAMPLE_DISPLAY_BAND_ROWS 0
+#define EXAMPLE_DISPLAY_BAND_COUNT 2
+
+// 源图行预取: 缩放每 EXAMPLE_SCALER_PREFETCH_ROWS 输出行之前, 用异步内存拷贝 (GDMA)
+// 把它们要读的源图行从 PSRAM 拷到内部RAM, 与上一段的缩放同时进行; 0 = 直接读PSRAM
+// 两块内部DMA缓冲区, 每块须放得下这些行对应的源图行 (QVGA 8行约 8.5KB), 放不下时直接读PSRAM
+// 板上减少了多少 PSRAM 等待尚未测量, 默认关闭; 试用时设为 8
+#define EXAMPLE_SCALER_PREFETCH_ROWS 0
+#define EXAMPLE_SCALER_PREFETCH_BYTES (10 * 1024)
+
+// 局部刷新: 按块比较与上次发送的内容, 只发送变化的矩形 (仅整帧缓冲模式)
+#define EXAMPLE_DISPLAY_DIRTY_RECTS 0
+#define EXAMPLE_DIRTY_TILE_SIZE 16        // 块大小 8/16/32 像素
+#define EXAMPLE_DIRTY_THRESHOLD 3         // 噪声阈值: 单元内平均每像素变化量
+#define EXAMPLE_DIRTY_MAX_RECTS 4         // 每帧最多发送的矩形数
+#define EXAMPLE_DIRTY_FULL_PERCENT 70     // 变化面积超过该比例时整帧发送
+// 非整行宽度的矩形需拷贝到连续的暂存区 (内部DMA内存, 像素数), 不够时扩展为整行
+#define EXAMPLE_DIRTY_STAGING_PIXELS (EXAMPLE_PREVIEW_WIDTH * EXAMPLE_PREVIEW_HEIGHT / 4)
+
+// SPI 发送 (display_submitter.h): 窗口只设置一次, 像素数据按块排队, 最多 EXAMPLE_LCD_TRANS_QUEUE_DEPTH 块同时在队列中
+#define EXAMPLE_LCD_TRANS_QUEUE_DEPTH 10
+// 单次 SPI DMA 传输上限 (总线 max_transfer_sz); 整帧 40 KB, 不必为其准备整帧的 DMA 描述符
+#define EXAMPLE_LCD_MAX_TRANSFER_BYTES (16 * 1024)
+// 每块字节数: 块越小排队越早开始、队列越不容易断流, 块越多中断越多 (不超过上面的上限)
+#define EXAMPLE_DISPLAY_CHUNK_BYTES (8 * 1024)
+
+// 零拷贝: RGB565 帧与屏幕窗口逐像素一致且行连续 (如传感器开窗 128x160) 时,
+// SPI DMA 直接从 PSRAM 帧缓冲发送, 不经过LCD缓冲区 (仅整帧缓冲且不用局部刷新)
+// 帧在传输完成前不还给驱动, 此时 EXAMPLE_CAMERA_FB_COUNT 3 可避免传感器丢帧
+// 只在主机模拟中验证过, 板上测量之前默认关闭
+#define EXAMPLE_DISPLAY_ZERO_COPY 0
+
+// 摄像头帧缓冲数量（1 = 采集与转换串行, 2 = 转换时可同时采集下一帧）
+// 2 需要多一帧 PSRAM 且板上帧率未测量, 默认保持原来的 1
+#define EXAMPLE_CAMERA_FB_COUNT 1
+
+// 预览流水线任务: 采集/转换/显示, 运行核心与优先级
+#define EXAMPLE_PIPELINE_CAPTURE_CORE 0
+#define EXAMPLE_PIPELINE_CAPTURE_PRIORITY 6
+#define EXAMPLE_PIPELINE_CONVERT_CORE 1
+#define EXAMPLE_PIPELINE_CONVERT_PRIORITY 5
+#define EXAMPLE_PIPELINE_DISPLAY_CORE 0
+#define EXAMPLE_PIPELINE_DISPLAY_PRIORITY 5
+#define EXAMPLE_PIPELINE_STACK_SIZE 4096
+// 帧队列深度（2的幂）, 满时丢弃最旧的一帧
+#define EXAMPLE_PIPELINE_CAPTURE_RING_DEPTH 1
+#define EXAMPLE_PIPELINE_DISPLAY_RING_DEPTH 1
+#define EXAMPLE_PIPELINE_STATS_INTERVAL_MS 5000
+// 目标帧率, 0 = 不限 (跟随传感器); 运行时可用 preview_pipeline_set_target_fps() 修改
+// 超出目标帧率、或下一帧到达前下游仍处理不了的帧, 在采集任务里直接还给驱动
+#define EXAMPLE_PIPELINE_TARGET_FPS 0
+// 各阶段耗时直方图 (p50/p95/p99), 随统计信息定期输出
+#define EXAMPLE_PIPELINE_PROFILE 1
+// 帧循环内的堆分配检查 (buffer_arena.h, 需要 CONFIG_HEAP_USE_HOOKS):
+// 0 = 关闭, 1 = 计数并在统计信息中警告, 2 = 在分配处 abort (回溯指向调用者)
+#define EXAMPLE_ARENA_ALLOC_GUARD 1
+
+// 帧录制 (frame_recorder.h): 每秒最多录制的显示帧数, 0 = 不录制 (不编入)
+// 无损压缩后写入 flash 分区 EXAMPLE_RECORDER_PARTITION (partitions.csv) 里的环形区, 写满后覆盖最旧的;
+// 读出分区后用 host/ 下的 frame_rec_decode 转成 PNG. 运行时可用 frame_recorder_set_fps() 修改
+// flash 擦写期间两个核的缓存暂停 (每擦一个4KB扇区几十毫秒), 录制帧率宜低, 或开启 CONFIG_SPI_FLASH_AUTO_SUSPEND
+#define EXAMPLE_RECORDER_FPS 0
+#define EXAMPLE_RECORDER_PARTITION "framerec"
+#define EXAMPLE_RECORDER_CORE 0
+#define EXAMPLE_RECORDER_PRIORITY 2 // 低于流水线任务
+
+// 运动检测 (motion_detect.h): 每帧先缩放出一张亮度缩略图与上一帧比较, 画面静止时
+// 不转换也不发送 (屏幕保持最后一帧), 只每 EXAMPLE_MOTION_IDLE_REFRESH_MS 刷新一帧 (0 = 不刷新)
+// 0 = 关闭 (不编入); 运行时可用 preview_pipeline_set_motion_callback() 接收开始/静止事件
+// 默认关闭: 阈值只在 host 合成序列 (motion_detect_test) 和 motion_replay 上验证过, 板上尚未测量
+#define EXAMPLE_MOTION_IDLE 0
+#define EXAMPLE_MOTION_IDLE_REFRESH_MS 1000
+#define EXAMPLE_MOTION_THUMB_WIDTH (EXAMPLE_PREVIEW_WIDTH / 4)  // 视野与预览相同
+#define EXAMPLE_MOTION_THUMB_HEIGHT (EXAMPLE_PREVIEW_HEIGHT / 4)
+#define EXAMPLE_MOTION_PIXEL_THRESHOLD 12 // 缩略图像素亮度差 (0..255), 高于传感器噪声
+#define EXAMPLE_MOTION_START_PERMILLE 20  // 变化像素达到 2% ...
+#define EXAMPLE_MOTION_START_FRAMES 1     // ... 一帧即恢复显示
+#define EXAMPLE_MOTION_STOP_PERMILLE 5    // 低于 0.5% ...
+#define EXAMPLE_MOTION_STOP_FRAMES 30     // ... 连续约 2 秒才进入静止
+
+// 曝光统计 (frame_analysis.h): 缩放时顺带统计刚写出、还在缓存里的行 (各通道直方图、截断像素、
+// 平均亮度、4x4 亮度格), 不再另读一遍帧; 每 EXAMPLE_FRAME_STATS_STEP 行/列取一个像素, 0 = 关闭
+// preview_pipeline_frame_stats() 读取最近一帧的结果; 零拷贝的帧不经过CPU, 没有统计
+// 主机上每个图像像素约: step 1 4.8 ns, step 2 1.6 ns, step 4 0.47 ns (原来只数黑白的整帧遍历 0.32 ns),
+// 三个直方图逐像素累加占了大部分; 128x160 取 step 4 仍有 1280 个样本, 每格 80 个
+#define EXAMPLE_FRAME_STATS_STEP 4
+
+// 帧损坏检测 (frame_check.h): 转换之前取样检查每帧, 长度不足、截断、撕裂 (部分行是旧帧)、
+// 测试图案、字节/像素错位的帧不送LCD也不录制, 按类计数; 与前一帧相同的帧照常显示; 0 = 关闭
+// 阈值为 FRAME_CHECK_CONFIG_DEFAULT, 只在主机生成的帧上调过; 在板上录制的真实画面
+// (host/tools/frame_check_corpus) 上确认没有误判之前默认关闭
+#define EXAMPLE_FRAME_CHECK 0
+
+// 预览缩放方式（用于没有预设的摄像头分辨率）
+// FRAME_SCALER_MODE_CROP / FIT / FILL / LETTERBOX
+#define EXAMPLE_PREVIEW_SCALE_MODE FRAME_SCALER_MODE_FILL
+// 默认缩放滤波: FRAME_SCALER_FILTER_NEAREST / BOX / BILINEAR
+// 运行时可用 preview_pipeline_set_filter() 切换
+// 滤波仍明显慢于最近邻, 默认保持 NEAREST. pixel_bench 主机上 320x240 crop (5:2, 成对读取的
+// 固定比例内核): nearest 0.6, box 2.0, bilinear 3.7 ns/px; 其他比例查表: box 3.2, bilinear 4.5.
+// 没有达到最近邻的 1.5 倍以内 (pixel_bench --max-filter-ratio 1.5 失败); 板上尚未测量
+#define EXAMPLE_PREVIEW_FILTER FRAME_SCALER_FILTER_NEAREST
+
+// 摄像头输出格式: PIXFORMAT_RGB565 或 PIXFORMAT_YUV422 (YUYV)
+// YUV422 时转换任务一次完成色彩转换+裁剪+缩放, 并顺带输出亮度平面
+#define EXAMPLE_CAMERA_PIXFORMAT PIXFORMAT_RGB565
+
+// 传感器端开窗 (ov7670_window.h): OV7670_WINDOW_OFF / OV7670_WINDOW_128X160 / OV7670_WINDOW_160X128
+// 开启后传感器直接输出屏幕尺寸, CPU 只做行拷贝; 160x128 需同时设置 EXAMPLE_LCD_SWAP_XY
+// 驱动按 frame_size (QCIF) 检查每帧字节数, 开窗帧可能被丢弃; 板上尚未验证.
+// 开机时若收不到开窗帧, capture_profile_init 自动关窗改用 CPU 缩放
+#define EXAMPLE_SENSOR_WINDOW OV7670_WINDOW_OFF
+
+// 运行时切换采集配置 (capture_profile.h): 排空流水线/等待新配置第一帧的上限
+#define EXAMPLE_CAPTURE_SWITCH_TIMEOUT_MS 500
+// 每隔多少毫秒在预览与缩略图之间切换一次并输出耗时, 0 = 不切换
+#define EXAMPLE_CAPTURE_SWITCH_DEMO_MS 0
+
+// 传感器就绪检测: 增益/曝光/白平衡寄存器与平均亮度连续几帧不变即开始预览
+#define EXAMPLE_SENSOR_SETTLE_TIMEOUT_MS 1500  // 上限, 超时后照常启动
+#define EXAMPLE_SENSOR_SETTLE_FRAMES 3
+#define EXAMPLE_SENSOR_SETTLE_REG_TOLERANCE 2
+#define EXAMPLE_SENSOR_SETTLE_LUMA_TOLERANCE 3
+#define EXAMPLE_SENSOR_SETTLE_MIN_LUMA 8       // 更暗视为无效帧
+
 // #define EXAMPLE_CAM_FORMAT "DVP_8bit_20Minput_RGB565_320x240_30fps"
 
 #ifdef __cplusplus
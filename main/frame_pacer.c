@@ -0,0 +1,113 @@
+/*
+ * Frame pacing for the preview pipeline
+ * 帧节奏控制
+ */
+#include <stdbool.h>
+#include <string.h>
+#include "frame_pacer.h"
+
+// 平滑系数 1/8: 几帧内跟上变化, 单帧的抖动影响不大
+static uint32_t smooth(uint32_t avg, uint32_t sample)
+{
+    return avg == 0 ? sample : avg + ((int32_t)(sample - avg) >> 3);
+}
+
+void frame_pacer_init(frame_pacer_t *p, uint32_t target_fps)
+{
+    memset(p, 0, sizeof(*p));
+    frame_pacer_set_fps(p, target_fps);
+}
+
+void frame_pacer_set_fps(frame_pacer_t *p, uint32_t target_fps)
+{
+    // 采集任务在下一帧看到新的间隔, 目标时间点随之重新对齐
+    p->period_us = target_fps ? 1000000 / target_fps : 0;
+}
+
+frame_pacer_decision_t frame_pacer_offer(frame_pacer_t *p, int64_t frame_us, uint32_t busy_us)
+{
+    uint32_t period = p->period_us;
+
+    if (p->last_frame_us != 0 && frame_us > p->last_frame_us) {
+        uint32_t interval = (uint32_t)(frame_us - p->last_frame_us);
+        // 暂停或驱动丢帧造成的长间隔不计入
+        if (p->sensor_interval_us == 0 || interval < p->sensor_interval_us * 4) {
+            p->sensor_interval_us = smooth(p->sensor_interval_us, interval);
+        }
+    }
+    p->last_frame_us = frame_us;
+    p->stats.offered++;
+
+    if (period != 0) {
+        // 帧只能落在传感器的帧间隔上, 提前半个帧间隔以内也算赶上
+        int64_t slot = p->next_us - p->sensor_interval_us / 2;
+        if (p->next_us != 0 && frame_us < slot && p->next_us - frame_us <= period) {
+            p->stats.skipped_rate++;
+            return FRAME_PACER_SKIP_RATE;
+        }
+    }
+    // 下一帧到达时下游仍然忙: 这一帧在队列里只会被替换掉
+    if (p->sensor_interval_us != 0 && busy_us > p->sensor_interval_us) {
+        p->stats.skipped_busy++;
+        return FRAME_PACER_SKIP_BUSY;
+    }
+
+    if (period != 0) {
+        // 落后超过一个周期 (过载或暂停后) 或刚改了帧率时重新对齐, 不追赶
+        bool aligned = p->next_us != 0 && frame_us - p->next_us < period &&
+                       p->next_us - frame_us <= period;
+        p->next_us = aligned ? p->next_us + period : frame_us + period;
+    } else {
+        p->next_us = 0;
+    }
+    p->stats.accepted++;
+    return FRAME_PACER_ACCEPT;
+}
+
+void frame_pacer_service(frame_pacer_t *p, uint32_t us)
+{
+    p->service_us = smooth(p->service_us, us);
+}
+
+void frame_pacer_shown(frame_pacer_t *p, int64_t now_us)
+{
+    if (p->last_shown_us != 0) {
+        uint64_t interval = (uint64_t)(now_us - p->last_shown_us);
+        p->stats.intervals++;
+        p->stats.interval_sum += interval;
+        p->stats.interval_sq_sum += interval * interval;
+    }
+    p->last_shown_us = now_us;
+}
+
+static uint32_t isqrt64(uint64_t v)
+{
+    uint64_t r = 0, bit = 1ULL << 62;
+
+    while (bit > v) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (v >= r + bit) {
+            v -= r + bit;
+            r = (r >> 1) + bit;
+        } else {
+            r >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)r;
+}
+
+uint32_t frame_pacer_jitter_us(const frame_pacer_stats_t *now, const frame_pacer_stats_t *before)
+{
+    uint32_t n = now->intervals - before->intervals;
+    if (n < 2) {
+        return 0;
+    }
+    uint64_t sum = now->interval_sum - before->interval_sum;
+    uint64_t sq = now->interval_sq_sum - before->interval_sq_sum;
+    uint64_t mean = sum / n;
+    uint64_t mean_sq = sq / n;
+    return mean_sq > mean * mean ? isqrt64(mean_sq - mean * mean) : 0;
+}
@@ -0,0 +1,75 @@
+/*
+ * Frame pacing for the preview pipeline
+ * 帧节奏控制：按目标帧率取帧，下游来不及时直接跳过
+ *
+ * Plain C, no ESP-IDF dependencies, so it also builds on Linux.
+ * Driven by frame arrival: the capture task blocks in esp_camera_fb_get
+ * (the driver's frame-done event) and offers each frame here. A frame is
+ * skipped when it arrives before the next target slot, or when the
+ * downstream stages, judged by their measured per-frame time, will still
+ * be busy when the next sensor frame arrives: it would only be replaced
+ * in the ring, so it is handed back to the driver at once instead of
+ * being queued. Each field has a single writer (capture task, convert
+ * task, display side), so no locking is needed.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef enum {
+    FRAME_PACER_ACCEPT = 0,
+    FRAME_PACER_SKIP_RATE,  // 早于下一个目标时间点
+    FRAME_PACER_SKIP_BUSY,  // 下一帧到达前下游都处理不了
+} frame_pacer_decision_t;
+
+// Cumulative counters; reporters subtract an earlier copy.
+typedef struct {
+    uint32_t offered;
+    uint32_t accepted;
+    uint32_t skipped_rate;
+    uint32_t skipped_busy;
+    uint32_t intervals;        // 上屏间隔个数
+    uint64_t interval_sum;     // 微秒
+    uint64_t interval_sq_sum;  // 微秒^2, 用于抖动 (标准差)
+} frame_pacer_stats_t;
+
+typedef struct {
+    volatile uint32_t period_us;  // 目标帧间隔, 0 = 跟随传感器
+    // 采集任务
+    uint32_t sensor_interval_us;  // 传感器帧间隔 (平滑)
+    int64_t last_frame_us;
+    int64_t next_us;              // 下一个目标时间点, 0 = 未开始
+    // 转换任务
+    volatile uint32_t service_us; // 下游处理一帧的耗时 (平滑)
+    // 显示一侧
+    int64_t last_shown_us;
+    frame_pacer_stats_t stats;
+} frame_pacer_t;
+
+void frame_pacer_init(frame_pacer_t *p, uint32_t target_fps);
+
+// 0 = no limit, take every frame the downstream can handle.
+void frame_pacer_set_fps(frame_pacer_t *p, uint32_t target_fps);
+
+// Decide for a frame captured at frame_us. busy_us is how long the
+// downstream still needs for the frame it is working on (0 = idle).
+frame_pacer_decision_t frame_pacer_offer(frame_pacer_t *p, int64_t frame_us, uint32_t busy_us);
+
+// Feed the measured time the downstream spent on one accepted frame.
+void frame_pacer_service(frame_pacer_t *p, uint32_t us);
+
+// A frame went to the panel at now_us (interval / jitter statistics).
+void frame_pacer_shown(frame_pacer_t *p, int64_t now_us);
+
+// Standard deviation of the shown intervals between two snapshots, in us.
+uint32_t frame_pacer_jitter_us(const frame_pacer_stats_t *now, const frame_pacer_stats_t *before);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,147 @@
+/*
+ * GDMA prefetch of camera rows from PSRAM
+ * 异步内存拷贝预取源图行
+ */
+#include <string.h>
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "frame_prefetch.h"
+
+static const char *TAG = "frame_prefetch";
+
+#define BYTES_PER_PIXEL 2 // RGB565 与 YUYV 相同
+
+// 完成回调 (ISR)
+static IRAM_ATTR bool copy_done(async_memcpy_handle_t mcp, async_memcpy_event_t *event, void *arg)
+{
+    BaseType_t need_yield = pdFALSE;
+    xSemaphoreGiveFromISR(((frame_prefetch_slot_t *)arg)->done, &need_yield);
+    return need_yield == pdTRUE;
+}
+
+esp_err_t frame_prefetch_init(frame_prefetch_t *p, void *const *buffers, size_t bytes)
+{
+    memset(p, 0, sizeof(*p));
+    p->buffer_bytes = bytes;
+    p->in_use = -1;
+    p->next = -1;
+    for (int i = 0; i < FRAME_PREFETCH_SLOTS; i++) {
+        p->slots[i].buf = buffers[i];
+        p->slots[i].done = xSemaphoreCreateBinary();
+        if (p->slots[i].buf == NULL || p->slots[i].done == NULL) {
+            ESP_LOGE(TAG, "Prefetch buffer %d not available", i);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    async_memcpy_config_t config = ASYNC_MEMCPY_DEFAULT_CONFIG();
+    config.backlog = FRAME_PREFETCH_SLOTS;
+    // 默认配置 (对齐为 0) 不支持 PSRAM 作为源
+    config.psram_trans_align = FRAME_PREFETCH_PSRAM_ALIGN;
+    esp_err_t err = esp_async_memcpy_install(&config, &p->driver);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to install async memcpy: %s", esp_err_to_name(err));
+    }
+    return err;
+}
+
+static void wait_slot(frame_prefetch_t *p, frame_prefetch_slot_t *slot)
+{
+    if (slot->pending) {
+        int64_t start = esp_timer_get_time();
+        xSemaphoreTake(slot->done, portMAX_DELAY);
+        p->stats.wait_us += esp_timer_get_time() - start;
+        p->stats.copies++;
+        slot->pending = false;
+    }
+}
+
+// 启动拷贝到槽位 i; 返回是否真正启动了DMA
+static bool start_copy(frame_prefetch_t *p, int i, const frame_scaler_t *scaler, const void *frame,
+                       uint32_t y0, uint32_t rows)
+{
+    frame_prefetch_slot_t *slot = &p->slots[i];
+    const size_t stride = scaler->geometry.src_stride;
+
+    // 上一次提前启动但没被取走的拷贝可能还在写这块缓冲区
+    wait_slot(p, slot);
+    slot->frame = frame;
+    slot->y0 = y0;
+    slot->rows = rows;
+    slot->valid = false;
+    if (!frame_scaler_source_span(scaler, y0, rows, &slot->span)) {
+        return false; // 全是黑边, 不读源图
+    }
+
+    // 一次连续拷贝: 第一行从 span.x 起, 最后一行到 span 右边为止, 中间的行整行,
+    // 再向外扩到 PSRAM 对齐边界. 缓冲区从 FRAME_PREFETCH_PSRAM_ALIGN 起对应第一行行首,
+    // 各像素与帧内的行/列位置相同, 缩放内核按原来的 x 读取
+    const frame_rect_t *span = &slot->span;
+    const uintptr_t align = FRAME_PREFETCH_PSRAM_ALIGN;
+    uintptr_t row0 = (uintptr_t)frame + (size_t)span->y * stride * BYTES_PER_PIXEL;
+    uintptr_t first = row0 + (size_t)span->x * BYTES_PER_PIXEL;
+    uintptr_t last = first + ((size_t)(span->height - 1) * stride + span->width) * BYTES_PER_PIXEL;
+    uintptr_t frame_end = (uintptr_t)frame + (size_t)stride * scaler->geometry.src_height * BYTES_PER_PIXEL;
+    uintptr_t src = first & ~(align - 1);
+    uintptr_t end = (last + align - 1) & ~(align - 1);
+    // 末尾留一个像素: 右边界贴着行尾时, 抽取内核仍会多读一个
+    uintptr_t need = end > last + BYTES_PER_PIXEL ? end : last + BYTES_PER_PIXEL;
+    if (end > frame_end || align + (need - row0) > p->buffer_bytes) {
+        p->stats.fallbacks++;
+        return false;
+    }
+    // 驱动接口的源地址不带 const, 只读取
+    uint8_t *dst = slot->buf + align + ((intptr_t)src - (intptr_t)row0);
+    esp_err_t err = esp_async_memcpy(p->driver, dst, (void *)src, end - src, copy_done, slot);
+    if (err != ESP_OK) {
+        if (p->stats.errors++ == 0) {
+            ESP_LOGW(TAG, "⚠ GDMA copy of %u bytes at %p failed: %s, reading PSRAM directly",
+                     (unsigned)(end - src), (void *)src, esp_err_to_name(err));
+        }
+        p->stats.fallbacks++;
+        return false;
+    }
+    slot->pending = true;
+    slot->valid = true;
+    p->stats.bytes += end - src;
+    return true;
+}
+
+void frame_prefetch_start(frame_prefetch_t *p, const frame_scaler_t *scaler, const void *frame,
+                          uint32_t y0, uint32_t rows)
+{
+    int i = p->in_use == 0 ? 1 : 0;
+    start_copy(p, i, scaler, frame, y0, rows);
+    p->next = i;
+}
+
+const void *frame_prefetch_get(frame_prefetch_t *p, const frame_scaler_t *scaler, const void *frame,
+                               uint32_t y0, uint32_t rows, uint32_t *first_row)
+{
+    int i = p->next;
+    p->next = -1;
+    if (i < 0 || p->slots[i].frame != frame || p->slots[i].y0 != y0 || p->slots[i].rows < rows) {
+        // 一帧的第一段, 或提前启动的不是这几行: 现在拷贝并等它完成
+        i = p->in_use == 0 ? 1 : 0;
+        if (start_copy(p, i, scaler, frame, y0, rows)) {
+            p->stats.sync_copies++;
+        }
+    }
+
+    frame_prefetch_slot_t *slot = &p->slots[i];
+    wait_slot(p, slot);
+    p->in_use = i;
+    *first_row = slot->span.y;
+    return slot->valid ? slot->buf + FRAME_PREFETCH_PSRAM_ALIGN : NULL;
+}
+
+void frame_prefetch_end(frame_prefetch_t *p)
+{
+    for (int i = 0; i < FRAME_PREFETCH_SLOTS; i++) {
+        wait_slot(p, &p->slots[i]);
+        p->slots[i].frame = NULL;
+    }
+    p->in_use = -1;
+    p->next = -1;
+}
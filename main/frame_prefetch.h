@@ -0,0 +1,91 @@
+/*
+ * GDMA prefetch of camera rows from PSRAM
+ * 用异步内存拷贝 (GDMA) 把下一段输出要用的源图行从 PSRAM 预取到内部RAM
+ *
+ * The scaler reads the camera frame with a strided, row-skipping pattern,
+ * so most of its loads from PSRAM miss the cache and stall the CPU. Here
+ * the output is processed in short sub-bands: while the CPU scales one
+ * from internal RAM, esp_async_memcpy copies the source span of the next
+ * one (frame_scaler_source_span: the rows between its first and last
+ * source row, trimmed to the sampled columns) into the other of two
+ * internal buffers, in a single DMA transaction.
+ *
+ * get() hands out a copy started earlier when it matches the requested
+ * rows, otherwise it copies synchronously; when a span does not fit in a
+ * buffer it returns NULL and the caller reads PSRAM directly.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_err.h"
+#include "esp_async_memcpy.h"
+#include "frame_scaler.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define FRAME_PREFETCH_SLOTS 2 // 乒乓: 一块正在被缩放, 另一块由DMA填充
+
+// GDMA 读 PSRAM 时源地址和长度须按此对齐 (psram_trans_align); 拷贝范围向外扩到
+// 对齐边界, 缓冲区开头留出同样大小的空间放扩出来的部分
+#define FRAME_PREFETCH_PSRAM_ALIGN 64
+
+// Cumulative; reporters subtract an earlier copy.
+typedef struct {
+    uint32_t copies;      // 完成的DMA拷贝
+    uint64_t bytes;
+    uint32_t sync_copies; // 没有提前启动, 现拷现等的
+    uint32_t fallbacks;   // 放不下、超出帧尾或DMA失败, 直接读PSRAM的子段
+    uint32_t errors;      // 其中 esp_async_memcpy 返回错误的
+    uint64_t wait_us;     // CPU等待DMA完成的时间
+} frame_prefetch_stats_t;
+
+typedef struct {
+    uint8_t *buf;
+    SemaphoreHandle_t done;   // 拷贝完成回调给出
+    const void *frame;
+    uint32_t y0, rows;        // 输出行
+    frame_rect_t span;        // 拷贝的源图区域
+    bool pending;             // 已启动, 完成信号还没取走
+    bool valid;               // pending 时: 拷贝成功启动
+} frame_prefetch_slot_t;
+
+typedef struct {
+    async_memcpy_handle_t driver;
+    frame_prefetch_slot_t slots[FRAME_PREFETCH_SLOTS];
+    size_t buffer_bytes;
+    int in_use;               // 正在被缩放读取的槽位, -1 = 无
+    int next;                 // 提前启动、下一次 get 要用的槽位, -1 = 无
+    frame_prefetch_stats_t stats;
+} frame_prefetch_t;
+
+// buffers: FRAME_PREFETCH_SLOTS internal DMA-capable buffers of bytes each;
+// FRAME_PREFETCH_PSRAM_ALIGN bytes of each are lost to the alignment.
+esp_err_t frame_prefetch_init(frame_prefetch_t *p, void *const *buffers, size_t bytes);
+
+// Start copying the source span of output rows [y0, y0 + rows) of frame
+// into the buffer that is not in use. Does nothing when it does not fit.
+void frame_prefetch_start(frame_prefetch_t *p, const frame_scaler_t *scaler, const void *frame,
+                          uint32_t y0, uint32_t rows);
+
+// Source rows for output rows [y0, y0 + rows), for
+// frame_scaler_run_rows_band (*first_row). NULL: read frame directly. The
+// buffer stays valid until the next get, start after that get may reuse
+// the other one.
+const void *frame_prefetch_get(frame_prefetch_t *p, const frame_scaler_t *scaler, const void *frame,
+                               uint32_t y0, uint32_t rows, uint32_t *first_row);
+
+// The frame is done (before it goes back to the camera driver): wait for
+// copies still reading it and forget them.
+void frame_prefetch_end(frame_prefetch_t *p);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,38 @@
+/*
+ * Frame recording format
+ * 录制帧格式
+ */
+#include <stddef.h>
+#include "frame_record.h"
+
+// 半字节查表: 64 字节的表, 每字节两次查表
+static const uint32_t s_crc_nibble[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+uint32_t frame_record_crc32(uint32_t crc, const void *data, size_t bytes)
+{
+    const uint8_t *p = data;
+
+    crc = ~crc;
+    for (size_t i = 0; i < bytes; i++) {
+        crc ^= p[i];
+        crc = (crc >> 4) ^ s_crc_nibble[crc & 0x0F];
+        crc = (crc >> 4) ^ s_crc_nibble[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+void frame_record_seal(frame_record_header_t *header)
+{
+    header->magic = FRAME_RECORD_MAGIC;
+    header->header_crc = frame_record_crc32(0, header, offsetof(frame_record_header_t, header_crc));
+}
+
+bool frame_record_valid(const frame_record_header_t *header, size_t space)
+{
+    return header->magic == FRAME_RECORD_MAGIC &&
+           header->header_crc == frame_record_crc32(0, header, offsetof(frame_record_header_t, header_crc)) &&
+           space >= sizeof(*header) && header->payload_bytes <= space - sizeof(*header);
+}
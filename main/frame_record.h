@@ -0,0 +1,63 @@
+/*
+ * Frame recording format
+ * 录制帧在 flash 分区里的格式
+ *
+ * Plain C, no ESP-IDF dependencies, so it also builds on Linux
+ * (host/tools/frame_rec_decode.c reads partition dumps with it).
+ *
+ * The partition is a ring of records, each a header followed by the
+ * rgb565_codec.h image, 4-byte aligned. The payload is written before the
+ * header, so a record cut short by a reset has no valid header. After the
+ * ring wraps, older records remain behind the newest one until their
+ * sectors are erased; readers scan for valid headers and order them by seq.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define FRAME_RECORD_MAGIC 0x31524D46u // "FMR1"
+#define FRAME_RECORD_ALIGN 4
+#define FRAME_RECORD_FORMAT_RGB565_CODEC 1
+
+#define FRAME_RECORD_FLAG_SESSION_START 0x0001 // 开机后录制的第一帧
+
+// Little-endian, as stored.
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;           // 逐帧递增, 重启后接着编号
+    uint32_t time_ms;       // 采集时间 (自启动)
+    uint16_t width;
+    uint16_t height;
+    uint16_t format;        // FRAME_RECORD_FORMAT_*
+    uint16_t flags;
+    uint32_t payload_bytes;
+    uint32_t payload_crc;
+    uint32_t header_crc;    // 以上各字段
+} frame_record_header_t;
+
+// CRC-32 (IEEE), continued from crc (0 to start).
+uint32_t frame_record_crc32(uint32_t crc, const void *data, size_t bytes);
+
+// Fill in magic and header_crc.
+void frame_record_seal(frame_record_header_t *header);
+
+// Magic, header CRC and a payload that fits in space bytes (header included).
+bool frame_record_valid(const frame_record_header_t *header, size_t space);
+
+// Bytes the record takes in the ring, header and padding included.
+static inline size_t frame_record_size(const frame_record_header_t *header)
+{
+    return (sizeof(*header) + header->payload_bytes + FRAME_RECORD_ALIGN - 1) & ~(size_t)(FRAME_RECORD_ALIGN - 1);
+}
+
+#ifdef __cplusplus
+}
+#endif
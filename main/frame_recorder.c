@@ -0,0 +1,247 @@
+/*
+ * Compressed frame recorder
+ * 帧录制
+ */
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_partition.h"
+#include "example_config.h"
+#include "rgb565_codec.h"
+#include "frame_record.h"
+#include "frame_recorder.h"
+
+static const char *TAG = "frame_recorder";
+
+#define FRAME_PIXELS (EXAMPLE_PREVIEW_WIDTH * EXAMPLE_PREVIEW_HEIGHT)
+// 每次 flash 写入的字节数; 编码输出先放在内部RAM, 不必经过驱动的中转缓冲区
+#define WRITE_BYTES 1024
+// 一条记录最大的长度, 放不下时回到分区开头
+#define MAX_RECORD_BYTES ((sizeof(frame_record_header_t) + RGB565_CODEC_MAX_BYTES(FRAME_PIXELS) + 3) & ~3u)
+
+static const esp_partition_t *s_part;
+static uint16_t *s_snapshot; // PSRAM, 启动时从 buffer_arena 预留
+static TaskHandle_t s_task;
+static atomic_bool s_busy;   // 快照正在编码/写入
+static volatile uint32_t s_interval_us;
+static frame_recorder_stats_t s_stats;
+
+// 转换任务
+static bool s_claimed;
+static int64_t s_next_us;
+static uint32_t s_time_ms;
+
+// 录制任务: 环形区写入位置, 之后到 s_erased_to 为止已擦除
+static uint32_t s_head;
+static uint32_t s_erased_to;
+static uint32_t s_seq;
+static uint16_t s_flags = FRAME_RECORD_FLAG_SESSION_START;
+static uint8_t s_out[WRITE_BYTES + RGB565_CODEC_MAX_BYTES(EXAMPLE_PREVIEW_WIDTH)];
+
+static inline uint32_t align_sector(uint32_t offset)
+{
+    uint32_t sector = s_part->erase_size;
+    return (offset + sector - 1) / sector * sector;
+}
+
+esp_err_t frame_recorder_reserve(buffer_arena_t *arena)
+{
+    // 只由CPU读写, 放PSRAM
+    return buffer_arena_request(arena, "record snapshot", BUFFER_ARENA_PSRAM,
+                                FRAME_PIXELS * sizeof(uint16_t), 1, (void **)&s_snapshot);
+}
+
+// 从分区开头沿记录链走到最新一条之后; 链在扇区中间断开时 (没写完或空白) 再看下一个扇区
+static void ring_resume(void)
+{
+    frame_record_header_t header;
+    uint32_t offset = 0;
+    bool found = false;
+
+    while (offset + sizeof(header) <= s_part->size) {
+        if (esp_partition_read(s_part, offset, &header, sizeof(header)) == ESP_OK &&
+            frame_record_valid(&header, s_part->size - offset) && (!found || header.seq >= s_seq)) {
+            found = true;
+            s_seq = header.seq + 1;
+            offset += frame_record_size(&header);
+        } else if (offset % s_part->erase_size != 0) {
+            offset = align_sector(offset);
+        } else {
+            break;
+        }
+    }
+    // 之后的内容可能是没写完的记录, 从下一个扇区开始擦除
+    s_head = s_erased_to = align_sector(offset);
+}
+
+static esp_err_t ring_write(uint32_t offset, const void *data, size_t bytes)
+{
+    int64_t start = esp_timer_get_time();
+    esp_err_t err = ESP_OK;
+
+    while (err == ESP_OK && s_erased_to < offset + bytes) {
+        err = esp_partition_erase_range(s_part, s_erased_to, s_part->erase_size);
+        s_erased_to += s_part->erase_size;
+        s_stats.erases++;
+    }
+    if (err == ESP_OK) {
+        err = esp_partition_write(s_part, offset, data, bytes);
+    }
+    s_stats.flash_us += esp_timer_get_time() - start;
+    return err;
+}
+
+static esp_err_t record_snapshot(void)
+{
+    frame_record_header_t header = {
+        .seq = s_seq,
+        .time_ms = s_time_ms,
+        .width = EXAMPLE_PREVIEW_WIDTH,
+        .height = EXAMPLE_PREVIEW_HEIGHT,
+        .format = FRAME_RECORD_FORMAT_RGB565_CODEC,
+        .flags = s_flags,
+    };
+    if (s_head + MAX_RECORD_BYTES > s_part->size) {
+        s_head = s_erased_to = 0;
+        s_stats.wraps++;
+    }
+
+    // 记录头最后写: 没写完的记录没有有效的头
+    uint32_t offset = s_head + sizeof(header);
+    uint32_t crc = 0;
+    size_t fill = 0;
+    rgb565_encoder_t enc;
+    rgb565_codec_encode_begin(&enc);
+    for (int y = 0; y <= EXAMPLE_PREVIEW_HEIGHT; y++) {
+        int64_t start = esp_timer_get_time();
+        if (y < EXAMPLE_PREVIEW_HEIGHT) {
+            fill += rgb565_codec_encode(&enc, s_snapshot + y * EXAMPLE_PREVIEW_WIDTH, EXAMPLE_PREVIEW_WIDTH,
+                                        s_out + fill);
+        } else {
+            fill += rgb565_codec_encode_end(&enc, s_out + fill);
+        }
+        s_stats.encode_us += esp_timer_get_time() - start;
+
+        size_t n = y < EXAMPLE_PREVIEW_HEIGHT ? (fill >= WRITE_BYTES ? WRITE_BYTES : 0) : fill;
+        if (n > 0) {
+            esp_err_t err = ring_write(offset, s_out, n);
+            if (err != ESP_OK) {
+                return err;
+            }
+            crc = frame_record_crc32(crc, s_out, n);
+            offset += n;
+            fill -= n;
+            memmove(s_out, s_out + n, fill);
+        }
+    }
+
+    header.payload_bytes = offset - s_head - sizeof(header);
+    header.payload_crc = crc;
+    frame_record_seal(&header);
+    esp_err_t err = ring_write(s_head, &header, sizeof(header));
+    if (err != ESP_OK) {
+        return err;
+    }
+    s_head += frame_record_size(&header);
+    s_seq++;
+    s_flags = 0;
+    s_stats.frames++;
+    s_stats.raw_bytes += FRAME_PIXELS * sizeof(uint16_t);
+    s_stats.stored_bytes += frame_record_size(&header);
+    return ESP_OK;
+}
+
+static void recorder_task(void *arg)
+{
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        esp_err_t err = record_snapshot();
+        if (err != ESP_OK) {
+            // 写过的扇区不再干净, 从已擦除的位置之后继续
+            s_head = s_erased_to;
+            s_stats.failed++;
+            ESP_LOGE(TAG, "Failed to write frame #%" PRIu32 ": %s", s_seq, esp_err_to_name(err));
+        }
+        atomic_store(&s_busy, false);
+    }
+}
+
+esp_err_t frame_recorder_init(void)
+{
+    if (s_snapshot == NULL) {
+        ESP_LOGE(TAG, "Snapshot not reserved (frame_recorder_reserve, buffer_arena_commit)");
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, EXAMPLE_RECORDER_PARTITION);
+    if (s_part == NULL) {
+        ESP_LOGW(TAG, "⚠ No \"%s\" partition (partitions.csv), not recording", EXAMPLE_RECORDER_PARTITION);
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (s_part->size < MAX_RECORD_BYTES + s_part->erase_size) {
+        ESP_LOGW(TAG, "⚠ Partition \"%s\" too small: %" PRIu32 " bytes", EXAMPLE_RECORDER_PARTITION, s_part->size);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    int64_t start = esp_timer_get_time();
+    ring_resume();
+    frame_recorder_set_fps(EXAMPLE_RECORDER_FPS);
+    if (xTaskCreatePinnedToCore(recorder_task, "frame_rec", EXAMPLE_PIPELINE_STACK_SIZE, NULL,
+                                EXAMPLE_RECORDER_PRIORITY, &s_task, EXAMPLE_RECORDER_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create recorder task");
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "✓ Recording %d fps into \"%s\" (%" PRIu32 " KB): frame #%" PRIu32 " at 0x%" PRIx32 ", found in %" PRId64 " ms",
+             EXAMPLE_RECORDER_FPS, EXAMPLE_RECORDER_PARTITION, s_part->size / 1024, s_seq, s_head,
+             (esp_timer_get_time() - start) / 1000);
+    return ESP_OK;
+}
+
+bool frame_recorder_begin(int64_t captured_us)
+{
+    uint32_t interval = s_interval_us;
+
+    if (s_task == NULL || interval == 0 || captured_us < s_next_us) {
+        return false;
+    }
+    s_next_us = captured_us + interval;
+    if (atomic_load(&s_busy)) {
+        s_stats.skipped++;
+        return false;
+    }
+    s_claimed = true;
+    s_time_ms = (uint32_t)(captured_us / 1000);
+    return true;
+}
+
+void frame_recorder_rows(const uint16_t *data, uint32_t y0, uint32_t rows)
+{
+    if (s_claimed) {
+        memcpy(s_snapshot + y0 * EXAMPLE_PREVIEW_WIDTH, data, rows * EXAMPLE_PREVIEW_WIDTH * sizeof(uint16_t));
+    }
+}
+
+void frame_recorder_end(bool complete)
+{
+    if (!s_claimed) {
+        return;
+    }
+    s_claimed = false;
+    if (complete) {
+        atomic_store(&s_busy, true);
+        xTaskNotifyGive(s_task);
+    }
+}
+
+void frame_recorder_set_fps(uint32_t fps)
+{
+    s_interval_us = fps > 0 ? 1000000 / fps : 0;
+}
+
+void frame_recorder_get_stats(frame_recorder_stats_t *stats)
+{
+    *stats = s_stats;
+}
@@ -0,0 +1,75 @@
+/*
+ * Compressed frame recorder
+ * 录制显示的帧: 无损压缩后写入 flash 分区里的环形区
+ *
+ * The convert task copies the rows of a frame it has just scaled into a
+ * PSRAM snapshot (EXAMPLE_RECORDER_FPS frames per second at most, and only
+ * when the previous one is written), nothing else happens in the frame
+ * loop. A low-priority task encodes the snapshot with rgb565_codec.h, row
+ * by row into a small internal buffer, and appends it to the ring in the
+ * EXAMPLE_RECORDER_PARTITION partition (frame_record.h), erasing sectors
+ * just ahead of the write position. After a reset recording continues
+ * behind the newest record.
+ *
+ * SPI flash erase and write suspend the cache of both cores; an erase of
+ * a 4 KB sector takes tens of ms, so keep the rate low or enable
+ * CONFIG_SPI_FLASH_AUTO_SUSPEND. Frames that come due while the previous
+ * one is still being written are skipped, never waited for.
+ *
+ * host/tools/frame_rec_decode.c turns a dump of the partition into PNGs.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "buffer_arena.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// Cumulative; reporters subtract an earlier copy.
+typedef struct {
+    uint32_t frames;        // 写入的帧
+    uint32_t skipped;       // 到了录制时间, 上一帧还没写完
+    uint32_t failed;        // flash 擦写失败, 该帧丢弃
+    uint32_t erases;        // 擦除的扇区
+    uint32_t wraps;         // 环形区回到开头的次数
+    uint64_t raw_bytes;
+    uint64_t stored_bytes;  // 含记录头
+    uint64_t encode_us;
+    uint64_t flash_us;      // 擦除 + 写入
+} frame_recorder_stats_t;
+
+// Request the PSRAM snapshot from the boot arena.
+esp_err_t frame_recorder_reserve(buffer_arena_t *arena);
+
+// Find the partition, continue behind the newest record and start the
+// recorder task. Without the partition recording stays off
+// (ESP_ERR_NOT_FOUND), the preview is not affected.
+esp_err_t frame_recorder_init(void);
+
+// Called by the convert task for each frame: true when this one is to be
+// recorded; then pass all its rows to frame_recorder_rows() and finish
+// with frame_recorder_end(). captured_us: capture time (esp_timer).
+bool frame_recorder_begin(int64_t captured_us);
+
+// rows preview rows (big-endian RGB565, EXAMPLE_PREVIEW_WIDTH wide)
+// starting at row y0. Does nothing when the frame is not recorded.
+void frame_recorder_rows(const uint16_t *data, uint32_t y0, uint32_t rows);
+
+// complete: every row was passed; otherwise the snapshot is dropped.
+void frame_recorder_end(bool complete);
+
+// Change the recording rate at runtime, 0 = pause.
+void frame_recorder_set_fps(uint32_t fps);
+
+// Snapshot of the counters (not synchronised; for logging).
+void frame_recorder_get_stats(frame_recorder_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
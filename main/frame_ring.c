@@ -0,0 +1,78 @@
+/*
+ * Lock-free single-producer / single-consumer frame ring
+ * 无锁单生产者/单消费者帧队列
+ */
+#include <stddef.h>
+#include "frame_ring.h"
+
+bool frame_ring_init(frame_ring_t *ring, uint32_t capacity)
+{
+    if (capacity == 0 || capacity > FRAME_RING_MAX_SLOTS || (capacity & (capacity - 1)) != 0) {
+        return false;
+    }
+    for (uint32_t i = 0; i < FRAME_RING_MAX_SLOTS; i++) {
+        atomic_init(&ring->slots[i], NULL);
+    }
+    ring->mask = capacity - 1;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->pushed, 0);
+    atomic_init(&ring->dropped, 0);
+    return true;
+}
+
+void frame_ring_push(frame_ring_t *ring, void *frame, void **dropped)
+{
+    const uint32_t capacity = ring->mask + 1;
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    void *oldest = NULL;
+
+    for (;;) {
+        uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+        if (head - tail < capacity) {
+            break;
+        }
+        // 队列已满: 与消费者竞争最旧的一帧, 抢到的一方负责处理它
+        oldest = atomic_load_explicit(&ring->slots[tail & ring->mask], memory_order_relaxed);
+        if (atomic_compare_exchange_weak_explicit(&ring->tail, &tail, tail + 1,
+                                                  memory_order_acq_rel, memory_order_acquire)) {
+            atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+            break;
+        }
+        oldest = NULL;
+    }
+
+    atomic_store_explicit(&ring->slots[head & ring->mask], frame, memory_order_relaxed);
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    atomic_fetch_add_explicit(&ring->pushed, 1, memory_order_relaxed);
+
+    if (dropped) {
+        *dropped = oldest;
+    }
+}
+
+bool frame_ring_pop(frame_ring_t *ring, void **frame)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    for (;;) {
+        uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        if (tail == head) {
+            return false;
+        }
+        // 先读槽位再 CAS: CAS 成功说明生产者尚未覆盖该槽位
+        void *item = atomic_load_explicit(&ring->slots[tail & ring->mask], memory_order_relaxed);
+        if (atomic_compare_exchange_weak_explicit(&ring->tail, &tail, tail + 1,
+                                                  memory_order_acq_rel, memory_order_acquire)) {
+            *frame = item;
+            return true;
+        }
+        // CAS 失败时 tail 已更新为最新值, 重试
+    }
+}
+
+uint32_t frame_ring_count(const frame_ring_t *ring)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    return head - tail;
+}
@@ -0,0 +1,49 @@
+/*
+ * Lock-free single-producer / single-consumer frame ring
+ * 无锁单生产者/单消费者帧队列（满时丢弃最旧帧）
+ *
+ * Plain C11 atomics, no ESP-IDF dependencies, so it also builds on Linux.
+ * Slots carry opaque frame pointers. When the ring is full, push drops the
+ * oldest entry and hands it back to the producer so it can be recycled
+ * (e.g. esp_camera_fb_return). The consumer and a dropping producer both
+ * claim the oldest slot with a CAS on the read index, so exactly one of
+ * them gets each entry.
+ */
+
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define FRAME_RING_MAX_SLOTS 8
+
+typedef struct {
+    _Atomic(void *) slots[FRAME_RING_MAX_SLOTS];
+    uint32_t mask;
+    atomic_uint_least32_t head;    // 写索引, 只有生产者修改
+    atomic_uint_least32_t tail;    // 读索引, 消费者取帧/生产者丢帧时 CAS
+    atomic_uint_least32_t pushed;
+    atomic_uint_least32_t dropped;
+} frame_ring_t;
+
+// capacity must be a power of two, 1..FRAME_RING_MAX_SLOTS.
+bool frame_ring_init(frame_ring_t *ring, uint32_t capacity);
+
+// Producer side. Never blocks. If the ring was full the oldest entry is
+// removed and returned through *dropped, otherwise *dropped is NULL.
+void frame_ring_push(frame_ring_t *ring, void *frame, void **dropped);
+
+// Consumer side. Returns false when empty.
+bool frame_ring_pop(frame_ring_t *ring, void **frame);
+
+uint32_t frame_ring_count(const frame_ring_t *ring);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,284 @@
+/*
+ * LCD SPI clock calibration
+ * LCD SPI 时钟校准
+ */
+#include <inttypes.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "driver/gpio.h"
+#include "nvs.h"
+#include "example_config.h"
+#include "spi_clock_tune.h"
+#include "lcd_clock_tune.h"
+
+static const char *TAG = "lcd_clock_tune";
+
+#define TUNE_NVS_NAMESPACE "lcd"
+#define TUNE_NVS_KEY "pclk_hz"
+#define TUNE_SOURCE_HZ (80 * 1000 * 1000) // SPI 时钟源 APB 80MHz, 实际时钟为整数分频
+#define TUNE_PIXELS ST7735S_LCD_H_RES     // 每轮写读一整行
+
+// ST7735S 命令
+#define ST7735_SWRESET 0x01
+#define ST7735_SLPOUT 0x11
+#define ST7735_CASET 0x2A
+#define ST7735_RASET 0x2B
+#define ST7735_RAMWR 0x2C
+#define ST7735_RAMRD 0x2E
+#define ST7735_COLMOD 0x3A
+
+typedef struct {
+    spi_host_device_t host;
+    uint8_t *tx;      // DMA 内存: 一行像素
+    uint8_t *rx;      // DMA 内存: RAMRD 原始数据
+    uint16_t row;     // 每轮写下一行
+} tune_ctx_t;
+
+static esp_err_t add_device(spi_host_device_t host, uint32_t hz, spi_device_handle_t *dev)
+{
+    spi_device_interface_config_t config = {
+        .clock_speed_hz = hz,
+        .mode = 0,
+        .spics_io_num = EXAMPLE_PIN_NUM_LCD_CS,
+        .queue_size = 1,
+        .flags = SPI_DEVICE_HALFDUPLEX, // 读: 先在 MOSI 发命令, 再从 MISO 收数据, CS 保持有效
+    };
+    return spi_bus_add_device(host, &config, dev);
+}
+
+// 命令字节 (DC 低) 加最多4个参数字节 (DC 高)
+static esp_err_t command(spi_device_handle_t dev, uint8_t cmd, const uint8_t *params, size_t len)
+{
+    spi_transaction_t t = {
+        .flags = SPI_TRANS_USE_TXDATA,
+        .length = 8,
+        .tx_data = {cmd},
+    };
+    gpio_set_level(EXAMPLE_PIN_NUM_LCD_DC, 0);
+    esp_err_t err = spi_device_polling_transmit(dev, &t);
+    if (err != ESP_OK || len == 0) {
+        return err;
+    }
+    t.length = len * 8;
+    memcpy(t.tx_data, params, len);
+    gpio_set_level(EXAMPLE_PIN_NUM_LCD_DC, 1);
+    return spi_device_polling_transmit(dev, &t);
+}
+
+static esp_err_t set_row_window(spi_device_handle_t dev, uint16_t row, size_t count)
+{
+    const uint8_t caset[] = {0, 0, (uint8_t)((count - 1) >> 8), (uint8_t)(count - 1)};
+    const uint8_t raset[] = {(uint8_t)(row >> 8), (uint8_t)row, (uint8_t)(row >> 8), (uint8_t)row};
+    esp_err_t err = command(dev, ST7735_CASET, caset, sizeof(caset));
+    return err == ESP_OK ? command(dev, ST7735_RASET, raset, sizeof(raset)) : err;
+}
+
+static esp_err_t write_row(tune_ctx_t *ctx, uint32_t hz, size_t count)
+{
+    spi_device_handle_t dev;
+    esp_err_t err = add_device(ctx->host, hz, &dev);
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = set_row_window(dev, ctx->row, count);
+    if (err == ESP_OK) {
+        err = command(dev, ST7735_RAMWR, NULL, 0);
+    }
+    if (err == ESP_OK) {
+        spi_transaction_t t = {.length = count * 16, .tx_buffer = ctx->tx};
+        gpio_set_level(EXAMPLE_PIN_NUM_LCD_DC, 1);
+        err = spi_device_polling_transmit(dev, &t);
+    }
+    spi_bus_remove_device(dev);
+    return err;
+}
+
+static esp_err_t read_row(tune_ctx_t *ctx, size_t count, size_t raw_len)
+{
+    spi_device_handle_t dev;
+    esp_err_t err = add_device(ctx->host, EXAMPLE_LCD_READ_CLOCK_HZ, &dev);
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = set_row_window(dev, ctx->row, count);
+    if (err == ESP_OK) {
+        spi_transaction_t t = {
+            .flags = SPI_TRANS_USE_TXDATA,
+            .length = 8,
+            .tx_data = {ST7735_RAMRD},
+            .rxlength = raw_len * 8,
+            .rx_buffer = ctx->rx,
+        };
+        gpio_set_level(EXAMPLE_PIN_NUM_LCD_DC, 0);
+        err = spi_device_polling_transmit(dev, &t);
+    }
+    spi_bus_remove_device(dev);
+    return err;
+}
+
+// spi_clock_panel_t 回调: 以 hz 写一行, 以读时钟读回
+static int tune_write_read(void *arg, uint32_t hz, const uint16_t *pixels, size_t count,
+                           uint8_t *raw, size_t raw_len)
+{
+    tune_ctx_t *ctx = arg;
+
+    for (size_t i = 0; i < count; i++) {
+        ctx->tx[i * 2] = pixels[i] >> 8;
+        ctx->tx[i * 2 + 1] = pixels[i] & 0xff;
+    }
+    esp_err_t err = write_row(ctx, hz, count);
+    if (err == ESP_OK) {
+        err = read_row(ctx, count, raw_len);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "⚠ SPI transfer at %" PRIu32 " Hz failed: %s", hz, esp_err_to_name(err));
+        return -1;
+    }
+    memcpy(raw, ctx->rx, raw_len);
+    ctx->row = (ctx->row + 1) % ST7735S_LCD_V_RES;
+    return 0;
+}
+
+// 硬件复位, 退出睡眠, 16位色; 显示保持关闭, 测试图案不会出现在屏上
+static esp_err_t panel_wake(spi_host_device_t host)
+{
+    gpio_config_t io = {
+        .pin_bit_mask = 1ULL << EXAMPLE_PIN_NUM_LCD_DC,
+        .mode = GPIO_MODE_OUTPUT,
+    };
+    if (EXAMPLE_PIN_NUM_LCD_RST >= 0) {
+        io.pin_bit_mask |= 1ULL << EXAMPLE_PIN_NUM_LCD_RST;
+    }
+    esp_err_t err = gpio_config(&io);
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (EXAMPLE_PIN_NUM_LCD_RST >= 0) {
+        gpio_set_level(EXAMPLE_PIN_NUM_LCD_RST, 0);
+        vTaskDelay(pdMS_TO_TICKS(10));
+        gpio_set_level(EXAMPLE_PIN_NUM_LCD_RST, 1);
+        vTaskDelay(pdMS_TO_TICKS(120));
+    }
+
+    spi_device_handle_t dev;
+    err = add_device(host, EXAMPLE_LCD_READ_CLOCK_HZ, &dev);
+    if (err != ESP_OK) {
+        return err;
+    }
+    const uint8_t colmod = 0x05; // 16 位/像素
+    err = command(dev, ST7735_SWRESET, NULL, 0);
+    vTaskDelay(pdMS_TO_TICKS(150));
+    if (err == ESP_OK) {
+        err = command(dev, ST7735_SLPOUT, NULL, 0);
+        vTaskDelay(pdMS_TO_TICKS(120));
+    }
+    if (err == ESP_OK) {
+        err = command(dev, ST7735_COLMOD, &colmod, 1);
+    }
+    spi_bus_remove_device(dev);
+    return err;
+}
+
+static void log_result(const spi_clock_tune_result_t *result)
+{
+    for (size_t i = 0; i < result->step_count; i++) {
+        const spi_clock_step_t *step = &result->steps[i];
+        ESP_LOGI(TAG, "  %6.2f MHz: %s (%" PRIu32 " bad pixels)", step->hz / 1e6f,
+                 step->errors ? "fail" : "ok", step->errors);
+    }
+}
+
+// 校准的结果是否值得保存: 没跑到回读 (缓冲区分配失败, 面板没应答) 时下次开机重试
+typedef enum {
+    TUNE_NOT_RUN,
+    TUNE_MISMATCH,  // 回读跑了但不一致: MISO 没接, 保存起点不再重试
+    TUNE_VERIFIED,
+} tune_outcome_t;
+
+static uint32_t calibrate(spi_host_device_t host, tune_outcome_t *outcome)
+{
+    const spi_clock_tune_config_t config = {
+        .source_hz = TUNE_SOURCE_HZ,
+        .min_hz = EXAMPLE_LCD_PIXEL_CLOCK_HZ,
+        .max_hz = EXAMPLE_LCD_CLOCK_TUNE_MAX_HZ,
+        .pixels = TUNE_PIXELS,
+        .rounds = EXAMPLE_LCD_CLOCK_TUNE_ROUNDS,
+        .margin_steps = EXAMPLE_LCD_CLOCK_TUNE_MARGIN,
+    };
+    size_t raw_len = SPI_CLOCK_TUNE_RAW_BYTES(TUNE_PIXELS);
+    tune_ctx_t ctx = {
+        .host = host,
+        .tx = heap_caps_malloc(TUNE_PIXELS * 2, MALLOC_CAP_DMA),
+        .rx = heap_caps_malloc((raw_len + 3) & ~3u, MALLOC_CAP_DMA),
+    };
+    spi_clock_panel_t panel = {.write_read = tune_write_read, .ctx = &ctx};
+    spi_clock_tune_result_t result = {0};
+    int64_t start = esp_timer_get_time();
+    uint32_t hz = EXAMPLE_LCD_PIXEL_CLOCK_HZ;
+
+    *outcome = TUNE_NOT_RUN;
+    if (ctx.tx == NULL || ctx.rx == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate calibration buffers");
+    } else if (panel_wake(host) != ESP_OK) {
+        ESP_LOGW(TAG, "⚠ Panel did not answer, keeping %" PRIu32 " Hz", hz);
+    } else if (!spi_clock_tune_run(&config, &panel, &result)) {
+        log_result(&result);
+        *outcome = TUNE_MISMATCH;
+        ESP_LOGW(TAG, "⚠ RAMRD readback does not match at %" PRIu32 " Hz (MISO on GPIO%d wired?), keeping it",
+                 hz, EXAMPLE_PIN_NUM_MISO);
+    } else {
+        log_result(&result);
+        hz = result.chosen_hz;
+        *outcome = TUNE_VERIFIED;
+        ESP_LOGI(TAG, "✓ Pixel clock %.2f MHz (fastest verified %.2f MHz, %" PRIu32 " step margin), "
+                 "readback %u dummy bits%s, %" PRId64 " ms",
+                 hz / 1e6f, result.fastest_pass_hz / 1e6f, (uint32_t)EXAMPLE_LCD_CLOCK_TUNE_MARGIN,
+                 result.dummy_bits, result.swap_rb ? ", BGR" : "",
+                 (esp_timer_get_time() - start) / 1000);
+    }
+    heap_caps_free(ctx.tx);
+    heap_caps_free(ctx.rx);
+    return hz;
+}
+
+uint32_t lcd_clock_tune_pclk(spi_host_device_t host)
+{
+    nvs_handle_t nvs;
+    uint32_t hz = 0;
+
+    if (EXAMPLE_LCD_CLOCK_TUNE == 1 && nvs_open(TUNE_NVS_NAMESPACE, NVS_READONLY, &nvs) == ESP_OK) {
+        esp_err_t err = nvs_get_u32(nvs, TUNE_NVS_KEY, &hz);
+        nvs_close(nvs);
+        // 配置改了范围时保存的值可能已不适用
+        if (err == ESP_OK && hz >= EXAMPLE_LCD_PIXEL_CLOCK_HZ && hz <= EXAMPLE_LCD_CLOCK_TUNE_MAX_HZ) {
+            ESP_LOGI(TAG, "Pixel clock %.2f MHz (saved calibration)", hz / 1e6f);
+            return hz;
+        }
+    }
+
+    tune_outcome_t outcome;
+    hz = calibrate(host, &outcome);
+    if (outcome == TUNE_NOT_RUN) {
+        // 一时的失败不写入 NVS, 下次开机再校准
+        return hz;
+    }
+    // 回读不一致时也保存起点, 不必每次开机都重试; EXAMPLE_LCD_CLOCK_TUNE 2 强制重新校准
+    esp_err_t err = nvs_open(TUNE_NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (err == ESP_OK) {
+        err = nvs_set_u32(nvs, TUNE_NVS_KEY, hz);
+        if (err == ESP_OK) {
+            err = nvs_commit(nvs);
+        }
+        nvs_close(nvs);
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "⚠ Could not save pixel clock: %s", esp_err_to_name(err));
+    } else if (outcome != TUNE_VERIFIED) {
+        ESP_LOGW(TAG, "⚠ Saved the unverified default, set EXAMPLE_LCD_CLOCK_TUNE 2 to retry");
+    }
+    return hz;
+}
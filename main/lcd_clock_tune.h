@@ -0,0 +1,33 @@
+/*
+ * LCD SPI clock calibration
+ * LCD SPI 时钟校准：开机时找出当前接线下可靠的最快像素时钟，结果保存在 NVS
+ *
+ * Runs on the bare SPI bus before the esp_lcd panel IO exists: one
+ * spi_master device per clock step (never two on the same CS at once),
+ * DC driven by hand, RAMRD answers read over MISO (EXAMPLE_PIN_NUM_MISO).
+ * The search itself is spi_clock_tune.h. The panel is reset and put
+ * into 16-bit mode for the test; esp_lcd_panel_reset/init afterwards
+ * start it from scratch. Needs nvs_flash_init first.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "driver/spi_master.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// Pixel clock to create the panel IO with: the value saved in NVS, or a
+// new calibration when there is none (EXAMPLE_LCD_CLOCK_TUNE 2: always).
+// Falls back to EXAMPLE_LCD_PIXEL_CLOCK_HZ when readback does not work;
+// that is saved only when the readback ran and did not match, not when
+// the panel did not answer or buffers could not be allocated.
+// The bus must be initialised with the MISO pin.
+uint32_t lcd_clock_tune_pclk(spi_host_device_t host);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,130 @@
+/*
+ * OV7670 sensor-side windowing and downscaling
+ * OV7670 传感器端开窗与缩小
+ */
+#include "ov7670_window.h"
+
+// 共用部分: 关闭 COM7 的 QVGA/QCIF 预设, 开启 DCW 水平/垂直各 /2,
+// PCLK 同样 /2, 行时序与 QVGA 相同 (参考 OV7670 implementation guide 的 QVGA 设置)
+#define OV7670_WINDOW_DCW2_REGS \
+    {OV7670_REG_COM7, 0x38, 0x00}, \
+    {OV7670_REG_COM3, 0x0C, 0x04}, \
+    {OV7670_REG_COM14, 0x1F, 0x19}, \
+    {OV7670_REG_SCALING_XSC, 0x7F, 0x3A}, \
+    {OV7670_REG_SCALING_YSC, 0x7F, 0x35}, \
+    {OV7670_REG_SCALING_DCWCTR, 0xFF, 0x11}, \
+    {OV7670_REG_SCALING_PCLK_DIV, 0xFF, 0xF1}, \
+    {OV7670_REG_SCALING_PCLK_DELAY, 0x7F, 0x02}
+
+// 竖屏: 窗口 x 350..606, y 90..410 (VGA 中央 256x320)
+static const ov7670_reg_t s_window_128x160[] = {
+    OV7670_WINDOW_DCW2_REGS,
+    {OV7670_REG_HSTART, 0xFF, 0x2B},
+    {OV7670_REG_HSTOP, 0xFF, 0x4B},
+    {OV7670_REG_HREF, 0xFF, 0xB6},
+    {OV7670_REG_VSTART, 0xFF, 0x16},
+    {OV7670_REG_VSTOP, 0xFF, 0x66},
+    {OV7670_REG_VREF, 0x0F, 0x0A},
+};
+
+// 横屏: 窗口 x 318..638, y 122..378 (VGA 中央 320x256)
+static const ov7670_reg_t s_window_160x128[] = {
+    OV7670_WINDOW_DCW2_REGS,
+    {OV7670_REG_HSTART, 0xFF, 0x27},
+    {OV7670_REG_HSTOP, 0xFF, 0x4F},
+    {OV7670_REG_HREF, 0xFF, 0xB6},
+    {OV7670_REG_VSTART, 0xFF, 0x1E},
+    {OV7670_REG_VSTOP, 0xFF, 0x5E},
+    {OV7670_REG_VREF, 0x0F, 0x0A},
+};
+
+const ov7670_reg_t *ov7670_window_regs(ov7670_window_mode_t mode, size_t *count)
+{
+    switch (mode) {
+    case OV7670_WINDOW_128X160:
+        *count = sizeof(s_window_128x160) / sizeof(s_window_128x160[0]);
+        return s_window_128x160;
+    case OV7670_WINDOW_160X128:
+        *count = sizeof(s_window_160x128) / sizeof(s_window_160x128[0]);
+        return s_window_160x128;
+    default:
+        *count = 0;
+        return NULL;
+    }
+}
+
+bool ov7670_window_size(ov7670_window_mode_t mode, uint16_t *width, uint16_t *height)
+{
+    size_t count;
+    ov7670_window_info_t info;
+    const ov7670_reg_t *regs = ov7670_window_regs(mode, &count);
+
+    if (regs == NULL || !ov7670_window_decode(regs, count, &info)) {
+        return false;
+    }
+    *width = info.out_width;
+    *height = info.out_height;
+    return true;
+}
+
+// 表中最后一次写入该寄存器的值 (只看 mask 覆盖的位)
+static bool find_reg(const ov7670_reg_t *regs, size_t count, uint8_t reg, uint8_t *value)
+{
+    bool found = false;
+    for (size_t i = 0; i < count; i++) {
+        if (regs[i].reg == reg) {
+            *value = regs[i].value & regs[i].mask;
+            found = true;
+        }
+    }
+    return found;
+}
+
+bool ov7670_window_decode(const ov7670_reg_t *regs, size_t count, ov7670_window_info_t *info)
+{
+    uint8_t hstart = 0, hstop = 0, href = 0, vstart = 0, vstop = 0, vref = 0;
+    uint8_t com3 = 0, com14 = 0, dcwctr = 0;
+
+    if (!find_reg(regs, count, OV7670_REG_HSTART, &hstart) ||
+        !find_reg(regs, count, OV7670_REG_HSTOP, &hstop) ||
+        !find_reg(regs, count, OV7670_REG_HREF, &href) ||
+        !find_reg(regs, count, OV7670_REG_VSTART, &vstart) ||
+        !find_reg(regs, count, OV7670_REG_VSTOP, &vstop) ||
+        !find_reg(regs, count, OV7670_REG_VREF, &vref)) {
+        return false;
+    }
+    find_reg(regs, count, OV7670_REG_COM3, &com3);
+    find_reg(regs, count, OV7670_REG_COM14, &com14);
+    find_reg(regs, count, OV7670_REG_SCALING_DCWCTR, &dcwctr);
+
+    // HSTART/HSTOP 为高8位, 低3位在 HREF; VSTART/VSTOP 为高8位, 低2位在 VREF
+    uint32_t h0 = ((uint32_t)hstart << 3) | (href & 0x07);
+    uint32_t h1 = ((uint32_t)hstop << 3) | ((href >> 3) & 0x07);
+    uint32_t v0 = ((uint32_t)vstart << 2) | (vref & 0x03);
+    uint32_t v1 = ((uint32_t)vstop << 2) | ((vref >> 2) & 0x03);
+
+    // 水平计数器会回绕, HSTOP 可以小于 HSTART
+    uint32_t width = (h1 + OV7670_HREF_PERIOD - h0) % OV7670_HREF_PERIOD;
+    if (v1 <= v0 || width == 0 || h0 < OV7670_VGA_HSTART || v0 < OV7670_VGA_VSTART) {
+        return false;
+    }
+    uint32_t x = h0 - OV7670_VGA_HSTART;
+    uint32_t y = v0 - OV7670_VGA_VSTART;
+    uint32_t height = v1 - v0;
+    if (x + width > OV7670_VGA_WIDTH || y + height > OV7670_VGA_HEIGHT) {
+        return false;
+    }
+
+    info->x = x;
+    info->y = y;
+    info->width = width;
+    info->height = height;
+    // COM3[2]: DCW 使能, DCWCTR[1:0] 水平 / [5:4] 垂直降采样 (2^n)
+    info->h_downsample = (com3 & 0x04) ? 1 << (dcwctr & 0x03) : 1;
+    info->v_downsample = (com3 & 0x04) ? 1 << ((dcwctr >> 4) & 0x03) : 1;
+    // COM14[4]: 手动缩放时 PCLK 分频 COM14[2:0]
+    info->pclk_divider = (com14 & 0x10) ? 1 << (com14 & 0x07) : 1;
+    info->out_width = width / info->h_downsample;
+    info->out_height = height / info->v_downsample;
+    return true;
+}
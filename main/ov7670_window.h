@@ -0,0 +1,85 @@
+/*
+ * OV7670 sensor-side windowing and downscaling
+ * OV7670 传感器端开窗与缩小（直接输出屏幕尺寸）
+ *
+ * Plain C, no ESP-IDF dependencies, so it also builds on Linux.
+ * Each mode is a register table (HSTART/HSTOP/VSTART/VSTOP/HREF/VREF,
+ * COM3, COM14, SCALING_*) written through sensor_t::set_reg. The sensor
+ * then crops a window from its VGA pixel array and downsamples it by 2 in
+ * both directions (DCW), so frames arrive at the panel size and the CPU
+ * scaler only has to copy rows.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// 寄存器地址 (OV7670 datasheet)
+#define OV7670_REG_VREF 0x03
+#define OV7670_REG_COM3 0x0C
+#define OV7670_REG_COM7 0x12
+#define OV7670_REG_HSTART 0x17
+#define OV7670_REG_HSTOP 0x18
+#define OV7670_REG_VSTART 0x19
+#define OV7670_REG_VSTOP 0x1A
+#define OV7670_REG_HREF 0x32
+#define OV7670_REG_COM14 0x3E
+#define OV7670_REG_SCALING_XSC 0x70
+#define OV7670_REG_SCALING_YSC 0x71
+#define OV7670_REG_SCALING_DCWCTR 0x72
+#define OV7670_REG_SCALING_PCLK_DIV 0x73
+#define OV7670_REG_SCALING_PCLK_DELAY 0xA2
+
+// VGA 有效区域在行/帧计数器中的起点, 水平计数器一行 784 个周期
+#define OV7670_VGA_HSTART 158
+#define OV7670_VGA_VSTART 10
+#define OV7670_VGA_WIDTH 640
+#define OV7670_VGA_HEIGHT 480
+#define OV7670_HREF_PERIOD 784
+
+typedef enum {
+    OV7670_WINDOW_OFF = 0,       // 使用驱动的 frame_size, CPU 缩放
+    OV7670_WINDOW_128X160,       // 竖屏: 256x320 窗口 /2 -> 128x160
+    OV7670_WINDOW_160X128,       // 横屏: 320x256 窗口 /2 -> 160x128, 屏幕需 swap_xy
+} ov7670_window_mode_t;
+
+typedef struct {
+    uint8_t reg;
+    uint8_t mask;  // 只修改这些位, 其余保持驱动设置
+    uint8_t value;
+} ov7670_reg_t;
+
+// What a register set makes the sensor output, decoded from the values.
+typedef struct {
+    uint16_t x;            // 窗口在 VGA 有效区域内的位置和大小
+    uint16_t y;
+    uint16_t width;
+    uint16_t height;
+    uint8_t h_downsample;  // 1, 2, 4, 8
+    uint8_t v_downsample;
+    uint8_t pclk_divider;  // 1, 2, 4, 8, 16
+    uint16_t out_width;    // 输出帧尺寸
+    uint16_t out_height;
+} ov7670_window_info_t;
+
+// Register table for a mode, NULL (count 0) for OV7670_WINDOW_OFF.
+const ov7670_reg_t *ov7670_window_regs(ov7670_window_mode_t mode, size_t *count);
+
+// Output frame size of a mode. Returns false for OV7670_WINDOW_OFF.
+bool ov7670_window_size(ov7670_window_mode_t mode, uint16_t *width, uint16_t *height);
+
+// Decode the crop rectangle, downsampling and output size from a register
+// table. Returns false if a window register is missing or the window lies
+// outside the VGA array.
+bool ov7670_window_decode(const ov7670_reg_t *regs, size_t count, ov7670_window_info_t *info);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,62 @@
+/*
+ * Fixed-size latency histograms
+ * 固定大小的耗时直方图
+ */
+#include "perf_stats.h"
+
+uint32_t perf_hist_bucket_floor(uint32_t index)
+{
+    if (index < (1u << PERF_HIST_SUB_BITS)) {
+        return index;
+    }
+    uint32_t octave = (index >> PERF_HIST_SUB_BITS) + PERF_HIST_SUB_BITS - 1;
+    uint32_t sub = index & ((1u << PERF_HIST_SUB_BITS) - 1);
+    return (1u << octave) + (sub << (octave - PERF_HIST_SUB_BITS));
+}
+
+void perf_hist_delta(const perf_hist_t *now, const perf_hist_t *before, perf_hist_t *out)
+{
+    for (uint32_t i = 0; i < PERF_HIST_BUCKETS; i++) {
+        out->buckets[i] = now->buckets[i] - before->buckets[i];
+    }
+    out->count = now->count - before->count;
+    out->sum = now->sum - before->sum;
+    out->max = now->max;
+}
+
+// 第 rank 个样本 (从1开始) 所在的桶内线性插值
+static uint32_t percentile(const perf_hist_t *h, uint32_t pct)
+{
+    uint32_t rank = (uint32_t)(((uint64_t)h->count * pct + 99) / 100);
+    uint32_t seen = 0;
+
+    if (rank == 0) {
+        rank = 1;
+    }
+    for (uint32_t i = 0; i < PERF_HIST_BUCKETS; i++) {
+        uint32_t n = h->buckets[i];
+        if (n == 0 || seen + n < rank) {
+            seen += n;
+            continue;
+        }
+        uint32_t lo = perf_hist_bucket_floor(i);
+        uint32_t hi = i + 1 < PERF_HIST_BUCKETS ? perf_hist_bucket_floor(i + 1) : h->max + 1;
+        uint32_t value = lo + (uint32_t)((uint64_t)(hi - lo) * (rank - seen) / (n + 1));
+        return value < h->max ? value : h->max;
+    }
+    return h->max;
+}
+
+void perf_hist_summarize(const perf_hist_t *h, perf_summary_t *summary)
+{
+    memset(summary, 0, sizeof(*summary));
+    if (h->count == 0) {
+        return;
+    }
+    summary->count = h->count;
+    summary->p50 = percentile(h, 50);
+    summary->p95 = percentile(h, 95);
+    summary->p99 = percentile(h, 99);
+    summary->max = h->max;
+    summary->mean = (uint32_t)(h->sum / h->count);
+}
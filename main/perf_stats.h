@@ -0,0 +1,82 @@
+/*
+ * Fixed-size latency histograms
+ * 固定大小的耗时直方图（对数分桶）
+ *
+ * Plain C, no ESP-IDF dependencies, so it also builds on Linux.
+ * Each power of two is split into 4 sub-buckets (<= 19% relative error).
+ * Recording is a few integer ops with no allocation or locking, so it can
+ * run in the hot path and in ISRs. Histograms only ever grow; a reporter
+ * keeps a snapshot and works on the difference, so writers are never reset
+ * underneath it.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define PERF_HIST_SUB_BITS 2
+#define PERF_HIST_OCTAVES 27 // 最大约 2^27 微秒 (134 s)
+#define PERF_HIST_BUCKETS (PERF_HIST_OCTAVES << PERF_HIST_SUB_BITS)
+
+typedef struct {
+    uint32_t buckets[PERF_HIST_BUCKETS];
+    uint32_t count;
+    uint32_t max;
+    uint64_t sum;
+} perf_hist_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t p50;
+    uint32_t p95;
+    uint32_t p99;
+    uint32_t max;
+    uint32_t mean;
+} perf_summary_t;
+
+// 0..3 直接对应, 之后每个 2 的幂分 4 个桶
+static inline uint32_t perf_hist_bucket(uint32_t value)
+{
+    if (value < (1u << PERF_HIST_SUB_BITS)) {
+        return value;
+    }
+    uint32_t msb = 31 - __builtin_clz(value);
+    uint32_t sub = (value >> (msb - PERF_HIST_SUB_BITS)) & ((1u << PERF_HIST_SUB_BITS) - 1);
+    uint32_t index = ((msb - PERF_HIST_SUB_BITS + 1) << PERF_HIST_SUB_BITS) + sub;
+    return index < PERF_HIST_BUCKETS ? index : PERF_HIST_BUCKETS - 1;
+}
+
+// Inline so that it lands in the caller's IRAM section when used from ISRs.
+static inline void perf_hist_record(perf_hist_t *h, uint32_t value)
+{
+    h->buckets[perf_hist_bucket(value)]++;
+    h->count++;
+    h->sum += value;
+    if (value > h->max) {
+        h->max = value;
+    }
+}
+
+static inline void perf_hist_reset(perf_hist_t *h)
+{
+    memset(h, 0, sizeof(*h));
+}
+
+// Lower bound of a bucket's value range.
+uint32_t perf_hist_bucket_floor(uint32_t index);
+
+// out = now - before. max is taken from now (it cannot be windowed).
+void perf_hist_delta(const perf_hist_t *now, const perf_hist_t *before, perf_hist_t *out);
+
+// Percentiles interpolated inside the matching bucket, count 0 if empty.
+void perf_hist_summarize(const perf_hist_t *h, perf_summary_t *summary);
+
+#ifdef __cplusplus
+}
+#endif
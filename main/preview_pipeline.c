@@ -0,0 +1,1602 @@
+/*
+ * Camera -> LCD preview pipeline
+ * 摄像头到LCD的预览流水线
+ *
+ * capture task:  esp_camera_fb_get -> capture ring
+ * convert task:  capture ring -> scale into LCD buffer -> display ring
+ * display task:  display ring -> display_submitter (async SPI queue)
+ *
+ * Both rings drop the oldest frame when full, so a slow stage always
+ * works on the newest frame instead of building up latency. Before that,
+ * the capture task paces frames (frame_pacer.h): frames above the target
+ * FPS, or that the downstream could not start before the next one
+ * arrives, go straight back to the driver.
+ *
+ * Band mode (EXAMPLE_DISPLAY_BAND_ROWS > 0): the convert task scales
+ * a few output rows at a time into small internal-RAM buffers and sends
+ * each one while scaling the next, all bands continuing one memory write.
+ * No full-screen DMA buffer is needed and the display task is not used.
+ *
+ * YUV422 frames (EXAMPLE_CAMERA_PIXFORMAT) are converted, cropped and
+ * scaled in the same single pass over PSRAM; the Y value of every output
+ * pixel is kept in a luma plane as a by-product.
+ *
+ * With a sensor window (EXAMPLE_SENSOR_WINDOW) the OV7670 itself crops and
+ * downsamples to the panel size; the driver still reports its frame_size,
+ * so the frame is taken to be the window size and the scaler reduces to a
+ * 1:1 row copy.
+ *
+ * The capture format (pixel format, sensor window, crop) can change at
+ * runtime: pause stops the capture task and waits until every frame in
+ * flight has been displayed or dropped, the caller reprograms the sensor,
+ * and frames started before the last register write are discarded after
+ * resuming. The scaler rebuilds its tables on the first frame whose
+ * geometry differs.
+ *
+ * With EXAMPLE_DISPLAY_DIRTY_RECTS the display task compares each frame
+ * tile by tile against what is already on the panel and sends only the
+ * changed rectangles, each with its own window.
+ *
+ * Zero-copy (EXAMPLE_DISPLAY_ZERO_COPY): when an RGB565 frame already is
+ * the panel image (1:1, rows contiguous, e.g. a 128x160 sensor window),
+ * the convert task only writes back the CPU cache for it and hands the
+ * camera frame itself to the display task; SPI DMA reads it straight from
+ * PSRAM and the frame goes back to the driver once the transfer is done.
+ *
+ * Pixel data goes to the panel through display_submitter.h: the window
+ * is set only when it changes and the data is split into
+ * EXAMPLE_DISPLAY_CHUNK_BYTES transactions that keep the SPI queue full;
+ * the periodic stats report how busy the bus was and how long it idled
+ * while a frame was still being sent.
+ *
+ * The scaler does not read the camera frame in PSRAM directly: with
+ * EXAMPLE_SCALER_PREFETCH_ROWS the source rows of each few output rows are
+ * copied into internal RAM by GDMA (frame_prefetch.h) while the previous
+ * ones are scaled, so its strided loads no longer miss the cache.
+ *
+ * With EXAMPLE_RECORDER_FPS the rows of a scaled frame are also copied
+ * into the recorder's snapshot now and then (frame_recorder.h); encoding
+ * and writing to flash happen in its own task.
+ *
+ * With EXAMPLE_MOTION_IDLE every frame is first reduced to a small luma
+ * thumbnail of the same field of view and scored against the previous one
+ * (motion_detect.h). While the scene is static the frame goes straight
+ * back to the driver: no conversion, no SPI, the panel keeps the last
+ * image; one frame is still shown every EXAMPLE_MOTION_IDLE_REFRESH_MS.
+ *
+ * With EXAMPLE_FRAME_CHECK every frame is checked before anything else
+ * reads it (frame_check.h): a sample of rows is hashed and compared with
+ * the recent frames and with the last good one, so short, truncated, torn,
+ * test pattern and misaligned frames go back to the driver instead of to
+ * the panel, counted by class. A frame identical to a recent one is still
+ * shown (a static scene) and only counted.
+ *
+ * With EXAMPLE_FRAME_STATS_STEP the exposure statistics of each frame
+ * (frame_analysis.h) are accumulated from the output rows right after they
+ * are scaled, while they are still in cache, and published when the frame
+ * is complete.
+ *
+ * EXAMPLE_PIPELINE_PROFILE times every stage with esp_timer (one clock for
+ * both cores and the ISR) into fixed log-bucket histograms; recording is
+ * a few integer ops, all formatting happens in the periodic report.
+ */
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_cache.h"
+#include "esp_memory_utils.h"
+#include "esp_camera.h"
+#include "example_config.h"
+#include "frame_scaler.h"
+#include "frame_ring.h"
+#include "display_buffers.h"
+#include "display_submitter.h"
+#include "ov7670_window.h"
+#include "tile_diff.h"
+#include "perf_stats.h"
+#include "frame_pacer.h"
+#include "buffer_arena.h"
+#include "frame_prefetch.h"
+#include "frame_recorder.h"
+#include "motion_detect.h"
+#include "frame_analysis.h"
+#include "frame_check.h"
+#include "preview_pipeline.h"
+
+static const char *TAG = "preview_pipeline";
+
+// 已知摄像头分辨率的显示方式, 与原来三个固定分支的输出逐像素一致
+typedef struct {
+    uint16_t width;
+    uint16_t height;
+    frame_scaler_mode_t mode;
+    uint16_t crop_width;
+    uint16_t crop_height;
+} preview_profile_t;
+
+static const preview_profile_t s_preview_profiles[] = {
+    {160, 120, FRAME_SCALER_MODE_CROP, 128, 120},      // QQVGA: 水平居中裁剪128列, 垂直拉伸
+    {128, 128, FRAME_SCALER_MODE_LETTERBOX, 0, 0},     // 128x128: 居中显示, 上下留黑边
+    {320, 240, FRAME_SCALER_MODE_CROP, 256, 192},      // QVGA: 居中裁剪256x192后缩放
+    {128, 160, FRAME_SCALER_MODE_LETTERBOX, 0, 0},     // 传感器开窗输出, 1:1 拷贝
+    {160, 128, FRAME_SCALER_MODE_LETTERBOX, 0, 0},
+};
+
+typedef struct {
+    uint32_t captured;
+    uint32_t capture_failed;
+    uint32_t converted;
+    uint32_t rejected;   // 格式/尺寸不支持
+    uint32_t stale;      // 切换采集配置前开始的帧
+    uint32_t displayed;
+    uint32_t draw_failed;
+    uint32_t static_frames;    // 局部刷新: 没有变化, 未发送
+    uint32_t last_frame_bytes; // 最近一帧通过SPI发送的字节数
+    uint64_t bytes_sent;
+    uint32_t zero_copy;        // 直接从摄像头帧缓冲发送的帧
+    uint64_t bytes_copied;     // 缩放/拷贝写入LCD缓冲区的字节数
+    uint64_t convert_us;       // 转换任务处理帧内容的CPU时间
+    uint32_t idle;             // 画面静止, 未转换未发送的帧
+    uint32_t motion_events;
+    uint64_t motion_us;        // 缩略图与运动评分的CPU时间
+    uint32_t corrupt;          // 检测为损坏, 丢弃的帧
+    uint64_t check_us;         // 损坏检测的CPU时间
+} preview_counters_t;
+
+static display_submitter_t s_submitter;
+static frame_scaler_t s_scaler;
+static frame_ring_t s_capture_ring;   // camera_fb_t *
+static frame_ring_t s_display_ring;   // 已缩放的LCD缓冲区
+static TaskHandle_t s_capture_task;
+static TaskHandle_t s_convert_task;
+static TaskHandle_t s_display_task;
+static preview_counters_t s_counters;
+static volatile frame_scaler_filter_t s_filter = EXAMPLE_PREVIEW_FILTER;
+static uint8_t *s_luma; // YUV422 时的亮度平面, LCD 分辨率
+#if EXAMPLE_SCALER_PREFETCH_ROWS > 0
+static frame_prefetch_t s_prefetch;
+static void *s_prefetch_mem[FRAME_PREFETCH_SLOTS];
+static volatile bool s_prefetch_enabled = true;
+#endif
+static int64_t s_first_frame_us; // 第一帧提交到屏幕的时间 (自启动)
+
+// 当前采集配置, 只在暂停时修改
+static preview_capture_t s_capture = {
+    .format = EXAMPLE_CAMERA_PIXFORMAT,
+    .window = EXAMPLE_SENSOR_WINDOW,
+};
+static int64_t s_valid_from_us;          // 早于该时间开始的帧属于切换之前, 丢弃
+static atomic_uint_least32_t s_in_flight; // 已取得但尚未显示或丢弃的帧
+static atomic_bool s_pause_request;
+static atomic_bool s_wait_shown;         // 恢复后等待第一帧上屏
+static int64_t s_shown_us;
+static TaskHandle_t s_waiter;            // 调用 pause/resume 的任务
+
+static frame_pacer_t s_pacer;
+static volatile uint32_t s_convert_since; // 转换任务开始当前帧的时间 (微秒, 低32位), 0 = 空闲
+
+#define FRAME_BYTES (EXAMPLE_PREVIEW_WIDTH * EXAMPLE_PREVIEW_HEIGHT * sizeof(uint16_t))
+
+// 每次颜色传输的字节数, 不超过总线的 max_transfer_sz
+#if EXAMPLE_DISPLAY_CHUNK_BYTES < EXAMPLE_LCD_MAX_TRANSFER_BYTES
+#define DISPLAY_CHUNK_BYTES EXAMPLE_DISPLAY_CHUNK_BYTES
+#else
+#define DISPLAY_CHUNK_BYTES EXAMPLE_LCD_MAX_TRANSFER_BYTES
+#endif
+
+#if EXAMPLE_LCD_TRANS_QUEUE_DEPTH >= DISPLAY_SUBMITTER_SLOTS
+#error "EXAMPLE_LCD_TRANS_QUEUE_DEPTH must be smaller than DISPLAY_SUBMITTER_SLOTS"
+#endif
+
+#if EXAMPLE_DISPLAY_DIRTY_RECTS && EXAMPLE_DISPLAY_BAND_ROWS > 0
+#error "EXAMPLE_DISPLAY_DIRTY_RECTS needs full-frame buffers (EXAMPLE_DISPLAY_BAND_ROWS 0)"
+#endif
+
+#if EXAMPLE_DISPLAY_BAND_ROWS > 0
+#define DISPLAY_BUFFER_ROWS EXAMPLE_DISPLAY_BAND_ROWS
+#define DISPLAY_BUFFER_COUNT EXAMPLE_DISPLAY_BAND_COUNT
+#else
+#define DISPLAY_BUFFER_ROWS EXAMPLE_PREVIEW_HEIGHT
+#define DISPLAY_BUFFER_COUNT EXAMPLE_DISPLAY_BUFFER_COUNT
+#endif
+
+// 显示缓冲区: 缩放下一帧(或下一段)的同时, SPI DMA发送上一帧(段)
+static display_buffers_t s_display;
+static void *s_display_mem[DISPLAY_BUFFER_COUNT]; // 启动时从 buffer_arena 预留
+static SemaphoreHandle_t s_display_released;
+
+// 零拷贝只用于整帧模式; 局部刷新要拷贝矩形, 不使用
+#define DISPLAY_ZERO_COPY (EXAMPLE_DISPLAY_ZERO_COPY && EXAMPLE_DISPLAY_BAND_ROWS == 0 && \
+                           !EXAMPLE_DISPLAY_DIRTY_RECTS)
+
+#if DISPLAY_ZERO_COPY
+// 直接发送的摄像头帧: 经显示队列交给显示任务, 传输完成后才归还驱动.
+// 一个帧缓冲同一时间只在一处, 槽位数与驱动的帧缓冲数相同
+typedef struct {
+    camera_fb_t *pic;     // NULL = 空闲槽位
+    const uint16_t *data; // 屏幕窗口的第一个像素
+    bool sent;            // 已提交给SPI, 完成数达到 mark 时归还
+    uint32_t mark;
+} in_place_frame_t;
+
+static in_place_frame_t s_in_place[EXAMPLE_CAMERA_FB_COUNT];
+static atomic_uint_least32_t s_in_place_sent; // 已提交尚未归还的帧数
+
+static inline bool is_in_place(const void *item)
+{
+    return (const in_place_frame_t *)item >= s_in_place &&
+           (const in_place_frame_t *)item < s_in_place + EXAMPLE_CAMERA_FB_COUNT;
+}
+#endif
+
+// 驱动用 esp_timer 填写 timestamp, 与 esp_timer_get_time() 同一时钟
+static inline int64_t frame_time_us(const camera_fb_t *pic)
+{
+    return pic->timestamp.tv_sec * 1000000LL + pic->timestamp.tv_usec;
+}
+
+#if EXAMPLE_PIPELINE_PROFILE
+static perf_hist_t s_perf[PREVIEW_PERF_STAGE_COUNT];
+static uint32_t s_buffer_capture[DISPLAY_BUFFER_COUNT]; // 整帧缓冲区对应的采集时间
+static uint32_t s_last_frame_done;
+static int64_t s_start_time;
+
+static const char *const s_perf_names[PREVIEW_PERF_STAGE_COUNT] = {
+    "fb_get", "convert", "buf_wait", "submit", "transfer", "idle", "frame", "latency",
+};
+
+// 微秒, 32位回绕后差值仍然正确
+static inline uint32_t perf_now(void)
+{
+    return (uint32_t)esp_timer_get_time();
+}
+#define PERF_START(var) uint32_t var = perf_now()
+#define PERF_RECORD(stage, start) perf_hist_record(&s_perf[stage], perf_now() - (start))
+
+static inline uint32_t perf_capture_time(const camera_fb_t *pic)
+{
+    return (uint32_t)frame_time_us(pic);
+}
+
+static uint32_t *perf_buffer_capture(const void *buffer)
+{
+    for (int i = 0; i < DISPLAY_BUFFER_COUNT; i++) {
+        if (s_display.buffers[i] == buffer) {
+            return &s_buffer_capture[i];
+        }
+    }
+    return &s_buffer_capture[0];
+}
+#define PERF_CAPTURE_TIME(pic) perf_capture_time(pic)
+#define PERF_SET_BUFFER_CAPTURE(buffer, pic) (*perf_buffer_capture(buffer) = perf_capture_time(pic))
+#define PERF_BUFFER_CAPTURE(buffer) (*perf_buffer_capture(buffer))
+#else
+#define PERF_START(var)
+#define PERF_RECORD(stage, start)
+#define PERF_CAPTURE_TIME(pic) 0
+#define PERF_SET_BUFFER_CAPTURE(buffer, pic)
+#define PERF_BUFFER_CAPTURE(buffer) 0
+#endif
+
+// SPI颜色数据传输完成回调 (ISR上下文), 归还缓冲区给生产者
+bool IRAM_ATTR preview_pipeline_color_trans_done(esp_lcd_panel_io_handle_t panel_io,
+                                                 esp_lcd_panel_io_event_data_t *edata, void *user_ctx)
+{
+    BaseType_t need_yield = pdFALSE;
+    uint32_t queued_us;
+    // tag: 帧的最后一次传输为采集时间, 其余为 0
+    uint32_t captured = display_submitter_on_trans_done(&s_submitter, &queued_us);
+    display_buffers_on_trans_done(&s_display);
+#if EXAMPLE_PIPELINE_PROFILE
+    PERF_RECORD(PREVIEW_PERF_TRANSFER, queued_us);
+    if (captured != 0) {
+        PERF_RECORD(PREVIEW_PERF_LATENCY, captured);
+    }
+#else
+    (void)captured;
+#endif
+    xSemaphoreGiveFromISR(s_display_released, &need_yield);
+#if DISPLAY_ZERO_COPY
+    // 显示任务归还已发送完的摄像头帧, 驱动才能尽快用它采集下一帧
+    if (atomic_load_explicit(&s_in_place_sent, memory_order_relaxed) != 0) {
+        vTaskNotifyGiveFromISR(s_display_task, &need_yield);
+    }
+#endif
+    return need_yield == pdTRUE;
+}
+
+// 等待下一个可写的显示缓冲区
+static uint16_t *display_acquire_buffer(void)
+{
+    PERF_START(start);
+    void *buffer;
+    while ((buffer = display_buffers_acquire(&s_display)) == NULL) {
+        if (xSemaphoreTake(s_display_released, pdMS_TO_TICKS(1000)) != pdTRUE) {
+            ESP_LOGW(TAG, "Timed out waiting for LCD transfer to finish");
+        }
+    }
+    PERF_RECORD(PREVIEW_PERF_BUFFER_WAIT, start);
+    return (uint16_t *)buffer;
+}
+
+// 排队像素数据, 延续 display_submitter_begin 开始的矩形. 调用方先把
+// display_submitter_transactions() 次传输计入 s_display: 回调可能在返回前触发.
+// captured 非 0 表示这是一帧的最后一段数据 (用于端到端延迟)
+static esp_err_t display_push(const void *data, size_t bytes, uint32_t captured, uint32_t *queued)
+{
+    PERF_START(start);
+    // 队列满时在这里等待, 总线不会空闲
+    esp_err_t ret = display_submitter_push(&s_submitter, data, bytes, captured, queued);
+    PERF_RECORD(PREVIEW_PERF_SUBMIT, start);
+    if (ret == ESP_OK) {
+        s_counters.bytes_sent += bytes;
+    }
+    return ret;
+}
+
+#if !EXAMPLE_DISPLAY_DIRTY_RECTS
+// 异步发送 rows 行, 传输完成后缓冲区由回调归还
+static esp_err_t display_submit_rows(uint16_t *buffer, int rows, uint32_t captured)
+{
+    size_t bytes = EXAMPLE_PREVIEW_WIDTH * rows * sizeof(uint16_t);
+    uint32_t count = display_submitter_transactions(&s_submitter, bytes), queued;
+
+    display_buffers_submit(&s_display, buffer, count);
+    esp_err_t ret = display_push(buffer, bytes, captured, &queued);
+    if (ret != ESP_OK) {
+        // 已排队的部分发送完后缓冲区才空闲
+        display_buffers_cancel(&s_display, buffer, count - queued);
+    }
+    return ret;
+}
+
+// 整帧缓冲区, 一个窗口
+static esp_err_t display_submit_frame(uint16_t *buffer)
+{
+    esp_err_t ret = display_submitter_begin(&s_submitter, 0, 0, EXAMPLE_PREVIEW_WIDTH,
+                                            EXAMPLE_PREVIEW_HEIGHT);
+    if (ret != ESP_OK) {
+        display_buffers_release(&s_display, buffer);
+        return ret;
+    }
+    ret = display_submit_rows(buffer, EXAMPLE_PREVIEW_HEIGHT, PERF_BUFFER_CAPTURE(buffer));
+    display_submitter_end(&s_submitter);
+    return ret;
+}
+#endif
+
+#if DISPLAY_ZERO_COPY
+// 帧内容与屏幕窗口逐像素一致且行连续时, 返回窗口的第一个像素, 否则 NULL
+static const uint16_t *in_place_data(const camera_fb_t *pic)
+{
+    const frame_rect_t *src = &s_scaler.src_rect, *dst = &s_scaler.dst_rect;
+
+    if (s_capture.format != PIXFORMAT_RGB565 || s_scaler.x_kernel != FRAME_SCALER_KERNEL_COPY ||
+        dst->x != 0 || dst->y != 0 || dst->width != EXAMPLE_PREVIEW_WIDTH ||
+        dst->height != EXAMPLE_PREVIEW_HEIGHT || src->height != EXAMPLE_PREVIEW_HEIGHT ||
+        s_scaler.geometry.src_stride != EXAMPLE_PREVIEW_WIDTH) {
+        return NULL;
+    }
+    // 跨行裁剪 (stride > 宽度) 要每行一次传输, 比拷贝更慢, 仍走拷贝
+    const uint16_t *data = (const uint16_t *)pic->buf + s_scaler.y_offset[0] + s_scaler.x_map[0];
+    // 不能被DMA直接读取时SPI驱动会自己拷贝一份, 省不下什么
+    if (((uintptr_t)data & 3) != 0 ||
+        !(esp_ptr_dma_capable(data) || esp_ptr_dma_ext_capable(data))) {
+        return NULL;
+    }
+    return data;
+}
+
+static in_place_frame_t *in_place_claim(camera_fb_t *pic, const uint16_t *data)
+{
+    for (int i = 0; i < EXAMPLE_CAMERA_FB_COUNT; i++) {
+        if (s_in_place[i].pic == NULL) {
+            s_in_place[i] = (in_place_frame_t) {.pic = pic, .data = data};
+            return &s_in_place[i];
+        }
+    }
+    return NULL;
+}
+
+// 槽位先清空再归还: 驱动随后可能把同一个帧缓冲交给转换任务
+static void in_place_return(in_place_frame_t *frame)
+{
+    camera_fb_t *pic = frame->pic;
+    if (frame->sent) {
+        atomic_fetch_sub(&s_in_place_sent, 1);
+    }
+    frame->sent = false;
+    frame->pic = NULL;
+    esp_camera_fb_return(pic);
+}
+
+// 归还已传输完成的摄像头帧 (显示任务)
+static void in_place_reclaim(void)
+{
+    for (int i = 0; i < EXAMPLE_CAMERA_FB_COUNT; i++) {
+        if (s_in_place[i].sent && display_buffers_reached(&s_display, s_in_place[i].mark)) {
+            in_place_return(&s_in_place[i]);
+        }
+    }
+}
+
+// SPI DMA 直接读取 PSRAM 中的帧; 写回已在转换任务中完成
+static esp_err_t display_submit_in_place(in_place_frame_t *frame)
+{
+    uint32_t count = display_submitter_transactions(&s_submitter, FRAME_BYTES), queued = 0;
+    esp_err_t ret = display_submitter_begin(&s_submitter, 0, 0, EXAMPLE_PREVIEW_WIDTH,
+                                            EXAMPLE_PREVIEW_HEIGHT);
+    if (ret == ESP_OK) {
+        display_buffers_submit(&s_display, NULL, count);
+        frame->mark = display_buffers_mark(&s_display);
+        frame->sent = true;
+        atomic_fetch_add(&s_in_place_sent, 1);
+        ret = display_push(frame->data, FRAME_BYTES, PERF_CAPTURE_TIME(frame->pic), &queued);
+        display_submitter_end(&s_submitter);
+        if (ret != ESP_OK) {
+            display_buffers_cancel(&s_display, NULL, count - queued);
+            frame->mark = display_buffers_mark(&s_display);
+        }
+    }
+    // 部分已排队时帧留到那些传输完成再归还
+    if (ret != ESP_OK && queued == 0) {
+        in_place_return(frame);
+    }
+    return ret;
+}
+#endif
+
+// 丢弃显示队列中的一项: LCD缓冲区, 或零拷贝时的摄像头帧
+static void display_drop(void *item)
+{
+#if DISPLAY_ZERO_COPY
+    if (is_in_place(item)) {
+        in_place_return((in_place_frame_t *)item);
+        return;
+    }
+#endif
+    display_buffers_release(&s_display, item);
+}
+
+#if EXAMPLE_DISPLAY_DIRTY_RECTS
+static tile_diff_t s_tile_diff;
+static uint16_t *s_staging;      // 非整行矩形的连续拷贝
+static uint32_t s_staging_mark;  // 暂存区上次发送的完成标记
+
+// 矩形的发送数据: 整行宽度直接指向帧缓冲, 否则拷贝到暂存区;
+// 暂存区不够时把矩形扩展为整行
+static const uint16_t *dirty_rect_data(const uint16_t *buffer, frame_rect_t *r, uint32_t *staged)
+{
+    uint32_t area = (uint32_t)r->width * r->height;
+
+    if (r->width < EXAMPLE_PREVIEW_WIDTH && *staged + area <= EXAMPLE_DIRTY_STAGING_PIXELS) {
+        if (*staged == 0) {
+            // 上一次用暂存区的传输可能还没完成
+            while (!display_buffers_reached(&s_display, s_staging_mark)) {
+                vTaskDelay(1);
+            }
+        }
+        uint16_t *out = s_staging + *staged;
+        for (uint32_t row = 0; row < r->height; row++) {
+            memcpy(out + row * r->width, buffer + (r->y + row) * EXAMPLE_PREVIEW_WIDTH + r->x,
+                   r->width * sizeof(uint16_t));
+        }
+        *staged += area;
+        return out;
+    }
+    r->x = 0;
+    r->width = EXAMPLE_PREVIEW_WIDTH;
+    return buffer + r->y * EXAMPLE_PREVIEW_WIDTH;
+}
+
+// 只发送与屏幕内容不同的矩形, 每个矩形设置一次窗口
+static esp_err_t display_submit_dirty(uint16_t *buffer)
+{
+    frame_rect_t rects[TILE_DIFF_MAX_RECTS];
+    const uint16_t *data[TILE_DIFF_MAX_RECTS];
+    size_t count = tile_diff_update(&s_tile_diff, buffer, rects);
+    uint32_t staged = 0, bytes = 0, transactions = 0, queued = 0;
+
+    if (count == 0) {
+        display_buffers_release(&s_display, buffer);
+        s_counters.static_frames++;
+        s_counters.last_frame_bytes = 0;
+        return ESP_OK;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        data[i] = dirty_rect_data(buffer, &rects[i], &staged);
+        transactions += display_submitter_transactions(&s_submitter,
+                                                       (size_t)rects[i].width * rects[i].height * sizeof(uint16_t));
+    }
+    // 整帧的传输一次计入: 缓冲区在最后一个矩形发送完之前不能被重新获取
+    display_buffers_submit(&s_display, buffer, transactions);
+    for (size_t i = 0; i < count; i++) {
+        const frame_rect_t *r = &rects[i];
+        uint32_t rect_bytes = (uint32_t)r->width * r->height * sizeof(uint16_t), sent = 0;
+        esp_err_t ret = display_submitter_begin(&s_submitter, r->x, r->y, r->x + r->width, r->y + r->height);
+        if (ret == ESP_OK) {
+            ret = display_push(data[i], rect_bytes, i + 1 == count ? PERF_BUFFER_CAPTURE(buffer) : 0, &sent);
+            display_submitter_end(&s_submitter);
+        }
+        queued += sent;
+        if (ret != ESP_OK) {
+            display_buffers_cancel(&s_display, buffer, transactions - queued);
+            s_staging_mark = display_buffers_mark(&s_display);
+            tile_diff_invalidate(&s_tile_diff);
+            return ret;
+        }
+        bytes += rect_bytes;
+    }
+    if (staged > 0) {
+        s_staging_mark = display_buffers_mark(&s_display);
+    }
+    s_counters.last_frame_bytes = bytes;
+    return ESP_OK;
+}
+#endif
+
+// 根据源图尺寸生成缩放几何参数, 未知分辨率使用 EXAMPLE_PREVIEW_SCALE_MODE
+static void preview_geometry_for(uint16_t width, uint16_t height, frame_scaler_geometry_t *geometry)
+{
+    *geometry = (frame_scaler_geometry_t) {
+        .src_width = width,
+        .src_height = height,
+        .src_stride = width,
+        .dst_width = EXAMPLE_PREVIEW_WIDTH,
+        .dst_height = EXAMPLE_PREVIEW_HEIGHT,
+        .mode = EXAMPLE_PREVIEW_SCALE_MODE,
+        .filter = s_filter,
+    };
+
+    for (size_t i = 0; i < sizeof(s_preview_profiles) / sizeof(s_preview_profiles[0]); i++) {
+        const preview_profile_t *p = &s_preview_profiles[i];
+        if (p->width == width && p->height == height) {
+            geometry->mode = p->mode;
+            geometry->crop_width = p->crop_width;
+            geometry->crop_height = p->crop_height;
+            break;
+        }
+    }
+    if (s_capture.crop_width != 0 && s_capture.crop_height != 0) {
+        geometry->mode = FRAME_SCALER_MODE_CROP;
+        geometry->crop_width = s_capture.crop_width;
+        geometry->crop_height = s_capture.crop_height;
+    }
+}
+
+// 相邻两帧提交完成的间隔
+static inline void perf_frame_done(void)
+{
+#if EXAMPLE_PIPELINE_PROFILE
+    uint32_t now = perf_now();
+    if (s_last_frame_done != 0) {
+        perf_hist_record(&s_perf[PREVIEW_PERF_FRAME], now - s_last_frame_done);
+    }
+    s_last_frame_done = now;
+#endif
+}
+
+// 启动到第一帧上屏的时间, 只记录一次
+static void note_first_frame(void)
+{
+    if (s_first_frame_us == 0) {
+        s_first_frame_us = esp_timer_get_time();
+        ESP_LOGI(TAG, "First frame on the panel %" PRId64 " ms after boot", s_first_frame_us / 1000);
+    }
+}
+
+// 一帧已提交到屏幕; 恢复后的第一帧记录时间并唤醒等待者
+static void note_frame_shown(void)
+{
+    note_first_frame();
+    frame_pacer_shown(&s_pacer, esp_timer_get_time());
+    if (atomic_load(&s_wait_shown)) {
+        s_shown_us = esp_timer_get_time();
+        atomic_store(&s_wait_shown, false);
+        xTaskNotifyGive(s_waiter);
+    }
+}
+
+// 一帧处理结束 (显示、丢弃或拒绝); 暂停时最后一帧结束即唤醒等待者
+static void frame_retired(void)
+{
+    if (atomic_fetch_sub(&s_in_flight, 1) == 1 && atomic_load(&s_pause_request)) {
+        xTaskNotifyGive(s_waiter);
+    }
+}
+
+#if EXAMPLE_FRAME_STATS_STEP > 0
+static frame_stats_t s_stats_acc;      // 转换任务正在累计的帧
+static frame_stats_t s_stats;          // 最近完成的一帧
+static atomic_uint_least32_t s_stats_seq; // 奇数: s_stats 正在更新
+#endif
+
+// 曝光统计只覆盖被图像覆盖的区域, 不算黑边
+static inline void stats_begin(void)
+{
+#if EXAMPLE_FRAME_STATS_STEP > 0
+    const frame_rect_t *r = &s_scaler.dst_rect;
+    frame_stats_begin(&s_stats_acc, r->x, r->y, r->width, r->height, EXAMPLE_FRAME_STATS_STEP);
+#endif
+}
+
+static inline void stats_rows(const uint16_t *rows, int y0, int count)
+{
+#if EXAMPLE_FRAME_STATS_STEP > 0
+    frame_stats_rows(&s_stats_acc, rows, EXAMPLE_PREVIEW_WIDTH, y0, count);
+#endif
+}
+
+static void stats_publish(void)
+{
+#if EXAMPLE_FRAME_STATS_STEP > 0
+    frame_stats_end(&s_stats_acc);
+    atomic_fetch_add(&s_stats_seq, 1);
+    s_stats = s_stats_acc;
+    atomic_fetch_add(&s_stats_seq, 1);
+#endif
+}
+
+// 缩放输出的第 y0 行开始的 rows 行, 按帧格式选择内核;
+// band 非 NULL 时从预取到内部RAM的源图行 (从 first_row 起) 读取
+static void scale_span(const camera_fb_t *pic, const void *band, uint32_t first_row, uint16_t *dst,
+                       int y0, int rows)
+{
+    uint8_t *luma = s_luma ? s_luma + y0 * EXAMPLE_PREVIEW_WIDTH : NULL;
+
+    if (s_capture.format == PIXFORMAT_YUV422) {
+        if (band) {
+            frame_scaler_run_yuv422_rows_band(&s_scaler, band, first_row, dst, luma, y0, rows);
+        } else {
+            frame_scaler_run_yuv422_rows(&s_scaler, pic->buf, dst, luma, y0, rows);
+        }
+    } else if (band) {
+        frame_scaler_run_rows_band(&s_scaler, band, first_row, dst, y0, rows);
+    } else {
+        frame_scaler_run_rows(&s_scaler, (const uint16_t *)pic->buf, dst, y0, rows);
+    }
+    // 刚写出的行还在缓存里
+    stats_rows(dst, y0, rows);
+}
+
+#if EXAMPLE_SCALER_PREFETCH_ROWS > 0
+// 子段在 EXAMPLE_SCALER_PREFETCH_ROWS 的整数倍处分开, 分段模式下一次调用的
+// 第一段与上一次调用末尾提前拷贝的相同
+static int prefetch_rows(int y, int end)
+{
+    int n = EXAMPLE_SCALER_PREFETCH_ROWS - y % EXAMPLE_SCALER_PREFETCH_ROWS;
+    return n < end - y ? n : end - y;
+}
+#endif
+
+static void scale_rows(const camera_fb_t *pic, uint16_t *dst, int y0, int rows)
+{
+#if EXAMPLE_SCALER_PREFETCH_ROWS > 0
+    if (s_prefetch_enabled) {
+        int end = y0 + rows;
+        for (int y = y0, n; y < end; y += n) {
+            n = prefetch_rows(y, end);
+            uint32_t first_row;
+            const void *band = frame_prefetch_get(&s_prefetch, &s_scaler, pic->buf, y, n, &first_row);
+            // 缩放这一段时 DMA 拷贝下一段: 本次调用里的, 或分段模式下一段的开头
+            int next = y + n;
+            if (next < EXAMPLE_PREVIEW_HEIGHT) {
+                frame_prefetch_start(&s_prefetch, &s_scaler, pic->buf, next,
+                                     prefetch_rows(next, next < end ? end : EXAMPLE_PREVIEW_HEIGHT));
+            }
+            scale_span(pic, band, first_row, dst + (y - y0) * EXAMPLE_PREVIEW_WIDTH, y, n);
+        }
+        return;
+    }
+#endif
+    scale_span(pic, NULL, 0, dst, y0, rows);
+}
+
+// 录制: 选中的帧把缩放好的行拷贝一份, 由录制任务压缩写入 flash
+static inline void record_begin(const camera_fb_t *pic)
+{
+#if EXAMPLE_RECORDER_FPS > 0
+    frame_recorder_begin(frame_time_us(pic));
+#endif
+}
+
+static inline void record_rows(const uint16_t *rows, int y0, int count)
+{
+#if EXAMPLE_RECORDER_FPS > 0
+    frame_recorder_rows(rows, y0, count);
+#endif
+}
+
+static inline void record_end(bool complete)
+{
+#if EXAMPLE_RECORDER_FPS > 0
+    frame_recorder_end(complete);
+#endif
+}
+
+#if EXAMPLE_MOTION_IDLE
+#define MOTION_THUMB_PIXELS (EXAMPLE_MOTION_THUMB_WIDTH * EXAMPLE_MOTION_THUMB_HEIGHT)
+
+static frame_scaler_t s_thumb_scaler;
+static motion_detect_t s_motion;
+static uint16_t s_thumb_rgb[MOTION_THUMB_PIXELS];
+static uint8_t s_thumb[MOTION_THUMB_PIXELS];
+static atomic_bool s_motion_restart;   // 采集配置改变, 上一张缩略图不再可比
+static int64_t s_idle_shown_us;        // 静止时最近一次刷新的帧时间
+static preview_motion_cb_t s_motion_cb;
+static void *s_motion_ctx;
+
+// 运动检测: 缩略图取预览的源区域 (居中), 与预览视野相同; 返回 false 时画面静止, 这一帧不显示
+static bool motion_frame(const camera_fb_t *pic, const frame_scaler_geometry_t *preview)
+{
+    int64_t start = esp_timer_get_time();
+    frame_scaler_geometry_t geometry = {
+        .src_width = preview->src_width,
+        .src_height = preview->src_height,
+        .src_stride = preview->src_stride,
+        .dst_width = EXAMPLE_MOTION_THUMB_WIDTH,
+        .dst_height = EXAMPLE_MOTION_THUMB_HEIGHT,
+        .mode = FRAME_SCALER_MODE_CROP,
+        .crop_width = s_scaler.src_rect.width,
+        .crop_height = s_scaler.src_rect.height,
+        .filter = FRAME_SCALER_FILTER_BOX, // 2x2 平均, 压低传感器噪声
+    };
+    if (!frame_scaler_configure(&s_thumb_scaler, &geometry)) {
+        return true;
+    }
+    if (atomic_exchange(&s_motion_restart, false)) {
+        motion_detect_reset(&s_motion);
+    }
+    if (s_capture.format == PIXFORMAT_YUV422) {
+        frame_scaler_run_yuv422_rows(&s_thumb_scaler, pic->buf, s_thumb_rgb, s_thumb, 0, EXAMPLE_MOTION_THUMB_HEIGHT);
+    } else {
+        frame_scaler_run_rows(&s_thumb_scaler, (const uint16_t *)pic->buf, s_thumb_rgb, 0, EXAMPLE_MOTION_THUMB_HEIGHT);
+        motion_luma_rgb565(s_thumb_rgb, s_thumb, MOTION_THUMB_PIXELS);
+    }
+    motion_event_t event = motion_detect_update(&s_motion, s_thumb);
+    s_counters.motion_us += esp_timer_get_time() - start;
+
+    int64_t now = frame_time_us(pic);
+    if (event != MOTION_EVENT_NONE) {
+        s_counters.motion_events++;
+        ESP_LOGI(TAG, event == MOTION_EVENT_START ? "Motion (%u‰ of the scene changed), display resumed"
+                                                  : "Scene static (%u‰ changed), display idle", s_motion.score);
+        if (s_motion_cb) {
+            s_motion_cb(event == MOTION_EVENT_START, s_motion.score, s_motion_ctx);
+        }
+        s_idle_shown_us = now;
+    }
+    // 恢复后有人在等第一帧上屏, 静止也要显示
+    if (s_motion.moving || atomic_load(&s_wait_shown)) {
+        return true;
+    }
+    if (EXAMPLE_MOTION_IDLE_REFRESH_MS > 0 && now - s_idle_shown_us >= EXAMPLE_MOTION_IDLE_REFRESH_MS * 1000LL) {
+        s_idle_shown_us = now;
+        return true;
+    }
+    return false;
+}
+#endif
+
+#if EXAMPLE_FRAME_CHECK
+static frame_check_t s_check;
+static atomic_bool s_check_restart;    // 采集配置改变, 近几帧不再可比
+
+// 损坏检测: 只读取样的行; 返回 false 时这一帧丢弃
+static bool check_frame(const camera_fb_t *pic, uint16_t width, uint16_t height)
+{
+    int64_t start = esp_timer_get_time();
+    if (atomic_exchange(&s_check_restart, false)) {
+        frame_check_reset(&s_check);
+    }
+    frame_check_result_t result;
+    frame_check_run(&s_check, pic->buf, pic->len, width, height, s_capture.format == PIXFORMAT_YUV422, &result);
+    s_counters.check_us += esp_timer_get_time() - start;
+    // 与前一帧逐位相同: 静止画面, 照常显示, 只按类计数
+    if (result.verdict == FRAME_CHECK_OK || result.verdict == FRAME_CHECK_DUPLICATE) {
+        return true;
+    }
+    s_counters.corrupt++;
+    ESP_LOGW(TAG, "⚠ Corrupt frame dropped: %s from row %d (%dx%d, %zu bytes)",
+             frame_check_class_name(result.verdict), result.first_bad_row, width, height, pic->len);
+    return false;
+}
+#endif
+
+// 帧处理完, 还给驱动之前: 不能还有DMA在读它
+static void scale_frame_done(void)
+{
+#if EXAMPLE_SCALER_PREFETCH_ROWS > 0
+    frame_prefetch_end(&s_prefetch);
+#endif
+}
+
+static void capture_task(void *arg)
+{
+    buffer_arena_guard_enter();
+    while (1) {
+        PERF_START(start);
+        camera_fb_t *pic = esp_camera_fb_get();
+        PERF_RECORD(PREVIEW_PERF_CAPTURE_WAIT, start);
+        if (pic == NULL) {
+            s_counters.capture_failed++;
+            ESP_LOGE(TAG, "Camera capture failed");
+            continue;
+        }
+        // 先计入再检查暂停请求: pause 要么看到这一帧, 要么这里看到请求
+        atomic_fetch_add(&s_in_flight, 1);
+        if (atomic_load(&s_pause_request)) {
+            // 切换采集配置期间不取帧, 驱动继续用最新帧覆盖自己的缓冲区
+            esp_camera_fb_return(pic);
+            frame_retired();
+            while (atomic_load(&s_pause_request)) {
+                ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            }
+            continue;
+        }
+        if (frame_time_us(pic) < s_valid_from_us) {
+            // 寄存器改写时已经开始的帧, 尺寸或内容可能混杂
+            s_counters.stale++;
+            esp_camera_fb_return(pic);
+            frame_retired();
+            continue;
+        }
+        s_counters.captured++;
+
+        // 下游处理当前帧还需要多久, 由实测的每帧耗时估计
+        uint32_t since = s_convert_since, busy = 0;
+        if (since != 0) {
+            uint32_t elapsed = (uint32_t)esp_timer_get_time() - since;
+            busy = elapsed < s_pacer.service_us ? s_pacer.service_us - elapsed : 0;
+        }
+#if EXAMPLE_DISPLAY_BAND_ROWS == 0
+        // LCD缓冲区都在SPI队列里: 这一帧只能等着, 下一帧来时缓冲区多半也还没空出来
+        if (display_buffers_free_count(&s_display) == 0) {
+            busy = UINT32_MAX;
+        }
+#endif
+#if DISPLAY_ZERO_COPY
+        // 零拷贝同理: 一帧在发送, 一帧排在SPI队列里
+        if (atomic_load(&s_in_place_sent) >= 2) {
+            busy = UINT32_MAX;
+        }
+#endif
+        if (frame_pacer_offer(&s_pacer, frame_time_us(pic), busy) != FRAME_PACER_ACCEPT) {
+            esp_camera_fb_return(pic);
+            frame_retired();
+            continue;
+        }
+
+        void *dropped;
+        frame_ring_push(&s_capture_ring, pic, &dropped);
+        if (dropped) {
+            // 转换任务来不及处理, 最旧的一帧直接还给驱动
+            esp_camera_fb_return((camera_fb_t *)dropped);
+            frame_retired();
+        }
+        xTaskNotifyGive(s_convert_task);
+    }
+}
+
+#if EXAMPLE_DISPLAY_BAND_ROWS > 0
+// 分段缩放并发送: 第一段缩放完成即开始传输, 内部RAM只需几个小缓冲区
+static void stream_frame_bands(camera_fb_t *pic)
+{
+    esp_err_t ret = ESP_OK;
+    bool open = false;
+
+    for (int y0 = 0; y0 < EXAMPLE_PREVIEW_HEIGHT && ret == ESP_OK; y0 += DISPLAY_BUFFER_ROWS) {
+        int rows = EXAMPLE_PREVIEW_HEIGHT - y0;
+        if (rows > DISPLAY_BUFFER_ROWS) {
+            rows = DISPLAY_BUFFER_ROWS;
+        }
+        uint16_t *band = display_acquire_buffer();
+        int64_t start = esp_timer_get_time();
+        scale_rows(pic, band, y0, rows);
+        record_rows(band, y0, rows);
+        PERF_RECORD(PREVIEW_PERF_CONVERT, (uint32_t)start);
+        s_counters.convert_us += esp_timer_get_time() - start;
+        // 整帧一个窗口, 各段接着同一次写入; 第一段缩放好才开始, 之后段与段之间总线空闲算作间隙
+        if (!open) {
+            ret = display_submitter_begin(&s_submitter, 0, 0, EXAMPLE_PREVIEW_WIDTH, EXAMPLE_PREVIEW_HEIGHT);
+            if (ret != ESP_OK) {
+                display_buffers_release(&s_display, band);
+                break;
+            }
+            open = true;
+        }
+        ret = display_submit_rows(band, rows,
+                                  y0 + rows >= EXAMPLE_PREVIEW_HEIGHT ? PERF_CAPTURE_TIME(pic) : 0);
+    }
+    if (open) {
+        display_submitter_end(&s_submitter);
+    }
+    record_end(ret == ESP_OK);
+    if (ret == ESP_OK) {
+        stats_publish();
+    }
+    scale_frame_done();
+    esp_camera_fb_return(pic);
+
+    s_counters.converted++;
+    s_counters.bytes_copied += FRAME_BYTES;
+    if (ret != ESP_OK) {
+        s_counters.draw_failed++;
+        ESP_LOGE(TAG, "LCD draw failed: %s", esp_err_to_name(ret));
+    } else {
+        s_counters.displayed++;
+        s_counters.last_frame_bytes = FRAME_BYTES;
+        perf_frame_done();
+        note_frame_shown();
+    }
+    frame_retired();
+}
+#endif
+
+static void convert_frame(camera_fb_t *pic)
+{
+    frame_scaler_geometry_t geometry;
+    uint16_t width = pic->width, height = pic->height;
+    // 开窗时帧尺寸由传感器窗口决定, 驱动报告的是 frame_size
+    if (s_capture.window != OV7670_WINDOW_OFF && !ov7670_window_size(s_capture.window, &width, &height)) {
+        width = height = 0;
+    }
+#if EXAMPLE_FRAME_CHECK
+    // 尺寸已知就先检查, 长度不足也按类计数; 坏帧不显示、不录制, 也不参与运动检测
+    if (width != 0 && !check_frame(pic, width, height)) {
+        esp_camera_fb_return(pic);
+        frame_retired();
+        return;
+    }
+#endif
+    if (pic->len < (size_t)width * height * 2) {
+        width = height = 0;
+    }
+    preview_geometry_for(width, height, &geometry);
+    // 驱动可能一直报告初始化时的格式; 两种格式都是每像素2字节, 按当前采集配置解码
+    if ((pic->format != PIXFORMAT_RGB565 && pic->format != PIXFORMAT_YUV422) ||
+        !frame_scaler_configure(&s_scaler, &geometry)) {
+        s_counters.rejected++;
+        ESP_LOGW(TAG, "Camera frame size/format mismatch: %dx%d, format: %d (expected %d)",
+                 width, height, pic->format, s_capture.format);
+        esp_camera_fb_return(pic);
+        frame_retired();
+        return;
+    }
+#if EXAMPLE_MOTION_IDLE
+    if (!motion_frame(pic, &geometry)) {
+        // 屏幕上保持上一帧; 也不录制
+        s_counters.idle++;
+        esp_camera_fb_return(pic);
+        frame_retired();
+        return;
+    }
+#endif
+
+    record_begin(pic);
+    stats_begin();
+#if EXAMPLE_DISPLAY_BAND_ROWS > 0
+    stream_frame_bands(pic);
+#else
+    void *item;
+#if DISPLAY_ZERO_COPY
+    const uint16_t *data = in_place_data(pic);
+    in_place_frame_t *frame = data ? in_place_claim(pic, data) : NULL;
+    if (frame != NULL) {
+        // 不经CPU拷贝; 只需把缓存中可能的脏行写回PSRAM, DMA读到的才是完整的帧
+        int64_t start = esp_timer_get_time();
+        if (esp_ptr_external_ram(data)) {
+            esp_cache_msync((void *)data, FRAME_BYTES,
+                            ESP_CACHE_MSYNC_FLAG_DIR_C2M | ESP_CACHE_MSYNC_FLAG_UNALIGNED);
+        }
+        record_rows(data, 0, EXAMPLE_PREVIEW_HEIGHT);
+        PERF_RECORD(PREVIEW_PERF_CONVERT, (uint32_t)start);
+        s_counters.convert_us += esp_timer_get_time() - start;
+        s_counters.zero_copy++;
+        item = frame;
+    } else
+#endif
+    {
+        // 拿到空闲缓冲区时, 上一帧可能仍在通过SPI DMA发送
+        uint16_t *frame_buffer = display_acquire_buffer();
+        int64_t start = esp_timer_get_time();
+        scale_rows(pic, frame_buffer, 0, EXAMPLE_PREVIEW_HEIGHT);
+        scale_frame_done();
+        stats_publish();
+        record_rows(frame_buffer, 0, EXAMPLE_PREVIEW_HEIGHT);
+        PERF_RECORD(PREVIEW_PERF_CONVERT, (uint32_t)start);
+        s_counters.convert_us += esp_timer_get_time() - start;
+        s_counters.bytes_copied += FRAME_BYTES;
+        PERF_SET_BUFFER_CAPTURE(frame_buffer, pic);
+        esp_camera_fb_return(pic);
+        item = frame_buffer;
+    }
+    s_counters.converted++;
+    record_end(true);
+
+    void *dropped;
+    frame_ring_push(&s_display_ring, item, &dropped);
+    if (dropped) {
+        // 显示任务来不及发送, 丢弃最旧的一帧
+        display_drop(dropped);
+        frame_retired();
+    }
+    xTaskNotifyGive(s_display_task);
+#endif
+}
+
+#if EXAMPLE_PIPELINE_PROFILE
+static void log_perf_stage(int stage, const perf_hist_t *hist)
+{
+    perf_summary_t sum;
+    perf_hist_summarize(hist, &sum);
+    if (sum.count == 0) {
+        return;
+    }
+    ESP_LOGI(TAG, "  %-8s n=%-5" PRIu32 " p50 %6" PRIu32 "  p95 %6" PRIu32 "  p99 %6" PRIu32 "  max %6" PRIu32 "  mean %6" PRIu32 " us",
+             s_perf_names[stage], sum.count, sum.p50, sum.p95, sum.p99, sum.max, sum.mean);
+}
+#endif
+
+static void log_stats(int64_t elapsed_us)
+{
+    static preview_counters_t last;
+    preview_counters_t now = s_counters;
+    float seconds = elapsed_us / 1e6f;
+
+    uint32_t frames = now.displayed - last.displayed;
+    uint64_t sent = now.bytes_sent - last.bytes_sent;
+
+    ESP_LOGI(TAG, "capture %.1f fps, convert %.1f fps, display %.1f fps | dropped: capture %u, display %u | rejected %" PRIu32 ", stale %" PRIu32 ", failed %" PRIu32 "/%" PRIu32,
+             (now.captured - last.captured) / seconds,
+             (now.converted - last.converted) / seconds,
+             frames / seconds,
+             (unsigned)atomic_load(&s_capture_ring.dropped),
+             (unsigned)atomic_load(&s_display_ring.dropped),
+             now.rejected, now.stale, now.capture_failed, now.draw_failed);
+    if (frames > 0) {
+        ESP_LOGI(TAG, "SPI %.1f KB/s, %.1f%% of full frames, %" PRIu32 " static frames",
+                 sent / 1024.0f / seconds, 100.0f * sent / ((uint64_t)frames * FRAME_BYTES),
+                 now.static_frames - last.static_frames);
+    }
+    uint32_t converted = now.converted - last.converted;
+    if (converted > 0) {
+        ESP_LOGI(TAG, "copy: %" PRIu32 " bytes, %.2f ms CPU per frame | zero-copy %" PRIu32 " of %" PRIu32 " frames",
+                 (uint32_t)((now.bytes_copied - last.bytes_copied) / converted),
+                 (now.convert_us - last.convert_us) / 1000.0f / converted,
+                 now.zero_copy - last.zero_copy, converted);
+    }
+#if EXAMPLE_MOTION_IDLE
+    uint32_t scored = now.converted - last.converted + now.idle - last.idle;
+    if (scored > 0) {
+        ESP_LOGI(TAG, "motion: %s, last score %u‰ | %" PRIu32 " of %" PRIu32 " frames idle, %" PRIu32 " events, %.2f ms CPU per frame",
+                 s_motion.moving ? "moving" : "static", s_motion.score, now.idle - last.idle, scored,
+                 now.motion_events - last.motion_events, (now.motion_us - last.motion_us) / 1000.0f / scored);
+    }
+#endif
+#if EXAMPLE_FRAME_CHECK
+    // 损坏检测: 按类列出; duplicate 照常显示, 不算在丢弃的帧里
+    static uint32_t last_counts[FRAME_CHECK_CLASS_COUNT];
+    uint32_t counts[FRAME_CHECK_CLASS_COUNT], checked = 0;
+    char classes[FRAME_CHECK_CLASS_COUNT * 20] = "";
+    int len = 0;
+    memcpy(counts, s_check.counts, sizeof(counts));
+    for (int c = 0; c < FRAME_CHECK_CLASS_COUNT; c++) {
+        uint32_t n = counts[c] - last_counts[c];
+        checked += n;
+        if (c != FRAME_CHECK_OK && n > 0) {
+            len += snprintf(classes + len, sizeof(classes) - len, ", %s %" PRIu32,
+                            frame_check_class_name((frame_check_class_t)c), n);
+        }
+    }
+    memcpy(last_counts, counts, sizeof(counts));
+    if (checked > 0) {
+        ESP_LOGI(TAG, "check: %" PRIu32 " of %" PRIu32 " frames corrupt%s | %.3f ms CPU per frame",
+                 now.corrupt - last.corrupt, checked, classes, (now.check_us - last.check_us) / 1000.0f / checked);
+    }
+#endif
+#if EXAMPLE_FRAME_STATS_STEP > 0
+    // 曝光: 最近一帧的截断比例与 4x4 亮度格 (逐行, 从上到下)
+    static frame_stats_t exposure;
+    if (preview_pipeline_frame_stats(&exposure) && exposure.pixels > 0) {
+        char grid[FRAME_STATS_GRID_ROWS * (FRAME_STATS_GRID_COLS * 4 + 3)];
+        int n = 0;
+        for (int gy = 0; gy < FRAME_STATS_GRID_ROWS; gy++) {
+            for (int gx = 0; gx < FRAME_STATS_GRID_COLS; gx++) {
+                n += snprintf(grid + n, sizeof(grid) - n, gx ? " %u" : gy ? " | %u" : "%u",
+                              exposure.grid_luma[gy][gx]);
+            }
+        }
+        float pct = 100.0f / exposure.pixels;
+        ESP_LOGI(TAG, "exposure: mean luma %u, clipped high R %.1f%% G %.1f%% B %.1f%%, black %.1f%%, white %.1f%% | grid %s",
+                 exposure.mean_luma, exposure.clipped_high[FRAME_STATS_RED] * pct,
+                 exposure.clipped_high[FRAME_STATS_GREEN] * pct, exposure.clipped_high[FRAME_STATS_BLUE] * pct,
+                 exposure.black * pct, exposure.white * pct, grid);
+    }
+#endif
+#if EXAMPLE_SCALER_PREFETCH_ROWS > 0
+    // 预取: DMA 拷贝量, CPU 等拷贝完成的时间; 与关闭预取时的每帧 CPU 时间对比即 PSRAM 停顿
+    static frame_prefetch_stats_t last_prefetch;
+    frame_prefetch_stats_t prefetch = s_prefetch.stats;
+    if (converted > 0 && prefetch.copies + prefetch.fallbacks != last_prefetch.copies + last_prefetch.fallbacks) {
+        ESP_LOGI(TAG, "prefetch: %.1f KB per frame by GDMA, waited %.2f ms per frame | %" PRIu32 " copies, %" PRIu32 " not ahead, %" PRIu32 " read from PSRAM",
+                 (prefetch.bytes - last_prefetch.bytes) / 1024.0f / converted,
+                 (prefetch.wait_us - last_prefetch.wait_us) / 1000.0f / converted,
+                 prefetch.copies - last_prefetch.copies, prefetch.sync_copies - last_prefetch.sync_copies,
+                 prefetch.fallbacks - last_prefetch.fallbacks);
+    }
+    last_prefetch = prefetch;
+#endif
+#if EXAMPLE_RECORDER_FPS > 0
+    static frame_recorder_stats_t last_rec;
+    frame_recorder_stats_t rec;
+    frame_recorder_get_stats(&rec);
+    uint32_t recorded = rec.frames - last_rec.frames;
+    if (recorded > 0 || rec.skipped != last_rec.skipped || rec.failed != last_rec.failed) {
+        ESP_LOGI(TAG, "recorder: %" PRIu32 " frames, %.1f KB each (%.0f%%), encode %.2f ms, flash %.1f ms per frame | skipped %" PRIu32 ", failed %" PRIu32 ", %" PRIu32 " sectors erased",
+                 recorded,
+                 recorded ? (rec.stored_bytes - last_rec.stored_bytes) / 1024.0f / recorded : 0.0f,
+                 recorded ? 100.0f * (rec.stored_bytes - last_rec.stored_bytes) / (rec.raw_bytes - last_rec.raw_bytes) : 0.0f,
+                 recorded ? (rec.encode_us - last_rec.encode_us) / 1000.0f / recorded : 0.0f,
+                 recorded ? (rec.flash_us - last_rec.flash_us) / 1000.0f / recorded : 0.0f,
+                 rec.skipped - last_rec.skipped, rec.failed - last_rec.failed, rec.erases - last_rec.erases);
+    }
+    last_rec = rec;
+#endif
+    last = now;
+
+    // 总线占用: 颜色传输从开始发送到完成的时间; 间隙: 一帧还有数据要发时总线空闲
+    static display_submitter_stats_t last_bus;
+    static perf_hist_t last_gaps, gaps, gap_hist; // 各约 450 字节, 不放在栈上
+    display_submitter_stats_t bus = s_submitter.stats;
+    gap_hist = s_submitter.gap_hist;
+    perf_summary_t gap_sum;
+    perf_hist_delta(&gap_hist, &last_gaps, &gaps);
+    perf_hist_summarize(&gaps, &gap_sum);
+    ESP_LOGI(TAG, "SPI bus busy %.1f%%, %" PRIu32 " transactions, %" PRIu32 " windows | gaps with data waiting: %" PRIu32 ", %.2f ms total, p95 %" PRIu32 " us",
+             100.0f * (bus.busy_us - last_bus.busy_us) / elapsed_us,
+             bus.transactions - last_bus.transactions, bus.windows - last_bus.windows,
+             bus.gaps - last_bus.gaps, (bus.gap_us - last_bus.gap_us) / 1000.0f, gap_sum.p95);
+    last_bus = bus;
+    last_gaps = gap_hist;
+
+    static frame_pacer_stats_t last_pacing;
+    frame_pacer_stats_t pacing = s_pacer.stats;
+    uint32_t period = s_pacer.period_us;
+    ESP_LOGI(TAG, "pacing: target %.1f fps, shown %.1f fps, jitter %.1f ms | skipped: rate %" PRIu32 ", busy %" PRIu32 " | sensor %.1f fps, %.1f ms per frame",
+             period ? 1e6f / period : 0.0f,
+             pacing.intervals != last_pacing.intervals ?
+             1e6f * (pacing.intervals - last_pacing.intervals) / (pacing.interval_sum - last_pacing.interval_sum) : 0.0f,
+             frame_pacer_jitter_us(&pacing, &last_pacing) / 1000.0f,
+             pacing.skipped_rate - last_pacing.skipped_rate, pacing.skipped_busy - last_pacing.skipped_busy,
+             s_pacer.sensor_interval_us ? 1e6f / s_pacer.sensor_interval_us : 0.0f,
+             s_pacer.service_us / 1000.0f);
+    last_pacing = pacing;
+
+    static uint32_t last_violations;
+    uint32_t last_size;
+    uint32_t violations = buffer_arena_guard_violations(&last_size);
+    if (violations != last_violations) {
+        ESP_LOGW(TAG, "⚠ %" PRIu32 " heap allocations in the frame loop (last %" PRIu32 " bytes)",
+                 violations - last_violations, last_size);
+        last_violations = violations;
+    }
+
+#if EXAMPLE_PIPELINE_PROFILE
+    // 只统计本周期: 与上次快照相减, 写入方从不清零
+    static perf_hist_t snapshot[PREVIEW_PERF_STAGE_COUNT];
+    static perf_hist_t delta;
+    for (int i = 0; i < PREVIEW_PERF_STAGE_COUNT; i++) {
+        static perf_hist_t current;
+        current = s_perf[i];
+        perf_hist_delta(&current, &snapshot[i], &delta);
+        snapshot[i] = current;
+        log_perf_stage(i, &delta);
+    }
+#endif
+}
+
+static void display_task(void *arg)
+{
+    buffer_arena_guard_enter();
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+#if DISPLAY_ZERO_COPY
+        in_place_reclaim();
+#endif
+        void *buffer;
+        while (frame_ring_pop(&s_display_ring, &buffer)) {
+            if (atomic_load(&s_pause_request)) {
+                // 切换采集配置: 排队中的旧帧不再发送
+                display_drop(buffer);
+                frame_retired();
+                continue;
+            }
+            // Display to LCD (异步, 不等待传输完成)
+#if EXAMPLE_DISPLAY_DIRTY_RECTS
+            esp_err_t ret = display_submit_dirty((uint16_t *)buffer);
+#else
+            esp_err_t ret;
+#if DISPLAY_ZERO_COPY
+            if (is_in_place(buffer)) {
+                ret = display_submit_in_place((in_place_frame_t *)buffer);
+            } else
+#endif
+            {
+                ret = display_submit_frame((uint16_t *)buffer);
+            }
+            s_counters.last_frame_bytes = ret == ESP_OK ? FRAME_BYTES : 0;
+#endif
+            if (ret != ESP_OK) {
+                s_counters.draw_failed++;
+                ESP_LOGE(TAG, "LCD draw failed: %s", esp_err_to_name(ret));
+            } else {
+                s_counters.displayed++;
+                perf_frame_done();
+                note_frame_shown();
+            }
+            frame_retired();
+        }
+    }
+}
+
+static void convert_task(void *arg)
+{
+    int64_t last_report = esp_timer_get_time();
+
+    buffer_arena_guard_enter();
+    while (1) {
+        PERF_START(idle);
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(EXAMPLE_PIPELINE_STATS_INTERVAL_MS));
+        void *pic;
+        bool first = true;
+        while (frame_ring_pop(&s_capture_ring, &pic)) {
+            if (first) {
+                PERF_RECORD(PREVIEW_PERF_IDLE, idle);
+                first = false;
+            }
+            if (atomic_load(&s_pause_request)) {
+                esp_camera_fb_return((camera_fb_t *)pic);
+                frame_retired();
+                continue;
+            }
+            // 每帧耗时含等待空闲的LCD缓冲区, 即瓶颈阶段 (SPI) 的节奏
+            uint32_t start = (uint32_t)esp_timer_get_time() | 1;
+            s_convert_since = start;
+            convert_frame((camera_fb_t *)pic);
+            frame_pacer_service(&s_pacer, (uint32_t)esp_timer_get_time() - start);
+            s_convert_since = 0;
+        }
+
+        int64_t now = esp_timer_get_time();
+        if (now - last_report >= EXAMPLE_PIPELINE_STATS_INTERVAL_MS * 1000LL) {
+            // 浮点格式化可能分配内存, 统计输出不算帧循环
+            buffer_arena_guard_exit();
+            log_stats(now - last_report);
+            buffer_arena_guard_enter();
+            last_report = now;
+        }
+    }
+}
+
+
+void preview_pipeline_set_filter(frame_scaler_filter_t filter)
+{
+    // 转换任务下一帧生成几何参数时读取, 查找表随之重建
+    s_filter = filter;
+    ESP_LOGI(TAG, "Scaling filter set to %d", filter);
+}
+
+void preview_pipeline_set_prefetch(bool enable)
+{
+#if EXAMPLE_SCALER_PREFETCH_ROWS > 0
+    // 转换任务下一次缩放时读取; 一帧中途切换也安全, 帧结束时等待所有拷贝
+    s_prefetch_enabled = enable;
+    ESP_LOGI(TAG, "Source row prefetch %s", enable ? "on" : "off");
+#else
+    ESP_LOGW(TAG, "⚠ Source row prefetch not built (EXAMPLE_SCALER_PREFETCH_ROWS 0)");
+#endif
+}
+
+void preview_pipeline_set_target_fps(uint32_t fps)
+{
+    frame_pacer_set_fps(&s_pacer, fps);
+    ESP_LOGI(TAG, "Target frame rate set to %" PRIu32 " fps%s", fps, fps ? "" : " (sensor rate)");
+}
+
+void preview_pipeline_get_tx_stats(preview_pipeline_tx_stats_t *stats)
+{
+    stats->last_frame_bytes = s_counters.last_frame_bytes;
+    stats->full_frame_bytes = FRAME_BYTES;
+    stats->bytes_sent = s_counters.bytes_sent;
+    stats->frames = s_counters.displayed;
+    stats->static_frames = s_counters.static_frames;
+    stats->idle_frames = s_counters.idle;
+    stats->corrupt_frames = s_counters.corrupt;
+    stats->bus_busy_us = s_submitter.stats.busy_us;
+    stats->bus_gaps = s_submitter.stats.gaps;
+    stats->bus_gap_us = s_submitter.stats.gap_us;
+}
+
+bool preview_pipeline_perf_summary(preview_perf_stage_t stage, perf_summary_t *summary)
+{
+#if EXAMPLE_PIPELINE_PROFILE
+    if (stage < PREVIEW_PERF_STAGE_COUNT) {
+        perf_hist_summarize(&s_perf[stage], summary);
+        return true;
+    }
+#endif
+    return false;
+}
+
+void preview_pipeline_log_perf(void)
+{
+#if EXAMPLE_PIPELINE_PROFILE
+    float seconds = (esp_timer_get_time() - s_start_time) / 1e6f;
+    ESP_LOGI(TAG, "since start: %.1f s, %.1f fps displayed", seconds,
+             seconds > 0 ? s_counters.displayed / seconds : 0.0f);
+    for (int i = 0; i < PREVIEW_PERF_STAGE_COUNT; i++) {
+        log_perf_stage(i, &s_perf[i]);
+    }
+#else
+    ESP_LOGI(TAG, "Profiling disabled (EXAMPLE_PIPELINE_PROFILE)");
+#endif
+}
+
+int64_t preview_pipeline_first_frame_time(void)
+{
+    return s_first_frame_us;
+}
+
+bool preview_pipeline_frame_stats(frame_stats_t *stats)
+{
+#if EXAMPLE_FRAME_STATS_STEP > 0
+    // 转换任务每帧更新一次; 读到一半被更新就重读
+    uint32_t seq;
+    do {
+        seq = atomic_load(&s_stats_seq);
+        *stats = s_stats;
+    } while ((seq & 1) || atomic_load(&s_stats_seq) != seq);
+    return seq != 0;
+#else
+    return false;
+#endif
+}
+
+bool preview_pipeline_frame_check_counts(uint32_t counts[FRAME_CHECK_CLASS_COUNT])
+{
+#if EXAMPLE_FRAME_CHECK
+    memcpy(counts, s_check.counts, sizeof(s_check.counts));
+    return true;
+#else
+    memset(counts, 0, FRAME_CHECK_CLASS_COUNT * sizeof(counts[0]));
+    return false;
+#endif
+}
+
+void preview_pipeline_set_motion_callback(preview_motion_cb_t cb, void *ctx)
+{
+#if EXAMPLE_MOTION_IDLE
+    // 先写 ctx: 转换任务看到新回调时 ctx 已就绪
+    s_motion_cb = NULL;
+    s_motion_ctx = ctx;
+    s_motion_cb = cb;
+#else
+    ESP_LOGW(TAG, "⚠ Motion detection not built (EXAMPLE_MOTION_IDLE 0)");
+#endif
+}
+
+bool preview_pipeline_motion(uint16_t *score)
+{
+#if EXAMPLE_MOTION_IDLE
+    if (score != NULL) {
+        *score = s_motion.score;
+    }
+    return s_motion.moving;
+#else
+    if (score != NULL) {
+        *score = 0;
+    }
+    return true;
+#endif
+}
+
+const uint8_t *preview_pipeline_luma(void)
+{
+    return s_capture.format == PIXFORMAT_YUV422 ? s_luma : NULL;
+}
+
+esp_err_t preview_pipeline_pause(uint32_t timeout_ms)
+{
+    int64_t deadline = esp_timer_get_time() + timeout_ms * 1000LL;
+
+    if (s_capture_task == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_waiter = xTaskGetCurrentTaskHandle();
+    atomic_store(&s_pause_request, true);
+    // 采集任务阻塞在 esp_camera_fb_get 时不用等它: 拿到的帧会被直接归还
+    while (atomic_load(&s_in_flight) != 0) {
+        int64_t left = deadline - esp_timer_get_time();
+        if (left <= 0) {
+            ESP_LOGW(TAG, "⚠ Pipeline not drained after %" PRIu32 " ms, %u frames in flight",
+                     timeout_ms, (unsigned)atomic_load(&s_in_flight));
+            return ESP_ERR_TIMEOUT;
+        }
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(left / 1000) + 1);
+    }
+    return ESP_OK;
+}
+
+esp_err_t preview_pipeline_set_capture(const preview_capture_t *capture, int64_t valid_from_us)
+{
+    if (capture->format != PIXFORMAT_RGB565 && capture->format != PIXFORMAT_YUV422) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    s_capture = *capture;
+    s_valid_from_us = valid_from_us;
+#if EXAMPLE_MOTION_IDLE
+    atomic_store(&s_motion_restart, true);
+#endif
+#if EXAMPLE_FRAME_CHECK
+    atomic_store(&s_check_restart, true);
+#endif
+    return ESP_OK;
+}
+
+esp_err_t preview_pipeline_resume(uint32_t timeout_ms, int64_t *shown_us)
+{
+    int64_t deadline = esp_timer_get_time() + timeout_ms * 1000LL;
+
+    if (s_capture_task == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_waiter = xTaskGetCurrentTaskHandle();
+    atomic_store(&s_wait_shown, timeout_ms > 0);
+    atomic_store(&s_pause_request, false);
+    xTaskNotifyGive(s_capture_task);
+    while (atomic_load(&s_wait_shown)) {
+        int64_t left = deadline - esp_timer_get_time();
+        if (left <= 0) {
+            atomic_store(&s_wait_shown, false);
+            return ESP_ERR_TIMEOUT;
+        }
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(left / 1000) + 1);
+    }
+    if (shown_us != NULL) {
+        *shown_us = s_shown_us;
+    }
+    return ESP_OK;
+}
+
+esp_err_t preview_pipeline_reserve(buffer_arena_t *arena)
+{
+    size_t buffer_size = EXAMPLE_PREVIEW_WIDTH * DISPLAY_BUFFER_ROWS * sizeof(uint16_t);
+
+    // 显示缓冲区 - 整帧或分段, 均放在内部DMA内存
+    esp_err_t err = buffer_arena_request(arena, "display", BUFFER_ARENA_INTERNAL_DMA, buffer_size,
+                                         DISPLAY_BUFFER_COUNT, s_display_mem);
+#if EXAMPLE_DISPLAY_DIRTY_RECTS
+    if (err == ESP_OK) {
+        err = buffer_arena_request(arena, "dirty staging", BUFFER_ARENA_INTERNAL_DMA,
+                                   EXAMPLE_DIRTY_STAGING_PIXELS * sizeof(uint16_t), 1, (void **)&s_staging);
+    }
+#endif
+#if EXAMPLE_SCALER_PREFETCH_ROWS > 0
+    if (err == ESP_OK) {
+        err = buffer_arena_request(arena, "prefetch", BUFFER_ARENA_INTERNAL_DMA, EXAMPLE_SCALER_PREFETCH_BYTES,
+                                   FRAME_PREFETCH_SLOTS, s_prefetch_mem);
+    }
+#endif
+    // 亮度平面只由CPU写入, 放PSRAM; 运行时可能切换到 YUV422, 总是预留
+    if (err == ESP_OK) {
+        err = buffer_arena_request(arena, "luma", BUFFER_ARENA_PSRAM,
+                                   EXAMPLE_PREVIEW_WIDTH * EXAMPLE_PREVIEW_HEIGHT, 1, (void **)&s_luma);
+    }
+    return err;
+}
+
+esp_err_t preview_pipeline_init(void)
+{
+    if (s_display_mem[0] == NULL || s_luma == NULL) {
+        ESP_LOGE(TAG, "Buffers not reserved (preview_pipeline_reserve, buffer_arena_commit)");
+        return ESP_ERR_INVALID_STATE;
+    }
+    ESP_LOGI(TAG, "%d display buffers: %zu bytes each (%d rows of %dx%d display)",
+             DISPLAY_BUFFER_COUNT, EXAMPLE_PREVIEW_WIDTH * DISPLAY_BUFFER_ROWS * sizeof(uint16_t),
+             DISPLAY_BUFFER_ROWS, EXAMPLE_PREVIEW_WIDTH, EXAMPLE_PREVIEW_HEIGHT);
+
+#if EXAMPLE_DISPLAY_DIRTY_RECTS
+    tile_diff_config_t dirty_config = {
+        .width = EXAMPLE_PREVIEW_WIDTH,
+        .height = EXAMPLE_PREVIEW_HEIGHT,
+        .tile_size = EXAMPLE_DIRTY_TILE_SIZE,
+        .threshold = EXAMPLE_DIRTY_THRESHOLD,
+        .max_rects = EXAMPLE_DIRTY_MAX_RECTS,
+        .full_percent = EXAMPLE_DIRTY_FULL_PERCENT,
+    };
+    if (!tile_diff_init(&s_tile_diff, &dirty_config)) {
+        ESP_LOGE(TAG, "Unsupported dirty tile configuration");
+        return ESP_ERR_INVALID_ARG;
+    }
+#endif
+
+#if EXAMPLE_MOTION_IDLE
+    motion_config_t motion_config = {
+        .width = EXAMPLE_MOTION_THUMB_WIDTH,
+        .height = EXAMPLE_MOTION_THUMB_HEIGHT,
+        .pixel_threshold = EXAMPLE_MOTION_PIXEL_THRESHOLD,
+        .start_frames = EXAMPLE_MOTION_START_FRAMES,
+        .start_permille = EXAMPLE_MOTION_START_PERMILLE,
+        .stop_permille = EXAMPLE_MOTION_STOP_PERMILLE,
+        .stop_frames = EXAMPLE_MOTION_STOP_FRAMES,
+    };
+    if (!motion_detect_init(&s_motion, &motion_config)) {
+        ESP_LOGE(TAG, "Motion thumbnail larger than %d pixels", MOTION_THUMB_MAX_PIXELS);
+        return ESP_ERR_INVALID_ARG;
+    }
+#endif
+
+#if EXAMPLE_FRAME_CHECK
+    frame_check_config_t check_config = FRAME_CHECK_CONFIG_DEFAULT();
+    frame_check_init(&s_check, &check_config);
+#endif
+
+#if EXAMPLE_SCALER_PREFETCH_ROWS > 0
+    esp_err_t err = frame_prefetch_init(&s_prefetch, s_prefetch_mem, EXAMPLE_SCALER_PREFETCH_BYTES);
+    if (err != ESP_OK) {
+        return err;
+    }
+#endif
+
+    display_buffers_init(&s_display, s_display_mem, DISPLAY_BUFFER_COUNT);
+    frame_pacer_init(&s_pacer, EXAMPLE_PIPELINE_TARGET_FPS);
+    s_display_released = xSemaphoreCreateBinary();
+    if (s_display_released == NULL) {
+        ESP_LOGE(TAG, "Failed to create display semaphore");
+        return ESP_ERR_NO_MEM;
+    }
+    if (!frame_ring_init(&s_capture_ring, EXAMPLE_PIPELINE_CAPTURE_RING_DEPTH) ||
+        !frame_ring_init(&s_display_ring, EXAMPLE_PIPELINE_DISPLAY_RING_DEPTH)) {
+        ESP_LOGE(TAG, "Ring depth must be a power of two <= %d", FRAME_RING_MAX_SLOTS);
+        return ESP_ERR_INVALID_ARG;
+    }
+    return ESP_OK;
+}
+
+esp_err_t preview_pipeline_start(esp_lcd_panel_io_handle_t io_handle)
+{
+    display_submitter_init(&s_submitter, io_handle, DISPLAY_CHUNK_BYTES);
+    ESP_LOGI(TAG, "SPI: up to %d transactions of %d bytes queued (%" PRIu32 " per frame)",
+             EXAMPLE_LCD_TRANS_QUEUE_DEPTH, DISPLAY_CHUNK_BYTES,
+             display_submitter_transactions(&s_submitter, FRAME_BYTES));
+#if EXAMPLE_PIPELINE_PROFILE
+    s_start_time = esp_timer_get_time();
+#endif
+
+    // 先创建下游任务, 上游任务启动时即可通知它们; 分段模式由转换任务直接发送
+    if ((EXAMPLE_DISPLAY_BAND_ROWS == 0 &&
+         xTaskCreatePinnedToCore(display_task, "lcd_display", EXAMPLE_PIPELINE_STACK_SIZE, NULL,
+                                 EXAMPLE_PIPELINE_DISPLAY_PRIORITY, &s_display_task,
+                                 EXAMPLE_PIPELINE_DISPLAY_CORE) != pdPASS) ||
+        xTaskCreatePinnedToCore(convert_task, "cam_convert", EXAMPLE_PIPELINE_STACK_SIZE, NULL,
+                                EXAMPLE_PIPELINE_CONVERT_PRIORITY, &s_convert_task,
+                                EXAMPLE_PIPELINE_CONVERT_CORE) != pdPASS ||
+        xTaskCreatePinnedToCore(capture_task, "cam_capture", EXAMPLE_PIPELINE_STACK_SIZE, NULL,
+                                EXAMPLE_PIPELINE_CAPTURE_PRIORITY, &s_capture_task,
+                                EXAMPLE_PIPELINE_CAPTURE_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create pipeline tasks");
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Pipeline started: capture core %d, convert core %d, display core %d",
+             EXAMPLE_PIPELINE_CAPTURE_CORE, EXAMPLE_PIPELINE_CONVERT_CORE, EXAMPLE_PIPELINE_DISPLAY_CORE);
+    return ESP_OK;
+}
@@ -0,0 +1,151 @@
+/*
+ * Camera -> LCD preview pipeline
+ * 摄像头到LCD的预览流水线（采集/转换/显示三个任务）
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_lcd_panel_io.h"
+#include "esp_camera.h"
+#include "buffer_arena.h"
+#include "frame_analysis.h"
+#include "frame_check.h"
+#include "frame_scaler.h"
+#include "ov7670_window.h"
+#include "perf_stats.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// Profiled stages (EXAMPLE_PIPELINE_PROFILE), all in microseconds.
+typedef enum {
+    PREVIEW_PERF_CAPTURE_WAIT = 0, // esp_camera_fb_get 阻塞时间
+    PREVIEW_PERF_CONVERT,          // 缩放/格式转换 (分段模式为每段)
+    PREVIEW_PERF_BUFFER_WAIT,      // 等待空闲的LCD缓冲区
+    PREVIEW_PERF_SUBMIT,           // 像素数据排队 (含队列满时的等待)
+    PREVIEW_PERF_TRANSFER,         // 每次颜色传输: 排队到 on_color_trans_done
+    PREVIEW_PERF_IDLE,             // 转换任务等待新帧
+    PREVIEW_PERF_FRAME,            // 相邻两帧提交完成的间隔
+    PREVIEW_PERF_LATENCY,          // 采集时间戳到该帧最后一次传输完成
+    PREVIEW_PERF_STAGE_COUNT
+} preview_perf_stage_t;
+
+// SPI traffic to the panel, for comparing partial updates with full frames.
+typedef struct {
+    uint32_t last_frame_bytes; // 最近一帧发送的字节数 (静止帧为 0)
+    uint32_t full_frame_bytes; // 整帧字节数
+    uint64_t bytes_sent;       // 累计
+    uint32_t frames;           // 已显示帧数
+    uint32_t static_frames;    // 无变化未发送的帧数
+    uint32_t idle_frames;      // 画面静止, 未转换也未发送的帧数 (EXAMPLE_MOTION_IDLE)
+    uint32_t corrupt_frames;   // 检测为损坏而丢弃的帧数 (EXAMPLE_FRAME_CHECK)
+    uint64_t bus_busy_us;      // 颜色传输占用 SPI 总线的时间
+    uint32_t bus_gaps;         // 一帧还有数据要发时总线空闲的次数
+    uint64_t bus_gap_us;
+} preview_pipeline_tx_stats_t;
+
+// How incoming camera frames are to be read. Changed only while the
+// pipeline is paused (capture_profile.h switches it at runtime).
+typedef struct {
+    pixformat_t format;             // PIXFORMAT_RGB565 / PIXFORMAT_YUV422
+    ov7670_window_mode_t window;    // 传感器开窗: 帧尺寸由窗口决定
+    uint16_t crop_width;            // 居中裁剪后缩放, 0 = 该分辨率的默认显示方式
+    uint16_t crop_height;
+} preview_capture_t;
+
+// Request the pipeline's buffers from the boot arena: the LCD output
+// buffers (full frames, or small bands when EXAMPLE_DISPLAY_BAND_ROWS > 0),
+// the dirty rect staging area and the luma plane. Nothing is allocated
+// later, also not when the capture format changes.
+esp_err_t preview_pipeline_reserve(buffer_arena_t *arena);
+
+// Set up the pipeline on the reserved buffers (after buffer_arena_commit).
+// Must run before the panel IO is created, because
+// preview_pipeline_color_trans_done() uses them.
+esp_err_t preview_pipeline_init(void);
+
+// on_color_trans_done callback for esp_lcd_panel_io_spi_config_t (ISR context).
+bool preview_pipeline_color_trans_done(esp_lcd_panel_io_handle_t panel_io,
+                                       esp_lcd_panel_io_event_data_t *edata, void *user_ctx);
+
+// Switch the scaling filter at runtime; takes effect on the next frame.
+void preview_pipeline_set_filter(frame_scaler_filter_t filter);
+
+// Turn the GDMA prefetch of source rows (EXAMPLE_SCALER_PREFETCH_ROWS) on
+// or off at runtime, e.g. to compare the per-frame CPU time with and
+// without PSRAM stalls in the periodic stats.
+void preview_pipeline_set_prefetch(bool enable);
+
+// Change the target frame rate at runtime (0 = as fast as the sensor and
+// the downstream stages allow); takes effect on the next frame.
+void preview_pipeline_set_target_fps(uint32_t fps);
+
+// Snapshot of the SPI traffic counters (not synchronised; for logging).
+void preview_pipeline_get_tx_stats(preview_pipeline_tx_stats_t *stats);
+
+// Percentiles of one stage since start. False when profiling is disabled.
+bool preview_pipeline_perf_summary(preview_perf_stage_t stage, perf_summary_t *summary);
+
+// Log p50/p95/p99 of every stage since start, plus the average FPS. The
+// same table for the last interval is logged with the periodic stats.
+void preview_pipeline_log_perf(void);
+
+// Time since boot (us) at which the first frame was queued to the panel,
+// 0 before that. Boot-to-first-frame is the number power cycles care about.
+int64_t preview_pipeline_first_frame_time(void);
+
+// Exposure statistics of the last scaled frame (EXAMPLE_FRAME_STATS_STEP):
+// channel histograms, clipped pixels, mean luma and a coarse brightness
+// grid, gathered during scaling. False when disabled or before the first
+// frame. Zero-copy frames are not scaled and do not update it.
+bool preview_pipeline_frame_stats(frame_stats_t *stats);
+
+// Motion state changes (EXAMPLE_MOTION_IDLE): moving is true when motion
+// starts, false when the scene has been static long enough for the display
+// to idle; score is the changed share of the thumbnail in permille.
+// Called from the convert task, so keep it short.
+typedef void (*preview_motion_cb_t)(bool moving, uint16_t score, void *ctx);
+
+// Register the motion callback (NULL to remove it).
+void preview_pipeline_set_motion_callback(preview_motion_cb_t cb, void *ctx);
+
+// Whether the scene is moving, and the score of the last frame (permille).
+// Always true without EXAMPLE_MOTION_IDLE.
+bool preview_pipeline_motion(uint16_t *score);
+
+// Frames checked for corruption so far, by verdict (EXAMPLE_FRAME_CHECK);
+// every class but FRAME_CHECK_OK was dropped before the LCD. False when
+// not built.
+bool preview_pipeline_frame_check_counts(uint32_t counts[FRAME_CHECK_CLASS_COUNT]);
+
+// Y plane of the last converted frame (EXAMPLE_PREVIEW_WIDTH x HEIGHT bytes),
+// or NULL when the camera is not in YUV422 mode. Written by the convert
+// task while the next frame is processed, so readers may see a mix.
+const uint8_t *preview_pipeline_luma(void);
+
+// Stop pulling camera frames and wait until every frame already taken has
+// been displayed or dropped, so no camera buffer is held by the pipeline.
+// ESP_ERR_TIMEOUT leaves the pipeline paused; call resume either way.
+esp_err_t preview_pipeline_pause(uint32_t timeout_ms);
+
+// Set the capture format. Frames whose timestamp is older than
+// valid_from_us (esp_timer time, e.g. the last sensor register write) are
+// dropped after resuming. Before preview_pipeline_start, or while paused.
+esp_err_t preview_pipeline_set_capture(const preview_capture_t *capture, int64_t valid_from_us);
+
+// Restart capturing. With timeout_ms > 0, wait until the first frame after
+// the pause has been queued to the panel and return its time in *shown_us.
+esp_err_t preview_pipeline_resume(uint32_t timeout_ms, int64_t *shown_us);
+
+// Create the pinned capture, convert and display tasks. Pixel data is sent
+// straight through the panel IO (the panel must be initialised already).
+esp_err_t preview_pipeline_start(esp_lcd_panel_io_handle_t io_handle);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,163 @@
+/*
+ * SCCB shadow-register cache
+ * SCCB 寄存器影子缓存
+ */
+#include <string.h>
+#include "sccb_cache.h"
+
+static inline bool bit_test(const uint32_t *map, uint8_t reg)
+{
+    return (map[reg >> 5] >> (reg & 31)) & 1;
+}
+
+static inline void bit_set(uint32_t *map, uint8_t reg)
+{
+    map[reg >> 5] |= 1u << (reg & 31);
+}
+
+static inline void bit_clear(uint32_t *map, uint8_t reg)
+{
+    map[reg >> 5] &= ~(1u << (reg & 31));
+}
+
+void sccb_cache_init(sccb_cache_t *c, const sccb_bus_t *bus)
+{
+    memset(c, 0, sizeof(*c));
+    c->bus = *bus;
+}
+
+void sccb_cache_set_volatile(sccb_cache_t *c, uint8_t reg)
+{
+    bit_set(c->volatile_regs, reg);
+    sccb_cache_invalidate(c, reg);
+}
+
+void sccb_cache_set_reset(sccb_cache_t *c, uint8_t reset_reg, uint8_t reset_mask)
+{
+    c->reset_reg = reset_reg;
+    c->reset_mask = reset_mask;
+}
+
+void sccb_cache_invalidate(sccb_cache_t *c, uint8_t reg)
+{
+    bit_clear(c->known, reg);
+    bit_clear(c->hw_known, reg);
+}
+
+void sccb_cache_invalidate_all(sccb_cache_t *c)
+{
+    memset(c->known, 0, sizeof(c->known));
+    memset(c->hw_known, 0, sizeof(c->hw_known));
+}
+
+int sccb_cache_read(sccb_cache_t *c, uint8_t reg)
+{
+    if (bit_test(c->known, reg)) {
+        c->stats.read_hits++;
+        return c->shadow[reg];
+    }
+    int value = c->bus.read(c->bus.ctx, reg);
+    c->stats.reads++;
+    if (value < 0) {
+        c->stats.errors++;
+        return -1;
+    }
+    if (!bit_test(c->volatile_regs, reg)) {
+        c->shadow[reg] = c->hw[reg] = (uint8_t)value;
+        bit_set(c->known, reg);
+        bit_set(c->hw_known, reg);
+    }
+    return value;
+}
+
+// 把 shadow 写到硬件, 与已知硬件值相同时跳过
+static int flush_reg(sccb_cache_t *c, uint8_t reg)
+{
+    uint8_t value = c->shadow[reg];
+
+    if (bit_test(c->hw_known, reg) && c->hw[reg] == value) {
+        c->stats.writes_skipped++;
+        return 0;
+    }
+    c->stats.writes++;
+    if (c->bus.write(c->bus.ctx, reg, value) != 0) {
+        c->stats.errors++;
+        sccb_cache_invalidate(c, reg);
+        return -1;
+    }
+    if (!bit_test(c->volatile_regs, reg)) {
+        c->hw[reg] = value;
+        bit_set(c->hw_known, reg);
+    }
+    return 0;
+}
+
+int sccb_cache_write(sccb_cache_t *c, uint8_t reg, uint8_t mask, uint8_t value)
+{
+    bool is_volatile = bit_test(c->volatile_regs, reg);
+    uint8_t current = c->shadow[reg];
+
+    // 部分写入需要其余位的当前值: 缓存里有就不用读
+    if (mask != 0xff && (is_volatile || !bit_test(c->known, reg))) {
+        int read = sccb_cache_read(c, reg);
+        if (read < 0) {
+            return -1;
+        }
+        current = (uint8_t)read;
+    }
+    uint8_t merged = (current & ~mask) | (value & mask);
+
+    if (c->reset_mask && reg == c->reset_reg && (merged & c->reset_mask)) {
+        // 复位: 之前暂存的写入已经没有意义
+        c->stats.writes++;
+        int ret = c->bus.write(c->bus.ctx, reg, merged);
+        memset(c->pending_map, 0, sizeof(c->pending_map));
+        c->pending_count = 0;
+        sccb_cache_invalidate_all(c);
+        if (ret != 0) {
+            c->stats.errors++;
+            return -1;
+        }
+        return 0;
+    }
+
+    if (!is_volatile && bit_test(c->known, reg) && merged == current) {
+        c->stats.writes_skipped++;
+        return 0;
+    }
+    c->shadow[reg] = merged;
+    if (!is_volatile) {
+        bit_set(c->known, reg);
+    }
+    if (!c->batching) {
+        return flush_reg(c, reg);
+    }
+    if (!bit_test(c->pending_map, reg)) {
+        bit_set(c->pending_map, reg);
+        c->pending[c->pending_count++] = reg;
+    }
+    return 0;
+}
+
+void sccb_cache_begin(sccb_cache_t *c)
+{
+    c->batching = true;
+}
+
+int sccb_cache_commit(sccb_cache_t *c)
+{
+    int ret = 0;
+
+    c->batching = false;
+    for (uint16_t i = 0; i < c->pending_count; i++) {
+        uint8_t reg = c->pending[i];
+        bit_clear(c->pending_map, reg);
+        if (ret == 0) {
+            ret = flush_reg(c, reg);
+        } else {
+            sccb_cache_invalidate(c, reg);
+        }
+    }
+    c->pending_count = 0;
+    return ret;
+}
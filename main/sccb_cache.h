@@ -0,0 +1,89 @@
+/*
+ * SCCB shadow-register cache
+ * SCCB 寄存器影子缓存（跳过重复写入、批量提交）
+ *
+ * Plain C, no ESP-IDF dependencies, so it also builds on Linux; the bus is
+ * a pair of callbacks, which can be a fake register file in a test.
+ * Reads are served from the shadow once a register has been read or
+ * written. Masked writes merge into the cached value instead of a read
+ * round trip. A write that leaves the value unchanged is dropped. Between
+ * begin and commit, writes only update the shadow; commit sends each
+ * changed register once, in first-write order, with its final value.
+ *
+ * Registers the sensor changes by itself (AGC/AEC/AWB results) are marked
+ * volatile and always go to the bus. Writing the reset bit forgets
+ * everything. Anything that writes the sensor behind the cache's back
+ * (e.g. esp32-camera setters) must invalidate it.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define SCCB_CACHE_REGS 256
+#define SCCB_CACHE_WORDS (SCCB_CACHE_REGS / 32)
+
+typedef struct {
+    int (*read)(void *ctx, uint8_t reg);                // 返回值 0..255, 失败 <0
+    int (*write)(void *ctx, uint8_t reg, uint8_t value); // 成功返回 0
+    void *ctx;
+} sccb_bus_t;
+
+typedef struct {
+    uint32_t reads;          // 总线读
+    uint32_t read_hits;      // 从缓存返回的读
+    uint32_t writes;         // 总线写
+    uint32_t writes_skipped; // 值未变化, 未发送
+    uint32_t errors;
+} sccb_cache_stats_t;
+
+typedef struct {
+    sccb_bus_t bus;
+    uint8_t shadow[SCCB_CACHE_REGS];     // 提交后寄存器应有的值
+    uint8_t hw[SCCB_CACHE_REGS];         // 最后确认的硬件值
+    uint32_t known[SCCB_CACHE_WORDS];    // shadow 有效
+    uint32_t hw_known[SCCB_CACHE_WORDS]; // hw 有效
+    uint32_t volatile_regs[SCCB_CACHE_WORDS];
+    uint32_t pending_map[SCCB_CACHE_WORDS];
+    uint8_t pending[SCCB_CACHE_REGS];    // 待提交寄存器, 按首次写入顺序
+    uint16_t pending_count;
+    bool batching;
+    uint8_t reset_reg;
+    uint8_t reset_mask;                  // 0 = 没有复位位
+    sccb_cache_stats_t stats;
+} sccb_cache_t;
+
+void sccb_cache_init(sccb_cache_t *c, const sccb_bus_t *bus);
+
+// Registers the sensor updates on its own; never cached.
+void sccb_cache_set_volatile(sccb_cache_t *c, uint8_t reg);
+
+// Writing a value with any of reset_mask set in reset_reg resets the
+// sensor: the write is sent at once and the whole cache is forgotten.
+void sccb_cache_set_reset(sccb_cache_t *c, uint8_t reset_reg, uint8_t reset_mask);
+
+// Current value (0..255), from the shadow when known, or -1 on a bus error.
+int sccb_cache_read(sccb_cache_t *c, uint8_t reg);
+
+// Change the bits in mask to value. Immediate outside a batch. 0 or -1.
+int sccb_cache_write(sccb_cache_t *c, uint8_t reg, uint8_t mask, uint8_t value);
+
+// Collect writes until commit. Nested begin is not supported.
+void sccb_cache_begin(sccb_cache_t *c);
+
+// Send the registers changed since begin. On a bus error the remaining
+// writes are dropped and their registers forgotten; returns -1.
+int sccb_cache_commit(sccb_cache_t *c);
+
+void sccb_cache_invalidate(sccb_cache_t *c, uint8_t reg);
+void sccb_cache_invalidate_all(sccb_cache_t *c);
+
+#ifdef __cplusplus
+}
+#endif
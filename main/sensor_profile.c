@@ -0,0 +1,312 @@
+/*
+ * Declarative sensor settings and readiness polling
+ * 传感器配置表与就绪检测
+ */
+#include <inttypes.h>
+#include <stdlib.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "frame_analysis.h"
+#include "sensor_profile.h"
+
+static const char *TAG = "sensor_profile";
+
+// 自动增益/曝光/白平衡的结果寄存器 (OV7670 datasheet), 传感器自己会改
+#define OV7670_REG_GAIN 0x00
+#define OV7670_REG_BLUE 0x01
+#define OV7670_REG_RED 0x02
+#define OV7670_REG_COM1 0x04   // AEC[1:0]
+#define OV7670_REG_AECHH 0x07  // AEC[15:10]
+#define OV7670_REG_AECH 0x10
+#define OV7670_COM7_RESET 0x80
+
+// 亮度每隔多少像素取样一次
+#define SETTLE_LUMA_STEP 61
+
+static const uint8_t s_sample_regs[SENSOR_SAMPLE_REGS] = {
+    OV7670_REG_GAIN, OV7670_REG_AECH, OV7670_REG_BLUE, OV7670_REG_RED,
+};
+
+static const uint8_t s_volatile_regs[] = {
+    OV7670_REG_GAIN, OV7670_REG_BLUE, OV7670_REG_RED, OV7670_REG_VREF,
+    OV7670_REG_COM1, OV7670_REG_AECHH, OV7670_REG_AECH,
+};
+
+static sccb_cache_t s_regs;
+static sensor_t *s_regs_sensor;
+static int s_applied[SENSOR_SETTING_COUNT];   // setter 上次设置的值
+static uint32_t s_applied_known;              // 按 setting id 的位图
+static uint32_t s_setters_called, s_setters_skipped;
+
+static const char *const s_setting_names[] = {
+    "pixformat", "framesize", "colorbar", "brightness", "contrast", "saturation",
+    "gainceiling", "whitebal", "gain_ctrl", "exposure_ctrl", "hmirror", "vflip",
+    "raw_gma", "lenc", "awb_gain", "wb_mode", "dcw", "bpc", "wpc", "special_effect",
+    "agc_gain", "aec_value", "quality", "reg",
+};
+
+static int bus_read(void *ctx, uint8_t reg)
+{
+    sensor_t *s = ctx;
+    return s->get_reg ? s->get_reg(s, reg, 0xff) : -1;
+}
+
+static int bus_write(void *ctx, uint8_t reg, uint8_t value)
+{
+    sensor_t *s = ctx;
+    return s->set_reg ? s->set_reg(s, reg, 0xff, value) : -1;
+}
+
+// 每个传感器对象一份缓存, 切换传感器时重建
+static sccb_cache_t *regs_for(sensor_t *s)
+{
+    if (s_regs_sensor != s) {
+        sccb_bus_t bus = {.read = bus_read, .write = bus_write, .ctx = s};
+        sccb_cache_init(&s_regs, &bus);
+        for (size_t i = 0; i < sizeof(s_volatile_regs); i++) {
+            sccb_cache_set_volatile(&s_regs, s_volatile_regs[i]);
+        }
+        sccb_cache_set_reset(&s_regs, OV7670_REG_COM7, OV7670_COM7_RESET);
+        s_regs_sensor = s;
+        s_applied_known = 0;
+    }
+    return &s_regs;
+}
+
+// 调用对应的 setter; 驱动未实现时返回 ESP_ERR_NOT_SUPPORTED
+static esp_err_t apply_setting(sensor_t *s, const sensor_setting_t *setting)
+{
+    int v = setting->value;
+    int ret;
+
+#define CALL_SETTER(fn, arg) \
+    if (s->fn == NULL) {     \
+        return ESP_ERR_NOT_SUPPORTED; \
+    }                        \
+    ret = s->fn(s, arg);     \
+    break
+
+    switch (setting->id) {
+    case SENSOR_SET_PIXFORMAT: CALL_SETTER(set_pixformat, (pixformat_t)v);
+    case SENSOR_SET_FRAMESIZE: CALL_SETTER(set_framesize, (framesize_t)v);
+    case SENSOR_SET_COLORBAR: CALL_SETTER(set_colorbar, v);
+    case SENSOR_SET_BRIGHTNESS: CALL_SETTER(set_brightness, v);
+    case SENSOR_SET_CONTRAST: CALL_SETTER(set_contrast, v);
+    case SENSOR_SET_SATURATION: CALL_SETTER(set_saturation, v);
+    case SENSOR_SET_GAINCEILING: CALL_SETTER(set_gainceiling, (gainceiling_t)v);
+    case SENSOR_SET_WHITEBAL: CALL_SETTER(set_whitebal, v);
+    case SENSOR_SET_GAIN_CTRL: CALL_SETTER(set_gain_ctrl, v);
+    case SENSOR_SET_EXPOSURE_CTRL: CALL_SETTER(set_exposure_ctrl, v);
+    case SENSOR_SET_HMIRROR: CALL_SETTER(set_hmirror, v);
+    case SENSOR_SET_VFLIP: CALL_SETTER(set_vflip, v);
+    case SENSOR_SET_RAW_GMA: CALL_SETTER(set_raw_gma, v);
+    case SENSOR_SET_LENC: CALL_SETTER(set_lenc, v);
+    case SENSOR_SET_AWB_GAIN: CALL_SETTER(set_awb_gain, v);
+    case SENSOR_SET_WB_MODE: CALL_SETTER(set_wb_mode, v);
+    case SENSOR_SET_DCW: CALL_SETTER(set_dcw, v);
+    case SENSOR_SET_BPC: CALL_SETTER(set_bpc, v);
+    case SENSOR_SET_WPC: CALL_SETTER(set_wpc, v);
+    case SENSOR_SET_SPECIAL_EFFECT: CALL_SETTER(set_special_effect, v);
+    case SENSOR_SET_AGC_GAIN: CALL_SETTER(set_agc_gain, v);
+    case SENSOR_SET_AEC_VALUE: CALL_SETTER(set_aec_value, v);
+    case SENSOR_SET_QUALITY: CALL_SETTER(set_quality, v);
+    case SENSOR_SET_REG:
+        if (s->set_reg == NULL) {
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+        // 只进入缓存, 在 profile 结束时统一发送
+        return sccb_cache_write(&s_regs, (uint8_t)(v >> 16), (uint8_t)(v >> 8), (uint8_t)v) == 0 ?
+               ESP_OK : ESP_FAIL;
+    default:
+        return ESP_ERR_INVALID_ARG;
+    }
+#undef CALL_SETTER
+    return ret == 0 ? ESP_OK : ESP_FAIL;
+}
+
+// setter 与上次设置的值相同时跳过; 真正调用后驱动直接写了寄存器, 缓存作废
+static esp_err_t apply_setter(sensor_t *s, const sensor_setting_t *setting)
+{
+    uint32_t bit = 1u << setting->id;
+
+    if ((s_applied_known & bit) && s_applied[setting->id] == setting->value) {
+        s_setters_skipped++;
+        return ESP_OK;
+    }
+    // 先发出之前暂存的寄存器, 保持与表中顺序一致
+    if (sccb_cache_commit(&s_regs) != 0) {
+        return ESP_FAIL;
+    }
+    sccb_cache_begin(&s_regs);
+    esp_err_t ret = apply_setting(s, setting);
+    if (ret == ESP_ERR_NOT_SUPPORTED) {
+        return ret;
+    }
+    s_setters_called++;
+    sccb_cache_invalidate_all(&s_regs);
+    s_applied_known &= ~bit;
+    if (ret == ESP_OK) {
+        s_applied[setting->id] = setting->value;
+        s_applied_known |= bit;
+    }
+    return ret;
+}
+
+esp_err_t sensor_profile_apply(sensor_t *s, const sensor_setting_t *settings, size_t count)
+{
+    int64_t start = esp_timer_get_time();
+    sccb_cache_t *regs = regs_for(s);
+    sccb_cache_stats_t before = regs->stats;
+    uint32_t unchanged = s_setters_skipped;
+    size_t unsupported = 0;
+    esp_err_t ret = ESP_OK;
+
+    sccb_cache_begin(regs);
+    for (size_t i = 0; i < count && ret == ESP_OK; i++) {
+        if ((unsigned)settings[i].id >= SENSOR_SETTING_COUNT) {
+            ret = ESP_ERR_INVALID_ARG;
+            break;
+        }
+        const char *name = s_setting_names[settings[i].id];
+        ret = settings[i].id == SENSOR_SET_REG ? apply_setting(s, &settings[i]) :
+              apply_setter(s, &settings[i]);
+        if (ret == ESP_ERR_NOT_SUPPORTED) {
+            ESP_LOGW(TAG, "⚠ set_%s not available, skipped", name);
+            unsupported++;
+            ret = ESP_OK;
+        } else if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "set_%s(%d) failed", name, settings[i].value);
+        }
+    }
+    if (sccb_cache_commit(regs) != 0 && ret == ESP_OK) {
+        ESP_LOGE(TAG, "SCCB register write failed");
+        ret = ESP_FAIL;
+    }
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ESP_LOGI(TAG, "✓ %u settings: %" PRIu32 " unchanged, %u unsupported; SCCB %" PRIu32 " writes, %" PRIu32 " skipped; %" PRId64 " ms",
+             (unsigned)count, s_setters_skipped - unchanged, (unsigned)unsupported,
+             regs->stats.writes - before.writes, regs->stats.writes_skipped - before.writes_skipped,
+             (esp_timer_get_time() - start) / 1000);
+    return ESP_OK;
+}
+
+esp_err_t sensor_profile_write_regs(sensor_t *s, const ov7670_reg_t *regs, size_t count)
+{
+    sccb_cache_t *cache = regs_for(s);
+
+    if (s->set_reg == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    sccb_cache_begin(cache);
+    for (size_t i = 0; i < count; i++) {
+        if (sccb_cache_write(cache, regs[i].reg, regs[i].mask, regs[i].value) != 0) {
+            sccb_cache_commit(cache);
+            ESP_LOGE(TAG, "Failed to read sensor register 0x%02x", regs[i].reg);
+            return ESP_FAIL;
+        }
+    }
+    if (sccb_cache_commit(cache) != 0) {
+        ESP_LOGE(TAG, "SCCB register write failed");
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+int sensor_profile_read_reg(sensor_t *s, uint8_t reg)
+{
+    return s->get_reg ? sccb_cache_read(regs_for(s), reg) : -1;
+}
+
+void sensor_profile_invalidate(void)
+{
+    sccb_cache_invalidate_all(&s_regs);
+    s_applied_known = 0;
+}
+
+void sensor_profile_forget(sensor_setting_id_t id)
+{
+    if ((unsigned)id < SENSOR_SETTING_COUNT) {
+        s_applied_known &= ~(1u << id);
+    }
+}
+
+void sensor_profile_get_stats(sensor_profile_stats_t *stats)
+{
+    stats->setters_called = s_setters_called;
+    stats->setters_skipped = s_setters_skipped;
+    stats->sccb = s_regs.stats;
+}
+
+void sensor_settle_init(sensor_settle_t *st, const sensor_settle_config_t *config)
+{
+    *st = (sensor_settle_t) {
+        .config = *config,
+    };
+}
+
+bool sensor_settle_update(sensor_settle_t *st, const sensor_sample_t *sample)
+{
+    const sensor_settle_config_t *cfg = &st->config;
+    bool steady = sample->luma >= cfg->min_luma && st->have_last &&
+                  abs(sample->luma - st->last.luma) <= cfg->luma_tolerance;
+
+    if (steady && sample->has_regs && st->last.has_regs) {
+        for (int i = 0; i < SENSOR_SAMPLE_REGS; i++) {
+            steady = steady && abs(sample->regs[i] - st->last.regs[i]) <= cfg->reg_tolerance;
+        }
+    }
+    st->stable = steady ? st->stable + 1 : 0;
+    st->last = *sample;
+    st->have_last = true;
+    st->frames++;
+    return st->stable >= cfg->stable_frames;
+}
+
+esp_err_t sensor_wait_ready(sensor_t *s, const sensor_settle_config_t *config,
+                            sensor_settle_result_t *result)
+{
+    sensor_settle_t st;
+    int64_t start = esp_timer_get_time();
+    int64_t deadline = start + config->timeout_ms * 1000LL;
+    bool converged = false;
+
+    sensor_settle_init(&st, config);
+    while (!converged && esp_timer_get_time() < deadline) {
+        camera_fb_t *fb = esp_camera_fb_get();
+        if (fb == NULL) {
+            continue;
+        }
+        sensor_sample_t sample = {
+            .luma = frame_analysis_mean_luma(fb->buf, fb->len, fb->format == PIXFORMAT_YUV422,
+                                             SETTLE_LUMA_STEP),
+        };
+        esp_camera_fb_return(fb);
+
+        // 读取寄存器需要驱动支持 get_reg, 否则只看帧亮度
+        sample.has_regs = s->get_reg != NULL;
+        for (int i = 0; i < SENSOR_SAMPLE_REGS && sample.has_regs; i++) {
+            int value = sensor_profile_read_reg(s, s_sample_regs[i]);
+            sample.has_regs = value >= 0;
+            sample.regs[i] = (uint8_t)value;
+        }
+        converged = sensor_settle_update(&st, &sample);
+    }
+
+    result->converged = converged;
+    result->frames = st.frames;
+    result->elapsed_ms = (uint32_t)((esp_timer_get_time() - start) / 1000);
+    if (st.frames == 0) {
+        ESP_LOGE(TAG, "No frame from the sensor within %" PRIu32 " ms", config->timeout_ms);
+        return ESP_ERR_TIMEOUT;
+    }
+    if (converged) {
+        ESP_LOGI(TAG, "✓ Sensor settled after %" PRIu32 " frames, %" PRIu32 " ms (luma %u)",
+                 result->frames, result->elapsed_ms, st.last.luma);
+    } else {
+        ESP_LOGW(TAG, "⚠ Sensor not settled after %" PRIu32 " ms (%" PRIu32 " frames, luma %u), starting anyway",
+                 result->elapsed_ms, result->frames, st.last.luma);
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,139 @@
+/*
+ * Declarative sensor settings and readiness polling
+ * 传感器配置表与就绪检测（替代逐项设置后的固定延时）
+ *
+ * A profile is one table of sensor_t setter calls applied back to back;
+ * SCCB writes take effect within a frame or two, so no per-setting delay
+ * is needed. Readiness is then decided from the frames themselves: the
+ * sensor is settled once the AGC/AEC/AWB registers (when the driver
+ * implements get_reg) and the mean frame luma stop moving for a few
+ * consecutive frames, with a timeout as the upper bound.
+ *
+ * Register access (raw SENSOR_SET_REG entries, window tables, settle
+ * polling) goes through an SCCB shadow cache (sccb_cache.h), and setters
+ * remember the last value they applied, so re-applying a profile only
+ * touches what actually changed. Profile register writes are collected
+ * and sent together at the end of the profile.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_camera.h"
+#include "ov7670_window.h"
+#include "sccb_cache.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef enum {
+    SENSOR_SET_PIXFORMAT,
+    SENSOR_SET_FRAMESIZE,
+    SENSOR_SET_COLORBAR,
+    SENSOR_SET_BRIGHTNESS,
+    SENSOR_SET_CONTRAST,
+    SENSOR_SET_SATURATION,
+    SENSOR_SET_GAINCEILING,
+    SENSOR_SET_WHITEBAL,
+    SENSOR_SET_GAIN_CTRL,
+    SENSOR_SET_EXPOSURE_CTRL,
+    SENSOR_SET_HMIRROR,
+    SENSOR_SET_VFLIP,
+    SENSOR_SET_RAW_GMA,
+    SENSOR_SET_LENC,
+    SENSOR_SET_AWB_GAIN,
+    SENSOR_SET_WB_MODE,
+    SENSOR_SET_DCW,
+    SENSOR_SET_BPC,
+    SENSOR_SET_WPC,
+    SENSOR_SET_SPECIAL_EFFECT,
+    SENSOR_SET_AGC_GAIN,
+    SENSOR_SET_AEC_VALUE,
+    SENSOR_SET_QUALITY,
+    SENSOR_SET_REG,       // 直接写寄存器: reg/mask/value
+    SENSOR_SETTING_COUNT
+} sensor_setting_id_t;
+
+typedef struct {
+    sensor_setting_id_t id;
+    int value;     // SENSOR_SET_REG: reg << 16 | mask << 8 | value
+} sensor_setting_t;
+
+#define SENSOR_REG(reg, mask, value) {SENSOR_SET_REG, ((reg) << 16) | ((mask) << 8) | (value)}
+
+typedef struct {
+    uint32_t setters_called;
+    uint32_t setters_skipped;  // 与上次设置的值相同
+    sccb_cache_stats_t sccb;
+} sensor_profile_stats_t;
+
+// Apply every setting in order. Settings the driver does not implement are
+// skipped with a warning; a setter returning an error fails the profile.
+// Setters called with the value they last applied are not called again.
+esp_err_t sensor_profile_apply(sensor_t *s, const sensor_setting_t *settings, size_t count);
+
+// Write a register table (e.g. ov7670_window_regs) as one batch.
+esp_err_t sensor_profile_write_regs(sensor_t *s, const ov7670_reg_t *regs, size_t count);
+
+// Read a register through the cache; -1 when unsupported or on error.
+int sensor_profile_read_reg(sensor_t *s, uint8_t reg);
+
+// Forget all cached register and setter state (after a sensor reset).
+void sensor_profile_invalidate(void);
+
+// Forget the last value of one setter, so the next profile calls it again
+// (e.g. set_framesize after window registers were written over it).
+void sensor_profile_forget(sensor_setting_id_t id);
+
+void sensor_profile_get_stats(sensor_profile_stats_t *stats);
+
+typedef struct {
+    uint32_t timeout_ms;     // 最长等待, 超时后仍然开始预览
+    uint8_t stable_frames;   // 连续多少帧不变视为收敛
+    uint8_t reg_tolerance;   // 增益/曝光/白平衡寄存器帧间允许的变化
+    uint8_t luma_tolerance;  // 平均亮度帧间允许的变化
+    uint8_t min_luma;        // 平均亮度低于该值视为无效帧 (全黑)
+} sensor_settle_config_t;
+
+#define SENSOR_SAMPLE_REGS 4 // GAIN, AECH, BLUE, RED
+
+// One frame's worth of convergence inputs.
+typedef struct {
+    bool has_regs;
+    uint8_t regs[SENSOR_SAMPLE_REGS];
+    uint8_t luma;
+} sensor_sample_t;
+
+typedef struct {
+    sensor_settle_config_t config;
+    sensor_sample_t last;
+    bool have_last;
+    uint8_t stable;
+    uint32_t frames;
+} sensor_settle_t;
+
+void sensor_settle_init(sensor_settle_t *st, const sensor_settle_config_t *config);
+
+// Feed one frame; true once stable_frames consecutive frames were valid
+// and within tolerance of the previous one.
+bool sensor_settle_update(sensor_settle_t *st, const sensor_sample_t *sample);
+
+typedef struct {
+    bool converged;      // false: 超时
+    uint32_t frames;     // 检查过的帧数
+    uint32_t elapsed_ms;
+} sensor_settle_result_t;
+
+// Pull frames with esp_camera_fb_get until the sensor has settled or the
+// timeout expires. ESP_ERR_TIMEOUT only when no frame arrived at all.
+esp_err_t sensor_wait_ready(sensor_t *s, const sensor_settle_config_t *config,
+                            sensor_settle_result_t *result);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,162 @@
+/*
+ * SPI pixel clock search with readback verification
+ * SPI 像素时钟搜索
+ */
+#include <string.h>
+#include "spi_clock_tune.h"
+
+size_t spi_clock_tune_candidates(const spi_clock_tune_config_t *config, uint32_t *hz, size_t max)
+{
+    size_t n = 0;
+
+    if (config->min_hz == 0 || config->max_hz < config->min_hz) {
+        return 0;
+    }
+    // 分频系数从大到小, 时钟从慢到快; 先取不超过 max_hz 的最小分频
+    uint32_t div_min = (config->source_hz + config->max_hz - 1) / config->max_hz;
+    uint32_t div_max = config->source_hz / config->min_hz;
+    if (div_min == 0) {
+        div_min = 1;
+    }
+    for (uint32_t div = div_max; div >= div_min && n < max; div--) {
+        hz[n++] = config->source_hz / div;
+    }
+    return n;
+}
+
+static uint32_t xorshift32(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+void spi_clock_tune_pattern(uint32_t round, uint16_t *pixels, size_t count)
+{
+    uint32_t seed = 0x9e3779b9u ^ (round * 0x85ebca6bu);
+
+    for (size_t i = 0; i < count; i++) {
+        switch (round) {
+        case 1:
+            pixels[i] = i & 1 ? 0x0000 : 0xffff; // 每一位都翻转
+            break;
+        case 2:
+            pixels[i] = i & 1 ? 0x5555 : 0xaaaa; // 相邻位相反
+            break;
+        case 3:
+            pixels[i] = (uint16_t)(1u << (i % 16));
+            break;
+        default:
+            // 第 0 行也用来识别回读格式, 随机数据不会在错位时碰巧一致
+            pixels[i] = (uint16_t)(xorshift32(&seed) >> 16);
+            break;
+        }
+    }
+}
+
+// 从第 bit 位开始的一个字节, 大端位序
+static inline uint8_t raw_byte(const uint8_t *raw, uint32_t bit)
+{
+    uint32_t i = bit / 8, shift = bit % 8;
+    uint16_t word = (uint16_t)(raw[i] << 8 | raw[i + 1]);
+    return (uint8_t)(word >> (8 - shift));
+}
+
+uint32_t spi_clock_tune_compare(const uint16_t *pixels, size_t count, const uint8_t *raw,
+                                uint8_t dummy_bits, bool swap_rb)
+{
+    uint32_t errors = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        uint32_t bit = dummy_bits + (uint32_t)i * 24;
+        // 每个分量 6 位, 左对齐在字节的高位
+        uint8_t c0 = raw_byte(raw, bit) >> 2;
+        uint8_t g = raw_byte(raw, bit + 8) >> 2;
+        uint8_t c2 = raw_byte(raw, bit + 16) >> 2;
+        uint8_t r = swap_rb ? c2 : c0, b = swap_rb ? c0 : c2;
+        uint16_t p = pixels[i];
+        if ((r >> 1) != (p >> 11) || g != ((p >> 5) & 0x3f) || (b >> 1) != (p & 0x1f)) {
+            errors++;
+        }
+    }
+    return errors;
+}
+
+// 在一个时钟下写读 rounds 行, 返回出错的像素数; 面板回调失败时全部计为错误
+static uint32_t probe(const spi_clock_tune_config_t *config, const spi_clock_panel_t *panel,
+                      uint32_t hz, const spi_clock_tune_result_t *format)
+{
+    uint16_t pixels[SPI_CLOCK_TUNE_MAX_PIXELS];
+    uint8_t raw[SPI_CLOCK_TUNE_RAW_BYTES(SPI_CLOCK_TUNE_MAX_PIXELS)];
+    size_t raw_len = SPI_CLOCK_TUNE_RAW_BYTES(config->pixels);
+    uint32_t errors = 0;
+
+    for (uint32_t round = 0; round < config->rounds; round++) {
+        spi_clock_tune_pattern(round, pixels, config->pixels);
+        memset(raw, 0, sizeof(raw));
+        if (panel->write_read(panel->ctx, hz, pixels, config->pixels, raw, raw_len) != 0) {
+            errors += config->pixels;
+            continue;
+        }
+        errors += spi_clock_tune_compare(pixels, config->pixels, raw, format->dummy_bits,
+                                         format->swap_rb);
+    }
+    return errors;
+}
+
+// 在已知可用的时钟下找出空闲位数与 R/B 顺序
+static bool detect_format(const spi_clock_tune_config_t *config, const spi_clock_panel_t *panel,
+                          spi_clock_tune_result_t *result)
+{
+    uint16_t pixels[SPI_CLOCK_TUNE_MAX_PIXELS];
+    uint8_t raw[SPI_CLOCK_TUNE_RAW_BYTES(SPI_CLOCK_TUNE_MAX_PIXELS)] = {0};
+
+    spi_clock_tune_pattern(0, pixels, config->pixels);
+    if (panel->write_read(panel->ctx, config->min_hz, pixels, config->pixels, raw,
+                          SPI_CLOCK_TUNE_RAW_BYTES(config->pixels)) != 0) {
+        return false;
+    }
+    for (uint8_t dummy = 0; dummy <= SPI_CLOCK_TUNE_MAX_DUMMY_BITS; dummy++) {
+        for (int swap = 0; swap < 2; swap++) {
+            if (spi_clock_tune_compare(pixels, config->pixels, raw, dummy, swap) == 0) {
+                result->dummy_bits = dummy;
+                result->swap_rb = swap;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool spi_clock_tune_run(const spi_clock_tune_config_t *config, const spi_clock_panel_t *panel,
+                        spi_clock_tune_result_t *result)
+{
+    uint32_t hz[SPI_CLOCK_TUNE_MAX_STEPS];
+    size_t count = spi_clock_tune_candidates(config, hz, SPI_CLOCK_TUNE_MAX_STEPS);
+    size_t passed = 0;
+
+    memset(result, 0, sizeof(*result));
+    if (count == 0 || config->pixels == 0 || config->pixels > SPI_CLOCK_TUNE_MAX_PIXELS ||
+        config->rounds == 0 || !detect_format(config, panel, result)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        spi_clock_step_t *step = &result->steps[result->step_count++];
+        step->hz = hz[i];
+        step->errors = probe(config, panel, hz[i], result);
+        if (step->errors != 0) {
+            result->first_fail_hz = hz[i];
+            break;
+        }
+        passed = i + 1;
+    }
+    if (passed == 0) {
+        return false;
+    }
+    result->fastest_pass_hz = hz[passed - 1];
+    result->chosen_hz = hz[passed - 1 > config->margin_steps ? passed - 1 - config->margin_steps : 0];
+    return true;
+}
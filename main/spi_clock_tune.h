@@ -0,0 +1,88 @@
+/*
+ * SPI pixel clock search with readback verification
+ * SPI 像素时钟搜索：逐档升高写时钟，回读校验，选有余量的最快一档
+ *
+ * Plain C, no ESP-IDF dependencies, so it also builds on Linux; the panel
+ * is one callback, which can be a simulated panel on the host.
+ * Candidates are the integer divisions of the SPI source clock between
+ * min_hz and max_hz, tried from slow to fast. At each clock a few pattern
+ * rows are written and read back (RAMRD, at a fixed slow read clock, since
+ * the panel reads much slower than it writes). The first clock with any
+ * wrong pixel ends the search; the result is margin_steps below the
+ * fastest clock that passed.
+ *
+ * In 16-bit mode the ST7735S reads frame memory back as 18-bit RGB666,
+ * 3 bytes per pixel, after a few dummy clocks. The number of dummy bits
+ * and the R/B order are found once at min_hz, which must be known to work.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define SPI_CLOCK_TUNE_MAX_STEPS 16
+#define SPI_CLOCK_TUNE_MAX_PIXELS 160
+#define SPI_CLOCK_TUNE_MAX_DUMMY_BITS 16
+// 回读原始字节数: 每像素3字节, 加上最多 MAX_DUMMY_BITS 个空闲位
+#define SPI_CLOCK_TUNE_RAW_BYTES(count) ((count) * 3 + SPI_CLOCK_TUNE_MAX_DUMMY_BITS / 8 + 1)
+
+typedef struct {
+    // Write count RGB565 pixels (high byte first, as draw_bitmap sends them)
+    // at write_hz into one row, then read the row back with RAMRD and store
+    // the first raw_len bytes after the command. 0 on success.
+    int (*write_read)(void *ctx, uint32_t write_hz, const uint16_t *pixels, size_t count,
+                      uint8_t *raw, size_t raw_len);
+    void *ctx;
+} spi_clock_panel_t;
+
+typedef struct {
+    uint32_t source_hz;    // SPI 时钟源, 实际时钟为其整数分频
+    uint32_t min_hz;       // 已知可用的起点, 也用来识别回读格式
+    uint32_t max_hz;
+    uint32_t pixels;       // 每行像素数 (<= SPI_CLOCK_TUNE_MAX_PIXELS)
+    uint32_t rounds;       // 每档时钟写读的图案行数
+    uint32_t margin_steps; // 从最快通过的一档向下退的档数
+} spi_clock_tune_config_t;
+
+typedef struct {
+    uint32_t hz;
+    uint32_t errors;       // 出错的像素数 (所有行)
+} spi_clock_step_t;
+
+typedef struct {
+    uint32_t chosen_hz;       // 0 = 回读不可用 (MISO 未连接或起点就不通过)
+    uint32_t fastest_pass_hz;
+    uint32_t first_fail_hz;   // 0 = 所有档都通过
+    uint8_t dummy_bits;       // RAMRD 后、像素数据前的空闲位
+    bool swap_rb;
+    size_t step_count;
+    spi_clock_step_t steps[SPI_CLOCK_TUNE_MAX_STEPS];
+} spi_clock_tune_result_t;
+
+// Candidate clocks, ascending. Returns how many were written to hz.
+size_t spi_clock_tune_candidates(const spi_clock_tune_config_t *config, uint32_t *hz, size_t max);
+
+// Test pattern for one round: pseudo-random, full swing, 0xAAAA/0x5555,
+// walking one, then more pseudo-random rows.
+void spi_clock_tune_pattern(uint32_t round, uint16_t *pixels, size_t count);
+
+// Number of pixels whose readback does not match. RGB666 is compared at
+// RGB565 precision.
+uint32_t spi_clock_tune_compare(const uint16_t *pixels, size_t count, const uint8_t *raw,
+                                uint8_t dummy_bits, bool swap_rb);
+
+// Run the search. False when readback does not work at min_hz; result
+// still lists what was tried.
+bool spi_clock_tune_run(const spi_clock_tune_config_t *config, const spi_clock_panel_t *panel,
+                        spi_clock_tune_result_t *result);
+
+#ifdef __cplusplus
+}
+#endif
@@ -15,7 +15,8 @@
 #include "driver/spi_master.h"
 #include "esp_lcd_panel_io.h"
 #include "esp_lcd_panel_ops.h"
-#include "esp_heap_caps.h"
+#include "esp_lcd_panel_commands.h"
+#include "esp_attr.h"
 #include "esp_lcd_st7735.h"
 #include "example_config.h"
 
@@ -29,6 +30,10 @@ static esp_lcd_panel_handle_t panel_handle = NULL;
 #define ST7735S_LCD_H_RES 128
 #define ST7735S_LCD_V_RES 160
 
+// 纯色填充用的整屏缓冲区, 静态分配并重复使用.
+// draw_bitmap 只是把传输排队, 返回时 DMA 仍在读取, 不能在这之后释放它
+DMA_ATTR static uint16_t s_pixel_buffer[ST7735S_LCD_H_RES * ST7735S_LCD_V_RES];
+
 // GPIO调试函数 - 检查引脚状态
 static esp_err_t debug_gpio_status(void)
 {
@@ -196,16 +201,16 @@ static esp_err_t fill_color(uint16_t color)
 {
     ESP_LOGI(TAG, "填充颜色: 0x%04X (分辨率:%dx%d)", color, ST7735S_LCD_H_RES, ST7735S_LCD_V_RES);
     
-    // 分配像素缓冲区 - 使用ST7735S的实际分辨率
     size_t pixel_count = ST7735S_LCD_H_RES * ST7735S_LCD_V_RES;
-    ESP_LOGI(TAG, "分配像素缓冲区: %d 像素 (%d 字节)", pixel_count, pixel_count * sizeof(uint16_t));
-    
-    uint16_t *pixel_buffer = heap_caps_malloc(pixel_count * sizeof(uint16_t), MALLOC_CAP_DMA);
-    if (!pixel_buffer) {
-        ESP_LOGE(TAG, "像素缓冲区分配失败");
-        return ESP_ERR_NO_MEM;
+    uint16_t *pixel_buffer = s_pixel_buffer;
+
+    // 上一次填充的颜色传输可能还在进行: 命令以轮询方式发送, 会先等队列中的传输完成
+    esp_err_t ret = esp_lcd_panel_io_tx_param(io_handle, LCD_CMD_NOP, NULL, 0);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "等待上一次传输失败: %s", esp_err_to_name(ret));
+        return ret;
     }
-    
+
     // 填充缓冲区
     for (size_t i = 0; i < pixel_count; i++) {
         pixel_buffer[i] = color;
@@ -219,7 +224,7 @@ static esp_err_t fill_color(uint16_t color)
     ESP_LOGI(TAG, "尝试带偏移的绘制: X偏移=%d, Y偏移=%d", x_offset, y_offset);
     
     // 绘制到屏幕 - 使用ST7735S分辨率和偏移
-    esp_err_t ret = esp_lcd_panel_draw_bitmap(panel_handle, 
+    ret = esp_lcd_panel_draw_bitmap(panel_handle, 
                                              x_offset, y_offset, 
                                              x_offset + ST7735S_LCD_H_RES, 
                                              y_offset + ST7735S_LCD_V_RES, 
@@ -233,7 +238,6 @@ static esp_err_t fill_color(uint16_t color)
                                        pixel_buffer);
         if (ret != ESP_OK) {
             ESP_LOGE(TAG, "无偏移绘制位图也失败: %s", esp_err_to_name(ret));
-            free(pixel_buffer);
             return ret;
         }
         ESP_LOGI(TAG, "无偏移绘制成功");
@@ -241,7 +245,6 @@ static esp_err_t fill_color(uint16_t color)
         ESP_LOGI(TAG, "带偏移绘制成功");
     }
     
-    free(pixel_buffer);
     ESP_LOGI(TAG, "✓ 颜色填充完成");
     return ESP_OK;
 }